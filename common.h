@@ -36,9 +36,9 @@
 
 /* about */
 #define PROJECT          "mfreq"
-#define VERSION          "v3.19"
+#define VERSION          "v3.20"
 #define VERSION_MAJOR    3
-#define VERSION_MINOR    19
+#define VERSION_MINOR    20
 #define COPYRIGHT        "(c) 1994-2019 by Markus Reschke"
 
 /* default paths */
@@ -48,11 +48,53 @@
 /* buffer size (must not exceed the maximum value of an Integer */
 #define DEFAULT_BUFFER_SIZE   4096           /* standard buffer size */
 
+/* logfile */
+#define LOG_BUFFER_SIZE  16384      /* write buffer (whole lines) */
+#define LOG_FLUSH        1          /* default flush interval (in s) */
+#define MAX_LOG_FLUSH    3600       /* max. flush interval (in s) */
+
 /* fileindex */
 #define SUFFIX_DATA      "data"
 #define SUFFIX_LOOKUP    "lookup"
 #define SUFFIX_ALIAS     "alias"
 #define SUFFIX_OFFSET    "offset"
+#define SUFFIX_BLOOM     "bloom"
+#define SUFFIX_TABLE     "table"
+#define SUFFIX_TEMP      "tmp"
+#define SUFFIX_BAD       "bad"
+#define SUFFIX_CACHE     "cache"
+#define SUFFIX_AREA      "area"
+
+/* bloom filter of fileindex */
+#define BLOOM_BITS       10         /* bits per name */
+#define BLOOM_HASHES     7          /* number of hash functions */
+#define BLOOM_SEED       0x9E3779B9 /* seed for second hash */
+
+/* lookup table of fileindex */
+#define LOOKUP_ENTRIES   256        /* one entry per byte value */
+
+/* request journal */
+#define JOURNAL_MAGIC    0x4A51464D /* "MFQJ" (little endian) */
+#define JOURNAL_VERSION  1          /* record format */
+#define MAX_JOURNAL_SIZE 1048576    /* max. size of a record */
+
+/* download counters */
+#define COUNTER_MAGIC    0x434D464D /* "MFMC" (little endian) */
+#define COUNTER_SLOTS    65536      /* initial slots of hash table */
+#define MAX_COUNTER_SLOTS     16777216   /* max. slots of hash table */
+#define MAX_COUNTER_PROBES    64    /* max. slots checked per filepath */
+#define MAX_COUNTER_LOAD      75    /* max. used slots before rehash (in %) */
+
+/* hash index of file information list */
+#define INFO_HASH_SIZE   256        /* initial number of buckets */
+#define ARENA_BLOCK_SIZE 65536      /* size of description arena block */
+
+/* filelist */
+#define MAX_AREA_WORKERS 16         /* max. number of area workers */
+#define AREA_CACHE_MAGIC 0x414C464D /* "MFLA" (little endian) */
+#define LIST_BUFFER_SIZE 65536      /* stream buffer of output files */
+#define MAX_RENDER_FIELDS 8         /* max. data fields of render plan */
+#define DATE_CACHE_SIZE  64         /* entries of date string cache */
 
 
 /*
@@ -76,6 +118,24 @@
 #define L_WARN           3    /* warning */
 #define L_ERR            4    /* error */
 
+/* run modes */
+#define MODE_NONE        0    /* standalone */
+#define MODE_SERVER      1    /* resident server */
+#define MODE_CLIENT      2    /* pass request to resident server */
+#define MODE_BATCH       3    /* process spool directory */
+
+/* server mode */
+#define SOCKET_MODE      0660       /* permissions of server socket */
+
+/* batch mode */
+#define SPOOL_PATTERN    "*.srf"    /* default name pattern of SRIF files */
+#define SPOOL_MIN_AGE    5          /* minimum age of SRIF file (in s) */
+
+/* result cache */
+#define CACHE_MAX_FILES  10000      /* default limit for cache files */
+#define CACHE_PRUNE_TIME 3600       /* interval for pruning cache (in s) */
+#define CACHE_STAMP      ".prune"   /* stamp file of last pruning */
+
 /* cfg switches (bitmask, 16 bits) */
 /* common */
 #define SW_NONE               0b0000000000000000  /* no switch set */
@@ -92,6 +152,8 @@
 #define SW_TYPE_2PLUS         0b0000100000000000  /* packet type-2+ */
 #define SW_SEND_TEXT          0b0001000000000000  /* send response text file */
 #define SW_LOG_REQUEST        0b0010000000000000  /* extensive logging */
+#define SW_PARALLEL_SEARCH    0b0100000000000000  /* search indexes in parallel */
+#define SW_TIMING             0b1000000000000000  /* log timing of phases */
 
 /* file flags (bitmask, 16 bits) */
 #define FILE_NONE             0b0000000000000000  /* no flag set */
@@ -119,6 +181,48 @@
 #define RESP_DUPE             0b0000000000001000  /* duplicate file */
 #define RESP_INTDUPE          0b0000000000010000  /* internal dupe */
 
+/* pre-check results for matched files */
+#define CHECK_NONE            0    /* passed, file details required */
+#define CHECK_INTDUPE         1    /* internal dupe */
+#define CHECK_PWERROR         2    /* password error */
+#define CHECK_DUPE            3    /* duplicate file */
+#define CHECK_CACHED          4    /* passed, file size from cache */
+
+/* state of opened file index */
+#define INDEX_OK              0    /* ready for search */
+#define INDEX_SKIPPED         1    /* fs not mounted */
+#define INDEX_ERROR           2    /* couldn't open index */
+#define INDEX_NOMATCH         3    /* no request can match (bloom filter) */
+
+/* result of index search for a request */
+#define SCAN_NONE             0    /* not searched */
+#define SCAN_OK               1    /* searched */
+#define SCAN_ERROR            2    /* error */
+#define SCAN_OVERFLOW         3    /* input overflow */
+#define SCAN_CACHED           4    /* result cache */
+#define SCAN_TRUNCATED        5    /* too many matches, merge continues */
+
+/* phases of frequest processing (timing) */
+#define TIME_CONFIG           0    /* read config */
+#define TIME_SRIF             1    /* read and check SRIF */
+#define TIME_LIMITS           2    /* activate limits */
+#define TIME_REQUEST          3    /* read request */
+#define TIME_INDEX            4    /* open index, load lookup table */
+#define TIME_PRESEARCH        5    /* get start position (binary pre-search) */
+#define TIME_SCAN             6    /* search index data */
+#define TIME_STAT             7    /* get file details */
+#define TIME_MAIL             8    /* write netmail/textmail */
+#define TIME_RESPONSE         9    /* write response */
+#define TIME_PHASES           10   /* number of phases */
+
+/* search plan for requested filename pattern */
+#define PLAN_NAME             0    /* no wildcards, exact name */
+#define PLAN_PREFIX           1    /* fixed prefix, then pattern */
+#define PLAN_PATTERN          2    /* pattern matching for all names */
+#define PLAN_ALL              3    /* match-all ("*") */
+#define PLAN_SUFFIX           4    /* fixed suffix ("*.ZIP") */
+#define PLAN_CONTAINS         5    /* fixed substring ("*.*") */
+
 /* file request status (bitmask, 16 bits) */
 #define FREQ_NONE             0b0000000000000000  /* no status */
 #define FREQ_NO_FILE          0b0000000000000001  /* no file found */
@@ -170,6 +274,27 @@
 #define FIELD_FORM_SINGLE     1    /* single line */
 #define FIELD_FORM_MULTI      2    /* multiple lines */
 
+/* emitters of render plan */
+#define RENDER_NAME           1    /* file name */
+#define RENDER_NAME_DOS       2    /* file name with DOS check */
+#define RENDER_SIZE           3    /* file size */
+#define RENDER_DATE_US        4    /* date MM-DD-YY */
+#define RENDER_DATE_ISO       5    /* date YYYY-MM-DD */
+#define RENDER_COUNTER        6    /* counter [...] */
+#define RENDER_DESC           7    /* first line of description */
+
+/* formats of additional filelist outputs (sinks) */
+#define SINK_CSV              0    /* comma separated values */
+#define SINK_JSON             1    /* JSON */
+#define SINK_HTML             2    /* HTML */
+#define SINK_NEW              3    /* filelist of new files */
+#define SINKS                 4    /* number of formats */
+
+/* frame parts of sinks */
+#define FRAME_HEAD            1    /* start of output */
+#define FRAME_SEPARATOR       2    /* between areas */
+#define FRAME_TAIL            3    /* end of output */
+
 
 
 /* ************************************************************************
@@ -216,6 +341,15 @@ typedef struct index_lookup
 } IndexLookup_Type;
 
 
+/* lookup table entry for file index (indexed by initial letter) */
+typedef struct
+{
+  off_t                  Offset;        /* data file offset (-1: none) */
+  unsigned int           Start;         /* start line# */
+  unsigned int           Stop;          /* stop line# */
+} LookupEntry_Type;
+
+
 /* path aliases for file index (linked list) */
 typedef struct index_alias
 {
@@ -249,11 +383,32 @@ typedef struct aka
 } AKA_Type;
 
 
+/* resident file index (mapped files) */
+typedef struct index_map
+{
+  char              *Data;              /* data file */
+  off_t             DataSize;           /* size of data file */
+  char              *Alias;             /* alias paths (loaded alias file) */
+  off_t             AliasSize;          /* size of alias file */
+  char              *Offset;            /* offset file */
+  off_t             OffsetSize;         /* size of offset file */
+  LookupEntry_Type  *Lookup;            /* lookup table */
+  off_t             LookupSize;         /* size of mapped table (0: allocated) */
+  char              *Bloom;             /* bloom filter file (optional) */
+  off_t             BloomSize;          /* size of bloom filter file */
+} IndexMap_Type;
+
+
 /* index definition (linked list) */
 typedef struct index
 {
   char              *Filepath;          /* filepath of file index */
   char              *MountingPoint;     /* mounting point */
+  IndexMap_Type     *Map;               /* resident index */
+  ino_t             Inode;              /* generation: inode of data file */
+  time_t            MTime;              /* generation: mtime of data file */
+  ino_t             FailInode;          /* generation failed to load */
+  time_t            FailMTime;
   struct index      *Next;              /* pointer to next element */
 } Index_Type;
 
@@ -271,6 +426,27 @@ typedef struct limit
 } Limit_Type;
 
 
+/* rule of compiled request limits (linked list) */
+typedef struct limit_rule
+{
+  Limit_Type        *Limit;             /* request limit */
+  unsigned int      Number;             /* position in limit list */
+  struct limit_rule *Next;              /* pointer to next element */
+} LimitRule_Type;
+
+
+/* node of request limit trie (zone/net/node/point/domain) */
+typedef struct limit_node
+{
+  long              Value;              /* field value (-1: wildcard) */
+  char              *Domain;            /* domain (domain level only) */
+  struct limit_node **Children;         /* next level (sorted array) */
+  unsigned int      Count;              /* number of children */
+  LimitRule_Type    *Rest;              /* rules ending with "*" for next field */
+  LimitRule_Type    *End;               /* rules ending here */
+} LimitNode_Type;
+
+
 /* file found (linked list) */
 typedef struct response
 {
@@ -281,12 +457,26 @@ typedef struct response
 } Response_Type;
 
 
+/* matched file waiting for file details (array) */
+typedef struct pending
+{
+  Response_Type     *Response;          /* response element */
+  unsigned short    Check;              /* result of pre-checks */
+  off_t             Size;               /* filesize */
+} Pending_Type;
+
+
 /* requested file (linked list) */
 typedef struct request
 {
   char              *Name;              /* requested filename or pattern */
   char              *SearchName;        /* filename pattern to search for */
   char              *PW;                /* password */
+  unsigned short    Plan;               /* search plan */
+  int               Pos;                /* position of first wildcard */
+                                        /* -1: no wildcard at all */
+  char              *Literal;           /* fixed part (suffix/substring) */
+  size_t            LiteralLength;      /* length of fixed part */
   unsigned short    Status;             /* request status */
   Response_Type     *Files;             /* files to send (linked list) */
   Response_Type     *LastFile;          /* pointer to last element in list */
@@ -294,6 +484,156 @@ typedef struct request
 } Request_Type;
 
 
+/* match found by parallel index search or result cache (linked list) */
+typedef struct candidate
+{
+  char              *Filepath;          /* filepath (may include alias) */
+  char              *Password;          /* password (optional) */
+  off_t             Size;               /* filesize (result cache) */
+  struct candidate  *Next;              /* pointer to next element */
+} Candidate_Type;
+
+
+/* result of index search for a request */
+typedef struct
+{
+  unsigned short    Result;             /* search result */
+  Candidate_Type    *First;             /* matches (linked list) */
+  Candidate_Type    *Last;              /* pointer to last element in list */
+  off_t             Offset;             /* continue search here (truncated) */
+} ScanResult_Type;
+
+
+/* timing and counters of frequest processing */
+typedef struct
+{
+  long long         Time[TIME_PHASES];  /* time per phase (microseconds) */
+  unsigned long     Records;            /* index records scanned */
+  unsigned long     Patterns;           /* pattern matching calls */
+  unsigned long     Stats;              /* files stat'ed */
+} Timing_Type;
+
+
+/*
+ *  record of request journal (one per session)
+ *  - header, requester AKA (0-terminated), requests
+ *  - request: entry, pattern (0-terminated), responses
+ *  - response: entry, filename (0-terminated)
+ *  - host byte order, fixed layout without padding
+ */
+
+typedef struct
+{
+  uint32_t          Magic;              /* JOURNAL_MAGIC */
+  uint32_t          Size;               /* size of record */
+  int64_t           Time;               /* unix time of session */
+  int64_t           Bytes;              /* bytes sent */
+  uint32_t          Files;              /* files sent */
+  uint16_t          Status;             /* frequest status */
+  uint16_t          Requests;           /* number of requests */
+  uint16_t          Version;            /* record format */
+  uint16_t          AKALength;          /* size of AKA string */
+  uint32_t          Phases[TIME_PHASES];   /* time per phase (microseconds) */
+  uint32_t          Reserved;           /* padding */
+} JournalHeader_Type;
+
+typedef struct
+{
+  int64_t           Size;               /* file size (response) */
+  uint32_t          Count;              /* number of responses (request) */
+  uint16_t          Status;             /* request/response status */
+  uint16_t          Length;             /* size of string */
+} JournalEntry_Type;
+
+
+/* cache file (array, pruning result cache) */
+typedef struct
+{
+  time_t            MTime;              /* modification time */
+  char              Name[32];           /* filename */
+} CacheFile_Type;
+
+
+/* statistics of request journal (array) */
+typedef struct
+{
+  char              *Name;              /* filename or AKA */
+  unsigned long     Count;              /* sessions or times sent */
+  unsigned long     Files;              /* files sent */
+  long long         Bytes;              /* bytes sent */
+} JournalStat_Type;
+
+
+/*
+ *  download counters (mapped file, shared by several processes)
+ *  - header, hash table with power of 2 slots (COUNTER_SLOTS at start)
+ *  - slot: hash of filepath (0: unused), counter
+ *  - updated with atomic operations under a shared lock
+ *  - rehashed into a larger file under an exclusive lock, the old file
+ *    is marked as moved then
+ */
+
+typedef struct
+{
+  uint32_t          Magic;              /* COUNTER_MAGIC */
+  uint32_t          Slots;              /* number of slots */
+  uint32_t          Used;               /* number of used slots */
+  uint32_t          Moved;              /* store replaced by larger one */
+} CounterHeader_Type;
+
+typedef struct
+{
+  uint64_t          Key;                /* hash of filepath */
+  uint32_t          Count;              /* download counter */
+  uint32_t          Reserved;           /* padding */
+} CounterSlot_Type;
+
+typedef struct
+{
+  CounterHeader_Type     *Header;       /* mapped file */
+  CounterSlot_Type       *Slots;        /* hash table */
+  size_t                 Size;          /* size of mapped file */
+  int                    File;          /* file descriptor (locking) */
+  char                   *Filepath;     /* filepath of store */
+  unsigned int           Generation;    /* number of store switches */
+} CounterStore_Type;
+
+
+/* path aliases of opened file index */
+typedef struct
+{
+  char              *Paths;             /* alias file (paths terminated by 0) */
+  off_t             Size;               /* size of alias file */
+  _Bool             FreePaths;          /* paths loaded by search (to free) */
+  off_t             LastOffset;         /* offset of cached path (-1: none) */
+  size_t            LastLength;         /* length of cached path */
+  char              Buffer[DEFAULT_BUFFER_SIZE];   /* cached path + filename */
+} AliasTable_Type;
+
+
+/* opened file index */
+typedef struct
+{
+  Index_Type        *Index;             /* file index */
+  unsigned short    State;              /* state */
+  ino_t             Inode;              /* generation: inode of data file */
+  time_t            MTime;              /* generation: mtime of data file */
+  FILE              *DataFile;          /* index data file */
+  AliasTable_Type   *Alias;             /* index path aliases */
+  FILE              *OffsetFile;        /* index offset file */
+  LookupEntry_Type  *Lookup;            /* lookup table */
+  LookupEntry_Type  *ReadLookup;        /* table loaded by search (to free) */
+  off_t             ReadLookupSize;     /* size of mapped table (0: allocated) */
+  char              *Bloom;             /* bloom filter (optional) */
+  off_t             BloomSize;          /* size of bloom filter */
+  _Bool             UnmapBloom;         /* bloom filter mapped by search */
+  char              *Buffer;            /* line buffer (parallel search) */
+  char              *Buffer2;           /* filepath buffer (parallel search) */
+  ScanResult_Type   *Results;           /* results per request (array) */
+  Timing_Type       Timing;             /* counters (parallel search) */
+} IndexSearch_Type;
+
+
 /* file information (linked list) */
 typedef struct info
 {
@@ -301,13 +641,107 @@ typedef struct info
   off_t             Size;               /* file size */
   time_t            Time;               /* time of last file modifaction */
   unsigned short    Counter;            /* download counter */
+  unsigned short    Downloads;          /* merged from counter store */
   unsigned short    Status;             /* file status */
   Token_Type        *Infos;             /* file decription (linked list) */
   Token_Type        *LastInfo;          /* pointer to last element in list */
   struct info       *Next;              /* pointer to next element */ 
+  uint32_t          Hash;               /* hash of name */
+  struct info       *HashNext;          /* next element in hash bucket */
 } Info_Type;
 
 
+/* area worker of filelist (linked list, in order of output) */
+typedef struct worker
+{
+  pid_t             PID;                /* process ID (0: text block) */
+  FILE              *Block;             /* rendered area (temporary file) */
+  FILE              *SinkBlock[SINKS];  /* rendered area for sinks */
+  char              *Text;              /* text block */
+  int               Status;             /* exit status */
+  _Bool             Done;               /* worker has ended */
+  struct worker     *Next;              /* pointer to next element */
+} Worker_Type;
+
+
+/* results of area worker (head of temporary file) */
+typedef struct
+{
+  long              Files;              /* file counter */
+  long long         Bytes;              /* byte counter */
+  long              Checks_files_bbs;   /* files.bbs checked for update */
+  long              Writes_files_bbs;   /* files.bbs rewritten */
+  long              SinkAreas;          /* areas rendered for sinks */
+  long              NewFiles;           /* files listed as new */
+  int               Flag;               /* success flag */
+} WorkerResult_Type;
+
+
+/* data field of render plan */
+typedef struct
+{
+  unsigned short    Emitter;            /* emitter ID */
+  unsigned short    Line;               /* line number */
+  int               Column;             /* start column (0 based) */
+  unsigned short    Width;              /* width (max. size) */
+  unsigned short    Format;             /* format ID */
+  _Bool             Right;              /* right alignment */
+} RenderField_Type;
+
+
+/* render plan for data fields (compiled layout) */
+typedef struct
+{
+  RenderField_Type  Fields[MAX_RENDER_FIELDS];   /* fields to write */
+  unsigned short    Number;             /* number of fields */
+  unsigned short    Max;                /* max. line length */
+  int               DescColumn;         /* column of description */
+  int               DescLimit;          /* max. length of description */
+  _Bool             Multi;              /* multi-line description */
+} RenderPlan_Type;
+
+
+/* date strings of a day (cache) */
+typedef struct
+{
+  time_t            Start;              /* start of day */
+  time_t            End;                /* start of next day */
+  char              US[9];              /* MM-DD-YY */
+  char              ISO[11];            /* YYYY-MM-DD */
+} DateCache_Type;
+
+
+/* head of render cache file (per filearea) */
+typedef struct
+{
+  uint32_t          Magic;              /* AREA_CACHE_MAGIC */
+  uint32_t          Reserved;           /* padding */
+  uint64_t          Key;                /* hash of area's sources */
+  int64_t           Files;              /* file counter */
+  int64_t           Bytes;              /* byte counter */
+  uint64_t          Size;               /* size of rendered area */
+} AreaCache_Type;
+
+
+/* hash index of file information list (per filearea) */
+typedef struct
+{
+  Info_Type         **Buckets;          /* bucket array */
+  unsigned int      Size;               /* number of buckets (power of 2) */
+  unsigned int      Count;              /* number of elements */
+  _Bool             AnyCase;            /* case-insensitive hashing */
+} InfoHash_Type;
+
+
+/* memory block of description arena (linked list) */
+typedef struct arena
+{
+  size_t            Size;               /* size of data area */
+  size_t            Used;               /* used bytes of data area */
+  struct arena      *Next;              /* pointer to next element */
+} Arena_Type;
+
+
 /* data field for file description file (linked list) */
 typedef struct field
 {
@@ -338,10 +772,12 @@ typedef struct
 
   /* file streams */
   FILE              *Log;               /* log file */
+  long              LogFlush;           /* flush interval (s, 0: each line) */
   FILE              *List;              /* filelist */
 
   /* program control */
   _Bool             Run;                /* stop/keep running */
+  unsigned short    RunMode;            /* run mode */
   unsigned short    ConfigDepth;        /* depth of cfg files (includes) */
   char              *CfgInUse;          /* cfg currently parsed */
   unsigned int      CfgLinenumber;      /* line number currently parsed */
@@ -350,6 +786,11 @@ typedef struct
   unsigned short    CfgSwitches;        /* several cfg switches */
 
   /* file index */
+  unsigned short    IndexSwitches;      /* switches of file index */
+  long              IndexFiles;         /* file counter of file index */
+  char              *IndexFilepath;     /* file index of mfreq-list */
+  char              *IndexPW;           /* password of current filearea */
+  _Bool             IndexAutoMagic;     /* AutoMagic of current filearea */
   IndexData_Type    *DataList;          /* index data (linked list) */
   IndexData_Type    *LastData;          /* pointer to last element in list */
   IndexLookup_Type  *LookupList;        /* index lookup (linked list) */
@@ -361,6 +802,10 @@ typedef struct
   File_Type         *FileList;          /* file details (linked list) */
   File_Type         *LastFile;          /* pointer to last element in list */
 
+  /* download counters */
+  char              *CounterPath;       /* filepath of counter store */
+  CounterStore_Type *CounterStore;      /* mapped counter store */
+
   /* frequest configuration */
   char              *MailPath;          /* path of response mail */
   Token_Type        *MailHeader;        /* mail header (linked list) */
@@ -373,6 +818,12 @@ typedef struct
   Index_Type        *LastIndex;         /* pointer to last element in list */
   Limit_Type        *LimitList;         /* request limits (linked list) */
   Limit_Type        *LastLimit;         /* pointer to last element in list */
+  LimitNode_Type    *LimitTrie;         /* compiled limits (trie) */
+  LimitRule_Type    *LimitRules;        /* limits not fitting the trie */
+  unsigned short    StatThreads;        /* threads for getting file details */
+  char              *CachePath;         /* path of result cache */
+  long              CacheMaxFiles;      /* max. number of cache files */
+  char              *JournalPath;       /* filepath of request journal */
 
   /* frequest filepaths */
   char              *SRIF_Filepath;     /* filepath of SRIF file */
@@ -380,6 +831,9 @@ typedef struct
   char              *ResponseFilepath;  /* filepath of response */
   char              *MailFilepath;      /* filepath of netmail */
   char              *TextFilepath;      /* filepath of textmail */
+  char              *SocketFilepath;    /* filepath of server socket */
+  char              *SpoolPath;         /* path of SRIF spool directory */
+  char              *SpoolPattern;      /* name pattern of spooled SRIF files */
   
   /* frequest(er) details */
   char              *Sysop;             /* sysop name */
@@ -407,6 +861,21 @@ typedef struct
   unsigned short    InfoMode;           /* file info mode */
   Info_Type         *InfoList;          /* file information list (linked list) */
   Info_Type         *LastInfo;          /* pointer to last element in list */
+  InfoHash_Type     InfoHash;           /* hash index of info list */
+  Arena_Type        *Arena;             /* descriptions of info list */
+  long              Checks_files_bbs;   /* files.bbs checked for update */
+  long              Writes_files_bbs;   /* files.bbs rewritten */
+  char              *SinkFilepath[SINKS];  /* filepaths of sinks */
+  FILE              *Sink[SINKS];       /* additional outputs (sinks) */
+  unsigned short    Sinks;              /* number of open sinks */
+  long              SinkAreas;          /* areas written to sinks */
+  time_t            NewFilesTime;       /* cutoff time of new files */
+  long              NewFiles;           /* files listed as new */
+  unsigned short    Workers;            /* max. number of area workers */
+  unsigned short    ActiveWorkers;      /* number of running workers */
+  _Bool             WorkerFailed;       /* area of a worker failed */
+  Worker_Type       *WorkerList;        /* area workers (linked list) */
+  Worker_Type       *LastWorker;        /* pointer to last element in list */
   /* file description fields (linked list) */
   Field_Type        *Fields_filelist;   /* for filelist */
   Field_Type        *Fields_files_bbs;  /* for files.bbs */
@@ -0,0 +1,580 @@
+/* ************************************************************************
+ *
+ *   functions for download counters
+ *
+ *   (c) 2026 by Markus Reschke
+ *
+ * ************************************************************************ */
+
+/*
+ *  local constants
+ */
+
+#define COUNTER_C
+
+
+/*
+ *  include header files
+ */
+
+
+/* local header files */
+#include "common.h"           /* common stuff */
+#include "variables.h"        /* global variables */
+#include "functions.h"        /* external functions */
+
+/* files */
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <errno.h>
+
+
+
+/* ************************************************************************
+ *   counter store
+ * ************************************************************************ */
+
+
+/*
+ *  hash filepath for counter store (FNV-1a, 64 bits)
+ *
+ *  returns:
+ *  - hash value (never 0)
+ */
+
+uint64_t CounterHash(char *Filepath)
+{
+  uint64_t          Hash;               /* return value */
+
+  Hash = 14695981039346656037ULL;       /* offset basis */
+
+  while (Filepath[0] != 0)
+  {
+    Hash ^= (unsigned char)Filepath[0];
+    Hash *= 1099511628211ULL;           /* FNV prime */
+    Filepath++;
+  }
+
+  if (Hash == 0) Hash = 1;              /* 0 marks unused slot */
+
+  return Hash;
+}
+
+
+
+/*
+ *  close counter store
+ */
+
+void CloseCounterStore(CounterStore_Type *Store)
+{
+  /* sanity check */
+  if (Store == NULL) return;
+
+  if (Store->Header) munmap(Store->Header, Store->Size);
+  if (Store->File >= 0) close(Store->File);
+  if (Store->Filepath) free(Store->Filepath);
+  free(Store);
+}
+
+
+
+/*
+ *  open counter store
+ *  - maps store file in shared mode
+ *  - creates and initializes store file if requested
+ *  - keeps file open for locking
+ *
+ *  requires:
+ *  - filepath of store
+ *  - create flag (True: create missing store)
+ *
+ *  returns:
+ *  - pointer to store on success
+ *  - NULL on error or missing store
+ */
+
+CounterStore_Type *OpenCounterStore(char *Filepath, _Bool Create)
+{
+  CounterStore_Type      *Store = NULL;       /* return value */
+  CounterHeader_Type     *Header = NULL;      /* mapped file */
+  int                    File;                /* file descriptor */
+  int                    Mode = O_RDWR;       /* open mode */
+  struct stat            FileData;
+  size_t                 Size;
+  uint32_t               Slots;
+  uint32_t               Magic = 0;
+
+  /* sanity check */
+  if (Filepath == NULL) return Store;
+
+  Size = sizeof(CounterHeader_Type) +
+    sizeof(CounterSlot_Type) * COUNTER_SLOTS;
+
+  if (Create) Mode |= O_CREAT;
+  File = open(Filepath, Mode, 0644);
+  if (File < 0)
+  {
+    if (Create) Log(L_WARN, "Couldn't open counter store (%s)!", Filepath);
+    return Store;
+  }
+
+  if (fstat(File, &FileData) == 0)
+  {
+    /* new store: concurrent processes set the same size */
+    if ((FileData.st_size == 0) && Create)
+    {
+      if (ftruncate(File, Size) == 0) FileData.st_size = Size;
+    }
+
+    /* size of store depends on number of slots */
+    if (FileData.st_size >= sizeof(CounterHeader_Type))
+    {
+      Size = FileData.st_size;
+      Header = mmap(NULL, Size, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+      if (Header == MAP_FAILED) Header = NULL;
+    }
+  }
+
+  if (Header)
+  {
+    /* initialize new store (same values for any process) */
+    if (__atomic_load_n(&Header->Magic, __ATOMIC_ACQUIRE) == 0)
+    {
+      Header->Slots = COUNTER_SLOTS;
+      __atomic_compare_exchange_n(&Header->Magic, &Magic, COUNTER_MAGIC,
+        False, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+    }
+
+    /* power of 2 slots matching file size */
+    Slots = Header->Slots;
+    if ((Header->Magic == COUNTER_MAGIC) && (Slots > 0) &&
+        ((Slots & (Slots - 1)) == 0) &&
+        (Size == sizeof(CounterHeader_Type) + sizeof(CounterSlot_Type) * Slots))
+    {
+      Store = malloc(sizeof(CounterStore_Type));
+      if (Store)
+      {
+        Store->Header = Header;
+        Store->Slots = (CounterSlot_Type *)&Header[1];
+        Store->Size = Size;
+        Store->File = File;
+        Store->Filepath = CopyString(Filepath);
+        Store->Generation = 0;
+      }
+      else
+      {
+        munmap(Header, Size);
+        Log(L_ERR, "Couldn't allocate memory!");
+      }
+    }
+    else
+    {
+      munmap(Header, Size);
+    }
+  }
+
+  if (Store == NULL)
+  {
+    close(File);
+    Log(L_WARN, "Invalid counter store (%s)!", Filepath);
+  }
+
+  return Store;
+}
+
+
+
+/*
+ *  switch to current store file (after rehash by any process)
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool ReopenCounterStore(CounterStore_Type *Store)
+{
+  _Bool                  Flag = False;        /* return value */
+  CounterStore_Type      *New;                /* current store */
+  CounterStore_Type      Old;                 /* old store */
+
+  New = OpenCounterStore(Store->Filepath, False);
+
+  if (New)
+  {
+    /* swap stores and close old one */
+    Old = *Store;
+    *Store = *New;
+    *New = Old;
+    Store->Generation = Old.Generation + 1;
+    CloseCounterStore(New);
+
+    Flag = True;
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  unlock counter store
+ */
+
+void UnlockCounterStore(CounterStore_Type *Store)
+{
+  struct flock           Lock;
+
+  Lock.l_type = F_UNLCK;
+  Lock.l_whence = SEEK_SET;
+  Lock.l_start = 0;
+  Lock.l_len = 0;                     /* whole file */
+
+  fcntl(Store->File, F_SETLK, &Lock);
+}
+
+
+
+/*
+ *  lock counter store
+ *  - shared lock for counter updates, exclusive lock for rehash
+ *  - switches to current store file if store was moved
+ *
+ *  requires:
+ *  - pointer to store
+ *  - lock type (F_RDLCK or F_WRLCK)
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool LockCounterStore(CounterStore_Type *Store, short Type)
+{
+  struct flock           Lock;
+
+  while (True)
+  {
+    Lock.l_type = Type;
+    Lock.l_whence = SEEK_SET;
+    Lock.l_start = 0;
+    Lock.l_len = 0;                   /* whole file */
+
+    /* we use fcntl since it's per process (fork) */
+    while (fcntl(Store->File, F_SETLKW, &Lock) != 0)
+    {
+      if (errno != EINTR)
+      {
+        Log(L_WARN, "Couldn't lock counter store (%s)!", Store->Filepath);
+        return False;
+      }
+    }
+
+    /* current store */
+    if (__atomic_load_n(&Store->Header->Moved, __ATOMIC_ACQUIRE) == 0)
+      return True;
+
+    UnlockCounterStore(Store);
+    if (!ReopenCounterStore(Store)) return False;
+  }
+}
+
+
+
+/*
+ *  rehash counter store into new store file
+ *  - drops unused slots and slots with zero downloads
+ *  - new store gets twice the slots of the remaining entries at least
+ *  - replaces store file and marks old one as moved
+ *
+ *  requires:
+ *  - pointer to store
+ *  - force flag (True: rehash regardless of load)
+ *  - generation of store checked by caller
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool RehashCounterStore(CounterStore_Type *Store, _Bool Force,
+  unsigned int Generation)
+{
+  _Bool                  Flag = False;        /* return value */
+  CounterHeader_Type     *Header = NULL;      /* new store */
+  CounterSlot_Type       *Slots;              /* new hash table */
+  CounterSlot_Type       *Slot;               /* old slot */
+  char                   *Filepath;           /* temporary file */
+  int                    File;                /* file descriptor */
+  uint32_t               NewSlots = COUNTER_SLOTS;
+  uint32_t               Entries = 0;         /* entries to keep */
+  uint32_t               Index;
+  uint32_t               n;
+  size_t                 Size;
+  struct stat            FileData;
+
+  if (!LockCounterStore(Store, F_WRLCK)) return Flag;
+
+  /* another process might have done it already */
+  if ((Store->Generation != Generation) || (!Force &&
+      (Store->Header->Used <= Store->Header->Slots / 100 * MAX_COUNTER_LOAD)))
+  {
+    UnlockCounterStore(Store);
+    return True;
+  }
+
+  /* count entries and size new store */
+  for (n = 0; n < Store->Header->Slots; n++)
+  {
+    Slot = &Store->Slots[n];
+    if (Slot->Key && Slot->Count) Entries++;
+  }
+
+  while ((NewSlots < MAX_COUNTER_SLOTS) && (NewSlots / 2 < Entries))
+    NewSlots *= 2;
+
+  if (NewSlots / 2 < Entries)
+  {
+    UnlockCounterStore(Store);
+    Log(L_WARN, "Counter store exceeds %u slots (%s)!",
+      MAX_COUNTER_SLOTS, Store->Filepath);
+    return Flag;
+  }
+
+  Size = sizeof(CounterHeader_Type) + sizeof(CounterSlot_Type) * NewSlots;
+
+  Filepath = malloc(strlen(Store->Filepath) + 32);
+  if (Filepath == NULL)
+  {
+    UnlockCounterStore(Store);
+    Log(L_ERR, "Couldn't allocate memory!");
+    return Flag;
+  }
+
+  /* write new store to temporary file */
+  sprintf(Filepath, "%s."SUFFIX_TEMP".%d", Store->Filepath, getpid());
+  File = open(Filepath, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (File >= 0)
+  {
+    /* keep permissions of old file */
+    if (fstat(Store->File, &FileData) == 0)
+      fchmod(File, FileData.st_mode & 07777);
+
+    if (ftruncate(File, Size) == 0)
+    {
+      Header = mmap(NULL, Size, PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+      if (Header == MAP_FAILED) Header = NULL;
+    }
+
+    if (Header)
+    {
+      Header->Magic = COUNTER_MAGIC;
+      Header->Slots = NewSlots;
+      Header->Used = Entries;
+      Slots = (CounterSlot_Type *)&Header[1];
+
+      for (n = 0; n < Store->Header->Slots; n++)
+      {
+        Slot = &Store->Slots[n];
+        if (Slot->Key && Slot->Count)
+        {
+          /* linear probing, at least half of the slots are free */
+          Index = Slot->Key % NewSlots;
+          while (Slots[Index].Key != 0) Index = (Index + 1) % NewSlots;
+
+          Slots[Index].Key = Slot->Key;
+          Slots[Index].Count = Slot->Count;
+        }
+      }
+
+      munmap(Header, Size);
+      if (fsync(File) == 0) Flag = True;
+    }
+
+    if (close(File) != 0) Flag = False;
+    if (Flag && (rename(Filepath, Store->Filepath) != 0)) Flag = False;
+    if (!Flag) unlink(Filepath);
+  }
+
+  if (Flag)
+  {
+    /* other processes switch to new store */
+    __atomic_store_n(&Store->Header->Moved, 1, __ATOMIC_RELEASE);
+    Log(L_INFO, "Rehashed counter store (%u entries, %u slots)",
+      Entries, NewSlots);
+  }
+  else
+  {
+    Log(L_WARN, "Couldn't rehash counter store (%s)!", Store->Filepath);
+  }
+
+  UnlockCounterStore(Store);
+  free(Filepath);
+
+  return Flag;
+}
+
+
+
+/*
+ *  find slot of filepath
+ *  - linear probing, claims unused slot if requested
+ *  - requires lock
+ *
+ *  returns:
+ *  - pointer to slot on success
+ *  - NULL if not found or no unused slot within MAX_COUNTER_PROBES
+ */
+
+CounterSlot_Type *FindCounterSlot(CounterStore_Type *Store, char *Filepath,
+  _Bool Claim)
+{
+  CounterSlot_Type       *Slot = NULL;        /* return value */
+  uint64_t               Key;                 /* hash of filepath */
+  uint64_t               Old;                 /* key of slot */
+  uint32_t               Slots;               /* number of slots */
+  uint32_t               Index;               /* slot index */
+  unsigned short         Probes = 0;
+
+  Key = CounterHash(Filepath);
+  Slots = Store->Header->Slots;
+  Index = Key % Slots;
+
+  while (Probes < MAX_COUNTER_PROBES)
+  {
+    Slot = &Store->Slots[Index];
+    Old = __atomic_load_n(&Slot->Key, __ATOMIC_ACQUIRE);
+
+    if (Old == Key) return Slot;              /* found it */
+
+    if (Old == 0)                             /* unused slot */
+    {
+      if (!Claim) break;                        /* not in store */
+
+      /* claim slot, another process might be faster */
+      if (__atomic_compare_exchange_n(&Slot->Key, &Old, Key,
+          False, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+      {
+        __atomic_fetch_add(&Store->Header->Used, 1, __ATOMIC_RELAXED);
+        return Slot;
+      }
+      if (Old == Key) return Slot;              /* claimed for same file */
+    }
+
+    Index = (Index + 1) % Slots;              /* next slot */
+    Probes++;
+  }
+
+  return NULL;
+}
+
+
+
+/*
+ *  change download counter of file
+ *  - negative value to subtract merged downloads
+ *  - rehashes store at high load or if no slot is left for the file
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool AddCounter(CounterStore_Type *Store, char *Filepath, long Value)
+{
+  _Bool                  Flag = False;        /* return value */
+  _Bool                  Run = True;          /* control flag */
+  _Bool                  Rehash = False;      /* rehash store */
+  _Bool                  Rehashed = False;    /* store rehashed already */
+  CounterSlot_Type       *Slot;
+  CounterHeader_Type     *Header;
+  unsigned int           Generation;
+
+  /* sanity checks */
+  if ((Store == NULL) || (Filepath == NULL)) return Flag;
+
+  while (Run && LockCounterStore(Store, F_RDLCK))
+  {
+    Run = False;
+    Generation = Store->Generation;
+    Slot = FindCounterSlot(Store, Filepath, (Value > 0));
+
+    if (Slot)
+    {
+      if (Value >= 0)
+        __atomic_fetch_add(&Slot->Count, (uint32_t)Value, __ATOMIC_RELAXED);
+      else
+        __atomic_fetch_sub(&Slot->Count, (uint32_t)-Value, __ATOMIC_RELAXED);
+
+      Flag = True;
+    }
+
+    /* new entry and store is full or gets crowded */
+    Header = Store->Header;
+    if ((Value > 0) && ((Slot == NULL) ||
+        (Header->Used > Header->Slots / 100 * MAX_COUNTER_LOAD)))
+      Rehash = True;
+
+    UnlockCounterStore(Store);
+
+    if (Rehash && !Rehashed)
+    {
+      Rehashed = True;
+
+      /* try again with new store */
+      if (RehashCounterStore(Store, (Slot == NULL), Generation) &&
+          (Slot == NULL)) Run = True;
+    }
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  get download counter of file
+ *
+ *  returns:
+ *  - number of downloads (0 if unknown)
+ */
+
+unsigned long GetCounter(CounterStore_Type *Store, char *Filepath)
+{
+  unsigned long          Value = 0;           /* return value */
+  CounterSlot_Type       *Slot;
+
+  /* sanity checks */
+  if ((Store == NULL) || (Filepath == NULL)) return Value;
+
+  if (LockCounterStore(Store, F_RDLCK))
+  {
+    Slot = FindCounterSlot(Store, Filepath, False);
+    if (Slot) Value = __atomic_load_n(&Slot->Count, __ATOMIC_RELAXED);
+
+    UnlockCounterStore(Store);
+  }
+
+  return Value;
+}
+
+
+
+/* ************************************************************************
+ *   clean-up of local constants
+ * ************************************************************************ */
+
+
+/*
+ *  undo local constants
+ */
+
+#undef COUNTER_C
+
+
+/* ************************************************************************
+ *   EOF
+ * ************************************************************************ */
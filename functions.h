@@ -19,6 +19,7 @@
 
 #ifndef LOG_C
 
+  extern void FlushLog(void);
   extern void Log(unsigned short int Type, const char *Line, ...);
 
   extern void LogCfgError(void);
@@ -44,6 +45,7 @@
   extern _Bool IsMountingPoint(char *Path);
 
   extern char *GetFilename(char *Filepath);
+  extern _Bool IsTempFile(char *Name);
 
   extern unsigned short GetKeyword(char **Keywords, char *String);
 
@@ -73,10 +75,13 @@
 
   extern void FreeDataList(IndexData_Type *List);
   extern _Bool AddDataElement(char *Name, char *Filepath, char *PW);
+  extern IndexData_Type *SortDataList(IndexData_Type *List,
+    IndexData_Type **Last);
 
   extern void FreeLookupList(IndexLookup_Type *List);
   extern _Bool AddLookupElement(char Letter, off_t Offset,
     unsigned int Start, unsigned int Stop);
+  extern void BuildLookupTable(IndexLookup_Type *List, LookupEntry_Type *Table);
 
   extern void FreeAliasList(IndexAlias_Type *List);
   extern _Bool AddAliasElement(unsigned int Number, char *Path);
@@ -85,6 +90,16 @@
   extern _Bool AddExcludeElement(char *Name);
   extern _Bool MatchExcludeList(char *Name);
 
+  extern uint32_t BloomHash(char *Name, uint32_t Seed);
+  extern void AddBloomName(unsigned char *Filter, uint32_t Bits, char *Name);
+  extern _Bool CheckBloomName(char *Data, off_t Size, char *Name);
+
+  extern _Bool AddIndexAlias(char *Path, off_t *Offset);
+  extern _Bool AddIndexFile(char *Name, char *Path, char *PW,
+    off_t AliasOffset, _Bool AutoMagic);
+  extern _Bool PublishIndex(char *Filepath, _Bool Publish);
+  extern _Bool WriteIndex(char *Filepath, long *Files);
+
 #endif
 
 
@@ -113,12 +128,28 @@
   extern _Bool AddLimitElement(char *Address, long Files, long long Bytes,
     int BadPWs, int Freqs, unsigned int Flags);
 
+  extern void FreeLimitRules(LimitRule_Type *List);
+  extern void FreeLimitTrie(LimitNode_Type *Node);
+  extern _Bool AddLimitRule(LimitRule_Type **List, Limit_Type *Limit,
+    unsigned int Number);
+  extern LimitNode_Type *GetLimitNode(LimitNode_Type *Parent, long Value,
+    char *Domain, _Bool Create);
+  extern _Bool AddLimitPattern(Limit_Type *Limit, unsigned int Number);
+  extern _Bool CompileLimits();
+  extern void UpdateBestLimit(LimitRule_Type **Best, LimitRule_Type *List,
+    unsigned short ReqFlags);
+  extern void SearchLimitTrie(LimitNode_Type *Node, unsigned short Level,
+    AKA_Type *AKA, unsigned short ReqFlags, LimitRule_Type **Best);
+  extern Limit_Type *MatchLimit(AKA_Type *AKA, unsigned short ReqFlags);
+
   extern void FreeResponseList(Response_Type *List);
   extern Response_Type *CreateResponseElement(char *Filepath);
   extern _Bool DuplicateResponse(Request_Type *Request, Response_Type *Response);
   extern _Bool AnyDuplicateResponse(Response_Type *Response);
 
   extern void FreeRequestList(Request_Type *List);
+  extern _Bool PlanRequest(Request_Type *Request);
+  extern char *GetPlanName(unsigned short Plan);
   extern _Bool AddRequestElement(char *Name, char *Password);
 
 #endif
@@ -147,6 +178,9 @@
 #ifndef LIST_C
 
   extern void FreeInfoList(Info_Type *List);
+  extern void FreeInfoHash(void);
+  extern void FreeArena(void);
+  extern void *GetArenaMemory(size_t Size);
   extern _Bool AddInfoElement(char *Name, off_t Size, time_t Time);
   extern Info_Type *SearchInfoList(Info_Type *List, char *Name);
   extern _Bool AddDesc2Info(Info_Type *Info, char *Data);
@@ -171,6 +205,21 @@
 #endif
 
 
+/* ************************************************************************
+ *   functions from counter.c
+ * ************************************************************************ */
+
+#ifndef COUNTER_C
+
+  extern void CloseCounterStore(CounterStore_Type *Store);
+  extern CounterStore_Type *OpenCounterStore(char *Filepath, _Bool Create);
+  extern _Bool AddCounter(CounterStore_Type *Store, char *Filepath,
+    long Value);
+  extern unsigned long GetCounter(CounterStore_Type *Store, char *Filepath);
+
+#endif
+
+
 /* ************************************************************************
  *   EOF
  * ************************************************************************ */
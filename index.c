@@ -84,7 +84,7 @@ _Bool AddDataElement(char *Name, char *Filepath, char *PW)
   if (Element)          /* success */
   {
     /* convert name to upper case for case-insensitive search */
-    if (Env->CfgSwitches & SW_ANY_CASE)
+    if (Env->IndexSwitches & SW_ANY_CASE)
     {
       /* convert name to upper case */
       Help = Name;
@@ -121,6 +121,175 @@ _Bool AddDataElement(char *Name, char *Filepath, char *PW)
 
 
 
+/*
+ *  sort file data by name
+ *  - algorithm: merge sort
+ *  - lower case > upper case
+ */
+
+IndexData_Type *SortDataList(IndexData_Type *List, IndexData_Type **Last)
+{
+  IndexData_Type        *NewList = NULL;       /* return value */
+  IndexData_Type        *LeftSub;              /* left sublist */
+  IndexData_Type        *RightSub;             /* right sublist */
+  IndexData_Type        *Element = NULL;       /* single element */
+  IndexData_Type        *MergedList;           /* merged list */
+  unsigned int          LeftSize;              /* number of elements in left sublist */
+  unsigned int          RightSize;             /* number of elements in right sublist */
+  unsigned int          StepSize;              /* number of elements to process */
+  unsigned int          Merges;                /* number of sublist merges */
+  _Bool                 Run = True;
+
+  /* sanity check */
+  if (List == NULL) return NewList;
+
+
+  /*
+   *  master loop
+   */
+
+  StepSize = 1;       /* start with sublists with one element each */
+                      /* an 1 element sublist is sorted by definition :-) */
+
+  NewList = List;     /* initialize new list for first loop run */
+
+  while (Run)
+  {
+    /* prepare this run */
+    LeftSub = NewList;       /* start with new list */
+    NewList = NULL;          /* reset new list */
+    MergedList = NULL;       /* reset merged list */
+    Merges = 0;              /* reset counter */
+
+
+    /*
+     *  process list using sublists with StepSize elements  
+     */
+
+    /* as long as we haven't reached the lists end */
+    while (LeftSub)
+    {
+      /*
+       *  create virtual left and right sublists with StepSize elements
+       */
+ 
+      RightSub = LeftSub;      /* starting point */
+      LeftSize = 0;            /* reset size */
+
+      /* as long as we don't reach the list's end move SubSize elements to the right */
+      while (RightSub && (LeftSize < StepSize))
+      {
+        LeftSize++;                     /* increase size of left sublist */
+        RightSub = RightSub ->Next;     /* move to next element */
+      }
+
+      RightSize = StepSize;             /* assume size of right sublist to be StepSize */
+                                        /* might be larger than real size */
+
+      /* 
+       *  merge both sub lists as long as elements are left
+       *  also prevent overrun of right sublist
+       */ 
+
+      while ((LeftSize > 0) || ((RightSize > 0) && RightSub))
+      {
+        /*
+         *  select element to merge
+         */
+
+        /* no elements left in left sublist */
+        if (LeftSize == 0)
+        {
+          /* so take next element of right sublist */
+          Element = RightSub;            /* take element */
+          RightSize--;                   /* one element less in sublist */
+          RightSub = RightSub->Next;     /* move to next element in sublist */
+        }
+
+        /* no elements left in right sublist */
+        /* or end of right sublist reached */
+        else if ((RightSize == 0) || (RightSub == NULL))
+        {
+          /* so take next element of left sublist */
+          Element = LeftSub;             /* take element */
+          LeftSize--;                    /* one element less in sublist */
+          LeftSub = LeftSub->Next;       /* move to next element in sublist */
+        }
+
+        /* otherwise we have to compare the next elements of both sublists */
+        else
+        {
+          if (LeftSub->Name && RightSub->Name)      /* sanity check */
+          {
+            if (strcmp(LeftSub->Name, RightSub->Name) <= 0)
+            {
+              /* element of left sublist is smaller or equal */
+              /* take that one */
+              Element = LeftSub;             /* take element */
+              LeftSize--;                    /* one element less in sublist */
+              LeftSub = LeftSub->Next;       /* move to next element in sublist */
+            }
+            else
+            {
+              /* element of right sublist is smaller */
+              /* take that one */
+              Element = RightSub;            /* take element */
+              RightSize--;                   /* one element less in sublist */
+              RightSub = RightSub->Next;     /* move to next element in sublist */
+            }
+          }
+        }
+
+
+        /*
+         *  merge selected element
+         *  by moving it to the merged list
+         */
+
+        if (MergedList)             /* if merged list exists */
+        {
+          MergedList->Next = Element;    /* link element */
+        }
+        else                        /* otherwise */
+        {
+          /* it's the first element for the merged list */
+          /* and the starting point for the next loop run */
+          NewList = Element;        /* set first element of new list */
+        }
+
+	MergedList = Element;      /* Element is the new end of merged list */
+      }
+
+      Merges++;                    /* another merge done */
+      LeftSub = RightSub;          /* move to next sublist pair */
+    }
+
+    MergedList->Next = NULL;        /* end merged list */
+
+
+    /*
+     *  loop control/feedback
+     */
+
+    /* if only one merge is done we sorted the complete list */ 
+    if (Merges <= 1)          /* if job done */
+    {
+      Run = False;              /* end master loop */
+
+      /* if requested update pointer to last element */
+      if (Last) *Last = MergedList;
+    }
+    else                      /* another run required */
+    {
+      StepSize = StepSize * 2;    /* double stepsize of sublist for next run */
+    }
+  }
+
+  return NewList;
+}
+
+
+
 /* ************************************************************************
  *   file index lookup (linked list)
  * ************************************************************************ */
@@ -192,6 +361,39 @@ _Bool AddLookupElement(char Letter, off_t Offset, unsigned int Start, unsigned i
 }
 
 
+
+/*
+ *  build lookup table from lookup list
+ *  - table has LOOKUP_ENTRIES entries indexed by the initial letter
+ *  - unused entries get an offset of -1
+ */
+
+void BuildLookupTable(IndexLookup_Type *List, LookupEntry_Type *Table)
+{
+  unsigned int             n;                   /* counter */
+
+  /* sanity check */
+  if (Table == NULL) return;
+
+  for (n = 0; n < LOOKUP_ENTRIES; n++)      /* reset table */
+  {
+    Table[n].Offset = -1;
+    Table[n].Start = 0;
+    Table[n].Stop = 0;
+  }
+
+  while (List)                              /* follow list */
+  {
+    n = (unsigned char)List->Letter;
+    Table[n].Offset = List->Offset;
+    Table[n].Start = List->Start;
+    Table[n].Stop = List->Stop;
+
+    List = List->Next;                      /* next element */
+  }
+}
+
+
 /* ************************************************************************
  *   file index path aliases (linked list)
  * ************************************************************************ */
@@ -390,6 +592,724 @@ _Bool MatchExcludeList(char *Name)
 
 
 
+/* ************************************************************************
+ *   file index bloom filter
+ * ************************************************************************ */
+
+
+/*
+ *  hash name for bloom filter (FNV-1a)
+ *
+ *  returns:
+ *  - hash value
+ */
+
+uint32_t BloomHash(char *Name, uint32_t Seed)
+{
+  uint32_t          Hash;               /* return value */
+
+  Hash = 2166136261U ^ Seed;            /* offset basis */
+
+  while (Name[0] != 0)                  /* all chars */
+  {
+    Hash ^= (unsigned char)Name[0];
+    Hash *= 16777619U;                  /* FNV prime */
+    Name++;                             /* next char */
+  }
+
+  return Hash;
+}
+
+
+
+/*
+ *  add name to bloom filter
+ *  - double hashing for BLOOM_HASHES bit positions
+ */
+
+void AddBloomName(unsigned char *Filter, uint32_t Bits, char *Name)
+{
+  uint32_t          Hash1, Hash2;       /* hash values */
+  uint32_t          Bit;                /* bit position */
+  unsigned int      n;                  /* counter */
+
+  /* sanity check */
+  if ((Filter == NULL) || (Bits == 0) || (Name == NULL)) return;
+
+  Hash1 = BloomHash(Name, 0);
+  Hash2 = BloomHash(Name, BLOOM_SEED) | 1;   /* odd step */
+
+  for (n = 0; n < BLOOM_HASHES; n++)
+  {
+    Bit = (Hash1 + n * Hash2) % Bits;
+    Filter[Bit / 8] |= 1 << (Bit % 8);
+  }
+}
+
+
+
+/*
+ *  check name against bloom filter
+ *  - format: <number of bits (uint32_t)><filter>
+ *
+ *  returns:
+ *  - 1 if name might be in file index (or filter is invalid)
+ *  - 0 if name is definitely not in file index
+ */
+
+_Bool CheckBloomName(char *Data, off_t Size, char *Name)
+{
+  _Bool             Flag = True;        /* return value */
+  unsigned char     *Filter;            /* bit field */
+  uint32_t          Bits;               /* size of bit field */
+  uint32_t          Hash1, Hash2;       /* hash values */
+  uint32_t          Bit;                /* bit position */
+  unsigned int      n = 0;              /* counter */
+
+  /* sanity checks */
+  if ((Data == NULL) || (Name == NULL)) return Flag;
+  if (Size < (off_t)sizeof(uint32_t)) return Flag;
+
+  memcpy(&Bits, Data, sizeof(uint32_t));
+  if ((Bits == 0) ||
+      (Size - (off_t)sizeof(uint32_t) < (off_t)((Bits + 7) / 8)))
+    return Flag;
+
+  Filter = (unsigned char *)Data + sizeof(uint32_t);
+
+  Hash1 = BloomHash(Name, 0);
+  Hash2 = BloomHash(Name, BLOOM_SEED) | 1;   /* odd step */
+
+  while (Flag && (n < BLOOM_HASHES))
+  {
+    Bit = (Hash1 + n * Hash2) % Bits;
+    if (! (Filter[Bit / 8] & (1 << (Bit % 8)))) Flag = False;
+    n++;
+  }
+
+  return Flag;
+}
+
+
+
+/* ************************************************************************
+ *   file index
+ * ************************************************************************ */
+
+
+/*
+ *  add path alias for directory
+ *  - only if path aliases are enabled
+ *
+ *  requires:
+ *  - absolute path of directory
+ *  - pointer to alias offset (-1 for no alias)
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool AddIndexAlias(char *Path, off_t *Offset)
+{
+  _Bool             Flag = True;        /* return value */
+  unsigned int      AliasNumber = 0;    /* alias counter */
+
+  /* sanity checks */
+  if ((Path == NULL) || (Offset == NULL)) return False;
+
+  *Offset = -1;                  /* no alias by default */
+
+  if (Env->IndexSwitches & SW_PATH_ALIASES)   /* if enabled */
+  {
+    /* get and set top number */
+    if (Env->LastAlias) AliasNumber = Env->LastAlias->Number;
+    AliasNumber++;
+
+    /* check for overflow */
+    if (AliasNumber <= 10000)        /* limit to 10000 */
+    {
+      /* add alias to list */
+      if (AddAliasElement(AliasNumber, Path))
+      {
+        *Offset = Env->LastAlias->Offset;
+      }
+      else
+      {
+        Flag = False;
+      }
+    }
+    /* else: no aliasing */
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  add file to index data
+ *  - builds filepath based on path alias or path
+ *  - adds name without extension for AutoMagic
+ *
+ *  requires:
+ *  - filename (not TempBuffer, may be changed for AnyCase)
+ *  - absolute path of directory
+ *  - password (optional)
+ *  - alias offset of path (-1 for no alias)
+ *  - AutoMagic flag
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool AddIndexFile(char *Name, char *Path, char *PW, off_t AliasOffset,
+  _Bool AutoMagic)
+{
+  _Bool             Flag = False;       /* return value */
+  char              *Help, *LastDot;
+  size_t            Length;             /* string length */
+
+  /* sanity checks */
+  if ((Name == NULL) || (Path == NULL)) return Flag;
+
+  /* build filepath */
+  /* omit filename (automatic filepath) */ 
+  if (AliasOffset >= 0)         /* path alias enabled */
+  {
+    /* create aliased path without filename */
+    /* format: %<alias offset>%/ */
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+      "%%%ld%%/", AliasOffset);
+  }
+  else                          /* path alias disabled */
+  {
+    /* create full path whithout filename */
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+      "%s/", Path);
+  }
+
+  if (Env->IndexSwitches & SW_ANY_CASE)   /* case-insensitive search */
+  {
+    /*
+     *  For AnyCase we have to convert the filename to uppper case
+     *  later on. So we need to add the original filename to the path.
+     */
+
+    /* add filename to path */
+    Length = strlen(TempBuffer);
+    Help = &TempBuffer[Length];       /* end of path */
+    snprintf(Help, DEFAULT_BUFFER_SIZE - 1 - Length,
+        "%s", Name);                
+  }
+
+  Flag = AddDataElement(Name, TempBuffer, PW);
+  if (Flag) Env->IndexFiles++;    /* increase file counter */
+
+  if (AutoMagic)         /* auto magic enabled */
+  {
+    /* find last "." in filename */
+    Help = Name;
+    LastDot = NULL;
+    while (Help[0] != 0)         /* scan string */
+    {
+      if (Help[0] == '.') LastDot = Help;
+      Help++;                    /* next char */
+    }
+
+    /* create magic */
+    if (LastDot)                 /* got extension */
+    {
+      /* add filename to path */
+      Length = strlen(TempBuffer);
+      Help = &TempBuffer[Length];    /* end of path */
+      snprintf(Help, DEFAULT_BUFFER_SIZE - 1 - Length,
+        "%s", Name);
+
+      LastDot[0] = 0;            /* create sub-string */
+
+      Flag = AddDataElement(Name, TempBuffer, PW); 
+
+      LastDot[0] = '.';          /* restore name */
+    }
+  }
+
+  return Flag;
+}
+
+
+/*
+ *  publish new index files
+ *  - renames temporary files to the final filenames
+ *  - each file is replaced atomically, so any reader keeps the old
+ *    file until it closes it
+ *  - data file comes last
+ *  - removes temporary files on error
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool PublishIndex(char *Filepath, _Bool Publish)
+{
+  _Bool             Flag = True;             /* return value */
+  unsigned short    n = 0;                   /* counter */
+  static char       *Suffixes[7] =
+    {SUFFIX_OFFSET, SUFFIX_ALIAS, SUFFIX_LOOKUP, SUFFIX_TABLE, SUFFIX_BLOOM,
+     SUFFIX_DATA, NULL};
+
+  /* sanity check */
+  if (Filepath == NULL) return False;
+
+  while (Suffixes[n])
+  {
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+      "%s.%s."SUFFIX_TEMP, Filepath, Suffixes[n]);
+
+    if (Publish && Flag)           /* rename */
+    {
+      snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1,
+        "%s.%s", Filepath, Suffixes[n]);
+
+      if (rename(TempBuffer, TempBuffer2) != 0)
+      {
+        Flag = False;
+        Log(L_WARN, "Couldn't rename index file (%s)!", TempBuffer);
+      }
+    }
+
+    if (!Publish || !Flag)         /* remove */
+    {
+      unlink(TempBuffer);
+    }
+
+    n++;                           /* next suffix */
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  write index
+ *  - writes temporary files and publishes them at the end
+ *
+ *  requires:
+ *  - filepath of index (without suffix)
+ *  - pointer to file counter (reset on success)
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool WriteIndex(char *Filepath, long *Files)
+{
+  _Bool             Flag = False;            /* return value */
+  _Bool             Run = True;              /* control flag */
+  IndexData_Type    *IndexData = NULL;       /* data list */
+  IndexData_Type    *LastData;               /* last element in data list */
+  IndexLookup_Type  *IndexLookup = NULL;     /* lookup list */
+  IndexAlias_Type   *IndexAlias = NULL;      /* alias list */
+  FILE              *DataFile = NULL;        /* index data file */
+  FILE              *LookupFile = NULL;      /* index lookup file */
+  FILE              *TableFile = NULL;       /* index lookup table file */
+  FILE              *AliasFile = NULL;       /* index alias file */
+  FILE              *OffsetFile = NULL;      /* index offset file */
+  FILE              *BloomFile = NULL;       /* index bloom filter file */
+  _Bool             DataLock = False;        /* data file locked */
+  _Bool             LookupLock = False;      /* lookup file locked */
+  _Bool             TableLock = False;       /* lookup table file locked */
+  _Bool             AliasLock = False;       /* alias file locked */
+  _Bool             OffsetLock = False;      /* offset file locked */
+  _Bool             BloomLock = False;       /* bloom filter file locked */
+  unsigned char     *Bloom = NULL;           /* bloom filter */
+  uint32_t          BloomBits = 0;           /* size of bloom filter */
+  LookupEntry_Type  Table[LOOKUP_ENTRIES];   /* lookup table */
+  char              FirstChar = 0;           /* first char of filename */
+  unsigned int      Counter = 0;             /* filename/line counter */
+  off_t             Offset;                  /* file offset */
+  char              *Help;
+  _Bool             OffsetFlag = False;      /* flag for binary search mode */
+
+  /* sanity checks */
+  if ((Filepath == NULL) || (Files == NULL)) return False;
+
+  /* update flag for binary search (create offset file) */
+  if (Env->IndexSwitches & SW_BINARY_SEARCH) OffsetFlag = True;
+
+
+  /*
+   *  sort data
+   */
+
+  if (Run)
+  {
+    Run = False;                               /* reset flag */
+    LastData = NULL;                           /* reset pointer */
+
+    IndexData = SortDataList(Env->DataList, &LastData);   /* sort */
+    Env->DataList = IndexData;                 /* update list start */
+    Env->LastData = LastData;                  /* update list end */
+
+    if (IndexData != NULL) Run = True;         /* ok for next part */
+  }
+
+
+  /*
+   *  create bloom filter
+   *  - size based on number of names
+   */
+
+  if (Run)
+  {
+    while (IndexData)                   /* count names */
+    {
+      BloomBits += BLOOM_BITS;
+      IndexData = IndexData->Next;
+    }
+
+    BloomBits = ((BloomBits + 63) / 64) * 64;    /* multiple of 64 bits */
+    IndexData = Env->DataList;          /* back to start */
+
+    Bloom = calloc(BloomBits / 8, 1);
+    if (Bloom == NULL)
+    {
+      Log(L_ERR, "Couldn't allocate memory!");
+      Run = False;
+    }
+  }
+
+
+  /*
+   *  open index files
+   */
+
+  if (Run)
+  {
+    Run = False;                                /* reset flag */
+
+    /* data file */
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+      "%s."SUFFIX_DATA"."SUFFIX_TEMP, Filepath);
+    DataFile = fopen(TempBuffer, "w");       /* truncate & write mode */
+
+    /* lookup file (binary search) */
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+      "%s."SUFFIX_LOOKUP"."SUFFIX_TEMP, Filepath);
+    LookupFile = fopen(TempBuffer, "w");     /* truncate & write mode */
+
+    /* lookup table file */
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+      "%s."SUFFIX_TABLE"."SUFFIX_TEMP, Filepath);
+    TableFile = fopen(TempBuffer, "w");      /* truncate & write mode */
+
+    /* alias file */
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+      "%s."SUFFIX_ALIAS"."SUFFIX_TEMP, Filepath);
+    AliasFile = fopen(TempBuffer, "w");      /* truncate & write mode */
+
+    /* offset file */
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+      "%s."SUFFIX_OFFSET"."SUFFIX_TEMP, Filepath);
+    OffsetFile = fopen(TempBuffer, "w");     /* truncate & write mode */
+
+    /* bloom filter file */
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+      "%s."SUFFIX_BLOOM"."SUFFIX_TEMP, Filepath);
+    BloomFile = fopen(TempBuffer, "w");      /* truncate & write mode */
+
+    /* check */
+    if (DataFile && LookupFile && TableFile && AliasFile && OffsetFile &&
+        BloomFile)
+    {
+      Run = True;                  /* ok for next part */
+    }
+    else
+    {
+      Log(L_WARN, "Can't open index files (%s)!", Filepath);
+    }
+  }
+
+
+  /*
+   *  lock index files
+   */
+
+  if (Run)
+  {
+    Run = False;                             /* reset flag */
+
+    /* lock files */
+    DataLock = LockFile(DataFile, NULL);
+    LookupLock = LockFile(LookupFile, NULL);
+    TableLock = LockFile(TableFile, NULL);
+    AliasLock = LockFile(AliasFile, NULL);
+    OffsetLock = LockFile(OffsetFile, NULL);
+    BloomLock = LockFile(BloomFile, NULL);
+
+    /* check */
+    if (DataLock && LookupLock && TableLock && AliasLock && OffsetLock &&
+        BloomLock)
+    {
+      Run = True;                  /* ok for next part */
+    }
+    else
+    {
+      Log(L_WARN, "Can't lock index files (%s)!", Filepath);
+    }
+  }
+
+
+  /*
+   *  write data file and optional offset file
+   *  also build lookup list
+   *
+   *  format: <name>0x1F<filepath>[0x1F<password>]LF
+   *  We use the ascii unit separator 31 (octal 037) as field separator.
+   *  <filepath>: <path>/[<filename>] or %<alias offset>%/[<filename>]
+   *  - %<alias offset>% for automatic path aliasing
+   *  - <filename> can be omitted if same as <name>
+   */
+
+  if (Run)
+  {
+    while (IndexData)                   /* follow list */
+    {
+      Counter++;              /* another file */
+
+      /* catch change of first letter */
+      if (IndexData->Name[0] != FirstChar)
+      {
+        /* update last line counter for old character */
+        IndexLookup = Env->LastLookup;     /* get current pointer */
+        if (IndexLookup) IndexLookup->Stop = Counter - 1;
+
+        FirstChar = IndexData->Name[0];    /* save new character */
+
+        /* add lookup element for new character */
+        Offset = ftello(DataFile);      /* get current offset of the data file */
+        AddLookupElement(FirstChar, Offset, Counter, 0);
+      }
+
+      /*
+       *  write offset file (BinarySearch)
+       *  format: <binary offset>
+       */
+
+      if (OffsetFlag)
+      {
+        Offset = ftello(DataFile);      /* get current offset of the data file */
+
+        /* write offset of the data file to the offset file */
+        if (fwrite(&Offset, sizeof(off_t), 1, OffsetFile) != 1)
+        {
+          Run = False;               /* signal problem */
+          IndexData = NULL;          /* end loop */
+          Log(L_WARN, "Write error for index offset file (%s)!", Filepath);
+        }
+      }
+
+      /* add name to bloom filter */
+      AddBloomName(Bloom, BloomBits, IndexData->Name);
+
+      /*
+       *  write data file
+       */
+
+      /* build data buffer */
+      if (IndexData->PW)           /* password required */
+      {
+        snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
+          "%s\037%s\037%s\n", IndexData->Name, IndexData->Filepath, IndexData->PW);
+      }
+      else                         /* no password */
+      {
+        snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
+          "%s\037%s\n", IndexData->Name, IndexData->Filepath);
+      }
+
+      IndexData = IndexData->Next;      /* go to next element */
+
+      /* and write to data file */
+      if (fputs(OutBuffer, DataFile) < 0)    /* got an error */
+      {
+        Run = False;               /* signal problem */
+        IndexData = NULL;          /* end loop */
+        Log(L_WARN, "Write error for index data file (%s)!", Filepath);
+      }
+
+      /* check for counter overflow */
+      if (Counter >= 1000000)      /* keep it reasonable, not UINT_MAX */
+      {
+        Run = False;               /* signal problem */
+        IndexData = NULL;          /* end loop */
+        Log(L_WARN, "Fileindex overrun (%s)!", Filepath);
+      } 
+    }
+
+    /* update stop line# of last char */
+    if (Run)
+    {
+      IndexLookup = Env->LastLookup;     /* get current pointer */
+      if (IndexLookup) IndexLookup->Stop = Counter;
+    } 
+  }
+
+
+  /*
+   *  write lookup file
+   *
+   *  format: <char> <file offset> <start line#> <stop line#>LF
+   */
+
+  if (Run)
+  {
+    IndexLookup = Env->LookupList;
+
+    while (IndexLookup)            /* follow list */
+    {
+      /* build data buffer */
+      snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
+        "%c %ld %u %u\n", IndexLookup->Letter, IndexLookup->Offset,
+        IndexLookup->Start, IndexLookup->Stop);
+      
+      IndexLookup = IndexLookup->Next;     /* go to next element */
+
+      if (fputs(OutBuffer, LookupFile) < 0)    /* got an error */
+      {
+        Run = False;
+        IndexLookup = NULL;
+        Log(L_WARN, "Write error for index lookup file (%s)!", Filepath);
+      }
+    }
+  }
+
+
+  /*
+   *  write lookup table file
+   *
+   *  format: LOOKUP_ENTRIES x <lookup entry (binary)>
+   *  Same data as the lookup file, but indexed by the initial letter.
+   *  Allows mfreq-srif to load the lookup data without parsing.
+   */
+
+  if (Run)
+  {
+    BuildLookupTable(Env->LookupList, Table);
+
+    if (fwrite(Table, sizeof(LookupEntry_Type), LOOKUP_ENTRIES, TableFile)
+        != LOOKUP_ENTRIES)
+    {
+      Run = False;
+      Log(L_WARN, "Write error for index lookup table file (%s)!", Filepath);
+    }
+  }
+
+
+  /*
+   *  write alias file
+   *
+   *  format: <path>LF
+   *  To access the paths later on the offsets to the paths are stored as aliases
+   *  in the data file.
+   */
+
+  if (Run)
+  {
+    IndexAlias = Env->AliasList;
+
+    while (IndexAlias)             /* follow list */
+    {
+      /* build data buffer */
+      snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1, "%s\n", IndexAlias->Path);
+      
+      IndexAlias = IndexAlias->Next;         /* go to next element */
+
+      if (fputs(OutBuffer, AliasFile) < 0)   /* got an error */
+      {
+        Run = False;
+        IndexAlias = NULL;
+        Log(L_WARN, "Write error for index alias file (%s)!", Filepath);
+      }
+    }
+  }
+
+
+  /*
+   *  write bloom filter file
+   *
+   *  format: <number of bits (uint32_t)><bit field>
+   *  Allows mfreq-srif to skip the index for names which aren't included.
+   */
+
+  if (Run)
+  {
+    if ((fwrite(&BloomBits, sizeof(uint32_t), 1, BloomFile) != 1) ||
+        (fwrite(Bloom, BloomBits / 8, 1, BloomFile) != 1))
+    {
+      Run = False;
+      Log(L_WARN, "Write error for index bloom filter file (%s)!", Filepath);
+    }
+  }
+
+
+  /*
+   *  check & log
+   */
+
+  if (Run)
+  {
+    Flag = True;             /* signal success */
+
+    /* log statistics */
+    Help = GetFilename(Filepath);
+    if (Help) Log(L_INFO, "Processed %ld files for index \"%s\".", *Files, Help);
+    *Files = 0;              /* reset counter */
+  }
+
+
+  /*
+   *  clean up
+   */
+
+  /* unlock and close files */
+  if (BloomLock) UnlockFile(BloomFile);
+  if (OffsetLock) UnlockFile(OffsetFile);
+  if (AliasLock) UnlockFile(AliasFile);
+  if (TableLock) UnlockFile(TableFile);
+  if (LookupLock) UnlockFile(LookupFile);
+  if (DataLock) UnlockFile(DataFile);
+  if (BloomFile) fclose(BloomFile);
+  if (OffsetFile) fclose(OffsetFile);
+  if (AliasFile) fclose(AliasFile);
+  if (TableFile) fclose(TableFile);
+  if (LookupFile) fclose(LookupFile);
+  if (DataFile) fclose(DataFile);
+  if (Bloom) free(Bloom);
+
+  /* replace old index files or remove temporary ones */
+  Flag &= PublishIndex(Filepath, Flag);
+
+  /* free file index lists */
+  FreeDataList(Env->DataList);            /* free index data list */
+  Env->DataList = NULL;
+  Env->LastData = NULL;
+  FreeLookupList(Env->LookupList);        /* free index lookup list */
+  Env->LookupList = NULL;
+  Env->LastLookup = NULL;
+  FreeAliasList(Env->AliasList);          /* free index alias list */
+  Env->AliasList = NULL;
+  Env->LastAlias = NULL;
+
+  return Flag;
+}
+
+
+
 /* ************************************************************************
  *   clean-up of local constants
  * ************************************************************************ */
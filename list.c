@@ -23,6 +23,9 @@
 #include "variables.h"        /* global variables */
 #include "functions.h"        /* external functions */
 
+/* strings */
+#include <ctype.h>
+
 
 
 /* ************************************************************************
@@ -32,6 +35,7 @@
 
 /*
  *  free list of info elements
+ *  - descriptions have to be freed by FreeArena()
  *
  *  requires:
  *  - pointer to fileinfo linked list
@@ -50,7 +54,7 @@ void FreeInfoList(Info_Type *List)
 
     /* free data */
     if (List->Name) free(List->Name);
-    if (List->Infos) FreeTokenlist(List->Infos);
+    /* descriptions are freed with the arena */
 
     /* free structure */
     free(List);
@@ -61,6 +65,143 @@ void FreeInfoList(Info_Type *List)
 
 
 
+/*
+ *  hash name of info element (FNV-1a)
+ *  - folds case for case-insensitive matching
+ *
+ *  returns:
+ *  - hash value
+ */
+
+uint32_t InfoHash(char *Name, _Bool AnyCase)
+{
+  uint32_t          Hash;               /* return value */
+  unsigned char     Char;
+
+  Hash = 2166136261U;                   /* offset basis */
+
+  while (Name[0] != 0)
+  {
+    Char = (unsigned char)Name[0];
+    if (AnyCase) Char = tolower(Char);
+    Hash ^= Char;
+    Hash *= 16777619U;                  /* FNV prime */
+    Name++;
+  }
+
+  return Hash;
+}
+
+
+
+/*
+ *  free hash index of global info list
+ */
+
+void FreeInfoHash(void)
+{
+  if (Env->InfoHash.Buckets) free(Env->InfoHash.Buckets);
+
+  Env->InfoHash.Buckets = NULL;
+  Env->InfoHash.Size = 0;
+  Env->InfoHash.Count = 0;
+}
+
+
+
+/*
+ *  link info element to hash bucket
+ *  - appends element to keep the order of doubles
+ */
+
+void LinkInfoHash(Info_Type **Buckets, unsigned int Size, Info_Type *Info)
+{
+  Info_Type           **Link;
+
+  Info->HashNext = NULL;
+
+  Link = &Buckets[Info->Hash & (Size - 1)];
+  while (*Link) Link = &((*Link)->HashNext);
+  *Link = Info;
+}
+
+
+
+/*
+ *  add info element to hash index of global info list
+ *  - creates index with first element
+ *  - doubles number of buckets when getting crowded
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool AddInfoHash(Info_Type *Info)
+{
+  _Bool               Flag = False;        /* return value */
+  InfoHash_Type       *Index;
+  Info_Type           **Buckets;           /* new bucket array */
+  Info_Type           *Element;
+  Info_Type           *Next;
+  unsigned int        Size;
+  unsigned int        n;                   /* counter */
+
+  /* sanity check */
+  if ((Info == NULL) || (Info->Name == NULL)) return Flag;
+
+  Index = &(Env->InfoHash);
+
+  /* new index */
+  if (Index->Buckets == NULL)
+  {
+    Index->Buckets = calloc(INFO_HASH_SIZE, sizeof(Info_Type *));
+    if (Index->Buckets == NULL)
+    {
+      Log(L_ERR, "Couldn't allocate memory!");
+      return Flag;
+    }
+    Index->Size = INFO_HASH_SIZE;
+    Index->Count = 0;
+    Index->AnyCase = (Env->CfgSwitches & SW_ANY_CASE) ? True : False;
+  }
+
+  /* grow index (keeps order within buckets, otherwise stay crowded) */
+  if (Index->Count >= Index->Size * 2)
+  {
+    Size = Index->Size * 2;
+    Buckets = calloc(Size, sizeof(Info_Type *));
+
+    if (Buckets)
+    {
+      for (n = 0; n < Index->Size; n++)
+      {
+        Element = Index->Buckets[n];
+        while (Element)
+        {
+          Next = Element->HashNext;
+          LinkInfoHash(Buckets, Size, Element);
+          Element = Next;
+        }
+      }
+
+      free(Index->Buckets);
+      Index->Buckets = Buckets;
+      Index->Size = Size;
+    }
+  }
+
+  Info->Hash = InfoHash(Info->Name, Index->AnyCase);
+  LinkInfoHash(Index->Buckets, Index->Size, Info);
+  Index->Count++;
+
+  Flag = True;
+
+  return Flag;
+}
+
+
+
 /*
  *  create and add new info element to global list
  *
@@ -83,6 +224,9 @@ _Bool AddInfoElement(char *Name, off_t Size, time_t Time)
   {
     /* set defaults */
     Element->Counter = 0;
+    Element->Downloads = 0;
+    Element->Hash = 0;
+    Element->HashNext = NULL;
     Element->Status = FINFO_NONE;
     Element->Infos = NULL;
     Element->LastInfo = NULL;
@@ -98,6 +242,10 @@ _Bool AddInfoElement(char *Name, off_t Size, time_t Time)
     else Env->InfoList = Element;                      /* start list */
     Env->LastInfo = Element;                           /* save new list end */
 
+    /* add to hash index */
+    if (Env->InfoList == Element) FreeInfoHash();      /* new list */
+    AddInfoHash(Element);
+
     Flag = True;            /* signal success */
   }
   else                  /* error */
@@ -112,6 +260,7 @@ _Bool AddInfoElement(char *Name, off_t Size, time_t Time)
 
 /*
  *  search for info element matching a specific name
+ *  - uses hash index for global list
  *
  *  requires:
  *  - pointer to fileinfo linked list
@@ -126,6 +275,8 @@ Info_Type *SearchInfoList(Info_Type *List, char *Name)
 {
   Info_Type           *Element = NULL;       /* return value */
   _Bool               AnyCase = False;       /* case sensitivity flag */
+  InfoHash_Type       *Index;
+  uint32_t            Hash;
 
   /* sanity check */
   if (Name == NULL) return Element;
@@ -133,6 +284,33 @@ Info_Type *SearchInfoList(Info_Type *List, char *Name)
   /* check for case-insensitive search */
   if (Env->CfgSwitches & SW_ANY_CASE) AnyCase = True; 
 
+  /* use hash index for global list */
+  Index = &(Env->InfoHash);
+  if (Index->Buckets && (List == Env->InfoList) && (Index->AnyCase == AnyCase))
+  {
+    Hash = InfoHash(Name, AnyCase);
+    List = Index->Buckets[Hash & (Index->Size - 1)];
+
+    while (List)              /* follow bucket */
+    {
+      if (List->Hash == Hash)
+      {
+        if (AnyCase == False)   /* case sensitive */
+        {
+          if (strcmp(Name, List->Name) == 0) return List;
+        }
+        else                    /* case insensitive */
+        {
+          if (strcasecmp(Name, List->Name) == 0) return List;
+        }
+      }
+
+      List = List->HashNext;       /* next element */
+    }
+
+    return Element;
+  }
+
   while (List)                /* follow list */
   {
     if (List->Name)           /* sanity check */
@@ -164,8 +342,73 @@ Info_Type *SearchInfoList(Info_Type *List, char *Name)
 
 
 
+/*
+ *  free description arena of global info list
+ */
+
+void FreeArena(void)
+{
+  Arena_Type          *Next;
+
+  while (Env->Arena)
+  {
+    Next = Env->Arena->Next;     /* save pointer to next element */
+    free(Env->Arena);
+    Env->Arena = Next;           /* move to next element */
+  }
+}
+
+
+
+/*
+ *  get memory from description arena
+ *  - memory is freed for the whole arena only
+ *
+ *  returns:
+ *  - pointer to memory on success
+ *  - NULL on error
+ */
+
+void *GetArenaMemory(size_t Size)
+{
+  void                *Memory;            /* return value */
+  Arena_Type          *Block;
+  size_t              BlockSize;
+
+  /* keep alignment for structures */
+  Size = (Size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+  Block = Env->Arena;
+  if ((Block == NULL) || (Block->Size - Block->Used < Size))
+  {
+    /* add new block (large requests get their own one) */
+    BlockSize = ARENA_BLOCK_SIZE;
+    if (Size > BlockSize) BlockSize = Size;
+
+    Block = malloc(sizeof(Arena_Type) + BlockSize);
+    if (Block == NULL)
+    {
+      Log(L_ERR, "Couldn't allocate memory!");
+      return NULL;
+    }
+
+    Block->Size = BlockSize;
+    Block->Used = 0;
+    Block->Next = Env->Arena;
+    Env->Arena = Block;
+  }
+
+  Memory = (char *)&Block[1] + Block->Used;
+  Block->Used += Size;
+
+  return Memory;
+}
+
+
+
 /*
  *  create and add new description line to Info element
+ *  - element and string are taken from description arena
  *
  *  requires:
  *  - pointer to fileinfo element
@@ -180,16 +423,19 @@ _Bool AddDesc2Info(Info_Type *Info, char *Data)
 {
   _Bool               Flag = False;        /* return value */
   Token_Type          *Token = NULL;
+  size_t              Length;
 
   /* sanity checks */
   if ((Info == NULL) || (Data == NULL)) return Flag;
 
-  Token = malloc(sizeof(Token_Type));
+  Length = strlen(Data);
+  Token = GetArenaMemory(sizeof(Token_Type) + Length + 1);
   if (Token)
   {
     /* setup element */
     Token->Next = NULL;
-    Token->String = CopyString(Data);
+    Token->String = (char *)&Token[1];
+    memcpy(Token->String, Data, Length + 1);
 
     /* and add it to list */
     if (Info->LastInfo) Info->LastInfo->Next = Token;
@@ -198,10 +444,6 @@ _Bool AddDesc2Info(Info_Type *Info, char *Data)
 
     Flag = True;    /* signal success */
   }
-  else
-  {
-    Log(L_ERR, "Could not allocate memory!");
-  }
 
   return Flag;
 }
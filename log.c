@@ -39,16 +39,63 @@
 #endif
 
 
+/*
+ *  local variables
+ */
+
+/* write buffer for logfile */
+char                WriteBuffer[LOG_BUFFER_SIZE];    /* buffered lines */
+size_t              WriteSize = 0;           /* used size of buffer */
+time_t              LastFlush = 0;           /* time of last flush */
+
+/* cached timestamp */
+time_t              LastTime = -1;           /* time of timestamp */
+char                TimeStamp[24];           /* formatted timestamp */
+size_t              TimeLength = 0;          /* length of timestamp */
+
+
 
 /* ************************************************************************
  *   logging
  * ************************************************************************ */
 
 
+/*
+ *  write buffered lines to logfile
+ *  - single write() for all lines, so lines of concurrent
+ *    processes aren't mixed up (append mode)
+ */
+
+void FlushLog(void)
+{
+  char              *Buffer;            /* support pointer */
+  ssize_t           Length;             /* bytes written */
+
+  if ((Env == NULL) || (Env->Log == NULL) || (WriteSize == 0)) return;
+
+  fflush(Env->Log);                /* just in case */
+
+  Buffer = WriteBuffer;
+  while (WriteSize > 0)
+  {
+    Length = write(fileno(Env->Log), Buffer, WriteSize);
+    if (Length <= 0) break;        /* error */
+    Buffer += Length;
+    WriteSize -= Length;
+  }
+
+  WriteSize = 0;
+  LastFlush = time(NULL);
+}
+
+
+
 /*
  *  log stuff (printf syntax)
  *  - write to logfile if one is set up 
  *  - write to console if not logfile is set up
+ *  - logfile is buffered and flushed based on flush interval,
+ *    when buffer is full and for warnings and errors
  */
 
 void Log(unsigned short int Type, const char *Line, ...)
@@ -59,6 +106,7 @@ void Log(unsigned short int Type, const char *Line, ...)
   char              *Buffer;            /* support pointer */
   char              *Message;
   FILE              *Stream;
+  time_t            UnixTime = 0;       /* current time */
   _Bool             ExitFlag = False;   /* exit flag */
 
   /* sanity checks */
@@ -80,27 +128,29 @@ void Log(unsigned short int Type, const char *Line, ...)
 
   if (Env && Env->Log)
   {
-    time_t          UnixTime;
-    struct tm       *DateTime;  
+    struct tm       DateTime;  
 
     /* get current date and time */
-    if (time(&UnixTime) != -1)           /* get UNIX time */
+    UnixTime = time(NULL);               /* get UNIX time */
+    if ((UnixTime != -1) && (UnixTime != LastTime))   /* new second */
     {
-      DateTime = localtime(&UnixTime);   /* convert unix time */
-      if (DateTime != NULL)
+      TimeLength = 0;
+
+      if (localtime_r(&UnixTime, &DateTime))   /* convert unix time */
       {
         /* format: year-month-day hh:mm:ss */
-        Length = strftime(Buffer, 22, "%F %T", DateTime);
-        if (Length > 0)       /* success */
-        {
-          Buffer += Length;     /* move pointer to end of string */
-          Size += Length;       /* update counter */
-        }
-        else                  /* error */
-        {
-          Buffer[0] = 0;        /* reset buffer */
-        }
+        TimeLength = strftime(TimeStamp, 22, "%F %T", &DateTime);
       }
+
+      LastTime = UnixTime;
+    }
+
+    /* add cached timestamp */
+    if (TimeLength > 0)
+    {
+      memcpy(Buffer, TimeStamp, TimeLength);
+      Buffer += TimeLength;   /* move pointer to end of string */
+      Size += TimeLength;     /* update counter */
     }
 
     /* add process ID */
@@ -123,10 +173,15 @@ void Log(unsigned short int Type, const char *Line, ...)
 
   va_end(ArgPointer);         /* clean up arg list */
 
+  /* vsnprintf() returns the length of the untruncated string */
+  if (Length > DEFAULT_BUFFER_SIZE - 3 - Size)
+    Length = DEFAULT_BUFFER_SIZE - 3 - Size;
+
   /* add LineFeed */
   Buffer += Length;           /* move pointer to end of string */
   Buffer[0] = '\n';
   Buffer[1] = 0;
+  Size += Length + 1;         /* update size */
 
 
   /*
@@ -135,8 +190,20 @@ void Log(unsigned short int Type, const char *Line, ...)
 
   if (Env && Env->Log)             /* log to file */
   { 
-    fputs(LogBuffer, Env->Log);    /* write */
-    fflush(Env->Log);              /* flush any buffered output */
+    /* flush buffer if it's full */
+    if (WriteSize + Size > LOG_BUFFER_SIZE) FlushLog();
+
+    /* add line to buffer */
+    memcpy(WriteBuffer + WriteSize, LogBuffer, Size);
+    WriteSize += Size;
+
+    /* flush based on type and interval */
+    if ((Type == L_WARN) || (Type == L_ERR) ||
+        (Env->LogFlush <= 0) ||
+        (UnixTime - LastFlush >= Env->LogFlush))
+    {
+      FlushLog();
+    }
   }
   else                             /* log to console */
   {
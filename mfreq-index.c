@@ -58,180 +58,6 @@ _Bool ReadConfig(char *Filepath);
 
 
 
-/* ************************************************************************
- *   data sorting
- * ************************************************************************ */
-
-
-/*
- *  sort file data by name
- *  - algorithm: merge sort
- *  - lower case > upper case
- */
-
-IndexData_Type *MergeSort(IndexData_Type *List, IndexData_Type **Last)
-{
-  IndexData_Type        *NewList = NULL;       /* return value */
-  IndexData_Type        *LeftSub;              /* left sublist */
-  IndexData_Type        *RightSub;             /* right sublist */
-  IndexData_Type        *Element = NULL;       /* single element */
-  IndexData_Type        *MergedList;           /* merged list */
-  unsigned int          LeftSize;              /* number of elements in left sublist */
-  unsigned int          RightSize;             /* number of elements in right sublist */
-  unsigned int          StepSize;              /* number of elements to process */
-  unsigned int          Merges;                /* number of sublist merges */
-  _Bool                 Run = True;
-
-  /* sanity check */
-  if (List == NULL) return NewList;
-
-
-  /*
-   *  master loop
-   */
-
-  StepSize = 1;       /* start with sublists with one element each */
-                      /* an 1 element sublist is sorted by definition :-) */
-
-  NewList = List;     /* initialize new list for first loop run */
-
-  while (Run)
-  {
-    /* prepare this run */
-    LeftSub = NewList;       /* start with new list */
-    NewList = NULL;          /* reset new list */
-    MergedList = NULL;       /* reset merged list */
-    Merges = 0;              /* reset counter */
-
-
-    /*
-     *  process list using sublists with StepSize elements  
-     */
-
-    /* as long as we haven't reached the lists end */
-    while (LeftSub)
-    {
-      /*
-       *  create virtual left and right sublists with StepSize elements
-       */
- 
-      RightSub = LeftSub;      /* starting point */
-      LeftSize = 0;            /* reset size */
-
-      /* as long as we don't reach the list's end move SubSize elements to the right */
-      while (RightSub && (LeftSize < StepSize))
-      {
-        LeftSize++;                     /* increase size of left sublist */
-        RightSub = RightSub ->Next;     /* move to next element */
-      }
-
-      RightSize = StepSize;             /* assume size of right sublist to be StepSize */
-                                        /* might be larger than real size */
-
-      /* 
-       *  merge both sub lists as long as elements are left
-       *  also prevent overrun of right sublist
-       */ 
-
-      while ((LeftSize > 0) || ((RightSize > 0) && RightSub))
-      {
-        /*
-         *  select element to merge
-         */
-
-        /* no elements left in left sublist */
-        if (LeftSize == 0)
-        {
-          /* so take next element of right sublist */
-          Element = RightSub;            /* take element */
-          RightSize--;                   /* one element less in sublist */
-          RightSub = RightSub->Next;     /* move to next element in sublist */
-        }
-
-        /* no elements left in right sublist */
-        /* or end of right sublist reached */
-        else if ((RightSize == 0) || (RightSub == NULL))
-        {
-          /* so take next element of left sublist */
-          Element = LeftSub;             /* take element */
-          LeftSize--;                    /* one element less in sublist */
-          LeftSub = LeftSub->Next;       /* move to next element in sublist */
-        }
-
-        /* otherwise we have to compare the next elements of both sublists */
-        else
-        {
-          if (LeftSub->Name && RightSub->Name)      /* sanity check */
-          {
-            if (strcmp(LeftSub->Name, RightSub->Name) <= 0)
-            {
-              /* element of left sublist is smaller or equal */
-              /* take that one */
-              Element = LeftSub;             /* take element */
-              LeftSize--;                    /* one element less in sublist */
-              LeftSub = LeftSub->Next;       /* move to next element in sublist */
-            }
-            else
-            {
-              /* element of right sublist is smaller */
-              /* take that one */
-              Element = RightSub;            /* take element */
-              RightSize--;                   /* one element less in sublist */
-              RightSub = RightSub->Next;     /* move to next element in sublist */
-            }
-          }
-        }
-
-
-        /*
-         *  merge selected element
-         *  by moving it to the merged list
-         */
-
-        if (MergedList)             /* if merged list exists */
-        {
-          MergedList->Next = Element;    /* link element */
-        }
-        else                        /* otherwise */
-        {
-          /* it's the first element for the merged list */
-          /* and the starting point for the next loop run */
-          NewList = Element;        /* set first element of new list */
-        }
-
-	MergedList = Element;      /* Element is the new end of merged list */
-      }
-
-      Merges++;                    /* another merge done */
-      LeftSub = RightSub;          /* move to next sublist pair */
-    }
-
-    MergedList->Next = NULL;        /* end merged list */
-
-
-    /*
-     *  loop control/feedback
-     */
-
-    /* if only one merge is done we sorted the complete list */ 
-    if (Merges <= 1)          /* if job done */
-    {
-      Run = False;              /* end master loop */
-
-      /* if requested update pointer to last element */
-      if (Last) *Last = MergedList;
-    }
-    else                      /* another run required */
-    {
-      StepSize = StepSize * 2;    /* double stepsize of sublist for next run */
-    }
-  }
-
-  return NewList;
-}
-
-
-
 /* ************************************************************************
  *   file handling
  * ************************************************************************ */
@@ -373,7 +199,7 @@ _Bool ReadMagicFile(char *Filename)
           {
             /* add to file index */
             Run = AddDataElement(Filename, TempBuffer, NULL);
-            if (Run) Env->Files++;       /* increase file counter */
+            if (Run) Env->IndexFiles++;       /* increase file counter */
           }
         }
       }
@@ -477,24 +303,16 @@ _Bool ProcessPath(char *Path, char *PW, int Depth, _Bool AutoMagic)
 {
   _Bool                  Flag = False;       /* return value */
   _Bool                  Run = True;         /* control flag */
-  _Bool                  AliasFlag = False;  /* path aliases */
-  _Bool                  AnyCase = False;    /* case-insensive search */
   DIR                    *Directory;
   struct dirent          *File;
   struct stat            FileData;
   char                   *LocalPath = NULL;  /* absolute path */
   char                   *SubPath = NULL;    /* path of sub-directory */
-  char                   *Help, *LastDot;
-  size_t                 Length;             /* string length */
-  unsigned int           AliasNumber = 0;    /* alias counter */
   off_t                  AliasOffset = -1;   /* alias file offset */
 
   /* sanity check */
   if ((Path == NULL) || (Depth < 0)) return Flag;
 
-  /* case-insensive search */
-  if (Env->CfgSwitches & SW_ANY_CASE) AnyCase = True;
-
   /* build absolute path if necessary */
   if (Path[0] != '/')      /* relative path */
   {
@@ -517,28 +335,7 @@ _Bool ProcessPath(char *Path, char *PW, int Depth, _Bool AutoMagic)
      *  path aliasing
      */
 
-    if (Env->CfgSwitches & SW_PATH_ALIASES)   /* if enabled */
-    {
-      /* get and set top number */
-      if (Env->LastAlias) AliasNumber = Env->LastAlias->Number;
-      AliasNumber++;
-
-      /* check for overflow */
-      if (AliasNumber <= 10000)        /* limit to 10000 */
-      {
-        /* add alias to list */
-        if (AddAliasElement(AliasNumber, Path))
-        {
-          AliasOffset = Env->LastAlias->Offset;
-          AliasFlag = True;            /* perform aliasing */
-        }
-        else
-        {
-          Run = False;
-        }
-      }
-      /* else: AliasFlag is still false */
-    }
+    if (Run) Run = AddIndexAlias(Path, &AliasOffset);
 
 
     /* intermediate check */
@@ -571,66 +368,10 @@ _Bool ProcessPath(char *Path, char *PW, int Depth, _Bool AutoMagic)
           if (S_ISREG(FileData.st_mode))        /* regular file */
           {
             /* add file to index if not excluded */
-            if (! MatchExcludeList(TempBuffer2))
+            if (! MatchExcludeList(TempBuffer2) && ! IsTempFile(TempBuffer2))
             {
-              /* build filepath */
-              /* omit filename (automatic filepath) */ 
-              if (AliasFlag)            /* path alias enabled */
-              {
-                /* create aliased path without filename */
-                /* format: %<alias offset>%/ */
-                snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
-                  "%%%ld%%/", AliasOffset);
-              }
-              else                      /* path alias disabled */
-              {
-                /* create full path whithout filename */
-                snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
-                  "%s/", Path);
-              }
-
-              if (AnyCase)              /* case-insensitive search */
-              {
-                /*
-                 *  For AnyCase we have to convert the filename to uppper case
-                 *  later on. So we need to add the original filename to the path.
-                 */
-
-                /* add filename to path */
-                Length = strlen(TempBuffer);
-                Help = &TempBuffer[Length];       /* end of path */
-                snprintf(Help, DEFAULT_BUFFER_SIZE - 1 - Length,
-                    "%s", TempBuffer2);                
-              }
-
-              Flag = AddDataElement(TempBuffer2, TempBuffer, PW);
-              if (Flag) Env->Files++;       /* increase file counter */
-
-              if (AutoMagic)         /* auto magic enabled */
-              {
-                /* find last "." in filename */
-                Help = TempBuffer2;
-                LastDot = NULL;
-                while (Help[0] != 0)         /* scan string */
-                {
-                  if (Help[0] == '.') LastDot = Help;
-                  Help++;                    /* next char */
-                }
-
-                /* create magic */
-                if (LastDot)                 /* got extension */
-                {
-                  /* add filename to path */
-                  Length = strlen(TempBuffer);
-                  Help = &TempBuffer[Length];    /* end of path */
-                  snprintf(Help, DEFAULT_BUFFER_SIZE - 1 - Length,
-                    "%s", TempBuffer2);
-
-                  LastDot[0] = 0;            /* create sub-string */
-
-                  Flag = AddDataElement(TempBuffer2, TempBuffer, PW); 
-                }
-              }
+              Flag = AddIndexFile(TempBuffer2, Path, PW, AliasOffset,
+                AutoMagic);
             }
           }
           else if (S_ISDIR(FileData.st_mode))   /* directory */
@@ -873,7 +614,7 @@ _Bool ProcessSmartMagic(char *Name, char *Path, char *Pattern, char *Password,
         snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
           "%s/%s", Path, File->Name);
         Flag = AddDataElement(Name, TempBuffer, Password);
-        if (Flag) Env->Files++;       /* increase file counter */
+        if (Flag) Env->IndexFiles++;       /* increase file counter */
         else Next = NULL;             /* end loop */
       }
 
@@ -900,327 +641,6 @@ _Bool ProcessSmartMagic(char *Name, char *Path, char *Pattern, char *Password,
 
 
 
-/* ************************************************************************
- *   file index
- * ************************************************************************ */
-
-
-/*
- *  write index
- *
- *  returns:
- *  - 1 on success
- *  - 0 on error
- */
-
-_Bool WriteIndex(char *Filepath)
-{
-  _Bool             Flag = False;            /* return value */
-  _Bool             Run = True;              /* control flag */
-  IndexData_Type    *IndexData = NULL;       /* data list */
-  IndexData_Type    *LastData;               /* last element in data list */
-  IndexLookup_Type  *IndexLookup = NULL;     /* lookup list */
-  IndexAlias_Type   *IndexAlias = NULL;      /* alias list */
-  FILE              *DataFile = NULL;        /* index data file */
-  FILE              *LookupFile = NULL;      /* index lookup file */
-  FILE              *AliasFile = NULL;       /* index alias file */
-  FILE              *OffsetFile = NULL;      /* index offset file */
-  _Bool             DataLock = False;        /* data file locked */
-  _Bool             LookupLock = False;      /* lookup file locked */
-  _Bool             AliasLock = False;       /* alias file locked */
-  _Bool             OffsetLock = False;      /* offset file locked */
-  char              FirstChar = 0;           /* first char of filename */
-  unsigned int      Counter = 0;             /* filename/line counter */
-  off_t             Offset;                  /* file offset */
-  char              *Help;
-  _Bool             OffsetFlag = False;      /* flag for binary search mode */
-
-  /* sanity check */
-  if (Filepath == NULL) return False;
-
-  /* update flag for binary search (create offset file) */
-  if (Env->CfgSwitches & SW_BINARY_SEARCH) OffsetFlag = True;
-
-
-  /*
-   *  sort data
-   */
-
-  if (Run)
-  {
-    Run = False;                               /* reset flag */
-    LastData = NULL;                           /* reset pointer */
-
-    IndexData = MergeSort(Env->DataList, &LastData);   /* sort */
-    Env->DataList = IndexData;                 /* update list start */
-    Env->LastData = LastData;                  /* update list end */
-
-    if (IndexData != NULL) Run = True;         /* ok for next part */
-  }
-
-
-  /*
-   *  open index files
-   */
-
-  if (Run)
-  {
-    Run = False;                                /* reset flag */
-
-    /* data file */
-    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
-      "%s."SUFFIX_DATA, Filepath);
-    DataFile = fopen(TempBuffer, "w");       /* truncate & write mode */
-
-    /* lookup file (binary search) */
-    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
-      "%s."SUFFIX_LOOKUP, Filepath);
-    LookupFile = fopen(TempBuffer, "w");     /* truncate & write mode */
-
-    /* alias file */
-    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
-      "%s."SUFFIX_ALIAS, Filepath);
-    AliasFile = fopen(TempBuffer, "w");      /* truncate & write mode */
-
-    /* offset file */
-    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
-      "%s."SUFFIX_OFFSET, Filepath);
-    OffsetFile = fopen(TempBuffer, "w");     /* truncate & write mode */
-
-    /* check */
-    if (DataFile && LookupFile && AliasFile && OffsetFile)
-    {
-      Run = True;                  /* ok for next part */
-    }
-    else
-    {
-      Log(L_WARN, "Can't open index files (%s)!", Filepath);
-    }
-  }
-
-
-  /*
-   *  lock index files
-   */
-
-  if (Run)
-  {
-    Run = False;                             /* reset flag */
-
-    /* lock files */
-    DataLock = LockFile(DataFile, NULL);
-    LookupLock = LockFile(LookupFile, NULL);
-    AliasLock = LockFile(AliasFile, NULL);
-    OffsetLock = LockFile(OffsetFile, NULL);
-
-    /* check */
-    if (DataLock && LookupLock && AliasLock && OffsetLock)
-    {
-      Run = True;                  /* ok for next part */
-    }
-    else
-    {
-      Log(L_WARN, "Can't lock index files (%s)!", Filepath);
-    }
-  }
-
-
-  /*
-   *  write data file and optional offset file
-   *  also build lookup list
-   *
-   *  format: <name>0x1F<filepath>[0x1F<password>]LF
-   *  We use the ascii unit separator 31 (octal 037) as field separator.
-   *  <filepath>: <path>/[<filename>] or %<alias offset>%/[<filename>]
-   *  - %<alias offset>% for automatic path aliasing
-   *  - <filename> can be omitted if same as <name>
-   */
-
-  if (Run)
-  {
-    while (IndexData)                   /* follow list */
-    {
-      Counter++;              /* another file */
-
-      /* catch change of first letter */
-      if (IndexData->Name[0] != FirstChar)
-      {
-        /* update last line counter for old character */
-        IndexLookup = Env->LastLookup;     /* get current pointer */
-        if (IndexLookup) IndexLookup->Stop = Counter - 1;
-
-        FirstChar = IndexData->Name[0];    /* save new character */
-
-        /* add lookup element for new character */
-        Offset = ftello(DataFile);      /* get current offset of the data file */
-        AddLookupElement(FirstChar, Offset, Counter, 0);
-      }
-
-      /*
-       *  write offset file (BinarySearch)
-       *  format: <binary offset>
-       */
-
-      if (OffsetFlag)
-      {
-        Offset = ftello(DataFile);      /* get current offset of the data file */
-
-        /* write offset of the data file to the offset file */
-        if (fwrite(&Offset, sizeof(off_t), 1, OffsetFile) != 1)
-        {
-          Run = False;               /* signal problem */
-          IndexData = NULL;          /* end loop */
-          Log(L_WARN, "Write error for index offset file (%s)!", Filepath);
-        }
-      }
-
-      /*
-       *  write data file
-       */
-
-      /* build data buffer */
-      if (IndexData->PW)           /* password required */
-      {
-        snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
-          "%s\037%s\037%s\n", IndexData->Name, IndexData->Filepath, IndexData->PW);
-      }
-      else                         /* no password */
-      {
-        snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
-          "%s\037%s\n", IndexData->Name, IndexData->Filepath);
-      }
-
-      IndexData = IndexData->Next;      /* go to next element */
-
-      /* and write to data file */
-      if (fputs(OutBuffer, DataFile) < 0)    /* got an error */
-      {
-        Run = False;               /* signal problem */
-        IndexData = NULL;          /* end loop */
-        Log(L_WARN, "Write error for index data file (%s)!", Filepath);
-      }
-
-      /* check for counter overflow */
-      if (Counter >= 1000000)      /* keep it reasonable, not UINT_MAX */
-      {
-        Run = False;               /* signal problem */
-        IndexData = NULL;          /* end loop */
-        Log(L_WARN, "Fileindex overrun (%s)!", Filepath);
-      } 
-    }
-
-    /* update stop line# of last char */
-    if (Run)
-    {
-      IndexLookup = Env->LastLookup;     /* get current pointer */
-      if (IndexLookup) IndexLookup->Stop = Counter;
-    } 
-  }
-
-
-  /*
-   *  write lookup file
-   *
-   *  format: <char> <file offset> <start line#> <stop line#>LF
-   */
-
-  if (Run)
-  {
-    IndexLookup = Env->LookupList;
-
-    while (IndexLookup)            /* follow list */
-    {
-      /* build data buffer */
-      snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
-        "%c %ld %u %u\n", IndexLookup->Letter, IndexLookup->Offset,
-        IndexLookup->Start, IndexLookup->Stop);
-      
-      IndexLookup = IndexLookup->Next;     /* go to next element */
-
-      if (fputs(OutBuffer, LookupFile) < 0)    /* got an error */
-      {
-        Run = False;
-        IndexLookup = NULL;
-        Log(L_WARN, "Write error for index lookup file (%s)!", Filepath);
-      }
-    }
-  }
-
-
-  /*
-   *  write alias file
-   *
-   *  format: <path>LF
-   *  To access the paths later on the offsets to the paths are stored as aliases
-   *  in the data file.
-   */
-
-  if (Run)
-  {
-    IndexAlias = Env->AliasList;
-
-    while (IndexAlias)             /* follow list */
-    {
-      /* build data buffer */
-      snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1, "%s\n", IndexAlias->Path);
-      
-      IndexAlias = IndexAlias->Next;         /* go to next element */
-
-      if (fputs(OutBuffer, AliasFile) < 0)   /* got an error */
-      {
-        Run = False;
-        IndexAlias = NULL;
-        Log(L_WARN, "Write error for index alias file (%s)!", Filepath);
-      }
-    }
-  }
-
-
-  /*
-   *  check & log
-   */
-
-  if (Run)
-  {
-    Flag = True;             /* signal success */
-
-    /* log statistics */
-    Help = GetFilename(Filepath);
-    if (Help) Log(L_INFO, "Processed %ld files for index \"%s\".", Env->Files, Help);
-    Env->Files = 0;          /* reset counter */
-  }
-
-
-  /*
-   *  clean up
-   */
-
-  /* unlock and close files */
-  if (OffsetLock) UnlockFile(OffsetFile);
-  if (AliasLock) UnlockFile(AliasFile);
-  if (LookupLock) UnlockFile(LookupFile);
-  if (DataLock) UnlockFile(DataFile);
-  if (OffsetFile) fclose(OffsetFile);
-  if (AliasFile) fclose(AliasFile);
-  if (LookupFile) fclose(LookupFile);
-  if (DataFile) fclose(DataFile);
-
-  /* free file index lists */
-  FreeDataList(Env->DataList);            /* free index data list */
-  Env->DataList = NULL;
-  Env->LastData = NULL;
-  FreeLookupList(Env->LookupList);        /* free index lookup list */
-  Env->LookupList = NULL;
-  Env->LastLookup = NULL;
-  FreeAliasList(Env->AliasList);          /* free index alias list */
-  Env->AliasList = NULL;
-  Env->LastAlias = NULL;
-
-  return Flag;
-}
-
-
-
 /* ************************************************************************
  *   command parser support
  * ************************************************************************ */
@@ -1395,7 +815,7 @@ _Bool Cmd_Index(Token_Type *TokenList)
 
   if (Run)
   {
-    Flag = WriteIndex(FilepathToken->String);
+    Flag = WriteIndex(FilepathToken->String, &Env->IndexFiles);
   }
 
   return Flag;
@@ -1943,7 +1363,7 @@ _Bool Cmd_Magic(Token_Type *TokenList)
     {
       /* add magic to global file index */
       Flag = AddDataElement(Name, Filepath, Password);
-      if (Flag) Env->Files++;       /* increase file counter */
+      if (Flag) Env->IndexFiles++;       /* increase file counter */
     }
   }
 
@@ -1993,7 +1413,7 @@ _Bool Cmd_Reset(Token_Type *TokenList)
         break;
 
       case 2:       /* SetMode */
-        Env->CfgSwitches = SW_NONE;     /* set switches to default */
+        Env->IndexSwitches = SW_NONE;     /* set switches to default */
         break;
 
       case 3:       /* Excludes */
@@ -2068,15 +1488,15 @@ _Bool Cmd_SetMode(Token_Type *TokenList)
         break;
 
       case 2:       /* path aliases */
-        Env->CfgSwitches |= SW_PATH_ALIASES;
+        Env->IndexSwitches |= SW_PATH_ALIASES;
         break;
 
       case 3:       /* binary search */
-        Env->CfgSwitches |= SW_BINARY_SEARCH;
+        Env->IndexSwitches |= SW_BINARY_SEARCH;
         break;
 
       case 4:       /* case-insensitive search */
-        Env->CfgSwitches |= SW_ANY_CASE;
+        Env->IndexSwitches |= SW_ANY_CASE;
         break;
     }
 
@@ -2104,7 +1524,7 @@ _Bool Cmd_SetMode(Token_Type *TokenList)
 
 /*
  *  open logfile
- *  Syntax: LogFile <filepath>
+ *  Syntax: LogFile <filepath> [Flush <seconds>]
  *
  *  returns:
  *  - 1 on success
@@ -2117,6 +1537,7 @@ _Bool Cmd_LogFile(Token_Type *TokenList)
   _Bool             Run = True;              /* control flag */
   unsigned short    Get = 0;                 /* mode control */
   Token_Type        *FilepathToken = NULL;
+  long              Seconds = LOG_FLUSH;     /* flush interval */
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
@@ -2141,10 +1562,19 @@ _Bool Cmd_LogFile(Token_Type *TokenList)
       FilepathToken = TokenList;
       Get = 0;                       /* reset */      
     }
+    else if (Get == 2)             /* get value: seconds */
+    {
+      Seconds = Str2Long(TokenList->String);
+      Get = 0;                       /* reset */
+    }
     else if (strcasecmp(TokenList->String, "LogFile") == 0)  /* filepath */
     {
       Get = 1;
     }
+    else if (strcasecmp(TokenList->String, "Flush") == 0)     /* seconds */
+    {
+      Get = 2;
+    }
     else                                               /* unknown */
     {
       Run = False;
@@ -2158,7 +1588,8 @@ _Bool Cmd_LogFile(Token_Type *TokenList)
    *  check parser results
    */
 
-  if ((Run == False) || (Get > 0) || (FilepathToken == NULL))
+  if ((Run == False) || (Get > 0) || (FilepathToken == NULL) ||
+      (Seconds < 0) || (Seconds > MAX_LOG_FLUSH))
   {
     Run = False;
     LogCfgError();
@@ -2173,6 +1604,7 @@ _Bool Cmd_LogFile(Token_Type *TokenList)
   {
     Env->LogFilepath = FilepathToken->String;    /* move string */
     FilepathToken->String = NULL;
+    Env->LogFlush = Seconds;
     Flag = OpenLogfile();                        /* open file */
   }
 
@@ -2588,6 +2020,7 @@ _Bool GetAllocations(void)
 
     /* environment: file streams */
     Env->Log = NULL;
+    Env->LogFlush = LOG_FLUSH;
 
     /* environment: program control */
     Env->Run = True;
@@ -2599,6 +2032,8 @@ _Bool GetAllocations(void)
     Env->CfgSwitches = SW_NONE;
 
     /* environment: file index */
+    Env->IndexSwitches = SW_NONE;
+    Env->IndexFiles = 0;
     Env->DataList = NULL;
     Env->LastData = NULL;
     Env->LookupList = NULL;
@@ -2609,9 +2044,6 @@ _Bool GetAllocations(void)
     Env->LastExclude = NULL;
     Env->FileList = NULL;
     Env->LastFile = NULL;
-
-    /* environment: frequest runtime stuff */
-    Env->Files = 0;         /* will misuse that for statistics */
   }
 
   return Flag;
@@ -2742,6 +2174,7 @@ int main(int argc, char *argv[])
 
     if (Env->Log)             /* close logfile */
     {
+      FlushLog();                  /* write buffered lines */
       UnlockFile(Env->Log);        /* unlock file */
       fclose(Env->Log);            /* close file */
       Env->Log = NULL;
@@ -0,0 +1,771 @@
+/* ************************************************************************
+ *
+ *   mfreq-journal
+ *
+ *   (c) 1994-2019 by Markus Reschke
+ *
+ * ************************************************************************ */
+
+
+/*
+ *  local constants
+ */
+
+#define MFREQ_JOURNAL_C
+
+
+/* defaults for this program */
+#define NAME            "mfreq-journal"
+#define TOP_ENTRIES     10          /* default number of top entries */
+
+
+/*
+ *  include header files
+ */
+
+#include "common.h"           /* common stuff */
+#include "variables.h"        /* global variables */
+#include "functions.h"        /* external functions */
+
+/* file stuff */
+#include <sys/types.h>
+#include <sys/stat.h>
+
+
+/*
+ *  local variables
+ */
+
+/* journal */
+char                *Journal = NULL;         /* loaded journal */
+off_t               JournalSize = 0;         /* size of journal */
+unsigned int        TopEntries = TOP_ENTRIES;   /* number of top entries */
+
+/* totals */
+unsigned long       Sessions = 0;            /* number of sessions */
+unsigned long       Requests = 0;            /* number of requests */
+unsigned long       Hits = 0;                /* requests with files found */
+unsigned long       FilesSent = 0;           /* files sent */
+long long           BytesSent = 0;           /* bytes sent */
+long long           TotalTime = 0;           /* time of all sessions */
+unsigned long       BadRecords = 0;          /* damaged records */
+
+/* statistics */
+JournalStat_Type    *FileStats = NULL;       /* files (array) */
+unsigned long       FileCount = 0;           /* number of entries */
+unsigned long       FileMax = 0;             /* size of array */
+JournalStat_Type    *AKAStats = NULL;        /* requesters (array) */
+unsigned long       AKACount = 0;            /* number of entries */
+unsigned long       AKAMax = 0;              /* size of array */
+
+
+
+/* ************************************************************************
+ *   statistics
+ * ************************************************************************ */
+
+
+/*
+ *  add entry to statistics
+ *  - entries are merged later on
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool AddStat(JournalStat_Type **Stats, unsigned long *Count,
+  unsigned long *Max, char *Name, unsigned long Files, long long Bytes)
+{
+  _Bool             Flag = False;            /* return value */
+  JournalStat_Type  *Help;                   /* new array */
+  unsigned long     Size;                    /* new size */
+
+  /* sanity checks */
+  if ((Stats == NULL) || (Count == NULL) || (Max == NULL) || (Name == NULL))
+    return Flag;
+
+  /* enlarge array */
+  if (*Count >= *Max)
+  {
+    Size = *Max * 2;
+    if (Size == 0) Size = 256;
+
+    Help = realloc(*Stats, Size * sizeof(JournalStat_Type));
+    if (Help == NULL)
+    {
+      Log(L_ERR, "Couldn't allocate memory!");
+      return Flag;
+    }
+
+    *Stats = Help;
+    *Max = Size;
+  }
+
+  Help = &(*Stats)[*Count];
+  Help->Name = Name;
+  Help->Count = 1;
+  Help->Files = Files;
+  Help->Bytes = Bytes;
+  (*Count)++;
+
+  Flag = True;
+
+  return Flag;
+}
+
+
+
+/*
+ *  compare entries by name (qsort)
+ */
+
+int CompareName(const void *Stat1, const void *Stat2)
+{
+  return strcmp(((JournalStat_Type *)Stat1)->Name,
+    ((JournalStat_Type *)Stat2)->Name);
+}
+
+
+
+/*
+ *  compare entries by count, files and bytes (qsort)
+ *  - descending order
+ */
+
+int CompareCount(const void *Stat1, const void *Stat2)
+{
+  JournalStat_Type  *A, *B;
+
+  A = (JournalStat_Type *)Stat1;
+  B = (JournalStat_Type *)Stat2;
+
+  if (A->Count != B->Count) return (A->Count < B->Count) ? 1 : -1;
+  if (A->Files != B->Files) return (A->Files < B->Files) ? 1 : -1;
+  if (A->Bytes != B->Bytes) return (A->Bytes < B->Bytes) ? 1 : -1;
+  return strcmp(A->Name, B->Name);
+}
+
+
+
+/*
+ *  merge entries with same name and sort by count
+ */
+
+void MergeStats(JournalStat_Type *Stats, unsigned long *Count)
+{
+  unsigned long     n, m = 0;                /* counters */
+
+  /* sanity checks */
+  if ((Stats == NULL) || (Count == NULL) || (*Count == 0)) return;
+
+  qsort(Stats, *Count, sizeof(JournalStat_Type), CompareName);
+
+  for (n = 1; n < *Count; n++)
+  {
+    if (strcmp(Stats[m].Name, Stats[n].Name) == 0)     /* same name */
+    {
+      Stats[m].Count += Stats[n].Count;
+      Stats[m].Files += Stats[n].Files;
+      Stats[m].Bytes += Stats[n].Bytes;
+    }
+    else                                               /* next name */
+    {
+      m++;
+      Stats[m] = Stats[n];
+    }
+  }
+
+  *Count = m + 1;
+
+  qsort(Stats, *Count, sizeof(JournalStat_Type), CompareCount);
+}
+
+
+
+/* ************************************************************************
+ *   journal
+ * ************************************************************************ */
+
+
+/*
+ *  load journal into memory
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool LoadJournal(char *Filepath)
+{
+  _Bool             Flag = False;            /* return value */
+  FILE              *File;                   /* file stream */
+  struct stat       FileData;
+
+  /* sanity check */
+  if (Filepath == NULL) return Flag;
+
+  File = fopen(Filepath, "r");               /* read mode */
+  if (File)
+  {
+    if ((fstat(fileno(File), &FileData) == 0) && (FileData.st_size > 0))
+    {
+      Journal = malloc(FileData.st_size);
+      if (Journal)
+      {
+        if (fread(Journal, FileData.st_size, 1, File) == 1)
+        {
+          JournalSize = FileData.st_size;
+          Flag = True;
+        }
+      }
+      else
+      {
+        Log(L_ERR, "Couldn't allocate memory!");
+      }
+    }
+    else if (FileData.st_size == 0)          /* empty journal */
+    {
+      Flag = True;
+    }
+
+    fclose(File);
+
+    if (!Flag) Log(L_WARN, "Read error for journal (%s)!", Filepath);
+  }
+  else
+  {
+    Log(L_WARN, "Couldn't open journal (%s)!", Filepath);
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  get next entry of record
+ *  - checks bounds and string
+ *
+ *  returns:
+ *  - pointer to string on success
+ *  - NULL on error
+ */
+
+char *GetJournalEntry(char **Pos, char *End, JournalEntry_Type *Entry)
+{
+  char              *String = NULL;          /* return value */
+
+  if (*Pos + sizeof(JournalEntry_Type) > End) return String;
+
+  memcpy(Entry, *Pos, sizeof(JournalEntry_Type));
+  *Pos += sizeof(JournalEntry_Type);
+
+  if ((Entry->Length > 0) && (*Pos + Entry->Length <= End) &&
+      ((*Pos)[Entry->Length - 1] == 0))
+  {
+    String = *Pos;
+    *Pos += Entry->Length;
+  }
+
+  return String;
+}
+
+
+
+/*
+ *  process single record of journal
+ *  - checks all entries without updating the statistics, so a damaged
+ *    record isn't counted partly
+ *
+ *  requires:
+ *  - start and end of record data
+ *  - record header
+ *  - update flag (False: check only)
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool ProcessRecord(char *Pos, char *End, JournalHeader_Type *Header,
+  _Bool Update)
+{
+  _Bool             Flag = True;             /* return value */
+  JournalEntry_Type Entry;                   /* record entry */
+  char              *AKA;                    /* requester AKA */
+  char              *Name;                   /* pattern or filename */
+  unsigned int      n = 0;                   /* counter */
+  uint32_t          m;                       /* counter */
+
+  /* requester AKA */
+  AKA = Pos;
+  if ((Header->AKALength == 0) || (Pos + Header->AKALength > End) ||
+      (AKA[Header->AKALength - 1] != 0))
+    return False;
+  Pos += Header->AKALength;
+
+  if (Update)
+  {
+    Sessions++;
+    for (m = 0; m < TIME_PHASES; m++) TotalTime += Header->Phases[m];
+    AddStat(&AKAStats, &AKACount, &AKAMax, AKA, Header->Files, Header->Bytes);
+  }
+
+  /* requests */
+  while (Flag && (n < Header->Requests))
+  {
+    Name = GetJournalEntry(&Pos, End, &Entry);
+
+    if (Name)                        /* request */
+    {
+      if (Update)
+      {
+        Requests++;
+        if (Entry.Status & FREQ_FOUND_FILE) Hits++;
+      }
+
+      /* responses */
+      m = Entry.Count;
+      while (Flag && (m > 0))
+      {
+        Name = GetJournalEntry(&Pos, End, &Entry);
+
+        if (Name == NULL)            /* bad entry */
+        {
+          Flag = False;
+        }
+        else if (Update && (Entry.Status & RESP_OK))     /* file sent */
+        {
+          FilesSent++;
+          BytesSent += Entry.Size;
+          AddStat(&FileStats, &FileCount, &FileMax, Name, 1, Entry.Size);
+        }
+
+        m--;
+      }
+    }
+    else                             /* bad entry */
+    {
+      Flag = False;
+    }
+
+    n++;
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  find next record header
+ *  - scans for magic behind a damaged record
+ *
+ *  returns:
+ *  - pointer to possible record
+ *  - end of journal if no magic is found
+ */
+
+char *FindRecord(char *Pos, char *End)
+{
+  uint32_t          Magic;
+
+  while (Pos + sizeof(Magic) <= End)
+  {
+    memcpy(&Magic, Pos, sizeof(Magic));
+    if (Magic == JOURNAL_MAGIC) return Pos;
+    Pos++;
+  }
+
+  return End;
+}
+
+
+
+/*
+ *  process all records of journal
+ *  - skips damaged records (e.g. torn append) and resumes at the next
+ *    record header
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 if any record is damaged
+ */
+
+_Bool ProcessJournal()
+{
+  _Bool             Flag = True;             /* return value */
+  _Bool             Valid;                   /* record is valid */
+  JournalHeader_Type  Header;                /* record header */
+  char              *Pos;                    /* position in journal */
+  char              *End;                    /* end of journal */
+
+  Pos = Journal;
+  End = Journal + JournalSize;
+
+  while (Pos < End)
+  {
+    Valid = False;
+
+    /* check header and entries */
+    if (Pos + sizeof(JournalHeader_Type) <= End)
+    {
+      memcpy(&Header, Pos, sizeof(JournalHeader_Type));
+
+      if ((Header.Magic == JOURNAL_MAGIC) &&
+          (Header.Version == JOURNAL_VERSION) &&
+          (Header.Size >= sizeof(JournalHeader_Type)) &&
+          (Header.Size <= End - Pos))
+      {
+        Valid = ProcessRecord(Pos + sizeof(JournalHeader_Type),
+          Pos + Header.Size, &Header, False);
+      }
+    }
+
+    if (Valid)                       /* count record */
+    {
+      ProcessRecord(Pos + sizeof(JournalHeader_Type),
+        Pos + Header.Size, &Header, True);
+      Pos += Header.Size;              /* next record */
+    }
+    else                             /* skip damaged record */
+    {
+      Log(L_WARN, "Bad record in journal (%s) at offset %lld!",
+        Env->JournalPath, (long long)(Pos - Journal));
+      BadRecords++;
+      Flag = False;
+      Pos = FindRecord(Pos + 1, End);
+    }
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  print statistics
+ */
+
+void PrintStats()
+{
+  unsigned long     n;                       /* counter */
+  double            Ratio = 0;               /* hit ratio */
+  long long         Time = 0;                /* average time */
+
+  MergeStats(FileStats, &FileCount);
+  MergeStats(AKAStats, &AKACount);
+
+  if (Requests > 0) Ratio = (double)Hits * 100 / Requests;
+  if (Sessions > 0) Time = TotalTime / Sessions;
+
+  Bytes2String(BytesSent, TempBuffer, DEFAULT_BUFFER_SIZE);
+
+  printf("Sessions:        %lu\n", Sessions);
+  printf("Requests:        %lu\n", Requests);
+  printf("Hit ratio:       %.1f%%\n", Ratio);
+  printf("Files sent:      %lu (%s)\n", FilesSent, TempBuffer);
+  printf("Avg. time:       %lld us\n", Time);
+  if (BadRecords > 0)
+    printf("Bad records:     %lu\n", BadRecords);
+
+  printf("\nTop files:\n");
+  for (n = 0; (n < FileCount) && (n < TopEntries); n++)
+  {
+    Bytes2String(FileStats[n].Bytes, TempBuffer, DEFAULT_BUFFER_SIZE);
+    printf("  %6lu  %10s  %s\n",
+      FileStats[n].Count, TempBuffer, FileStats[n].Name);
+  }
+
+  printf("\nTop requesters:\n");
+  for (n = 0; (n < AKACount) && (n < TopEntries); n++)
+  {
+    Bytes2String(AKAStats[n].Bytes, TempBuffer, DEFAULT_BUFFER_SIZE);
+    printf("  %6lu  %6lu  %10s  %s\n",
+      AKAStats[n].Count, AKAStats[n].Files, TempBuffer, AKAStats[n].Name);
+  }
+}
+
+
+
+/* ************************************************************************
+ *   command line
+ * ************************************************************************ */
+
+
+/*
+ *  print usage
+ */
+
+void PrintUsage()
+{
+  printf(NAME" "VERSION" "COPYRIGHT"\n");
+  printf("Usage: "NAME" [options]\n");
+  printf("Options:\n");
+  printf("  -h, -?                 Print this brief help.\n");
+  printf("  -j <journal file>      Use specified journal file.\n");
+  printf("  -n <number>            Number of top entries (default: %d).\n",
+    TOP_ENTRIES);
+}
+
+
+
+/*
+ *  parse command line
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool ParseCommandLine(int argc, char *argv[])
+{
+  _Bool              Flag = True;        /* return value */
+  unsigned int       n = 1;              /* loop counter */
+  unsigned short     Keyword = 0;        /* keyword ID */
+  long               Value;              /* number */
+  static char        *Keywords[5] =
+    {"-h", "-?", "-j", "-n", NULL};
+
+  /* sanity checks */
+  if ((argc == 0) || (argv == NULL)) return False;
+
+
+  /*
+   *  parse command line options
+   */
+
+  while (n < argc)                            /* as long as we got options, check: */
+  {
+    if (Keyword > 2)          /* get value */
+    {
+      switch (Keyword)
+      {
+        case 3:     /* journal file */
+          if (Env->JournalPath)      /* free old value if already set */
+          {
+            free(Env->JournalPath);
+            Env->JournalPath = NULL;
+          }
+          Env->JournalPath = CopyString(argv[n]);
+          break;
+
+        case 4:     /* number of top entries */
+          Value = Str2Long(argv[n]);
+          if (Value > 0) TopEntries = Value;
+          else
+          {
+            Log(L_WARN, "Invalid number \"%s\"!", argv[n]);
+            Flag = False;
+          }
+          break;
+      }
+
+      Keyword = 0;            /* reset */
+    }
+    else                      /* get keyword */
+    {
+      Keyword = GetKeyword(Keywords, argv[n]);
+
+      if (Keyword == 0)       /* unknown keyword */
+      {
+        Flag = False;           /* treat this as problem */
+        Log(L_WARN, "Unknown option \"%s\"!", argv[n]);
+        n = argc;               /* end loop */
+      }
+      else if (Keyword < 3)   /* help */
+      {
+        Env->Run = False;       /* don't proceed */
+        n = argc;               /* end loop */
+        Keyword = 0;
+        PrintUsage();           /* print usage */
+      }
+    }
+
+    n++;             /* next arg */
+  }
+
+
+  /*
+   *  check parser results
+   */
+
+  if (Keyword > 0)            /* missing argument */
+  {
+    Log(L_WARN, "Missing argument!");
+    Flag = False;
+  }
+
+  /* check if we got all required options */
+  if (Flag && Env->Run && (Env->JournalPath == NULL))
+  {
+    Log(L_WARN, "No journal file given!");
+    Flag = False;
+  }
+
+  /* on problems give user a hint */
+  if (Flag == False)
+  {
+    Log(L_WARN, "Please run "NAME" -h!");
+  }
+
+  return Flag;
+}
+
+
+
+/* ************************************************************************
+ *   support functions
+ * ************************************************************************ */
+
+
+/*
+ *  allocate global variables
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool GetAllocations(void)
+{
+  _Bool                 Flag = False;
+
+  /* buffers */
+  LogBuffer = (char *) malloc(DEFAULT_BUFFER_SIZE);
+  TempBuffer = (char *) malloc(DEFAULT_BUFFER_SIZE);
+
+  /* environment */
+  Env = calloc(1, sizeof(Env_Type));
+
+  /* check pointers */
+  if (LogBuffer && TempBuffer && Env)
+  {
+    Flag = True;        /* ok to proceed */
+  }
+
+  /* set default values */
+  if (Flag)
+  {
+    /* environment: program control */
+    Env->Run = True;
+    Env->CfgSwitches = SW_NONE;
+    Env->Log = NULL;
+    Env->JournalPath = NULL;
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  free global variables
+ */
+
+void FreeAllocations()
+{
+  /* structures */
+  if (Env)
+  {
+    if (Env->JournalPath) free(Env->JournalPath);
+    free(Env);
+    Env = NULL;
+  }
+
+  /* journal */
+  if (Journal) free(Journal);
+  if (FileStats) free(FileStats);
+  if (AKAStats) free(AKAStats);
+
+  /* buffers */
+  if (LogBuffer)
+  {
+    free(LogBuffer);
+    LogBuffer = NULL;
+  }
+  if (TempBuffer)
+  {
+    free(TempBuffer);
+    TempBuffer = NULL;
+  }
+}
+
+
+
+/* ************************************************************************
+ *   main process
+ * ************************************************************************ */
+
+
+/*
+ *  main function
+ */
+
+int main(int argc, char *argv[])
+{
+  int                RetVal = EXIT_FAILURE;   /* return value */
+  _Bool              Flag = False;            /* control flag */
+
+  /* sanity checks */
+  if ((argc == 0) || (argv == NULL)) return RetVal;
+
+
+  /*
+   *  basic initialization
+   */
+
+  if (GetAllocations())                 /* allocate global variables */
+  {
+    if (ParseCommandLine(argc, argv))   /* parse cmd line options */
+    {
+      Flag = True;                      /* ok for next part */
+    }
+  }
+
+
+  /*
+   *  process journal
+   */
+
+  if (Flag && Env->Run)
+  {
+    Flag = LoadJournal(Env->JournalPath);
+
+    if (Flag)
+    {
+      /* print what we got even for a broken record */
+      Flag = ProcessJournal();
+      PrintStats();
+    }
+  }
+
+
+  /*
+   *  clean up
+   */
+
+  FreeAllocations();          /* free memory */
+
+  if (Flag) RetVal = EXIT_SUCCESS;     /* on success update return value */
+  return RetVal;
+}
+
+
+
+/* ************************************************************************
+ *   clean-up of local constants
+ * ************************************************************************ */
+
+
+/*
+ *  undo local constants
+ */
+
+#undef MFREQ_JOURNAL_C
+
+
+/* ************************************************************************
+ *   EOF
+ * ************************************************************************ */
@@ -32,6 +32,14 @@
 #include <sys/stat.h>
 #include <errno.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+/* processes */
+#include <sys/wait.h>
+
+/* limits */
+#include <limits.h>
 
 
 /*
@@ -52,6 +60,15 @@
  */
 
 _Bool ReadConfig(char *Filepath);
+_Bool DrainWorkers(unsigned short Max);
+_Bool WriteSinkFrame(FILE *File, unsigned short Format, unsigned short Part);
+
+
+/*
+ *  local variables
+ */
+
+DateCache_Type      DateCache[DATE_CACHE_SIZE];  /* date strings per day */
 
 
 
@@ -288,6 +305,7 @@ _Bool OpenLogfile()
 _Bool OpenFilelist()
 {
   _Bool                  Flag = False;        /* return value */
+  unsigned short         n;                   /* counter */
 
   /* sanity check */
   if (Env->ListFilepath == NULL) return Flag;
@@ -296,6 +314,8 @@ _Bool OpenFilelist()
 
   if (Env->List != NULL)    /* success */
   {
+    setvbuf(Env->List, NULL, _IOFBF, LIST_BUFFER_SIZE);
+
     /*
      *  We try to lock the filelist to ensure that only one
      *  instance of this tool is writing the file.
@@ -313,6 +333,25 @@ _Bool OpenFilelist()
     Log(L_WARN, "Couldn't open filelist (%s)!", Env->ListFilepath);
   }
 
+  /* additional outputs (sinks) */
+  for (n = 0; n < SINKS; n++)
+  {
+    if ((Env->SinkFilepath[n] == NULL) || (Env->List == NULL)) continue;
+
+    Env->Sink[n] = fopen(Env->SinkFilepath[n], "w");
+    if (Env->Sink[n] != NULL)     /* success */
+    {
+      setvbuf(Env->Sink[n], NULL, _IOFBF, LIST_BUFFER_SIZE);
+      WriteSinkFrame(Env->Sink[n], n, FRAME_HEAD);
+      Env->Sinks++;
+    }
+    else                          /* error */
+    {
+      Log(L_WARN, "Couldn't open filelist (%s)!", Env->SinkFilepath[n]);
+      Flag = False;
+    }
+  }
+
   return Flag;
 }
 
@@ -330,10 +369,14 @@ _Bool CloseFilelist()
 {
   _Bool                  Flag = False;        /* return value */
   char                   *Help;
+  unsigned short         n;                   /* counter */
 
   /* sanity check */
   if (Env->List == NULL) return Flag;
 
+  /* write areas of workers */
+  Flag = DrainWorkers(0);
+
   UnlockFile(Env->List);  /* unlock file */
   fclose(Env->List);      /* close file */
   Env->List = NULL;       /* reset pointer */
@@ -346,6 +389,37 @@ _Bool CloseFilelist()
       Log(L_INFO, "Processed %ld files / %s for %s.", Env->Files, TempBuffer, Help);
   }
 
+  if (Env->Checks_files_bbs > 0)
+    Log(L_INFO, "Rewrote %ld of %ld files.bbs.",
+      Env->Writes_files_bbs, Env->Checks_files_bbs);
+
+  if (Env->Sink[SINK_NEW])
+  {
+    Help = GetFilename(Env->SinkFilepath[SINK_NEW]);
+    if (Help) Log(L_INFO, "Listed %ld new files for %s.", Env->NewFiles, Help);
+  }
+
+  /* close sinks */
+  for (n = 0; n < SINKS; n++)
+  {
+    if (Env->Sink[n])
+    {
+      WriteSinkFrame(Env->Sink[n], n, FRAME_TAIL);
+      if (fclose(Env->Sink[n]) != 0)
+      {
+        Log(L_WARN, "Couldn't write filelist (%s)!", Env->SinkFilepath[n]);
+        Flag = False;
+      }
+      Env->Sink[n] = NULL;
+    }
+
+    if (Env->SinkFilepath[n])
+    {
+      free(Env->SinkFilepath[n]);
+      Env->SinkFilepath[n] = NULL;
+    }
+  }
+
   /* clean up */
   if (Env->ListFilepath)             /* free filepath */
   {
@@ -354,8 +428,39 @@ _Bool CloseFilelist()
   }
   Env->Files = 0;                    /* reset counters */
   Env->Bytes = 0;
-  
-  Flag = True;
+  Env->Checks_files_bbs = 0;
+  Env->Writes_files_bbs = 0;
+  Env->Sinks = 0;
+  Env->SinkAreas = 0;
+  Env->NewFiles = 0;
+
+  return Flag;
+}
+
+
+
+/*
+ *  write file index of combined mode
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool CloseIndex()
+{
+  _Bool                  Flag = False;        /* return value */
+
+  /* sanity check */
+  if (Env->IndexFilepath == NULL) return Flag;
+
+  Flag = WriteIndex(Env->IndexFilepath, &Env->IndexFiles);
+
+  /* clean up */
+  free(Env->IndexFilepath);
+  Env->IndexFilepath = NULL;
+  Env->IndexSwitches = SW_NONE;
+  Env->IndexFiles = 0;
 
   return Flag;
 }
@@ -367,207 +472,339 @@ _Bool CloseFilelist()
  * ************************************************************************ */
 
 
+/*
+ *  compile layout of data fields into render plan
+ *  - selects emitter per field type and format
+ *  - skips fields which would never be written
+ *
+ *  requires:
+ *  - pointer to render plan
+ *  - pointer to data fields (linked list)
+ *  - max. line length
+ */
+
+void CompilePlan(RenderPlan_Type *Plan, Field_Type *Field, unsigned short Max)
+{
+  RenderField_Type  *Step;
+  unsigned short    Emitter;
+
+  /* sanity check */
+  if (Plan == NULL) return;
+
+  Plan->Number = 0;
+  Plan->Max = Max;
+  Plan->DescColumn = 0;
+  Plan->DescLimit = 0;
+  Plan->Multi = False;
+
+  while (Field)
+  {
+    Emitter = 0;
+
+    if (Field->Type == FIELD_NAME)
+    {
+      if (Field->Format == FIELD_FORM_DOS) Emitter = RENDER_NAME_DOS;
+      else Emitter = RENDER_NAME;
+    }
+    else if (Field->Type == FIELD_SIZE)
+    {
+      Emitter = RENDER_SIZE;
+    }
+    else if (Field->Type == FIELD_DATE)
+    {
+      if (Field->Format == FIELD_FORM_US) Emitter = RENDER_DATE_US;
+      else if (Field->Format == FIELD_FORM_ISO) Emitter = RENDER_DATE_ISO;
+    }
+    else if (Field->Type == FIELD_COUNTER)
+    {
+      if (Field->Format == FIELD_FORM_SQUARE) Emitter = RENDER_COUNTER;
+    }
+    else if (Field->Type == FIELD_DESC)
+    {
+      Emitter = RENDER_DESC;
+
+      /* last description field rules additional lines */
+      Plan->DescColumn = Field->Pos - 1;
+      Plan->DescLimit = Max - Field->Pos;
+      if (Field->Format & FIELD_FORM_MULTI) Plan->Multi = True;
+      else Plan->Multi = False;
+    }
+
+    if (Emitter && (Plan->Number < MAX_RENDER_FIELDS))
+    {
+      Step = &Plan->Fields[Plan->Number];
+      Step->Emitter = Emitter;
+      Step->Line = Field->Line;
+      Step->Column = Field->Pos - 1;
+      Step->Width = Field->Width;
+      Step->Format = Field->Format;
+      if ((Field->Align == ALIGN_RIGHT) && (Field->Width > 0))
+        Step->Right = True;
+      else
+        Step->Right = False;
+
+      Plan->Number++;
+    }
+
+    Field = Field->Next;         /* next one */
+  }
+}
+
+
+
+/*
+ *  get date string of unix time
+ *  - caches strings per day
+ *
+ *  returns:
+ *  - pointer to string on success
+ *  - NULL on error
+ */
+
+char *GetDateString(time_t Time, unsigned short Emitter)
+{
+  DateCache_Type    *Entry;
+  struct tm         DateTime;
+  struct tm         Check;
+  time_t            Start, End;
+
+  Entry = &DateCache[((uint64_t)Time / 86400) % DATE_CACHE_SIZE];
+
+  if ((Entry->Start >= Entry->End) ||
+      (Time < Entry->Start) || (Time >= Entry->End))
+  {
+    /* convert unix time */
+    if (localtime_r(&Time, &DateTime) == NULL) return NULL;
+
+    if (strftime(Entry->US, sizeof(Entry->US), "%m-%d-%y", &DateTime) == 0)
+      Entry->US[0] = 0;
+    if (strftime(Entry->ISO, sizeof(Entry->ISO), "%Y-%m-%d", &DateTime) == 0)
+      Entry->ISO[0] = 0;
+
+    /* get day's range (DST safe) */
+    DateTime.tm_hour = 0;
+    DateTime.tm_min = 0;
+    DateTime.tm_sec = 0;
+    DateTime.tm_isdst = -1;
+    Start = mktime(&DateTime);
+    DateTime.tm_mday++;
+    DateTime.tm_isdst = -1;
+    End = mktime(&DateTime);
+    DateTime.tm_mday--;           /* mktime normalized it */
+
+    /* make sure the range has the same date */
+    if ((Start != -1) && (End > Start) && (Start <= Time) && (Time < End) &&
+        localtime_r(&Start, &Check) &&
+        (Check.tm_mday == DateTime.tm_mday) &&
+        localtime_r(&End, &Check) && (Check.tm_mday != DateTime.tm_mday))
+    {
+      Entry->Start = Start;
+      Entry->End = End;
+    }
+    else                          /* just this second */
+    {
+      Entry->Start = Time;
+      Entry->End = Time + 1;
+    }
+  }
+
+  if (Emitter == RENDER_DATE_US)
+    return (Entry->US[0] ? Entry->US : NULL);
+  else
+    return (Entry->ISO[0] ? Entry->ISO : NULL);
+}
+
+
+
+/*
+ *  add string to line buffer
+ *  - limited to size of buffer
+ *
+ *  returns:
+ *  - new length of line buffer
+ */
+
+size_t AddLine(char *Line, size_t Used, const char *String, size_t Length)
+{
+  if (Length > (DEFAULT_BUFFER_SIZE - 2) - Used) Length = (DEFAULT_BUFFER_SIZE - 2) - Used;
+  memcpy(&Line[Used], String, Length);
+
+  return Used + Length;
+}
+
+
+
+/*
+ *  add spaces to line buffer
+ *  - limited to size of buffer
+ *
+ *  returns:
+ *  - new length of line buffer
+ */
+
+size_t AddSpaces(char *Line, size_t Used, int Spaces)
+{
+  if (Spaces <= 0) return Used;
+  if (Spaces > (DEFAULT_BUFFER_SIZE - 2) - Used) Spaces = (DEFAULT_BUFFER_SIZE - 2) - Used;
+  memset(&Line[Used], ' ', Spaces);
+
+  return Used + Spaces;
+}
+
+
+
 /*
  *  write single file info to a file
+ *  - renders lines based on compiled render plan
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool WriteInfo(FILE *File, Info_Type *Info, Field_Type **Fields, unsigned short Max)
+_Bool WriteInfo(FILE *File, Info_Type *Info, RenderPlan_Type *Plan)
 {
   _Bool             Flag = False;       /* return value */
-  _Bool             Add;                /* add flag */
   _Bool             Write = True;       /* write flag */
-  Field_Type        *Field;             /* data field */
-  Field_Type        *DescField = NULL;
+  RenderField_Type  *Step;              /* data field */
   Token_Type        *Text;
-  char              *Buffer;            /* virtual buffer */
-  long long         Value;
-  size_t            BufferSize;         /* size usage of buffer */
-  size_t            LineSize;           /* length of current line */
+  char              *Data;              /* field data */
+  char              *Line;              /* line buffer */
+  size_t            Used = 0;           /* size usage of buffer */
+  size_t            LineStart = 0;      /* start of current line */
   size_t            Length;             /* string length */
-  int               Diff;
   int               Spaces;             /* number of spaces */
-  struct tm         *DateTime;
   unsigned short    Counter = 1;        /* line number */
+  unsigned short    n;                  /* counter */
+  long long         Value;
+  int               Digits;
 
   /* sanity checks */
-  if ((File == NULL) || (Info == NULL) ||
-      (Fields == NULL)) return Flag;
+  if ((File == NULL) || (Info == NULL) || (Plan == NULL)) return Flag;
 
   Flag = True;           /* success by default :-) */
+  Line = OutBuffer;
 
 
   /*
    *  first line with file name
    */
 
-  Buffer = OutBuffer;
-  Buffer[0] = 0;
-  BufferSize = 0;
-  LineSize = 0;
-
-  Field = *Fields;
-  while (Field)                /* follow fields */
+  for (n = 0; n < Plan->Number; n++)
   {
-    Add = False;           /* reset flag */
-    InBuffer[0] = 0;       /* reset buffer */
+    Step = &Plan->Fields[n];
+    Data = InBuffer;
+    Length = 0;
 
     /*
      *  create field data string
      */
 
-    if (Field->Type == FIELD_NAME)          /* name */
+    switch (Step->Emitter)
     {
-      if (Info->Name)
-      {
-        snprintf(InBuffer, Field->Width + 1, "%s", Info->Name);
+      case RENDER_NAME:
+      case RENDER_NAME_DOS:
+        if (Info->Name == NULL) continue;
+        Data = Info->Name;
+        Length = strlen(Data);
 
-        Length = strlen(Info->Name);
-        if (Length > Field->Width)        /* width overflow */
+        if (Length > Step->Width)         /* width overflow */
         {
           /* truncate name with asterisk */
-          InBuffer[Field->Width - 1] = '*';
+          Length = Step->Width;
+          if (Length > 0)
+          {
+            memcpy(InBuffer, Info->Name, Length - 1);
+            InBuffer[Length - 1] = '*';
+            Data = InBuffer;
+          }
         }
-        else if (Field->Format == FIELD_FORM_DOS)
+        else if (Step->Emitter == RENDER_NAME_DOS)
         {
           /* check name syntax */
           Write = CheckDosFilename(Info->Name);
         }
-        
-        Add = True;      
-      }
-    }
-    else if (Field->Type == FIELD_SIZE)     /* size */
-    {
-      Add = Bytes2StringN(Info->Size, Field->Width, Field->Format,
-        InBuffer, DEFAULT_BUFFER_SIZE - 1);
-    }
-    else if (Field->Type == FIELD_DATE)     /* date */
-    {
-      DateTime = localtime(&(Info->Time));     /* convert unix time */
+        break;
 
-      if (DateTime == NULL)
-      {
-        /* nothing */
-      }      
-      else if (Field->Format == FIELD_FORM_US)    /* MM-DD-YY */
-      {
-        Length = strftime(InBuffer, 9, "%m-%d-%y", DateTime);
-        if (Length > 0) Add = True;
-      }
-      else if (Field->Format == FIELD_FORM_ISO)   /* YYYY-MM-DD */
-      {
-        Length = strftime(InBuffer, 11, "%Y-%m-%d", DateTime);
-        if (Length > 0) Add = True;
-      }
-    }
-    else if (Field->Type == FIELD_COUNTER)  /* counter */
-    {
-      /* limit digits to width */
-      Value = LimitNumber(Info->Counter, Field->Width - 2);
+      case RENDER_SIZE:
+        if (!Bytes2StringN(Info->Size, Step->Width, Step->Format,
+             InBuffer, DEFAULT_BUFFER_SIZE - 1)) continue;
+        Length = strlen(InBuffer);
+        break;
 
-      /* convert to string */
-      if (Field->Format == FIELD_FORM_SQUARE)
-      {
-        snprintf(InBuffer, DEFAULT_BUFFER_SIZE - 1,
-          "[%*lld]", Field->Width - 2, Value);
-        Add = True;
-      }
-    }
-    else if (Field->Type == FIELD_DESC)     /* description */
-    {
-      DescField = Field;    /* save pointer */
+      case RENDER_DATE_US:
+      case RENDER_DATE_ISO:
+        Data = GetDateString(Info->Time, Step->Emitter);
+        if (Data == NULL) continue;
+        Length = strlen(Data);
+        break;
 
-      Text = Info->Infos;
-      if (Text && (Text->String))      /* got description */
-      {
-        snprintf(InBuffer, DEFAULT_BUFFER_SIZE - 1, "%s", Text->String);
-        Add = True;
+      case RENDER_COUNTER:
+        /* limit digits to width and convert to string */
+        Digits = Step->Width - 2;
+        Value = LimitNumber(Info->Counter, Digits);
+        snprintf(InBuffer, DEFAULT_BUFFER_SIZE - 1,
+          "[%*lld]", Digits, Value);
+        Length = strlen(InBuffer);
+        break;
 
-        /* width overflow */
-        Length = strlen(Text->String);
-        Diff = Max - Field->Pos;
-        if (Length > Diff)
+      case RENDER_DESC:
+        Text = Info->Infos;
+        if (Text && (Text->String))      /* got description */
         {
-          if ((Diff > 1) && (Diff < DEFAULT_BUFFER_SIZE - 1))    /* sanity check */
+          Data = Text->String;
+          Length = strlen(Data);
+
+          /* width overflow */
+          if ((Plan->DescLimit > 1) && (Length > Plan->DescLimit) &&
+              (Plan->DescLimit < DEFAULT_BUFFER_SIZE - 1))
           {
-            InBuffer[Diff] = 0;
-            InBuffer[Diff - 1] = '~'; 
+            Length = Plan->DescLimit;
+            memcpy(InBuffer, Data, Length - 1);
+            InBuffer[Length - 1] = '~';
+            Data = InBuffer;
           }
         }
-      }
-      else                             /* no description */
-      {
-        strcpy(InBuffer, "n/a");
-        Add = True;
-      }
+        else                             /* no description */
+        {
+          Data = "n/a";
+          Length = 3;
+        }
+        break;
+
+      default:
+        continue;
     }
 
+
     /*
      *  add field data string to buffer
      */
 
-    if (Add)
+    /* line management */
+    while (Step->Line > Counter)     /* add lines until we match */
     {
-      /* line management */
-      while (Field->Line > Counter)     /* add lines until we match */
-      {
-        /* add linefeed */
-        snprintf(Buffer, DEFAULT_BUFFER_SIZE - 1 - BufferSize, "\n");
-        Length = strlen(Buffer);
-        BufferSize += Length;
-        Buffer = &(OutBuffer[BufferSize]);
-        LineSize = 0;
-        Counter++;
-      }
-
-      Spaces = 0;
-      Length = strlen(InBuffer);
-
-      /* take care about start position */
-      Diff = Field->Pos - 1 - LineSize; 
-      if (Diff > 0)
-      {
-        Spaces += Diff;
-      }
-      /* else if (Diff < 0) shouldn't happen */
-
-      /* take care about right alignment */
-      if ((Field->Align == ALIGN_RIGHT) && (Field->Width > 0))
-      {
-        Diff = Field->Width - Length;
-        if (Diff > 0)
-        {
-          Spaces += Diff;
-        }
-        /* else if (Diff < 0) shouldn't happen */
-      }
-
-      /* fill up with spaces */
-      if (Spaces > 0)
-      {
-        FillString(Buffer, ' ', Spaces, DEFAULT_BUFFER_SIZE - 1 - BufferSize);
-        Length = strlen(Buffer);
-        LineSize += Length;
-        BufferSize += Length;
-        Buffer = &(OutBuffer[BufferSize]);
-      }
-
-      /* add data string */
-      snprintf(Buffer, DEFAULT_BUFFER_SIZE - 1 - BufferSize, "%s", InBuffer);
-      Length = strlen(Buffer);
-      LineSize += Length;
-      BufferSize += Length;
-      Buffer = &(OutBuffer[BufferSize]);
+      Used = AddLine(Line, Used, "\n", 1);
+      LineStart = Used;
+      Counter++;
     }
 
-    Field = Field->Next;         /* next one */
+    /* take care about start position and right alignment */
+    Spaces = 0;
+    if (Step->Column > (int)(Used - LineStart))
+      Spaces += Step->Column - (int)(Used - LineStart);
+    if (Step->Right && (Step->Width > Length))
+      Spaces += Step->Width - Length;
+
+    Used = AddSpaces(Line, Used, Spaces);
+    Used = AddLine(Line, Used, Data, Length);
   }
 
-  if (Write) fprintf(File, "%s\n", OutBuffer);
+  if (Write)
+  {
+    Line[Used] = '\n';
+    if (fwrite(Line, 1, Used + 1, File) != Used + 1) Flag = False;
+  }
 
 
   /*
@@ -575,45 +812,36 @@ _Bool WriteInfo(FILE *File, Info_Type *Info, Field_Type **Fields, unsigned short
    */
 
   /* check for multiline mode */
-  if (Write && DescField && (DescField->Format & FIELD_FORM_MULTI))
+  if (Write && Plan->Multi)
   {
     /* skip first line since it's already written */
     Text = Info->Infos;
     if (Text) Text = Text->Next;
- 
+
     while (Text)              /* loop through remaining lines */
     {
-      /* reset variables */
-      Buffer = OutBuffer;
-      Buffer[0] = 0;
-      LineSize = 0;
-
       if (Text->String)       /* sanity check */
       {
         /* take care about start position */
-        Spaces = DescField->Pos - 1;
-        FillString(Buffer, ' ', Spaces, DEFAULT_BUFFER_SIZE - 1);
-        LineSize += strlen(Buffer);
-        Buffer = &(OutBuffer[LineSize]);
+        Used = AddSpaces(Line, 0, Plan->DescColumn);
+        LineStart = Used;
 
         /* add description */
-        snprintf(Buffer, DEFAULT_BUFFER_SIZE - 1 - LineSize, "%s", Text->String);
+        Used = AddLine(Line, Used, Text->String, strlen(Text->String));
 
         /* prevent width overflow */
-        Length = strlen(Buffer);
-        Diff = Max - DescField->Pos;
-        if (Length > Diff)              /* too long */
+        Length = Used - LineStart;
+        if ((Plan->DescLimit > 1) && (Length > Plan->DescLimit) &&
+            (Plan->DescLimit < DEFAULT_BUFFER_SIZE - 1))
         {
-          if ((Diff > 1) && (Diff < DEFAULT_BUFFER_SIZE - 1))    /* sanity check */
-          {
-            /* truncate line */
-            Buffer[Diff] = 0;
-            Buffer[Diff - 1] = '~'; 
-          }
+          /* truncate line */
+          Used = LineStart + Plan->DescLimit;
+          Line[Used - 1] = '~';
         }
 
         /* write line */
-        fprintf(File, "%s\n", OutBuffer);
+        Line[Used] = '\n';
+        if (fwrite(Line, 1, Used + 1, File) != Used + 1) Flag = False;
       }
 
       Text = Text->Next;             /* next one */
@@ -626,73 +854,530 @@ _Bool WriteInfo(FILE *File, Info_Type *Info, Field_Type **Fields, unsigned short
 
 
 /* ************************************************************************
- *   files.bbs
+ *   filelist sinks
  * ************************************************************************ */
 
 
 /*
- *  parse files.bbs
- *
- *  requires:
- *  - pointer to input buffer
- *  - line number
- *  - address of pointer of current fileinfo element 
- *
- *  returns:
- *  - 1 on success
- *  - 0 on error
+ *  write string to sink with escaping based on format
+ *  - characters beyond ASCII are taken as ISO-8859-1
  */
 
-_Bool Parse_files_bbs(char *Buffer, unsigned int Line, Info_Type **CurrentInfo)
+void WriteSinkString(FILE *File, unsigned short Format, char *String)
 {
-  _Bool             Flag = False;       /* return value */
-  _Bool             Skip = False;       /* skip flag */
-  _Bool             More;               /* more fields flag */
-  unsigned short    Pos;                /* position in string */
-  unsigned short    NewPos;             /* new position in string */
-  unsigned short    Width;              /* sub-string width */
-  unsigned short    Length;             /* sub-string width */
-  long long         Value;              /* twice as long as off_t */
-  char              *Str;               /* support string pointer */
-  char              *Data;              /* data sub-string */
-  char              *NewData;           /* new data sub-string */
-  Info_Type         *Info;              /* fileinfo element */
-  Field_Type        *Field;             /* data field element */
-  time_t            UnixTime;
-  struct tm         DateTime;
+  unsigned char     Char;
 
-  /* sanity checks */
-  if ((Buffer == NULL) || (CurrentInfo == NULL) ||
-      (Env->Fields_files_bbs == NULL)) return Flag; 
-
-  Flag = True;
-  Data = Buffer;
-  Field = Env->Fields_files_bbs;
-  Pos = 1;
+  /* sanity check */
+  if (String == NULL) String = "";
 
-  /*
-   *  additional description line
-   */
+  if (Format != SINK_HTML) putc('"', File);
 
-  if (Data[0] == ' ')         /* line starts with space */
+  while (String[0] != 0)
   {
-    if (*CurrentInfo != NULL)     /* if ok */
+    Char = (unsigned char)String[0];
+
+    if (Format == SINK_CSV)
     {
-      /* skip spaces */
-      while (Data[0] == ' ')
+      if (Char == '"') putc('"', File);     /* double quotes */
+      putc(Char, File);
+    }
+    else if (Format == SINK_JSON)
+    {
+      if ((Char == '"') || (Char == '\\'))
       {
-        Pos++;
-        Data++;
+        putc('\\', File);
+        putc(Char, File);
       }
+      else if ((Char < 0x20) || (Char >= 0x7f))
+        fprintf(File, "\\u%04x", Char);
+      else
+        putc(Char, File);
+    }
+    else                                    /* HTML */
+    {
+      if (Char == '&') fputs("&amp;", File);
+      else if (Char == '<') fputs("&lt;", File);
+      else if (Char == '>') fputs("&gt;", File);
+      else if (Char == '"') fputs("&quot;", File);
+      else if (Char >= 0x7f) fprintf(File, "&#%u;", Char);
+      else putc(Char, File);
+    }
 
-      /* check for string end */
-      if (Data[0] == 0)
-      {
-        Flag = False;
-      }
+    String++;
+  }
 
-      /* check position if strict checking is enabled */
-      else if (Env->InfoMode & INFO_STRICT)
+  if (Format != SINK_HTML) putc('"', File);
+}
+
+
+
+/*
+ *  write frame part of sink
+ *  - head, separator between areas and tail
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool WriteSinkFrame(FILE *File, unsigned short Format, unsigned short Part)
+{
+  _Bool             Flag = False;       /* return value */
+  char              *Text = "";
+
+  /* sanity check */
+  if (File == NULL) return Flag;
+
+  switch (Format)
+  {
+    case SINK_CSV:
+      if (Part == FRAME_HEAD)
+        Text = "\"Area\",\"Name\",\"Size\",\"Date\",\"Counter\",\"Description\"\n";
+      break;
+
+    case SINK_JSON:
+      if (Part == FRAME_HEAD) Text = "{\n \"areas\": [\n";
+      else if (Part == FRAME_SEPARATOR) Text = ",\n";
+      else Text = "\n ]\n}\n";
+      break;
+
+    case SINK_HTML:
+      if (Part == FRAME_HEAD)
+        Text = "<!DOCTYPE html>\n<html>\n<head>\n"
+               "<meta charset=\"us-ascii\">\n<title>Filelist</title>\n"
+               "</head>\n<body>\n";
+      else if (Part == FRAME_TAIL) Text = "</body>\n</html>\n";
+      break;
+  }
+
+  if (fputs(Text, File) >= 0) Flag = True;
+
+  return Flag;
+}
+
+
+
+/*
+ *  write filearea to sink
+ *  - lists all files of info list which are ok to list
+ *
+ *  requires:
+ *  - sink
+ *  - format ID
+ *  - area name
+ *  - area description (NULL for none)
+ *  - info list
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool WriteSinkArea(FILE *File, unsigned short Format, char *Name,
+  char *Desc, Info_Type *Info)
+{
+  _Bool             Flag = False;       /* return value */
+  _Bool             First = True;       /* first file */
+  Token_Type        *Text;
+  char              *Date;
+  size_t            Used;               /* size usage of buffer */
+
+  /* sanity checks */
+  if ((File == NULL) || (Name == NULL)) return Flag;
+
+
+  /*
+   *  area head
+   */
+
+  if (Format == SINK_JSON)
+  {
+    fputs("  {\"name\": ", File);
+    WriteSinkString(File, Format, Name);
+    fputs(", \"info\": ", File);
+    WriteSinkString(File, Format, Desc);
+    fputs(", \"files\": [", File);
+  }
+  else if (Format == SINK_HTML)
+  {
+    fputs("<h2>", File);
+    WriteSinkString(File, Format, Name);
+    fputs("</h2>\n", File);
+    if (Desc)
+    {
+      fputs("<p>", File);
+      WriteSinkString(File, Format, Desc);
+      fputs("</p>\n", File);
+    }
+    fputs("<table>\n<tr><th>Name</th><th>Size</th><th>Date</th>"
+      "<th>Counter</th><th>Description</th></tr>\n", File);
+  }
+
+
+  /*
+   *  files
+   */
+
+  while (Info)                    /* follow list */
+  {
+    if (Info->Status & FINFO_OK)  /* if ok to list */
+    {
+      Date = GetDateString(Info->Time, RENDER_DATE_ISO);
+      if (Date == NULL) Date = "";
+      Text = Info->Infos;
+
+      if (Format == SINK_CSV)
+      {
+        WriteSinkString(File, Format, Name);
+        putc(',', File);
+        WriteSinkString(File, Format, Info->Name);
+        fprintf(File, ",%lld,%s,%u,", (long long)Info->Size, Date,
+          Info->Counter);
+
+        /* description lines joined by spaces */
+        Used = 0;
+        while (Text)
+        {
+          if (Text->String)
+          {
+            if (Text != Info->Infos) Used = AddLine(InBuffer, Used, " ", 1);
+            Used = AddLine(InBuffer, Used, Text->String, strlen(Text->String));
+          }
+          Text = Text->Next;
+        }
+        InBuffer[Used] = 0;
+
+        WriteSinkString(File, Format, InBuffer);
+        putc('\n', File);
+      }
+      else if (Format == SINK_JSON)
+      {
+        if (!First) putc(',', File);
+        fputs("\n   {\"name\": ", File);
+        WriteSinkString(File, Format, Info->Name);
+        fprintf(File, ", \"size\": %lld, \"date\": \"%s\", \"counter\": %u, "
+          "\"description\": [", (long long)Info->Size, Date, Info->Counter);
+
+        while (Text)
+        {
+          if (Text->String)
+          {
+            if (Text != Info->Infos) fputs(", ", File);
+            WriteSinkString(File, Format, Text->String);
+          }
+          Text = Text->Next;
+        }
+
+        fputs("]}", File);
+      }
+      else                        /* HTML */
+      {
+        fputs("<tr><td>", File);
+        WriteSinkString(File, Format, Info->Name);
+        fprintf(File, "</td><td>%lld</td><td>%s</td><td>%u</td><td>",
+          (long long)Info->Size, Date, Info->Counter);
+
+        while (Text)
+        {
+          if (Text->String)
+          {
+            if (Text != Info->Infos) fputs("<br>", File);
+            WriteSinkString(File, Format, Text->String);
+          }
+          Text = Text->Next;
+        }
+
+        fputs("</td></tr>\n", File);
+      }
+
+      First = False;
+    }
+
+    Info = Info->Next;             /* next one */
+  }
+
+
+  /*
+   *  area tail
+   */
+
+  if (Format == SINK_JSON) fputs(First ? "]}" : "\n  ]}", File);
+  else if (Format == SINK_HTML) fputs("</table>\n", File);
+
+  if (ferror(File) == 0) Flag = True;
+
+  return Flag;
+}
+
+
+
+/*
+ *  write new files of filearea to list of new files
+ *  - files modified since cutoff time, same layout as filelist
+ *  - area is skipped when there are no new files
+ *
+ *  requires:
+ *  - list of new files
+ *  - area name
+ *  - area description (NULL for none)
+ *  - info list
+ *  - render plan of filelist
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool WriteNewFiles(FILE *File, char *Name, char *Desc, Info_Type *Info,
+  RenderPlan_Type *Plan)
+{
+  _Bool             Flag = False;       /* return value */
+  _Bool             First = True;       /* first new file */
+
+  /* sanity checks */
+  if ((File == NULL) || (Name == NULL) || (Plan == NULL)) return Flag;
+
+  Flag = True;
+
+  while (Info)                    /* follow list */
+  {
+    if ((Info->Status & FINFO_OK) && (Info->Time >= Env->NewFilesTime))
+    {
+      if (First)                  /* area head */
+      {
+        FillString(TempBuffer, '-', Plan->Max, DEFAULT_BUFFER_SIZE - 1);
+        fprintf(File, "\n%s\n%s\n", TempBuffer, Name);
+        if (Desc) fprintf(File, "%s\n", Desc);
+        fprintf(File, "%s\n", TempBuffer);
+        First = False;
+      }
+
+      if (!WriteInfo(File, Info, Plan)) Flag = False;
+      Env->NewFiles++;
+    }
+
+    Info = Info->Next;             /* next one */
+  }
+
+  return Flag;
+}
+
+
+
+/* ************************************************************************
+ *   file description files
+ * ************************************************************************ */
+
+
+/*
+ *  read file description file
+ *  - tries lower case name first and upper case name second
+ *  - maps file read-only and copies line-wise to InBuffer for parsing
+ *  - calls parser for each non-empty line
+ *
+ *  requires:
+ *  - path of file area
+ *  - lower case and upper case filename
+ *  - line parser (buffer, line number, parser state)
+ *  - parser state
+ *  - flag for warning about missing file
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool ReadInfoFile(char *Path, char *Name, char *AltName,
+  _Bool (*Parse)(char *Buffer, unsigned int Line, void *State),
+  void *State, _Bool Warn)
+{
+  _Bool             Flag = False;       /* return value */
+  _Bool             Run = True;         /* control flag */
+  unsigned short    Check;
+  int               File = -1;          /* file descriptor */
+  struct stat       FileData;
+  char              *Map = NULL;        /* mapped file */
+  char              *Pos;               /* start of line */
+  char              *End;               /* end of file */
+  char              *Next;              /* end of line */
+  size_t            Length;
+  unsigned int      Line = 0;           /* line number */
+
+  /* sanity check */
+  if ((Path == NULL) || (Name == NULL) || (AltName == NULL) ||
+      (Parse == NULL)) return Flag;
+
+  Flag = True;
+
+  /* try to open lower or upper case file */
+  Check = 2;
+  while (Check > 0)
+  {
+    if (Check == 2) snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1, "%s", Name);
+    else if (Check == 1) snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1, "%s", AltName);
+
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1, "%s/%s", Path, TempBuffer2);
+    File = open(TempBuffer, O_RDONLY);     /* read mode */
+    if (File < 0) Check--;
+    else Check = 0;
+  }
+
+  if (File >= 0)   /* file opened */
+  {
+    Log(L_INFO, "Reading: %s", TempBuffer2);
+
+    /* map whole file (empty file has no lines) */
+    if (fstat(File, &FileData) != 0)
+    {
+      Run = False;
+    }
+    else if (FileData.st_size > 0)
+    {
+      Map = mmap(NULL, FileData.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+      if (Map == MAP_FAILED)
+      {
+        Map = NULL;
+        Run = False;
+      }
+      else
+      {
+        madvise(Map, FileData.st_size, MADV_SEQUENTIAL);
+      }
+    }
+
+    close(File);             /* mapping stays valid */
+
+    if (!Run)
+    {
+      Flag = False;            /* signal problem */
+      Log(L_WARN, "Read error for %s!", TempBuffer2);
+    }
+
+    Pos = Map;
+    End = Map + FileData.st_size;
+
+    while (Run && (Pos < End))
+    {
+      /* get line */
+      Next = memchr(Pos, 10, End - Pos);
+      if (Next == NULL) Next = End;         /* last line without LF */
+      Length = Next - Pos;
+
+      /* remove CR at end of line */
+      if ((Length > 0) && (Pos[Length - 1] == 13)) Length--;
+
+      if (Length > DEFAULT_BUFFER_SIZE - 2)   /* maximum size exceeded */
+      {
+        Run = False;                         /* end loop */
+        Log(L_WARN, "Input overflow for %s!", TempBuffer2);
+      }
+      else
+      {
+        Line++;           /* got another line */
+
+        /* if it's not an empty line */
+        if ((Length > 0) && (Pos[0] != 0))
+        {
+          /* copy line since parsing modifies it */
+          memcpy(InBuffer, Pos, Length);
+          InBuffer[Length] = 0;
+
+          /* parse line */
+          Flag = Parse(InBuffer, Line, State);
+
+          /* if we care about for syntax errors */
+          if (!(Env->InfoMode & INFO_RELAX))
+          {
+            /* end processing on error */
+            if (!Flag) Run = False;        /* end loop */ 
+          }
+        }
+      }
+
+      Pos = Next + 1;        /* next line */
+    }
+
+    if (Map) munmap(Map, FileData.st_size);
+  }
+  else if (Warn)   /* file error */
+  {
+    Log(L_WARN, "Couldn't open neither %s nor %s!", Name, AltName);
+  }
+
+  return Flag;
+}
+
+
+
+/* ************************************************************************
+ *   files.bbs
+ * ************************************************************************ */
+
+
+/*
+ *  parse files.bbs
+ *
+ *  requires:
+ *  - pointer to input buffer
+ *  - line number
+ *  - address of pointer of current fileinfo element 
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool Parse_files_bbs(char *Buffer, unsigned int Line, void *State)
+{
+  Info_Type         **CurrentInfo = State;  /* current fileinfo element */
+  _Bool             Flag = False;       /* return value */
+  _Bool             Skip = False;       /* skip flag */
+  _Bool             More;               /* more fields flag */
+  unsigned short    Pos;                /* position in string */
+  unsigned short    NewPos;             /* new position in string */
+  unsigned short    Width;              /* sub-string width */
+  unsigned short    Length;             /* sub-string width */
+  long long         Value;              /* twice as long as off_t */
+  char              *Str;               /* support string pointer */
+  char              *Data;              /* data sub-string */
+  char              *NewData;           /* new data sub-string */
+  Info_Type         *Info;              /* fileinfo element */
+  Field_Type        *Field;             /* data field element */
+  time_t            UnixTime;
+  struct tm         DateTime;
+
+  /* sanity checks */
+  if ((Buffer == NULL) || (CurrentInfo == NULL) ||
+      (Env->Fields_files_bbs == NULL)) return Flag; 
+
+  Flag = True;
+  Data = Buffer;
+  Field = Env->Fields_files_bbs;
+  Pos = 1;
+
+  /*
+   *  additional description line
+   */
+
+  if (Data[0] == ' ')         /* line starts with space */
+  {
+    if (*CurrentInfo != NULL)     /* if ok */
+    {
+      /* skip spaces */
+      while (Data[0] == ' ')
+      {
+        Pos++;
+        Data++;
+      }
+
+      /* check for string end */
+      if (Data[0] == 0)
+      {
+        Flag = False;
+      }
+
+      /* check position if strict checking is enabled */
+      else if (Env->InfoMode & INFO_STRICT)
       {
         /* get description data field */
         while (Field && (Field->Type != FIELD_DESC))
@@ -1048,20 +1733,45 @@ _Bool Parse_files_bbs(char *Buffer, unsigned int Line, Info_Type **CurrentInfo)
  */
 
 _Bool Read_files_bbs(char *Path)
+{
+  Info_Type         *Info = NULL;       /* current fileinfo element */
+
+  return ReadInfoFile(Path, "files.bbs", "FILES.BBS", Parse_files_bbs,
+    &Info, True);
+}
+
+
+
+/*
+ *  write files.bbs
+ *  - renders files.bbs to memory and compares it with the existing file
+ *  - replaces changed file atomically via temporary file
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool Write_files_bbs(char *Path)
 {
   _Bool             Flag = False;       /* return value */
   _Bool             Run = True;         /* control flag */
+  _Bool             Changed = True;     /* content changed */
+  int               File = -1;          /* file descriptor */
+  FILE              *Output = NULL;     /* memory stream */
+  char              *Block = NULL;      /* rendered files.bbs */
+  size_t            Size = 0;           /* size of rendered files.bbs */
+  char              *Map;               /* mapped files.bbs */
+  char              *Target = NULL;     /* files.bbs (link resolved) */
+  char              *Help = NULL;
   unsigned short    Check;
-  FILE              *File;              /* files.bbs stream */
-  size_t            Length;
-  Info_Type         *Info = NULL;       /* fileinfo element */
-  unsigned int      Line = 0;           /* line number */
+  struct stat       FileData;
+  Info_Type         *Info;
+  RenderPlan_Type   Plan;               /* render plan */
 
   /* sanity check */
   if (Path == NULL) return Flag;
 
-  Flag = True;
-
   /* try to open files.bbs or FILES.BBS */
   Check = 2;
   while (Check > 0)
@@ -1070,166 +1780,304 @@ _Bool Read_files_bbs(char *Path)
     else if (Check == 1) snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1, "FILES.BBS");
 
     snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1, "%s/%s", Path, TempBuffer2);
-    File = fopen(TempBuffer, "r");         /* read mode */    
-    if (File == NULL) Check--;
+    File = open(TempBuffer, O_RDONLY);     /* read mode */
+    if (File < 0) Check--;
     else Check = 0;
   }
 
-  if (File)        /* file opened */
+  if ((File < 0) || (fstat(File, &FileData) != 0))
+  {
+    Run = False;
+    Log(L_WARN, "Couldn't open neither files.bbs nor FILES.BBS!");
+  }
+
+
+  /*
+   *  render files.bbs
+   */
+
+  if (Run)
+  {
+    Output = open_memstream(&Block, &Size);
+    if (Output == NULL) Run = False;
+  }
+
+  if (Run)
+  {
+    /* compile layout */
+    CompilePlan(&Plan, Env->Fields_files_bbs, 78);
+
+    /* follow info list */
+    Info = Env->InfoList;
+    while (Run && Info)
+    {
+      if (Info->Status & FINFO_OK)   /* ok to list  */
+      {
+        Run = WriteInfo(Output, Info, &Plan);
+      }
+
+      Info = Info->Next;             /* next one */
+    }
+
+    if (fclose(Output) != 0) Run = False;
+    if (Block == NULL) Run = False;
+  }
+
+
+  /*
+   *  compare with existing file
+   */
+
+  if (Run && (FileData.st_size == Size))
+  {
+    if (Size == 0)                     /* both empty */
+    {
+      Changed = False;
+    }
+    else
+    {
+      Map = mmap(NULL, Size, PROT_READ, MAP_PRIVATE, File, 0);
+      if (Map != MAP_FAILED)
+      {
+        if (memcmp(Map, Block, Size) == 0) Changed = False;
+        munmap(Map, Size);
+      }
+    }
+  }
+
+  if (File >= 0) close(File);
+
+  if (Run) Env->Checks_files_bbs++;
+
+
+  /*
+   *  replace file
+   */
+
+  if (Run && Changed)
+  {
+    Log(L_WARN, "Writing: %s", TempBuffer2);
+
+    /* replace target of symbolic link, not the link itself */
+    Target = realpath(TempBuffer, NULL);
+    if (Target) Help = strrchr(Target, '/');
+
+    /* hidden temporary file in same directory (skipped by scans) */
+    if (Help)
+    {
+      snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1, "%.*s/.%s."SUFFIX_TEMP".%d",
+        (int)(Help - Target), Target, Help + 1, getpid());
+      File = open(TempBuffer2, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    }
+    else File = -1;
+
+    if (File >= 0)
+    {
+      /* keep owner (requires root) and permissions of old file */
+      if (fchown(File, FileData.st_uid, FileData.st_gid) != 0)
+      {
+        /* not fatal, file keeps our owner */
+      }
+      fchmod(File, FileData.st_mode & 07777);
+
+      if (write(File, Block, Size) != (ssize_t)Size) Run = False;
+      if (fsync(File) != 0) Run = False;   /* data on disk before rename */
+      if (close(File) != 0) Run = False;
+
+      if (Run && (rename(TempBuffer2, Target) != 0)) Run = False;
+      if (!Run) unlink(TempBuffer2);
+    }
+    else
+    {
+      Run = False;
+    }
+
+    if (Run) Env->Writes_files_bbs++;
+    else Log(L_WARN, "Couldn't write %s!", TempBuffer);
+  }
+
+  /* clean up */
+  if (Block) free(Block);
+  if (Target) free(Target);
+
+  return Flag = Run;
+}
+
+
+
+/* ************************************************************************
+ *   download counters
+ * ************************************************************************ */
+
+
+/*
+ *  merge downloads from counter store into info list
+ *  - adds downloads to counter read from files.bbs
+ */
+
+void MergeCounters(char *Path)
+{
+  Info_Type         *Info;
+  unsigned long     Value;              /* downloads */
+
+  /* sanity checks */
+  if ((Path == NULL) || (Env->CounterStore == NULL)) return;
+
+  Info = Env->InfoList;
+  while (Info)
   {
-    Log(L_INFO, "Reading: %s", TempBuffer2);
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1, "%s/%s", Path, Info->Name);
+    Value = GetCounter(Env->CounterStore, TempBuffer);
 
-    while(Run)
+    if (Value > 0)
     {
-      /* read line-wise */
-      if (fgets(InBuffer, DEFAULT_BUFFER_SIZE, File) != NULL)
-      {
-        Length = strlen(InBuffer);
+      /* limit to counter's range */
+      if (Value > USHRT_MAX - Info->Counter)
+        Value = USHRT_MAX - Info->Counter;
 
-        if (Length == 0)                  /* sanity check */
-        {
-          Run = False;                         /* end loop */
-        }
-        else if (Length == (DEFAULT_BUFFER_SIZE - 1))         /* maximum size reached */
-        {
-          /* now check if line matches buffer size exacly or exceeds it */
-          /* exact matches should have a LF as last character in front of the trailing 0 */
-          if (TempBuffer[Length - 1] != 10)             /* pre-last char is not LF */
-          {
-            Run = False;                         /* end loop */
-            Log(L_WARN, "Input overflow for %s!", TempBuffer2);
-          }
-        }
+      Info->Counter += Value;
+      Info->Downloads = Value;
+    }
 
-        if (Run)       /* if still in business */
-        {
-          Line++;           /* got another line */
+    Info = Info->Next;             /* next one */
+  }
+}
 
-          /* remove LF at end of line */
-          if (InBuffer[Length - 1] == 10)
-          {
-            InBuffer[Length - 1] = 0;
-            Length--;
-          }
 
-          /* remove CR at end of line */
-          if (InBuffer[Length - 1] == 13)
-          {
-            InBuffer[Length - 1] = 0;
-            Length--;
-          }
 
-          /* if it's not an empty line */
-          if (InBuffer[0] != 0)
-          {
-            /* parse line and extract data fields */
-            Flag = Parse_files_bbs(InBuffer, Line, &Info);
+/*
+ *  remove downloads from counter store after writing files.bbs
+ *  - only if files.bbs has a counter field, i.e. the downloads merged
+ *    are stored in files.bbs now
+ *  - downloads counted meanwhile stay in the store
+ */
 
-            /* if we care about for syntax errors */
-            if (!(Env->InfoMode & INFO_RELAX))
-            {
-              /* end processing on error */
-              if (!Flag) Run = False;        /* end loop */ 
-            }
-          }
-        }
-      }
-      else                     /* EOF or error */
-      {
-        Run = False;        /* end loop */
+void CommitCounters(char *Path)
+{
+  Info_Type         *Info;
+  Field_Type        *Field;
 
-        /* check for error */
-        if (ferror(File) != 0)
-        {
-          Flag = False;            /* signal problem */
-          Log(L_WARN, "Read error for %s!", TempBuffer2);
-        }
-      }
-    }
+  /* sanity checks */
+  if ((Path == NULL) || (Env->CounterStore == NULL)) return;
 
-    fclose(File);            /* close file */
-  }
-  else             /* file error */
+  /* check for counter field */
+  Field = Env->Fields_files_bbs;
+  while (Field && (Field->Type != FIELD_COUNTER)) Field = Field->Next;
+  if (Field == NULL) return;
+
+  Info = Env->InfoList;
+  while (Info)
   {
-    Log(L_WARN, "Couldn't open neither files.bbs nor FILES.BBS!");
-  }
+    /* written to files.bbs */
+    if ((Info->Status & FINFO_OK) && (Info->Downloads > 0))
+    {
+      snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1, "%s/%s", Path, Info->Name);
+      AddCounter(Env->CounterStore, TempBuffer, -(long)Info->Downloads);
+      Info->Downloads = 0;
+    }
 
-  return Flag;
+    Info = Info->Next;             /* next one */
+  }
 }
 
 
 
+/* ************************************************************************
+ *   descript.ion
+ * ************************************************************************ */
+
+
 /*
- *  write files.bbs
+ *  parse descript.ion
+ *  - <name> <description>, long names with spaces are quoted
+ *  - 4DOS extension data (behind ^D) is ignored
+ *  - descriptions are only added to files found and without description
+ *
+ *  requires:
+ *  - pointer to input buffer
+ *  - line number
+ *  - parser state (not used)
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Write_files_bbs(char *Path)
+_Bool Parse_descript_ion(char *Buffer, unsigned int Line, void *State)
 {
   _Bool             Flag = False;       /* return value */
-  _Bool             Run = True;         /* control flag */
-  FILE              *File;              /* files.bbs stream */
-  unsigned short    Check;
+  char              *Name;              /* file name */
+  char              *Desc;              /* description */
+  char              *Help;
   Info_Type         *Info;
 
   /* sanity check */
-  if (Path == NULL) return Flag;
-
-  /* try to open files.bbs or FILES.BBS */
-  Check = 2;
-  while (Check > 0)
-  {
-    if (Check == 2) snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1, "files.bbs");
-    else if (Check == 1) snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1, "FILES.BBS");
-
-    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1, "%s/%s", Path, TempBuffer2);
-    File = fopen(TempBuffer, "r");         /* read mode */    
-    if (File == NULL) Check--;
-    else Check = 0;
-  }
+  if (Buffer == NULL) return Flag;
 
+  /* cut off extension data */
+  Help = strchr(Buffer, 4);
+  if (Help) Help[0] = 0;
 
-  /* now re-open file in write mode */
-  if (File)                            /* got it */
+  /* get name */
+  if (Buffer[0] == '"')               /* quoted name */
   {
-    fclose(File);                        /* close file */
-    File = fopen(TempBuffer, "w");       /* truncate & write mode */
-
-    if (File == NULL)                    /* error */
-    {
-      Run = False;
-      Log(L_WARN, "Couldn't write %s!", TempBuffer2);
-    }
-    else
+    Name = &Buffer[1];
+    Desc = strchr(Name, '"');
+    if (Desc == NULL)                   /* missing end quote */
     {
-      Log(L_WARN, "Writing: %s", TempBuffer2);
+      Log(L_WARN, "Syntax error for filename (line %d)!", Line);
+      return Flag;
     }
   }
-  else                                 /* none of both */
+  else                                /* plain name */
   {
-    Run = False;
-    Log(L_WARN, "Couldn't open neither files.bbs nor FILES.BBS!");
+    Name = Buffer;
+    Desc = Name;
+    while ((Desc[0] != 0) && (Desc[0] != ' ') && (Desc[0] != 9)) Desc++;
   }
 
-  /* follow info list */
-  Info = Env->InfoList;
-  while (Run && Info)
+  if (Desc[0] != 0)                   /* end name */
   {
-    if (Info->Status & FINFO_OK)   /* ok to list  */
+    Desc[0] = 0;
+    Desc++;
+  }
+
+  /* skip spaces and remove trailing spaces */
+  while ((Desc[0] == ' ') || (Desc[0] == 9)) Desc++;
+  Help = &Desc[strlen(Desc)];
+  while ((Help > Desc) && ((Help[-1] == ' ') || (Help[-1] == 9))) Help--;
+  Help[0] = 0;
+
+  Flag = True;
+
+  /* add description to file */
+  if ((Name[0] != 0) && (Desc[0] != 0))
+  {
+    Info = SearchInfoList(Env->InfoList, Name);
+    if (Info && (Info->Infos == NULL))
     {
-      Run = WriteInfo(File, Info, &(Env->Fields_files_bbs), 78);
+      Flag = AddDesc2Info(Info, Desc);
     }
-
-    Info = Info->Next;             /* next one */
   }
 
-  /* clean up */
-  if (File) fclose(File);
+  return Flag;
+}
 
-  return Flag = Run;
+
+
+/*
+ *  read descript.ion
+ *  - missing file is only reported if files.bbs isn't read too
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool Read_descript_ion(char *Path)
+{
+  return ReadInfoFile(Path, "descript.ion", "DESCRIPT.ION", Parse_descript_ion,
+    NULL, !(Env->InfoMode & INFO_FILES_BBS));
 }
 
 
@@ -1465,7 +2313,286 @@ char *Read_filearea_bbs(char *Path)
     Log(L_WARN, "Couldn't open neither filearea.bbs nor FILEAREA.BBS!");
   }
 
-  return Info;
+  return Info;
+}
+
+
+
+/* ************************************************************************
+ *   render cache
+ * ************************************************************************ */
+
+
+/*
+ *  add data to hash value (FNV-1a, 64 bits)
+ *
+ *  returns:
+ *  - new hash value
+ */
+
+uint64_t HashData(uint64_t Hash, const void *Data, size_t Size)
+{
+  const unsigned char    *Byte = Data;
+
+  while (Size > 0)
+  {
+    Hash ^= Byte[0];
+    Hash *= 1099511628211ULL;           /* FNV prime */
+    Byte++;
+    Size--;
+  }
+
+  return Hash;
+}
+
+
+
+/*
+ *  add string to hash value
+ *  - includes trailing 0 to separate strings
+ *
+ *  returns:
+ *  - new hash value
+ */
+
+uint64_t HashString(uint64_t Hash, char *String)
+{
+  if (String == NULL) String = "";
+
+  return HashData(Hash, String, strlen(String) + 1);
+}
+
+
+
+/*
+ *  add status of file to hash value
+ *  - mtime (with nanoseconds), size and inode
+ *  - missing file counts too
+ *
+ *  returns:
+ *  - new hash value
+ */
+
+uint64_t HashFileStatus(uint64_t Hash, char *Path, char *Filename)
+{
+  struct stat       FileData;           /* file details */
+
+  if (Filename)
+  {
+    snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1, "%s/%s", Path, Filename);
+    Path = TempBuffer2;
+  }
+
+  if (stat(Path, &FileData) != 0)       /* missing file */
+  {
+    memset(&FileData, 0, sizeof(struct stat));
+  }
+
+  Hash = HashData(Hash, &FileData.st_mtim, sizeof(FileData.st_mtim));
+  Hash = HashData(Hash, &FileData.st_size, sizeof(FileData.st_size));
+  Hash = HashData(Hash, &FileData.st_ino, sizeof(FileData.st_ino));
+
+  return Hash;
+}
+
+
+
+/*
+ *  add layout of data fields to hash value
+ *
+ *  returns:
+ *  - new hash value
+ */
+
+uint64_t HashFields(uint64_t Hash, Field_Type *Field)
+{
+  while (Field)
+  {
+    Hash = HashData(Hash, &Field->Type, sizeof(Field->Type));
+    Hash = HashData(Hash, &Field->Line, sizeof(Field->Line));
+    Hash = HashData(Hash, &Field->Pos, sizeof(Field->Pos));
+    Hash = HashData(Hash, &Field->Width, sizeof(Field->Width));
+    Hash = HashData(Hash, &Field->Align, sizeof(Field->Align));
+    Hash = HashData(Hash, &Field->Format, sizeof(Field->Format));
+
+    Field = Field->Next;
+  }
+
+  return HashData(Hash, "", 1);         /* end of list */
+}
+
+
+
+/*
+ *  get key of filearea for render cache
+ *  - directory, description files, layout and settings
+ *
+ *  returns:
+ *  - hash value
+ */
+
+uint64_t GetAreaKey(char *Name, char *Path, char *AreaInfo)
+{
+  uint64_t          Hash;               /* return value */
+  Exclude_Type      *Exclude;
+
+  Hash = 14695981039346656037ULL;       /* offset basis */
+
+  /* area */
+  Hash = HashString(Hash, VERSION);
+  Hash = HashString(Hash, Name);
+  Hash = HashString(Hash, Path);
+  Hash = HashString(Hash, AreaInfo);
+
+  /* directory and description files */
+  Hash = HashFileStatus(Hash, Path, NULL);
+  Hash = HashFileStatus(Hash, Path, "files.bbs");
+  Hash = HashFileStatus(Hash, Path, "FILES.BBS");
+  Hash = HashFileStatus(Hash, Path, "dir.bbs");
+  Hash = HashFileStatus(Hash, Path, "DIR.BBS");
+  Hash = HashFileStatus(Hash, Path, "descript.ion");
+  Hash = HashFileStatus(Hash, Path, "DESCRIPT.ION");
+
+  /* layout and settings */
+  Hash = HashFields(Hash, Env->Fields_filelist);
+  Hash = HashFields(Hash, Env->Fields_files_bbs);
+  Hash = HashData(Hash, &Env->InfoMode, sizeof(Env->InfoMode));
+  Hash = HashData(Hash, &Env->CfgSwitches, sizeof(Env->CfgSwitches));
+
+  Exclude = Env->ExcludeList;
+  while (Exclude)
+  {
+    Hash = HashString(Hash, Exclude->Name);
+    Exclude = Exclude->Next;
+  }
+
+  return Hash;
+}
+
+
+
+/*
+ *  build filepath of render cache file for filearea
+ */
+
+void GetAreaCachePath(char *Name, char *Path, char *Buffer)
+{
+  uint64_t          Hash;
+
+  Hash = HashString(14695981039346656037ULL, Name);
+  Hash = HashString(Hash, Path);
+
+  snprintf(Buffer, DEFAULT_BUFFER_SIZE - 1, "%s/%016llx."SUFFIX_AREA,
+    Env->CachePath, (unsigned long long)Hash);
+}
+
+
+
+/*
+ *  write filearea from render cache to filelist
+ *  - updates statistics after complete copy
+ *
+ *  returns:
+ *  - 1 on cache hit
+ *  - 0 on miss
+ *  - -1 on error (filelist might have partial area)
+ */
+
+int ReadAreaCache(char *Name, char *Path, uint64_t Key)
+{
+  int               Flag = 0;           /* return value */
+  FILE              *File;
+  AreaCache_Type    Head;               /* head of cache file */
+  struct stat       FileData;           /* file details */
+  size_t            Length;
+  uint64_t          Size;
+
+  GetAreaCachePath(Name, Path, TempBuffer);
+
+  File = fopen(TempBuffer, "r");
+  if (File == NULL) return Flag;
+
+  /* check head and size */
+  if ((fread(&Head, sizeof(AreaCache_Type), 1, File) == 1) &&
+      (Head.Magic == AREA_CACHE_MAGIC) && (Head.Key == Key) &&
+      (fstat(fileno(File), &FileData) == 0) &&
+      (FileData.st_size == sizeof(AreaCache_Type) + Head.Size))
+  {
+    Flag = 1;
+
+    /* copy rendered area */
+    Size = Head.Size;
+    while ((Flag == 1) && (Size > 0))
+    {
+      Length = DEFAULT_BUFFER_SIZE;
+      if (Size < Length) Length = Size;
+
+      if ((fread(OutBuffer, 1, Length, File) != Length) ||
+          (fwrite(OutBuffer, 1, Length, Env->List) != Length))
+      {
+        Log(L_WARN, "Couldn't copy cached area (%s)!", TempBuffer);
+        Flag = -1;
+      }
+
+      Size -= Length;
+    }
+
+    if (Flag == 1)
+    {
+      Env->Files += Head.Files;
+      Env->Bytes += Head.Bytes;
+    }
+  }
+
+  fclose(File);
+
+  return Flag;
+}
+
+
+
+/*
+ *  write rendered filearea to render cache
+ *  - temporary file replaced atomically
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool WriteAreaCache(char *Name, char *Path, uint64_t Key,
+  char *Block, size_t Size, long Files, long long Bytes)
+{
+  _Bool             Flag = False;       /* return value */
+  FILE              *File;
+  AreaCache_Type    Head;               /* head of cache file */
+
+  GetAreaCachePath(Name, Path, TempBuffer);
+  snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1, "%s."SUFFIX_TEMP".%d",
+    TempBuffer, getpid());
+
+  memset(&Head, 0, sizeof(AreaCache_Type));
+  Head.Magic = AREA_CACHE_MAGIC;
+  Head.Key = Key;
+  Head.Files = Files;
+  Head.Bytes = Bytes;
+  Head.Size = Size;
+
+  File = fopen(TempBuffer2, "w");
+  if (File)
+  {
+    if ((fwrite(&Head, sizeof(AreaCache_Type), 1, File) == 1) &&
+        (fwrite(Block, 1, Size, File) == Size)) Flag = True;
+
+    if (fclose(File) != 0) Flag = False;
+
+    if (Flag && (rename(TempBuffer2, TempBuffer) != 0)) Flag = False;
+    if (!Flag) unlink(TempBuffer2);
+  }
+
+  if (!Flag) Log(L_WARN, "Couldn't write render cache (%s)!", TempBuffer);
+
+  return Flag;
 }
 
 
@@ -1492,6 +2619,9 @@ _Bool ScanPath(char *Path)
   struct stat            FileData;            /* file details */
   long                   FileCounter = 0;     /* file counter */
   int                    Error;               /* error ID */
+  char                   *IndexPath = NULL;   /* path for file index */
+  char                   *LocalPath = NULL;   /* absolute path */
+  off_t                  AliasOffset = -1;    /* alias file offset */
 
   /* sanity check */
   if (Path == NULL) return Flag;
@@ -1508,6 +2638,21 @@ _Bool ScanPath(char *Path)
       Run = False;
     }
 
+    /* file index (combined mode) needs absolute path */
+    if (Run && Env->IndexFilepath)
+    {
+      IndexPath = Path;
+      if (Path[0] != '/')       /* relative path */
+      {
+        snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+          "%s/%s", Env->CWD, Path);
+        LocalPath = CopyString(TempBuffer);
+        IndexPath = LocalPath;
+      }
+
+      Run = AddIndexAlias(IndexPath, &AliasOffset);
+    }
+
     /* get all directory entries and check each name */
     while (Run)
     {
@@ -1516,7 +2661,8 @@ _Bool ScanPath(char *Path)
       if (File)                      /* got it */
       {
         /* check file type */
-        if (lstat(File->d_name, &FileData) == 0)
+        if ((lstat(File->d_name, &FileData) == 0) &&
+            ! IsTempFile(File->d_name))
         {
           if (S_ISREG(FileData.st_mode))        /* regular file */
           {
@@ -1532,6 +2678,15 @@ _Bool ScanPath(char *Path)
                   Env->LastInfo->Status = FINFO_EXCLUDED;
                 else
                   Env->LastInfo->Status = FINFO_OK;
+
+                /* add file to index (name might be changed) */
+                if (IndexPath && (Env->LastInfo->Status == FINFO_OK))
+                {
+                  snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1,
+                    "%s", File->d_name);
+                  Flag = AddIndexFile(TempBuffer2, IndexPath, Env->IndexPW,
+                    AliasOffset, Env->IndexAutoMagic);
+                }
               }
             }
 
@@ -1561,6 +2716,9 @@ _Bool ScanPath(char *Path)
     closedir(Directory);        /* close directory */
   }
 
+  /* clean up */
+  if (LocalPath) free(LocalPath);
+
   return Flag;
 }
 
@@ -1583,6 +2741,16 @@ _Bool ProcessPath(char *Name, char *Path, char *AreaInfo)
   Info_Type         *Last = NULL;       /* pointer to last element in list */
   Field_Type        *Field;
   unsigned short    Limit;
+  _Bool             UseCache = False;   /* render cache */
+  uint64_t          Key = 0;            /* key of area for cache */
+  FILE              *Output;            /* filelist or cache buffer */
+  char              *Block = NULL;      /* rendered area */
+  size_t            Size = 0;           /* size of rendered area */
+  long              Files;              /* statistics before area */
+  long long         Bytes;
+  RenderPlan_Type   Plan;               /* render plan */
+  unsigned short    n;                  /* counter */
+  int               Check;              /* result of render cache */
 
   /* sanity checks */
   if ((Name == NULL) || (Path == NULL)) return Flag;
@@ -1590,6 +2758,27 @@ _Bool ProcessPath(char *Name, char *Path, char *AreaInfo)
   Flag = True;
 
 
+  /*
+   *  render cache (download counters may change anytime,
+   *  file index and sinks need the scan)
+   */
+
+  if (Env->CachePath && (Env->CounterStore == NULL) &&
+      (Env->IndexFilepath == NULL) && (Env->Sinks == 0))
+  {
+    UseCache = True;
+    Key = GetAreaKey(Name, Path, AreaInfo);
+
+    /* unchanged area, error after partial output */
+    Check = ReadAreaCache(Name, Path, Key);
+    if (Check == 1) return Flag;
+    if (Check == -1) return False;
+  }
+
+  Files = Env->Files;
+  Bytes = Env->Bytes;
+
+
   /*
    *  directory specific info
    */
@@ -1620,6 +2809,18 @@ _Bool ProcessPath(char *Name, char *Path, char *AreaInfo)
     {
       Flag = Read_files_bbs(Path);
     }
+
+    /* descript.ion (files without description) */
+    if (Flag && (Env->InfoMode & INFO_DESCRIPT_ION))
+    {
+      Flag = Read_descript_ion(Path);
+    }
+  }
+
+  /* merge downloads from counter store */
+  if (Flag && Env->CounterStore)
+  {
+    MergeCounters(Path);
   }
 
   /* sort files */
@@ -1635,7 +2836,13 @@ _Bool ProcessPath(char *Name, char *Path, char *AreaInfo)
   {
     if (Env->InfoMode & INFO_FILES_BBS)
     {
-      Write_files_bbs(Path);
+      if (Write_files_bbs(Path))
+      {
+        CommitCounters(Path);
+
+        /* files.bbs is part of key */
+        if (UseCache) Key = GetAreaKey(Name, Path, AreaInfo);
+      }
     }
   }
 
@@ -1646,26 +2853,38 @@ _Bool ProcessPath(char *Name, char *Path, char *AreaInfo)
 
   if (Flag)
   {
+    /* render into buffer for cache */
+    Output = NULL;
+    if (UseCache) Output = open_memstream(&Block, &Size);
+    if (Output == NULL)
+    {
+      Output = Env->List;
+      UseCache = False;
+    }
+
     /* get line limit */
     Field = Env->Fields_filelist;
     while (Field && (Field->Type != FIELD_DESC)) Field = Field->Next;
     if (Field && (Field->Width > 0)) Limit = Field->Pos + Field->Width - 1;
     else Limit = 78;
 
+    /* compile layout */
+    CompilePlan(&Plan, Env->Fields_filelist, Limit);
+
     /* separation line */
     FillString(TempBuffer, '-', Limit, DEFAULT_BUFFER_SIZE - 1);
-    fprintf(Env->List, "\n%s\n", TempBuffer);
+    fprintf(Output, "\n%s\n", TempBuffer);
 
     /* area name */
-    fprintf(Env->List, "%s\n", Name);
+    fprintf(Output, "%s\n", Name);
 
     /* area description */
     if (AreaInfo) Desc = AreaInfo;
     else if (DirBBS) Desc = DirBBS;
-    if (Desc) fprintf(Env->List, "%s\n", Desc);
+    if (Desc) fprintf(Output, "%s\n", Desc);
 
     /* separation line */
-    fprintf(Env->List, "%s\n", TempBuffer);
+    fprintf(Output, "%s\n", TempBuffer);
 
     /* files */
     Info = Env->InfoList;
@@ -1674,11 +2893,50 @@ _Bool ProcessPath(char *Name, char *Path, char *AreaInfo)
     {
       if (Info->Status & FINFO_OK)  /* if ok to list  */
       {
-        WriteInfo(Env->List, Info, &(Env->Fields_filelist), Limit);
+        WriteInfo(Output, Info, &Plan);
       }
 
       Info = Info->Next;             /* next one */
     }
+
+    /* copy rendered area to filelist and cache */
+    if (UseCache)
+    {
+      fclose(Output);
+      if (Block)
+      {
+        fwrite(Block, 1, Size, Env->List);
+        WriteAreaCache(Name, Path, Key, Block, Size,
+          Env->Files - Files, Env->Bytes - Bytes);
+      }
+    }
+  }
+
+
+  /*
+   *  write sinks (same info list)
+   */
+
+  if (Flag && (Env->Sinks > 0))
+  {
+    for (n = 0; n < SINKS; n++)
+    {
+      if (Env->Sink[n] == NULL) continue;
+
+      if (n == SINK_NEW)            /* new files */
+      {
+        if (!WriteNewFiles(Env->Sink[n], Name, Desc, Env->InfoList, &Plan))
+          Flag = False;
+        continue;
+      }
+
+      if (Env->SinkAreas > 0)
+        WriteSinkFrame(Env->Sink[n], n, FRAME_SEPARATOR);
+      if (!WriteSinkArea(Env->Sink[n], n, Name, Desc, Env->InfoList))
+        Flag = False;
+    }
+
+    Env->SinkAreas++;
   }
 
 
@@ -1687,12 +2945,15 @@ _Bool ProcessPath(char *Name, char *Path, char *AreaInfo)
    */
 
   if (DirBBS) free(DirBBS);
+  if (Block) free(Block);
 
   if (Env->InfoList)               /* reset global list */
   {
     FreeInfoList(Env->InfoList);
     Env->InfoList = NULL;
     Env->LastInfo = NULL;
+    FreeInfoHash();
+    FreeArena();
   }
 
   return Flag;
@@ -1753,6 +3014,9 @@ _Bool ManagePath(char *Name, char *Path, char *AreaInfo, int Depth, _Bool SubFla
   Flag = ProcessPath(Name, Path, AreaInfo);
   if (!Flag) return Flag;
 
+  /* no recursion: skip checking directory entries */
+  if (Depth <= 0) return Flag;
+
 
   /*
    *  then look for sub-directories
@@ -1807,50 +3071,407 @@ _Bool ManagePath(char *Name, char *Path, char *AreaInfo, int Depth, _Bool SubFla
               /* copy sub-dir's name */
               SubName = CopyString(TempBuffer2);
 
-              /* call me resursively with a decreased depth */
-              Flag = ManagePath(SubName, SubPath, AreaInfo, Depth - 1, True);
-              if (!Flag) Run = False;   /* end loop on error */
+              /* call me resursively with a decreased depth */
+              Flag = ManagePath(SubName, SubPath, AreaInfo, Depth - 1, True);
+              if (!Flag) Run = False;   /* end loop on error */
+
+              if (SubName)         /* free name */
+              {
+                free(SubName);
+                SubName = NULL;
+              }
+
+              if (SubPath)         /* free path */
+              {
+                free(SubPath);
+                SubPath = NULL;
+              }
+
+              FileCounter++;       /* increase counter */
+              chdir(Path);         /* move back to current directory */
+            }
+          }
+        }
+      }
+      else                         /* error or no more entries */
+      {
+        Run = False;                   /* end loop */
+
+        /* check for empty directory */
+        if (errno == Error)            /* no more entries */
+        {
+          if (FileCounter == 0)        /* no valid sub-dirs found */
+          {
+            Flag = True;               /* signal success */
+          }
+        }
+      }
+    }
+
+    chdir(Env->CWD);            /* move back to start directory */
+    closedir(Directory);        /* close directory */
+  }
+
+  /* clean up */
+  if (LocalPath) free(LocalPath);
+  if (AltName) free(AltName);
+
+  return Flag;
+}
+
+
+
+/* ************************************************************************
+ *   area workers
+ * ************************************************************************ */
+
+
+/*
+ *  finish first element of worker list
+ *  - waits for worker and copies rendered area to filelist
+ *  - copies text block to filelist
+ *  - discards output behind a failed area
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool FinishWorker(void)
+{
+  _Bool             Flag = False;       /* return value */
+  Worker_Type       *Worker;
+  WorkerResult_Type Result;             /* results of worker */
+  size_t            Length;
+  unsigned short    n;                  /* counter */
+
+  /* sanity check */
+  if (Env->WorkerList == NULL) return Flag;
+
+  /* remove element from list */
+  Worker = Env->WorkerList;
+  Env->WorkerList = Worker->Next;
+  if (Env->WorkerList == NULL) Env->LastWorker = NULL;
+
+  if (Worker->PID > 0)             /* area worker */
+  {
+    Env->ActiveWorkers--;
+
+    /* wait for worker */
+    if (!Worker->Done)
+      Worker->Done = (waitpid(Worker->PID, &Worker->Status, 0) == Worker->PID);
+  }
+
+  if (Env->WorkerFailed)           /* discard output behind failed area */
+  {
+    Flag = False;
+  }
+  else if (Worker->PID == 0)       /* text block */
+  {
+    if (fputs(Worker->Text, Env->List) >= 0) Flag = True;
+  }
+  else                             /* area worker */
+  {
+    if (Worker->Done && WIFEXITED(Worker->Status))
+    {
+      /* get results and copy rendered area */
+      rewind(Worker->Block);
+      if (fread(&Result, sizeof(WorkerResult_Type), 1, Worker->Block) == 1)
+      {
+        Flag = Result.Flag;
+        Env->Files += Result.Files;
+        Env->Bytes += Result.Bytes;
+        Env->Checks_files_bbs += Result.Checks_files_bbs;
+        Env->Writes_files_bbs += Result.Writes_files_bbs;
+
+        while ((Length = fread(OutBuffer, 1, DEFAULT_BUFFER_SIZE,
+                Worker->Block)) > 0)
+        {
+          if (fwrite(OutBuffer, 1, Length, Env->List) != Length)
+          {
+            Flag = False;
+            break;
+          }
+        }
+
+        /* copy rendered areas of sinks */
+        for (n = 0; n < SINKS; n++)
+        {
+          if ((Worker->SinkBlock[n] == NULL) || (Result.SinkAreas == 0))
+            continue;
+
+          if (Env->SinkAreas > 0)
+            WriteSinkFrame(Env->Sink[n], n, FRAME_SEPARATOR);
+
+          rewind(Worker->SinkBlock[n]);
+          while ((Length = fread(OutBuffer, 1, DEFAULT_BUFFER_SIZE,
+                  Worker->SinkBlock[n])) > 0)
+          {
+            if (fwrite(OutBuffer, 1, Length, Env->Sink[n]) != Length)
+            {
+              Flag = False;
+              break;
+            }
+          }
+        }
+
+        Env->SinkAreas += Result.SinkAreas;
+        Env->NewFiles += Result.NewFiles;
+      }
+    }
+
+    if (!Flag)
+    {
+      Log(L_WARN, "Area worker failed (PID %d)!", Worker->PID);
+      Env->WorkerFailed = True;    /* like serial processing */
+    }
+  }
+
+  /* free element */
+  if (Worker->Block) fclose(Worker->Block);
+  for (n = 0; n < SINKS; n++)
+  {
+    if (Worker->SinkBlock[n]) fclose(Worker->SinkBlock[n]);
+  }
+  if (Worker->Text) free(Worker->Text);
+  free(Worker);
+
+  return Flag;
+}
+
+
+
+/*
+ *  finish workers in order of output
+ *
+ *  requires:
+ *  - max. number of workers to keep running
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool DrainWorkers(unsigned short Max)
+{
+  _Bool             Flag = True;        /* return value */
+
+  while (Env->WorkerList &&
+         ((Env->ActiveWorkers > Max) || (Env->WorkerList->PID == 0)))
+  {
+    Flag &= FinishWorker();
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  check for failed workers
+ *  - gets exit status of ended workers without waiting
+ *  - on failure writes output up to the failed area and discards the rest,
+ *    so processing stops like in serial mode
+ *
+ *  returns:
+ *  - 1 if no worker failed
+ *  - 0 on failure
+ */
+
+_Bool CheckWorkers(void)
+{
+  _Bool             Flag = True;        /* return value */
+  Worker_Type       *Worker;
+
+  if (Env->WorkerFailed) return False;
+
+  Worker = Env->WorkerList;
+  while (Worker)                   /* follow list */
+  {
+    if ((Worker->PID > 0) && !Worker->Done &&
+        (waitpid(Worker->PID, &Worker->Status, WNOHANG) == Worker->PID))
+    {
+      Worker->Done = True;
+
+      if (!WIFEXITED(Worker->Status) ||
+          (WEXITSTATUS(Worker->Status) != EXIT_SUCCESS)) Flag = False;
+    }
+
+    Worker = Worker->Next;         /* next one */
+  }
+
+  if (!Flag) DrainWorkers(0);
+
+  return Flag;
+}
+
+
+
+/*
+ *  add text block to worker list
+ *  - keeps text in order with areas still being processed
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool QueueText(char *Text)
+{
+  _Bool             Flag = False;       /* return value */
+  Worker_Type       *Worker;
+
+  /* sanity check */
+  if (Text == NULL) return Flag;
+
+  Worker = calloc(1, sizeof(Worker_Type));
+  if (Worker)
+  {
+    Worker->Text = CopyString(Text);
+
+    if (Env->LastWorker) Env->LastWorker->Next = Worker;
+    else Env->WorkerList = Worker;
+    Env->LastWorker = Worker;
+
+    if (Worker->Text) Flag = True;
+  }
+  else
+  {
+    Log(L_ERR, "Couldn't allocate memory!");
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  process filearea by a worker process
+ *  - worker renders area into temporary file
+ *  - results are written to the filelist in order by DrainWorkers()
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool StartWorker(char *Name, char *Path, char *AreaInfo, int Depth)
+{
+  _Bool             Flag = False;       /* return value */
+  _Bool             Run;                /* control flag */
+  Worker_Type       *Worker;
+  WorkerResult_Type Result;             /* results of worker */
+  unsigned short    n;                  /* counter */
+
+  /* sanity checks */
+  if ((Name == NULL) || (Path == NULL)) return Flag;
+
+  /* stop on failed area and limit number of workers */
+  if (!CheckWorkers()) return Flag;
+  if (!DrainWorkers(Env->Workers - 1)) return Flag;
+
+  Worker = calloc(1, sizeof(Worker_Type));
+  if (Worker == NULL)
+  {
+    Log(L_ERR, "Couldn't allocate memory!");
+    return Flag;
+  }
+
+  Worker->Block = tmpfile();
+  Run = (Worker->Block != NULL);
+
+  /* temporary files for sinks */
+  for (n = 0; n < SINKS; n++)
+  {
+    if (Run && Env->Sink[n])
+    {
+      Worker->SinkBlock[n] = tmpfile();
+      if (Worker->SinkBlock[n] == NULL) Run = False;
+    }
+  }
+
+  if (!Run)
+  {
+    Log(L_WARN, "Couldn't create temporary file!");
+    if (Worker->Block) fclose(Worker->Block);
+    for (n = 0; n < SINKS; n++)
+    {
+      if (Worker->SinkBlock[n]) fclose(Worker->SinkBlock[n]);
+    }
+    free(Worker);
+    return Flag;
+  }
 
-              if (SubName)         /* free name */
-              {
-                free(SubName);
-                SubName = NULL;
-              }
+  /* write buffered data before forking */
+  fflush(Env->List);
+  for (n = 0; n < SINKS; n++)
+  {
+    if (Env->Sink[n]) fflush(Env->Sink[n]);
+  }
+  FlushLog();
 
-              if (SubPath)         /* free path */
-              {
-                free(SubPath);
-                SubPath = NULL;
-              }
+  Worker->PID = fork();
 
-              FileCounter++;       /* increase counter */
-              chdir(Path);         /* move back to current directory */
-            }
-          }
-        }
-      }
-      else                         /* error or no more entries */
-      {
-        Run = False;                   /* end loop */
+  if (Worker->PID == 0)            /* worker */
+  {
+    memset(&Result, 0, sizeof(WorkerResult_Type));
+    fwrite(&Result, sizeof(WorkerResult_Type), 1, Worker->Block);
 
-        /* check for empty directory */
-        if (errno == Error)            /* no more entries */
-        {
-          if (FileCounter == 0)        /* no valid sub-dirs found */
-          {
-            Flag = True;               /* signal success */
-          }
-        }
-      }
+    /* render area */
+    Env->List = Worker->Block;
+    for (n = 0; n < SINKS; n++) Env->Sink[n] = Worker->SinkBlock[n];
+    Env->Files = 0;
+    Env->Bytes = 0;
+    Env->Checks_files_bbs = 0;
+    Env->Writes_files_bbs = 0;
+    Env->SinkAreas = 0;
+    Env->NewFiles = 0;
+    Result.Flag = ManagePath(Name, Path, AreaInfo, Depth, False);
+    Result.Files = Env->Files;
+    Result.Bytes = Env->Bytes;
+    Result.Checks_files_bbs = Env->Checks_files_bbs;
+    Result.Writes_files_bbs = Env->Writes_files_bbs;
+    Result.SinkAreas = Env->SinkAreas;
+    Result.NewFiles = Env->NewFiles;
+
+    /* write rendered areas of sinks */
+    for (n = 0; n < SINKS; n++)
+    {
+      if (Env->Sink[n] && (fflush(Env->Sink[n]) != 0)) Result.Flag = False;
     }
 
-    chdir(Env->CWD);            /* move back to start directory */
-    closedir(Directory);        /* close directory */
+    /* update results */
+    if ((fflush(Worker->Block) != 0) ||
+        (fseek(Worker->Block, 0, SEEK_SET) != 0) ||
+        (fwrite(&Result, sizeof(WorkerResult_Type), 1, Worker->Block) != 1) ||
+        (fflush(Worker->Block) != 0))
+    {
+      Result.Flag = False;
+    }
+
+    FlushLog();
+    _exit(Result.Flag ? EXIT_SUCCESS : EXIT_FAILURE);
   }
+  else if (Worker->PID > 0)        /* parent */
+  {
+    Env->ActiveWorkers++;
 
-  /* clean up */
-  if (LocalPath) free(LocalPath);
-  if (AltName) free(AltName);
+    if (Env->LastWorker) Env->LastWorker->Next = Worker;
+    else Env->WorkerList = Worker;
+    Env->LastWorker = Worker;
+
+    Flag = True;
+  }
+  else                             /* error */
+  {
+    Log(L_WARN, "Couldn't fork area worker!");
+    fclose(Worker->Block);
+    for (n = 0; n < SINKS; n++)
+    {
+      if (Worker->SinkBlock[n]) fclose(Worker->SinkBlock[n]);
+    }
+    free(Worker);
+  }
 
   return Flag;
 }
@@ -1977,97 +3598,370 @@ unsigned short      MaxPos;
     }
   }
 
-  return Flag;
-}
+  return Flag;
+}
+
+
+
+/* ************************************************************************
+ *   commands
+ * ************************************************************************ */
+
+
+/*
+ *  include file
+ *  Syntax: Include Config <filepath>
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool Cmd_Include(Token_Type *TokenList)
+{
+  _Bool                  Flag = False;       /* return value */
+  _Bool                  Run = True;         /* control flag */
+  _Bool                  Error = False;      /* error flag */
+  unsigned short         Keyword = 0;        /* keyword ID */
+  static char            *Keywords[3] =
+    {"Include", "Config", NULL};
+
+  /* sanity check */
+  if (TokenList == NULL) return Flag;
+
+
+  /*
+   *  parse tokens
+   */
+
+  while (Run && TokenList && TokenList->String)
+  {
+    if (Keyword > 0)          /* get value */
+    {
+      switch (Keyword)
+      {
+        case 2:          /* config */
+          if (Env->ConfigDepth >= 2)         /* limit cfg depth */
+          {
+            Log(L_WARN, "Cfg file depth exceeded!");
+            Run = False;                     /* end loop */
+          }
+          else                               /* include cfg file */
+          {
+            Run = ReadConfig(TokenList->String);
+            if (Run == False) Error = True;       /* signal error */
+          }
+      }
+
+      Keyword = 0;            /* reset */
+    }
+    else                      /* get keyword */
+    {
+      Keyword = GetKeyword(Keywords, TokenList->String);
+
+      switch (Keyword)           /* keywords without data */
+      {
+        case 0:          /* unknown keyword */
+          Run = False;
+          LogBadKeyword(TokenList->String);
+          break;
+
+        case 1:          /* command itself */
+          Keyword = 0;        /* reset keyword */
+       }
+    }
+
+    TokenList = TokenList->Next;     /* goto to next token */
+  }
+
+
+  /*
+   *  check parser results
+   */
+
+  if ((Run == False) || (Keyword > 0))       /* problem occured */
+  {
+    if (Error == False)                 /* syntax error */
+    {
+      LogCfgError();
+    }
+  }
+  else                   /* went fine */
+  {
+    Flag = True;       /* signal success */
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  set format of files.bbs
+ *  Syntax: files.bbs ...
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool Cmd_Define_files_bbs(Token_Type *TokenList)
+{
+  _Bool             Flag = False;       /* return value */
+  _Bool             Run = True;         /* control flag */
+  unsigned short    Keyword = 0;        /* keyword ID */
+  unsigned short    NamePos = 0;
+  unsigned short    NameWidth = 0;
+  unsigned short    NameAlign = ALIGN_LEFT;
+  unsigned short    NameFormat = FIELD_FORM_NONE;
+  unsigned short    SizePos = 0;
+  unsigned short    SizeWidth = 0;
+  unsigned short    SizeAlign = ALIGN_RIGHT;
+  unsigned short    SizeFormat = FIELD_FORM_NONE;
+  unsigned short    DatePos = 0;
+  unsigned short    DateWidth = 0;
+  unsigned short    DateAlign = ALIGN_LEFT;
+  unsigned short    DateFormat = FIELD_FORM_NONE;
+  unsigned short    CounterPos = 0;
+  unsigned short    CounterWidth = 0;
+  unsigned short    CounterAlign = ALIGN_LEFT;
+  unsigned short    CounterFormat = FIELD_FORM_NONE;
+  unsigned short    DescPos = 0;
+  unsigned short    DescWidth = 0;
+  unsigned short    DescAlign = ALIGN_LEFT;
+  unsigned short    DescFormat = FIELD_FORM_MULTI;
+  static char       *Keywords[11] =
+    {"files.bbs", "NameWidth", "NameFormat", "SizePos", "SizeFormat",
+     "DatePos", "DateFormat", "CounterPos", "CounterFormat", "DescPos", NULL};
+
+  /* sanity check */
+  if (TokenList == NULL) return Flag;
+
+  /* free current field list */
+  if (Env->Fields_files_bbs)
+  {
+    FreeFieldList(Env->Fields_files_bbs);
+    Env->Fields_files_bbs = NULL;
+  }
+
+
+  /*
+   *  parse tokens
+   */
+
+  while (Run && TokenList && TokenList->String)
+  {
+    if (Keyword > 1)           /* get value */
+    {
+      switch (Keyword)
+      {
+        case 2:          /* name width */
+          Run = String2Pos(TokenList->String, &NameWidth, 10, 60);
+          break;
+
+        case 3:          /* name format */
+          if (strcasecmp(TokenList->String, "DOS") == 0)
+          {
+            NamePos = 1;
+            NameFormat = FIELD_FORM_DOS;
+            NameWidth = 12;    /* 8.3 */
+          }
+          else if (strcasecmp(TokenList->String, "Long") == 0)
+          {
+            NamePos = 1;
+            NameFormat = FIELD_FORM_LONG;
+          }
+          else                /* unknown keyword */
+          {
+            Run = False;
+            LogBadKeyword(TokenList->String);
+          }
+          break;
+
+        case 4:          /* size position */
+          Run = String2Pos(TokenList->String, &SizePos, 1, 120);
+          break;
+
+        case 5:          /* size format */
+          if (strcasecmp(TokenList->String, "Bytes-8") == 0)
+          {
+            SizeFormat = FIELD_FORM_BYTES;
+            SizeWidth = 8;
+          }
+          else if (strcasecmp(TokenList->String, "Unit-8") == 0)
+          {
+            SizeFormat = FIELD_FORM_UNIT;
+            SizeWidth = 8;
+          }
+          else if (strcasecmp(TokenList->String, "Short-8") == 0)
+          {
+            SizeFormat = FIELD_FORM_SHORT;
+            SizeWidth = 8;
+          }
+          else               /* unknown keyword */
+          {
+            Run = False;
+            LogBadKeyword(TokenList->String);
+          }
+          break;
+
+        case 6:          /* date position */
+          Run = String2Pos(TokenList->String, &DatePos, 1, 120);
+          break;
 
+        case 7:          /* date format */
+          if (strcasecmp(TokenList->String, "US") == 0)
+          {
+            DateFormat = FIELD_FORM_US;
+            DateWidth = 8;
+          }
+          else if (strcasecmp(TokenList->String, "ISO") == 0)
+          {
+            DateFormat = FIELD_FORM_ISO;
+            DateWidth = 10;
+          }
+          else                /* unknown keyword */
+          {
+            Run = False;
+            LogBadKeyword(TokenList->String);
+          }
+          break;
 
+        case 8:          /* counter position */
+          Run = String2Pos(TokenList->String, &CounterPos, 1, 120);
+          break;
 
-/* ************************************************************************
- *   commands
- * ************************************************************************ */
+        case 9:          /* counter format */
+          if (strcasecmp(TokenList->String, "Square-2") == 0)
+          {
+            CounterFormat = FIELD_FORM_SQUARE;
+            CounterWidth = 4;
+          }
+          else if (strcasecmp(TokenList->String, "Square-3") == 0)
+          {
+            CounterFormat = FIELD_FORM_SQUARE;
+            CounterWidth = 5;
+          }
+          else if (strcasecmp(TokenList->String, "Square-4") == 0)
+          {
+            CounterFormat = FIELD_FORM_SQUARE;
+            CounterWidth = 6;
+          }
+          else                /* unknown keyword */
+          {
+            Run = False;
+            LogBadKeyword(TokenList->String);
+          }
+          break;
 
+        case 10:         /* description position */
+          Run = String2Pos(TokenList->String, &DescPos, 1, 120);
+      }
 
-/*
- *  include file
- *  Syntax: Include Config <filepath>
- *
- *  returns:
- *  - 1 on success
- *  - 0 on error
- */
+      Keyword = 0;                       /* reset */
+    }
+    else                      /* check for known keyword */
+    {
+      Keyword = GetKeyword(Keywords, TokenList->String);
 
-_Bool Cmd_Include(Token_Type *TokenList)
-{
-  _Bool                  Flag = False;       /* return value */
-  _Bool                  Run = True;         /* control flag */
-  _Bool                  Error = False;      /* error flag */
-  unsigned short         Keyword = 0;        /* keyword ID */
-  static char            *Keywords[3] =
-    {"Include", "Config", NULL};
+      if (Keyword == 0)            /* unknown keyword */
+      {
+        Run = False;
+        LogBadKeyword(TokenList->String);
+      }
+    }
 
-  /* sanity check */
-  if (TokenList == NULL) return Flag;
+    TokenList = TokenList->Next;     /* next token */
+  }
 
 
   /*
-   *  parse tokens
+   *  check values
    */
 
-  while (Run && TokenList && TokenList->String)
+  if (Run)
   {
-    if (Keyword > 0)          /* get value */
+    /* FileFormat must be set */
+    if (NameFormat == FIELD_FORM_NONE)
     {
-      switch (Keyword)
-      {
-        case 2:          /* config */
-          if (Env->ConfigDepth >= 2)         /* limit cfg depth */
-          {
-            Log(L_WARN, "Cfg file depth exceeded!");
-            Run = False;                     /* end loop */
-          }
-          else                               /* include cfg file */
-          {
-            Run = ReadConfig(TokenList->String);
-            if (Run == False) Error = True;       /* signal error */
-          }
-      }
+      Run = False;
+      Log(L_WARN, "NameFormat argument required!");
+    }
 
-      Keyword = 0;            /* reset */
+    /* for DOS filenames only a width of 12 is valid */
+    if ((NameFormat == FIELD_FORM_DOS) && (NameWidth != 12))
+    {
+      Run = False;
+      Log(L_WARN, "Wrong NameWidth!");
     }
-    else                      /* get keyword */
+
+    /* long filenames require the width option */
+    if ((NameFormat == FIELD_FORM_LONG) && (NameWidth == 0))
     {
-      Keyword = GetKeyword(Keywords, TokenList->String);
+      Run = False;
+      Log(L_WARN, "NameWidth argument required!");
+    }
 
-      switch (Keyword)           /* keywords without data */
-      {
-        case 0:          /* unknown keyword */
-          Run = False;
-          LogBadKeyword(TokenList->String);
-          break;
+    /* if size field is enabled, we need to have position and format */
+    /* same for date and counter fields */
+    if (((SizePos > 0) ^ (SizeFormat != FIELD_FORM_NONE)) ||
+        ((DatePos > 0) ^ (DateFormat != FIELD_FORM_NONE)) ||
+        ((CounterPos > 0) ^ (CounterFormat != FIELD_FORM_NONE)))
+    {
+      Run = False;
+      Log(L_WARN, "Missing argument (Pos and Format)!");
+    } 
 
-        case 1:          /* command itself */
-          Keyword = 0;        /* reset keyword */
-       }
+    /* DescPos must be set */
+    if (DescPos == 0)
+    {
+      Run = False;
+      Log(L_WARN, "DescPos argument required!");
     }
 
-    TokenList = TokenList->Next;     /* goto to next token */
+    /* description needs to be the last field */
+    if (DescPos > 0)
+    {
+      if ((DescPos <= SizePos) ||
+          (DescPos <= DatePos) ||
+          (DescPos <= CounterPos))
+      {
+        Run = False;
+        Log(L_WARN, "Description must be at the end of the line!");
+      }
+    }
   }
 
 
   /*
-   *  check parser results
+   *  add info fields to global list
    */
 
-  if ((Run == False) || (Keyword > 0))       /* problem occured */
+  if (Run)
   {
-    if (Error == False)                 /* syntax error */
-    {
-      LogCfgError();
-    }
+    if (NamePos > 0) Run &= InsertField(&(Env->Fields_files_bbs), FIELD_NAME,
+      1, NamePos, NameWidth, NameAlign, NameFormat); 
+
+    if (SizePos > 0) Run &= InsertField(&(Env->Fields_files_bbs), FIELD_SIZE,
+      1, SizePos, SizeWidth, SizeAlign, SizeFormat);
+
+    if (DatePos > 0) Run &= InsertField(&(Env->Fields_files_bbs), FIELD_DATE,
+      1, DatePos, DateWidth, DateAlign, DateFormat);
+
+    if (CounterPos > 0) Run &= InsertField(&(Env->Fields_files_bbs), FIELD_COUNTER,
+      1, CounterPos, CounterWidth, CounterAlign, CounterFormat);
+
+    if (DescPos > 0) Run &= InsertField(&(Env->Fields_files_bbs), FIELD_DESC,
+      1, DescPos, DescWidth, DescAlign, DescFormat);    
   }
-  else                   /* went fine */
+
+  if ((!Run) || (Keyword > 0))
   {
-    Flag = True;       /* signal success */
+    LogCfgError();
+  }
+  else
+  {
+    Flag = True;    /* signal success */
   }
 
   return Flag;
@@ -2076,51 +3970,60 @@ _Bool Cmd_Include(Token_Type *TokenList)
 
 
 /*
- *  set format of files.bbs
- *  Syntax: files.bbs ...
+ *  set format of filelist
+ *  Syntax: filelist ...
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Cmd_Define_files_bbs(Token_Type *TokenList)
+_Bool Cmd_Define_filelist(Token_Type *TokenList)
 {
   _Bool             Flag = False;       /* return value */
   _Bool             Run = True;         /* control flag */
   unsigned short    Keyword = 0;        /* keyword ID */
-  unsigned short    NamePos = 0;
+  unsigned short    Check;              /* counter for checking stuff */
+  unsigned short    TempLine;
+  unsigned short    TempPos;
+  unsigned short    NameLine = 1;
+  unsigned short    NamePos = 1;
   unsigned short    NameWidth = 0;
   unsigned short    NameAlign = ALIGN_LEFT;
   unsigned short    NameFormat = FIELD_FORM_NONE;
+  unsigned short    SizeLine = 1;
   unsigned short    SizePos = 0;
   unsigned short    SizeWidth = 0;
   unsigned short    SizeAlign = ALIGN_RIGHT;
   unsigned short    SizeFormat = FIELD_FORM_NONE;
+  unsigned short    DateLine = 1;
   unsigned short    DatePos = 0;
   unsigned short    DateWidth = 0;
   unsigned short    DateAlign = ALIGN_LEFT;
   unsigned short    DateFormat = FIELD_FORM_NONE;
+  unsigned short    CounterLine = 1;
   unsigned short    CounterPos = 0;
   unsigned short    CounterWidth = 0;
   unsigned short    CounterAlign = ALIGN_LEFT;
   unsigned short    CounterFormat = FIELD_FORM_NONE;
+  unsigned short    DescLine = 1;
   unsigned short    DescPos = 0;
   unsigned short    DescWidth = 0;
   unsigned short    DescAlign = ALIGN_LEFT;
   unsigned short    DescFormat = FIELD_FORM_MULTI;
-  static char       *Keywords[11] =
-    {"files.bbs", "NameWidth", "NameFormat", "SizePos", "SizeFormat",
-     "DatePos", "DateFormat", "CounterPos", "CounterFormat", "DescPos", NULL};
+  static char       *Keywords[14] =
+    {"filelist", "NamePos", "NameWidth", "NameFormat", "SizePos",
+     "SizeWidth", "SizeFormat", "DatePos", "DateFormat", "CounterPos", 
+     "CounterFormat", "DescPos", "DescWidth", NULL};
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
 
   /* free current field list */
-  if (Env->Fields_files_bbs)
+  if (Env->Fields_filelist)
   {
-    FreeFieldList(Env->Fields_files_bbs);
-    Env->Fields_files_bbs = NULL;
+    FreeFieldList(Env->Fields_filelist);
+    Env->Fields_filelist = NULL;
   }
 
 
@@ -2128,26 +4031,28 @@ _Bool Cmd_Define_files_bbs(Token_Type *TokenList)
    *  parse tokens
    */
 
-  while (Run && TokenList && TokenList->String)
+  while (Run && TokenList && TokenList->String)     /* loop through tokens */
   {
-    if (Keyword > 1)           /* get value */
+    if (Keyword > 1)     /* get value */
     {
       switch (Keyword)
       {
-        case 2:          /* name width */
-          Run = String2Pos(TokenList->String, &NameWidth, 10, 60);
+        case 2:          /* name position */
+          Run = String2LinePos(TokenList->String, &NameLine, &NamePos, 1, 120);
           break;
 
-        case 3:          /* name format */
+        case 3:          /* name width */
+          Run = String2Pos(TokenList->String, &NameWidth, 12, 60);
+          break;
+
+        case 4:          /* name format */
           if (strcasecmp(TokenList->String, "DOS") == 0)
           {
-            NamePos = 1;
             NameFormat = FIELD_FORM_DOS;
             NameWidth = 12;    /* 8.3 */
           }
           else if (strcasecmp(TokenList->String, "Long") == 0)
           {
-            NamePos = 1;
             NameFormat = FIELD_FORM_LONG;
           }
           else                /* unknown keyword */
@@ -2157,42 +4062,43 @@ _Bool Cmd_Define_files_bbs(Token_Type *TokenList)
           }
           break;
 
-        case 4:          /* size position */
-          Run = String2Pos(TokenList->String, &SizePos, 1, 120);
+        case 5:               /* size position */
+          Run = String2LinePos(TokenList->String, &SizeLine, &SizePos, 1, 120);
           break;
 
-        case 5:          /* size format */
-          if (strcasecmp(TokenList->String, "Bytes-8") == 0)
+        case 6:          /* size width */
+          Run = String2Pos(TokenList->String, &SizeWidth, 4, 12);
+          break;
+
+        case 7:          /* size format */
+          if (strcasecmp(TokenList->String, "Bytes") == 0)
           {
             SizeFormat = FIELD_FORM_BYTES;
-            SizeWidth = 8;
           }
-          else if (strcasecmp(TokenList->String, "Unit-8") == 0)
+          else if (strcasecmp(TokenList->String, "Unit") == 0)
           {
             SizeFormat = FIELD_FORM_UNIT;
-            SizeWidth = 8;
           }
-          else if (strcasecmp(TokenList->String, "Short-8") == 0)
+          else if (strcasecmp(TokenList->String, "Short") == 0)
           {
             SizeFormat = FIELD_FORM_SHORT;
-            SizeWidth = 8;
           }
-          else               /* unknown keyword */
+          else                /* unknown keyword */
           {
             Run = False;
             LogBadKeyword(TokenList->String);
           }
           break;
 
-        case 6:          /* date position */
-          Run = String2Pos(TokenList->String, &DatePos, 1, 120);
+        case 8:          /* date position */
+          Run = String2LinePos(TokenList->String, &DateLine, &DatePos, 1, 120);
           break;
 
-        case 7:          /* date format */
+        case 9:          /* date format */
           if (strcasecmp(TokenList->String, "US") == 0)
           {
             DateFormat = FIELD_FORM_US;
-            DateWidth = 8;
+            DateWidth = 10;
           }
           else if (strcasecmp(TokenList->String, "ISO") == 0)
           {
@@ -2206,11 +4112,11 @@ _Bool Cmd_Define_files_bbs(Token_Type *TokenList)
           }
           break;
 
-        case 8:          /* counter position */
-          Run = String2Pos(TokenList->String, &CounterPos, 1, 120);
+        case 10:      /* counter position */
+          Run = String2LinePos(TokenList->String, &CounterLine, &CounterPos, 1, 120);
           break;
 
-        case 9:          /* counter format */
+        case 11:      /* counter format */
           if (strcasecmp(TokenList->String, "Square-2") == 0)
           {
             CounterFormat = FIELD_FORM_SQUARE;
@@ -2233,24 +4139,28 @@ _Bool Cmd_Define_files_bbs(Token_Type *TokenList)
           }
           break;
 
-        case 10:         /* description position */
-          Run = String2Pos(TokenList->String, &DescPos, 1, 120);
+        case 12:      /* description position */
+          Run = String2LinePos(TokenList->String, &DescLine, &DescPos, 1, 120);
+          break;
+
+        case 13:      /* description width */
+          Run = String2Pos(TokenList->String, &DescWidth, 18, 80);
       }
 
       Keyword = 0;                       /* reset */
     }
-    else                      /* check for known keyword */
+    else                       /* check for known keyword */
     {
       Keyword = GetKeyword(Keywords, TokenList->String);
 
-      if (Keyword == 0)            /* unknown keyword */
+      if (Keyword == 0)                 /* unknown keyword */ 
       {
         Run = False;
         LogBadKeyword(TokenList->String);
       }
     }
 
-    TokenList = TokenList->Next;     /* next token */
+    TokenList = TokenList->Next;        /* next token */
   }
 
 
@@ -2281,32 +4191,84 @@ _Bool Cmd_Define_files_bbs(Token_Type *TokenList)
       Log(L_WARN, "NameWidth argument required!");
     }
 
-    /* if size field is enabled, we need to have position and format */
-    /* same for date and counter fields */
-    if (((SizePos > 0) ^ (SizeFormat != FIELD_FORM_NONE)) ||
-        ((DatePos > 0) ^ (DateFormat != FIELD_FORM_NONE)) ||
-        ((CounterPos > 0) ^ (CounterFormat != FIELD_FORM_NONE)))
+    /* if size field is enabled, we need to have position, width and format */
+    Check = 0;
+    if (SizePos > 0) Check++;
+    if (SizeWidth> 0) Check++;
+    if (SizeFormat != FIELD_FORM_NONE) Check++;
+    if ((Check != 0) && (Check != 3))
     {
       Run = False;
-      Log(L_WARN, "Missing argument (Pos and Format)!");
-    } 
+      Log(L_WARN, "Missing argument for size field!");
+    }
 
-    /* DescPos must be set */
-    if (DescPos == 0)
+    /* if date field is enabled, we need to have position and format */
+    Check = 0;
+    if (DatePos > 0) Check++;
+    if (DateWidth> 0) Check++;
+    if (DateFormat != FIELD_FORM_NONE) Check++;
+    if ((Check != 0) && (Check != 3))
     {
       Run = False;
-      Log(L_WARN, "DescPos argument required!");
+      Log(L_WARN, "Missing argument for date field!");
+    }
+
+    /* if date field is enabled, we need to have position and format */
+    Check = 0;
+    if (CounterPos > 0) Check++;
+    if (CounterWidth> 0) Check++;
+    if (CounterFormat != FIELD_FORM_NONE) Check++;
+    if ((Check != 0) && (Check != 3))
+    {
+      Run = False;
+      Log(L_WARN, "Missing argument for counter field!");
+    }
+
+    /* DescPos and DescWidth must be set */
+    if ((DescPos == 0) || (DescWidth == 0))
+    {
+      Run = False;
+      Log(L_WARN, "DescPos/DescWidth argument required!");
     }
 
     /* description needs to be the last field */
     if (DescPos > 0)
     {
-      if ((DescPos <= SizePos) ||
-          (DescPos <= DatePos) ||
-          (DescPos <= CounterPos))
+      Check = 0;
+
+      /* find largest line number or rightmost position */
+      TempLine = 0;
+      TempPos = 0;
+
+      /* find largest line number */
+      if (NameLine > TempLine) TempLine = NameLine;
+      if (SizeLine > TempLine) TempLine = SizeLine;
+      if (DateLine > TempLine) TempLine = DateLine;
+      if (CounterLine > TempLine) TempLine = CounterLine;
+
+      /* description's line number is the largest */
+      if (DescLine > TempLine)
+      {
+        Check = 1;                      /* ok */
+      }
+
+      /* description's line number matches last line */
+      else if (DescLine == TempLine)
+      {
+        /* find rightmost position */
+        if ((NameLine == TempLine) && (NamePos > TempPos)) TempPos = NamePos;
+        if ((SizeLine == TempLine) && (SizePos > TempPos)) TempPos = SizePos;
+        if ((DateLine == TempLine) && (DatePos > TempPos)) TempPos = DatePos;
+        if ((CounterLine == TempLine) && (CounterPos > TempPos)) TempPos = CounterPos;
+
+        /* description's position is the rightmost */
+        if (DescPos > TempPos) Check = 1;         /* ok */
+      }
+
+      if (Check == 0)         /* syntax problem */
       {
         Run = False;
-        Log(L_WARN, "Description must be at the end of the line!");
+        Log(L_WARN, "Description must be at the end of the (last) line!");
       }
     }
   }
@@ -2318,20 +4280,20 @@ _Bool Cmd_Define_files_bbs(Token_Type *TokenList)
 
   if (Run)
   {
-    if (NamePos > 0) Run &= InsertField(&(Env->Fields_files_bbs), FIELD_NAME,
-      1, NamePos, NameWidth, NameAlign, NameFormat); 
+    if (NamePos > 0) Run &= InsertField(&(Env->Fields_filelist), FIELD_NAME,
+      NameLine, NamePos, NameWidth, NameAlign, NameFormat); 
 
-    if (SizePos > 0) Run &= InsertField(&(Env->Fields_files_bbs), FIELD_SIZE,
-      1, SizePos, SizeWidth, SizeAlign, SizeFormat);
+    if (SizePos > 0) Run &= InsertField(&(Env->Fields_filelist), FIELD_SIZE,
+      SizeLine, SizePos, SizeWidth, SizeAlign, SizeFormat);
 
-    if (DatePos > 0) Run &= InsertField(&(Env->Fields_files_bbs), FIELD_DATE,
-      1, DatePos, DateWidth, DateAlign, DateFormat);
+    if (DatePos > 0) Run &= InsertField(&(Env->Fields_filelist), FIELD_DATE,
+      DateLine, DatePos, DateWidth, DateAlign, DateFormat);
 
-    if (CounterPos > 0) Run &= InsertField(&(Env->Fields_files_bbs), FIELD_COUNTER,
-      1, CounterPos, CounterWidth, CounterAlign, CounterFormat);
+    if (CounterPos > 0) Run &= InsertField(&(Env->Fields_filelist), FIELD_COUNTER,
+      CounterLine, CounterPos, CounterWidth, CounterAlign, CounterFormat);
 
-    if (DescPos > 0) Run &= InsertField(&(Env->Fields_files_bbs), FIELD_DESC,
-      1, DescPos, DescWidth, DescAlign, DescFormat);    
+    if (DescPos > 0) Run &= InsertField(&(Env->Fields_filelist), FIELD_DESC,
+      DescLine, DescPos, DescWidth, DescAlign, DescFormat);    
   }
 
   if ((!Run) || (Keyword > 0))
@@ -2349,339 +4311,307 @@ _Bool Cmd_Define_files_bbs(Token_Type *TokenList)
 
 
 /*
- *  set format of filelist
- *  Syntax: filelist ...
+ *  define syntax of file description file
+ *  Syntax: Define [files.bbs ...]
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Cmd_Define_filelist(Token_Type *TokenList)
+_Bool Cmd_Define(Token_Type *TokenList)
 {
   _Bool             Flag = False;       /* return value */
   _Bool             Run = True;         /* control flag */
-  unsigned short    Keyword = 0;        /* keyword ID */
-  unsigned short    Check;              /* counter for checking stuff */
-  unsigned short    TempLine;
-  unsigned short    TempPos;
-  unsigned short    NameLine = 1;
-  unsigned short    NamePos = 1;
-  unsigned short    NameWidth = 0;
-  unsigned short    NameAlign = ALIGN_LEFT;
-  unsigned short    NameFormat = FIELD_FORM_NONE;
-  unsigned short    SizeLine = 1;
-  unsigned short    SizePos = 0;
-  unsigned short    SizeWidth = 0;
-  unsigned short    SizeAlign = ALIGN_RIGHT;
-  unsigned short    SizeFormat = FIELD_FORM_NONE;
-  unsigned short    DateLine = 1;
-  unsigned short    DatePos = 0;
-  unsigned short    DateWidth = 0;
-  unsigned short    DateAlign = ALIGN_LEFT;
-  unsigned short    DateFormat = FIELD_FORM_NONE;
-  unsigned short    CounterLine = 1;
-  unsigned short    CounterPos = 0;
-  unsigned short    CounterWidth = 0;
-  unsigned short    CounterAlign = ALIGN_LEFT;
-  unsigned short    CounterFormat = FIELD_FORM_NONE;
-  unsigned short    DescLine = 1;
-  unsigned short    DescPos = 0;
-  unsigned short    DescWidth = 0;
-  unsigned short    DescAlign = ALIGN_LEFT;
-  unsigned short    DescFormat = FIELD_FORM_MULTI;
-  static char       *Keywords[14] =
-    {"filelist", "NamePos", "NameWidth", "NameFormat", "SizePos",
-     "SizeWidth", "SizeFormat", "DatePos", "DateFormat", "CounterPos", 
-     "CounterFormat", "DescPos", "DescWidth", NULL};
+  unsigned short    Get = 0;            /* mode control */
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
 
-  /* free current field list */
-  if (Env->Fields_filelist)
+  /*
+   *  This is just the pre-parser to find out which description file
+   *  will be defined and to call the according parser function.
+   */
+
+
+  /*
+   *  parse tokens
+   */
+
+  while (Run && TokenList && TokenList->String)
   {
-    FreeFieldList(Env->Fields_filelist);
-    Env->Fields_filelist = NULL;
+    if (Get == 1)                  /* get value: file */
+    {
+      if (strcasecmp(TokenList->String, "files.bbs") == 0)
+      {
+        Flag = Cmd_Define_files_bbs(TokenList);
+        TokenList = NULL;                 /* end loop */
+      }
+      else if (strcasecmp(TokenList->String, "Filelist") == 0)
+      {
+        Flag = Cmd_Define_filelist(TokenList);
+        TokenList = NULL;                 /* end loop */
+      }
+      else                    /* unknown keyword */
+      {
+        Run = False;
+        LogBadKeyword(TokenList->String);
+      }
+
+      Get = 0;                       /* reset */      
+    }
+    else if (strcasecmp(TokenList->String, "Define") == 0)   /* keyword */
+    {
+      Get = 1;
+    }
+    else                                               /* unknown */
+    {
+      Run = False;
+    }
+
+    if (TokenList) TokenList = TokenList->Next;     /* goto to next token */
+  }
+
+
+  /*
+   *  check parser results
+   */
+
+  if ((Run == False) || (Get > 0))
+  {
+    LogCfgError();
   }
 
+  return Flag;
+}
+
+
+
+/*
+ *  add directory to filelist (shared with mfreq-index)
+ *  Syntax: FileArea Name <name> Path <path> [Info <description>]
+ *            [PW <password>] [Depth <depth>] [AutoMagic]
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool Cmd_SharedFileArea(Token_Type *TokenList)
+{
+  _Bool             Flag = False;       /* return value */
+  _Bool             Run = True;         /* control flag */
+  unsigned short    Keyword = 0;        /* keyword ID */
+  char              *Name = NULL;       /* fileecho name */
+  char              *Path = NULL;       /* fileecho path */
+  char              *Info = NULL;       /* fileecho description */
+  char              *Password = NULL;   /* password (file index) */
+  int               Depth = 0;          /* depth of recursion */
+  _Bool             AutoMagic = False;  /* AutoMagic (file index) */
+  static char       *Keywords[8] =
+    {"SharedFileArea", "Name", "Path", "Info", "PW",
+     "Depth", "AutoMagic", NULL};
+
+  /* sanity check */
+  if (TokenList == NULL) return Flag;
+
 
   /*
    *  parse tokens
    */
 
-  while (Run && TokenList && TokenList->String)     /* loop through tokens */
+  while (Run && TokenList && TokenList->String)
   {
-    if (Keyword > 1)     /* get value */
+    if (Keyword > 0)        /* get value */
     {
       switch (Keyword)
       {
-        case 2:          /* name position */
-          Run = String2LinePos(TokenList->String, &NameLine, &NamePos, 1, 120);
-          break;
-
-        case 3:          /* name width */
-          Run = String2Pos(TokenList->String, &NameWidth, 12, 60);
-          break;
-
-        case 4:          /* name format */
-          if (strcasecmp(TokenList->String, "DOS") == 0)
-          {
-            NameFormat = FIELD_FORM_DOS;
-            NameWidth = 12;    /* 8.3 */
-          }
-          else if (strcasecmp(TokenList->String, "Long") == 0)
-          {
-            NameFormat = FIELD_FORM_LONG;
-          }
-          else                /* unknown keyword */
-          {
-            Run = False;
-            LogBadKeyword(TokenList->String);
-          }
-          break;
-
-        case 5:               /* size position */
-          Run = String2LinePos(TokenList->String, &SizeLine, &SizePos, 1, 120);
-          break;
-
-        case 6:          /* size width */
-          Run = String2Pos(TokenList->String, &SizeWidth, 4, 12);
-          break;
-
-        case 7:          /* size format */
-          if (strcasecmp(TokenList->String, "Bytes") == 0)
-          {
-            SizeFormat = FIELD_FORM_BYTES;
-          }
-          else if (strcasecmp(TokenList->String, "Unit") == 0)
-          {
-            SizeFormat = FIELD_FORM_UNIT;
-          }
-          else if (strcasecmp(TokenList->String, "Short") == 0)
-          {
-            SizeFormat = FIELD_FORM_SHORT;
-          }
-          else                /* unknown keyword */
-          {
-            Run = False;
-            LogBadKeyword(TokenList->String);
-          }
-          break;
-
-        case 8:          /* date position */
-          Run = String2LinePos(TokenList->String, &DateLine, &DatePos, 1, 120);
+        case 2:     /* name */
+          Name = TokenList->String;
           break;
-
-        case 9:          /* date format */
-          if (strcasecmp(TokenList->String, "US") == 0)
-          {
-            DateFormat = FIELD_FORM_US;
-            DateWidth = 10;
-          }
-          else if (strcasecmp(TokenList->String, "ISO") == 0)
-          {
-            DateFormat = FIELD_FORM_ISO;
-            DateWidth = 10;
-          }
-          else                /* unknown keyword */
-          {
-            Run = False;
-            LogBadKeyword(TokenList->String);
-          }
+      
+        case 3:     /* path */
+          Path = TokenList->String;
           break;
 
-        case 10:      /* counter position */
-          Run = String2LinePos(TokenList->String, &CounterLine, &CounterPos, 1, 120);
+        case 4:     /* info */
+          Info = TokenList->String;
           break;
 
-        case 11:      /* counter format */
-          if (strcasecmp(TokenList->String, "Square-2") == 0)
-          {
-            CounterFormat = FIELD_FORM_SQUARE;
-            CounterWidth = 4;
-          }
-          else if (strcasecmp(TokenList->String, "Square-3") == 0)
-          {
-            CounterFormat = FIELD_FORM_SQUARE;
-            CounterWidth = 5;
-          }
-          else if (strcasecmp(TokenList->String, "Square-4") == 0)
-          {
-            CounterFormat = FIELD_FORM_SQUARE;
-            CounterWidth = 6;
-          }
-          else                /* unknown keyword */
+        case 6:     /* depth */
+          Depth = Str2Long(TokenList->String);
+          if ((Depth < 0) || (Depth > 10))    /* invalid value */
           {
-            Run = False;
-            LogBadKeyword(TokenList->String);
+            Log(L_WARN, "Invalid recursion depth!");
+            Run = False;           /* end loop & signal problem */
           }
           break;
 
-        case 12:      /* description position */
-          Run = String2LinePos(TokenList->String, &DescLine, &DescPos, 1, 120);
+        case 5:     /* password */
+          Password = TokenList->String;
           break;
-
-        case 13:      /* description width */
-          Run = String2Pos(TokenList->String, &DescWidth, 18, 80);
       }
 
-      Keyword = 0;                       /* reset */
+      Keyword = 0;             /* reset */
     }
-    else                       /* check for known keyword */
+    else                   /* get keyword */
     {
       Keyword = GetKeyword(Keywords, TokenList->String);
 
-      if (Keyword == 0)                 /* unknown keyword */ 
+      switch (Keyword)        /* keywords without data */
       {
-        Run = False;
-        LogBadKeyword(TokenList->String);
+        case 0:               /* unknown keyword */
+          Run = False;
+          LogBadKeyword(TokenList->String);
+          break;
+
+        case 1:               /* command itself */
+          /* simply skip it */
+          Keyword = 0;        /* reset keyword */
+          break;
+
+        case 7:               /* automagic switch */
+          AutoMagic = True;   /* just for file index */
+          Keyword = 0;        /* reset keyword */
       }
     }
 
-    TokenList = TokenList->Next;        /* next token */
+    TokenList = TokenList->Next;     /* goto to next token */
   }
 
 
   /*
-   *  check values
+   *  check parser results
+   */
+
+  if ((Run == False) || (Keyword > 0) || (Name == NULL) || (Path == NULL))
+  {
+    Run = False;
+    LogCfgError();
+  }
+
+
+  /*
+   *  process
    */
 
   if (Run)
   {
-    /* FileFormat must be set */
-    if (NameFormat == FIELD_FORM_NONE)
-    {
-      Run = False;
-      Log(L_WARN, "NameFormat argument required!");
-    }
+    /* settings for file index */
+    Env->IndexPW = Password;
+    Env->IndexAutoMagic = AutoMagic;
 
-    /* for DOS filenames only a width of 12 is valid */
-    if ((NameFormat == FIELD_FORM_DOS) && (NameWidth != 12))
-    {
-      Run = False;
-      Log(L_WARN, "Wrong NameWidth!");
-    }
+    /* open path and process files */
+    if ((Env->Workers > 1) && Env->List && (Env->IndexFilepath == NULL))
+      Flag = StartWorker(Name, Path, Info, Depth);
+    else
+      Flag = ManagePath(Name, Path, Info, Depth, False);
 
-    /* long filenames require the width option */
-    if ((NameFormat == FIELD_FORM_LONG) && (NameWidth == 0))
-    {
-      Run = False;
-      Log(L_WARN, "NameWidth argument required!");
-    }
+    Env->IndexPW = NULL;
+    Env->IndexAutoMagic = False;
+  }
 
-    /* if size field is enabled, we need to have position, width and format */
-    Check = 0;
-    if (SizePos > 0) Check++;
-    if (SizeWidth> 0) Check++;
-    if (SizeFormat != FIELD_FORM_NONE) Check++;
-    if ((Check != 0) && (Check != 3))
-    {
-      Run = False;
-      Log(L_WARN, "Missing argument for size field!");
-    }
+  return Flag;
+}
 
-    /* if date field is enabled, we need to have position and format */
-    Check = 0;
-    if (DatePos > 0) Check++;
-    if (DateWidth> 0) Check++;
-    if (DateFormat != FIELD_FORM_NONE) Check++;
-    if ((Check != 0) && (Check != 3))
-    {
-      Run = False;
-      Log(L_WARN, "Missing argument for date field!");
-    }
 
-    /* if date field is enabled, we need to have position and format */
-    Check = 0;
-    if (CounterPos > 0) Check++;
-    if (CounterWidth> 0) Check++;
-    if (CounterFormat != FIELD_FORM_NONE) Check++;
-    if ((Check != 0) && (Check != 3))
-    {
-      Run = False;
-      Log(L_WARN, "Missing argument for counter field!");
-    }
 
-    /* DescPos and DescWidth must be set */
-    if ((DescPos == 0) || (DescWidth == 0))
-    {
-      Run = False;
-      Log(L_WARN, "DescPos/DescWidth argument required!");
-    }
+/*
+ *  add directory to filelist
+ *  Syntax: FileArea <name> Path <path> [Info <description>]
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
 
-    /* description needs to be the last field */
-    if (DescPos > 0)
-    {
-      Check = 0;
+_Bool Cmd_FileArea(Token_Type *TokenList)
+{
+  _Bool             Flag = False;       /* return value */
+  _Bool             Run = True;         /* control flag */
+  unsigned short    Keyword = 0;        /* keyword ID */
+  char              *Name = NULL;       /* fileecho name */
+  char              *Path = NULL;       /* fileecho path */
+  char              *Info = NULL;       /* fileecho description */
+  int               Depth = 0;          /* depth of recursion */
+  static char       *Keywords[5] =
+    {"FileArea", "Path", "Info", "Depth", NULL};
 
-      /* find largest line number or rightmost position */
-      TempLine = 0;
-      TempPos = 0;
+  /* sanity check */
+  if (TokenList == NULL) return Flag;
 
-      /* find largest line number */
-      if (NameLine > TempLine) TempLine = NameLine;
-      if (SizeLine > TempLine) TempLine = SizeLine;
-      if (DateLine > TempLine) TempLine = DateLine;
-      if (CounterLine > TempLine) TempLine = CounterLine;
 
-      /* description's line number is the largest */
-      if (DescLine > TempLine)
+  /*
+   *  parse tokens
+   */
+
+  while (Run && TokenList && TokenList->String)
+  {
+    if (Keyword > 0)        /* get value */
+    {
+      switch (Keyword)
       {
-        Check = 1;                      /* ok */
-      }
+        case 1:     /* name */
+          Name = TokenList->String;
+          break;
+      
+        case 2:     /* path */
+          Path = TokenList->String;
+          break;
 
-      /* description's line number matches last line */
-      else if (DescLine == TempLine)
-      {
-        /* find rightmost position */
-        if ((NameLine == TempLine) && (NamePos > TempPos)) TempPos = NamePos;
-        if ((SizeLine == TempLine) && (SizePos > TempPos)) TempPos = SizePos;
-        if ((DateLine == TempLine) && (DatePos > TempPos)) TempPos = DatePos;
-        if ((CounterLine == TempLine) && (CounterPos > TempPos)) TempPos = CounterPos;
+        case 3:     /* info */
+          Info = TokenList->String;
+          break;
 
-        /* description's position is the rightmost */
-        if (DescPos > TempPos) Check = 1;         /* ok */
+        case 4:     /* depth */
+          Depth = Str2Long(TokenList->String);
+          if ((Depth < 0) || (Depth > 10))    /* invalid value */
+          {
+            Log(L_WARN, "Invalid recursion depth!");
+            Run = False;           /* end loop & signal problem */
+          }
+          break;
       }
 
-      if (Check == 0)         /* syntax problem */
+      Keyword = 0;             /* reset */
+    }
+    else                   /* get keyword */
+    {
+      Keyword = GetKeyword(Keywords, TokenList->String);
+
+      if (Keyword == 0)       /* unknown keyword */
       {
         Run = False;
-        Log(L_WARN, "Description must be at the end of the (last) line!");
+        LogBadKeyword(TokenList->String);
       }
     }
+
+    TokenList = TokenList->Next;     /* goto to next token */
   }
 
 
   /*
-   *  add info fields to global list
+   *  check parser results
    */
 
-  if (Run)
+  if ((Run == False) || (Keyword > 0) || (Name == NULL) || (Path == NULL))
   {
-    if (NamePos > 0) Run &= InsertField(&(Env->Fields_filelist), FIELD_NAME,
-      NameLine, NamePos, NameWidth, NameAlign, NameFormat); 
-
-    if (SizePos > 0) Run &= InsertField(&(Env->Fields_filelist), FIELD_SIZE,
-      SizeLine, SizePos, SizeWidth, SizeAlign, SizeFormat);
-
-    if (DatePos > 0) Run &= InsertField(&(Env->Fields_filelist), FIELD_DATE,
-      DateLine, DatePos, DateWidth, DateAlign, DateFormat);
+    Run = False;
+    LogCfgError();
+  }
 
-    if (CounterPos > 0) Run &= InsertField(&(Env->Fields_filelist), FIELD_COUNTER,
-      CounterLine, CounterPos, CounterWidth, CounterAlign, CounterFormat);
 
-    if (DescPos > 0) Run &= InsertField(&(Env->Fields_filelist), FIELD_DESC,
-      DescLine, DescPos, DescWidth, DescAlign, DescFormat);    
-  }
+  /*
+   *  process
+   */
 
-  if ((!Run) || (Keyword > 0))
-  {
-    LogCfgError();
-  }
-  else
+  if (Run)
   {
-    Flag = True;    /* signal success */
+    /* open path and process files */
+    if ((Env->Workers > 1) && Env->List && (Env->IndexFilepath == NULL))
+      Flag = StartWorker(Name, Path, Info, Depth);
+    else
+      Flag = ManagePath(Name, Path, Info, Depth, False);
   }
 
   return Flag;
@@ -2690,28 +4620,24 @@ _Bool Cmd_Define_filelist(Token_Type *TokenList)
 
 
 /*
- *  define syntax of file description file
- *  Syntax: Define [files.bbs ...]
+ *  add text to filelist
+ *  Syntax: AddText <text>
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Cmd_Define(Token_Type *TokenList)
+_Bool Cmd_AddText(Token_Type *TokenList)
 {
   _Bool             Flag = False;       /* return value */
   _Bool             Run = True;         /* control flag */
   unsigned short    Get = 0;            /* mode control */
+  Token_Type        *TextToken = NULL;
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
 
-  /*
-   *  This is just the pre-parser to find out which description file
-   *  will be defined and to call the according parser function.
-   */
-
 
   /*
    *  parse tokens
@@ -2719,27 +4645,12 @@ _Bool Cmd_Define(Token_Type *TokenList)
 
   while (Run && TokenList && TokenList->String)
   {
-    if (Get == 1)                  /* get value: file */
+    if (Get == 1)                  /* get value: text */
     {
-      if (strcasecmp(TokenList->String, "files.bbs") == 0)
-      {
-        Flag = Cmd_Define_files_bbs(TokenList);
-        TokenList = NULL;                 /* end loop */
-      }
-      else if (strcasecmp(TokenList->String, "Filelist") == 0)
-      {
-        Flag = Cmd_Define_filelist(TokenList);
-        TokenList = NULL;                 /* end loop */
-      }
-      else                    /* unknown keyword */
-      {
-        Run = False;
-        LogBadKeyword(TokenList->String);
-      }
-
+      TextToken = TokenList;
       Get = 0;                       /* reset */      
     }
-    else if (strcasecmp(TokenList->String, "Define") == 0)   /* keyword */
+    else if (strcasecmp(TokenList->String, "AddText") == 0)   /* text */
     {
       Get = 1;
     }
@@ -2748,7 +4659,7 @@ _Bool Cmd_Define(Token_Type *TokenList)
       Run = False;
     }
 
-    if (TokenList) TokenList = TokenList->Next;     /* goto to next token */
+    TokenList = TokenList->Next;     /* goto to next token */
   }
 
 
@@ -2756,38 +4667,204 @@ _Bool Cmd_Define(Token_Type *TokenList)
    *  check parser results
    */
 
-  if ((Run == False) || (Get > 0))
+  if ((Run == False) || (Get > 0) || (TextToken == NULL))
   {
+    Run = False;
     LogCfgError();
   }
 
+
+  /*
+   *  process
+   */
+
+  if (Run)
+  {
+    if (Env->List)             /* if filelist is opened */
+    {
+      /* add text to filelist (after areas still being processed) */
+      snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1, "%s\n",
+        TextToken->String);
+      if (Env->WorkerList)
+      {
+        if (CheckWorkers()) Flag = QueueText(TempBuffer);
+      }
+      else if (fputs(TempBuffer, Env->List) >= 0) Flag = True;
+    }
+  }
+
   return Flag;
 }
 
 
 
 /*
- *  add directory to filelist (shared with mfreq-index)
- *  Syntax: FileArea Name <name> Path <path> [Info <description>]
- *            [PW <password>] [Depth <depth>] [AutoMagic]
+ *  open filelist
+ *  Syntax: FileList <filepath> [CSV <filepath>] [JSON <filepath>]
+ *            [HTML <filepath>] [NewFiles <filepath> <days>]
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Cmd_SharedFileArea(Token_Type *TokenList)
+_Bool Cmd_FileList(Token_Type *TokenList)
 {
-  _Bool             Flag = False;       /* return value */
-  _Bool             Run = True;         /* control flag */
-  unsigned short    Keyword = 0;        /* keyword ID */
-  char              *Name = NULL;       /* fileecho name */
-  char              *Path = NULL;       /* fileecho path */
-  char              *Info = NULL;       /* fileecho description */
-  int               Depth = 0;          /* depth of recursion */
-  static char       *Keywords[8] =
-    {"SharedFileArea", "Name", "Path", "Info", "PW",
-     "Depth", "AutoMagic", NULL};
+  _Bool             Flag = False;            /* return value */
+  _Bool             Run = True;              /* control flag */
+  unsigned short    Get = 0;                 /* mode control */
+  unsigned short    Keyword = 0;             /* keyword ID */
+  unsigned short    n;                       /* counter */
+  Token_Type        *FilepathToken = NULL;
+  long              Days = -1;               /* days of new files */
+  Token_Type        *SinkToken[SINKS] = {NULL, NULL, NULL, NULL};
+  static char       *Keywords[6] =
+    {"FileList", "CSV", "JSON", "HTML", "NewFiles", NULL};
+
+  /* sanity check */
+  if (TokenList == NULL) return Flag;
+
+
+  /*
+   *  parse tokens
+   */
+
+  while (Run && TokenList && TokenList->String)
+  {
+    if (Get == 1)                  /* get value: filepath */
+    {
+      FilepathToken = TokenList;
+      Get = 0;                       /* reset */      
+    }
+    else if (Get == SINKS + 2)     /* get value: days of new files */
+    {
+      Days = Str2Long(TokenList->String);
+      Get = 0;                       /* reset */
+    }
+    else if (Get == SINK_NEW + 2)  /* get value: filepath of new files */
+    {
+      SinkToken[SINK_NEW] = TokenList;
+      Get = SINKS + 2;               /* days follow */
+    }
+    else if (Get > 1)              /* get value: filepath of sink */
+    {
+      SinkToken[Get - 2] = TokenList;
+      Get = 0;                       /* reset */
+    }
+    else                           /* keywords */
+    {
+      Keyword = GetKeyword(Keywords, TokenList->String);
+
+      switch (Keyword)
+      {
+        case 0:       /* unknown keyword */
+          Run = False;
+          LogBadKeyword(TokenList->String);
+          break;
+
+        case 1:       /* filepath */
+          Get = 1;
+          break;
+
+        case 2:       /* CSV */
+          Get = SINK_CSV + 2;
+          break;
+
+        case 3:       /* JSON */
+          Get = SINK_JSON + 2;
+          break;
+
+        case 4:       /* HTML */
+          Get = SINK_HTML + 2;
+          break;
+
+        case 5:       /* new files */
+          Get = SINK_NEW + 2;
+          break;
+      }
+    }
+
+    TokenList = TokenList->Next;     /* goto to next token */
+  }
+
+
+  /*
+   *  check parser results
+   */
+
+  if ((Run == False) || (Get > 0) || (FilepathToken == NULL) ||
+      (SinkToken[SINK_NEW] && (Days < 0)))
+  {
+    Run = False;
+    LogCfgError();
+  }
+
+  if (Run)
+  {
+    if (Env->Fields_filelist == NULL)
+    {
+      Run = False;
+      Log(L_WARN, "No format for filelist specified!");
+      LogCfgError();
+    }
+  }
+
+
+  /*
+   *  process
+   */
+
+  if (Run)
+  {
+    /* first close old filelist */
+    if (Env->List) Run = CloseFilelist();
+  }
+
+  if (Run)
+  {
+    Env->ListFilepath = FilepathToken->String;   /* move string */
+    FilepathToken->String = NULL;
+
+    for (n = 0; n < SINKS; n++)     /* sinks */
+    {
+      if (SinkToken[n] == NULL) continue;
+      Env->SinkFilepath[n] = SinkToken[n]->String;   /* move string */
+      SinkToken[n]->String = NULL;
+    }
+
+    /* cutoff time of new files */
+    if (Days >= 0) Env->NewFilesTime = time(NULL) - (Days * 60 * 60 * 24);
+
+    /* reset statistics */
+    Env->Files = 0;
+    Env->Bytes = 0;
+    Env->Checks_files_bbs = 0;
+    Env->Writes_files_bbs = 0;
+
+    Flag = OpenFilelist();
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  reset stuff
+ *  Syntax: Reset [InfoMode] [Excludes] 
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool Cmd_Reset(Token_Type *TokenList)
+{
+  _Bool                  Flag = False;       /* return value */
+  _Bool                  Run = True;         /* control flag */
+  unsigned short         Keyword = 0;        /* keyword ID */
+  static char            *Keywords[4] =
+    {"Reset", "InfoMode", "Excludes", NULL};
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
@@ -2799,57 +4876,32 @@ _Bool Cmd_SharedFileArea(Token_Type *TokenList)
 
   while (Run && TokenList && TokenList->String)
   {
-    if (Keyword > 0)        /* get value */
-    {
-      switch (Keyword)
-      {
-        case 2:     /* name */
-          Name = TokenList->String;
-          break;
-      
-        case 3:     /* path */
-          Path = TokenList->String;
-          break;
-
-        case 4:     /* info */
-          Info = TokenList->String;
-          break;
-
-        case 6:     /* depth */
-          Depth = Str2Long(TokenList->String);
-          if ((Depth < 0) || (Depth > 10))    /* invalid value */
-          {
-            Log(L_WARN, "Invalid recursion depth!");
-            Run = False;           /* end loop & signal problem */
-          }
-          break;
-
-        /* Other keywords with values belong to mfreq-index,
-           so we simply skip them. */
-      }
+    Keyword = GetKeyword(Keywords, TokenList->String);
 
-      Keyword = 0;             /* reset */
-    }
-    else                   /* get keyword */
+    switch (Keyword)           /* keywords without data */
     {
-      Keyword = GetKeyword(Keywords, TokenList->String);
+      case 0:       /* unknown keyword */
+        Run = False;
+        LogBadKeyword(TokenList->String);
+        break;
 
-      switch (Keyword)        /* keywords without data */
-      {
-        case 0:               /* unknown keyword */
-          Run = False;
-          LogBadKeyword(TokenList->String);
-          break;
+      case 1:       /* command itself */
+        /* just skip */
+        break;
 
-        case 1:               /* command itself */
-          /* simply skip it */
-          Keyword = 0;        /* reset keyword */
-          break;
+      case 2:       /* InfoMode */
+        Env->InfoMode = INFO_NONE;      /* set switches to default */
+        /* unset bits for local switches set by InfoMode */
+        Env->CfgSwitches &= ~(SW_SI_UNITS | SW_IEC_UNITS | SW_ANY_CASE);
+        break;
 
-        case 7:               /* automagic switch */
-          /* skip it (mfreq-index) */
-          Keyword = 0;        /* reset keyword */
-      }
+      case 3:       /* Excludes */
+        if (Env->ExcludeList)           /* clear file excludes */
+        {
+          FreeExcludeList(Env->ExcludeList);
+          Env->ExcludeList = NULL;
+        }
+        break;
     }
 
     TokenList = TokenList->Next;     /* goto to next token */
@@ -2860,21 +4912,13 @@ _Bool Cmd_SharedFileArea(Token_Type *TokenList)
    *  check parser results
    */
 
-  if ((Run == False) || (Keyword > 0) || (Name == NULL) || (Path == NULL))
+  if (Run == False)
   {
-    Run = False;
     LogCfgError();
   }
-
-
-  /*
-   *  process
-   */
-
-  if (Run)
+  else
   {
-    /* open path and process files */
-    Flag = ManagePath(Name, Path, Info, Depth, False);
+    Flag = True;       /* signal success */
   }
 
   return Flag;
@@ -2883,25 +4927,26 @@ _Bool Cmd_SharedFileArea(Token_Type *TokenList)
 
 
 /*
- *  add directory to filelist
- *  Syntax: FileArea <name> Path <path> [Info <description>]
+ *  file info mode
+ *  Syntax: InfoMode [dir.bbs] [files.bbs] [descript.ion] [Update] [Strict]
+ *                   |Skips] [Relax] [SI-Units] [IEC-Units] |AnyCase]
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Cmd_FileArea(Token_Type *TokenList)
+_Bool Cmd_InfoMode(Token_Type *TokenList)
 {
-  _Bool             Flag = False;       /* return value */
-  _Bool             Run = True;         /* control flag */
-  unsigned short    Keyword = 0;        /* keyword ID */
-  char              *Name = NULL;       /* fileecho name */
-  char              *Path = NULL;       /* fileecho path */
-  char              *Info = NULL;       /* fileecho description */
-  int               Depth = 0;          /* depth of recursion */
-  static char       *Keywords[5] =
-    {"FileArea", "Path", "Info", "Depth", NULL};
+  _Bool                  Flag = False;       /* return value */
+  _Bool                  Run = True;         /* control flag */
+  unsigned short         Keyword = 0;        /* keyword ID */
+  unsigned short         Mode = INFO_NONE;
+  unsigned short         Switches = SW_NONE;
+  static char            *Keywords[12] =
+    {"InfoMode", "dir.bbs", "files.bbs", "Update", "Strict",
+     "Skips", "Relax", "SI-Units", "IEC-Units", "AnyCase",
+     "descript.ion", NULL};
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
@@ -2913,43 +4958,63 @@ _Bool Cmd_FileArea(Token_Type *TokenList)
 
   while (Run && TokenList && TokenList->String)
   {
-    if (Keyword > 0)        /* get value */
+    Keyword = GetKeyword(Keywords, TokenList->String);
+
+    switch (Keyword)      /* keywords without data */
     {
-      switch (Keyword)
-      {
-        case 1:     /* name */
-          Name = TokenList->String;
-          break;
-      
-        case 2:     /* path */
-          Path = TokenList->String;
-          break;
+      case 0:       /* unknown keyword */
+        Run = False;
+        LogBadKeyword(TokenList->String);
+        break;
 
-        case 3:     /* info */
-          Info = TokenList->String;
-          break;
+      case 1:       /* command itself */
+        /* just skip */
+        break;
 
-        case 4:     /* depth */
-          Depth = Str2Long(TokenList->String);
-          if ((Depth < 0) || (Depth > 10))    /* invalid value */
-          {
-            Log(L_WARN, "Invalid recursion depth!");
-            Run = False;           /* end loop & signal problem */
-          }
-          break;
-      }
+      case 2:       /* dir.bbs */
+        Mode |= INFO_DIR_BBS;
+        break;
 
-      Keyword = 0;             /* reset */
-    }
-    else                   /* get keyword */
-    {
-      Keyword = GetKeyword(Keywords, TokenList->String);
+      case 3:       /* files.bbs */
+        Mode |= INFO_FILES_BBS;
+        if (Env->Fields_files_bbs == NULL)
+        {
+          Log(L_WARN, "Format of files.bbs not defined!");
+          Run = False;
+        }
+        break;
 
-      if (Keyword == 0)       /* unknown keyword */
-      {
-        Run = False;
-        LogBadKeyword(TokenList->String);
-      }
+      case 4:       /* update */
+        Mode |= INFO_UPDATE;
+        break;
+
+      case 5:       /* strict */
+        Mode |= INFO_STRICT;
+        break;
+
+      case 6:       /* skips */
+        Mode |= INFO_SKIPS;
+        break;
+
+      case 7:       /* relax */
+        Mode |= INFO_RELAX;
+        break;
+
+      case 8:       /* SI units */
+        Switches |= SW_SI_UNITS;
+        break;
+
+      case 9:       /* IEC units for output */
+        Switches |= SW_IEC_UNITS;
+        break;
+
+      case 10:      /* any case */
+        Switches |= SW_ANY_CASE;
+        break;
+
+      case 11:      /* descript.ion */
+        Mode |= INFO_DESCRIPT_ION;
+        break;
     }
 
     TokenList = TokenList->Next;     /* goto to next token */
@@ -2960,21 +5025,17 @@ _Bool Cmd_FileArea(Token_Type *TokenList)
    *  check parser results
    */
 
-  if ((Run == False) || (Keyword > 0) || (Name == NULL) || (Path == NULL))
+  if (Run == False)           /* error */
   {
-    Run = False;
     LogCfgError();
   }
-
-
-  /*
-   *  process
-   */
-
-  if (Run)
+  else                        /* success */
   {
-    /* open path and process files */
-    Flag = ManagePath(Name, Path, Info, Depth, False);
+    Env->InfoMode = Mode;               /* set new infomode */
+    /* unset bits for local switches set by InfoMode */
+    Env->CfgSwitches &= ~(SW_SI_UNITS | SW_IEC_UNITS | SW_ANY_CASE);
+    Env->CfgSwitches |= Switches;       /* update switches */
+    Flag = True;
   }
 
   return Flag;
@@ -2983,20 +5044,20 @@ _Bool Cmd_FileArea(Token_Type *TokenList)
 
 
 /*
- *  add text to filelist
- *  Syntax: AddText <text>
+ *  exclude specific filename
+ *  Syntax: Exclude <name or pattern>
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Cmd_AddText(Token_Type *TokenList)
+_Bool Cmd_Exclude(Token_Type *TokenList)
 {
   _Bool             Flag = False;       /* return value */
   _Bool             Run = True;         /* control flag */
   unsigned short    Get = 0;            /* mode control */
-  Token_Type        *TextToken = NULL;
+  Token_Type        *NameToken = NULL;
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
@@ -3008,16 +5069,17 @@ _Bool Cmd_AddText(Token_Type *TokenList)
 
   while (Run && TokenList && TokenList->String)
   {
-    if (Get == 1)                  /* get value: text */
+    if (Get == 1)                  /* get value: name */
     {
-      TextToken = TokenList;
+      NameToken = TokenList;
+
       Get = 0;                       /* reset */      
     }
-    else if (strcasecmp(TokenList->String, "AddText") == 0)   /* text */
+    else if (strcasecmp(TokenList->String, "Exclude") == 0)   /* name */
     {
       Get = 1;
     }
-    else                                               /* unknown */
+    else                                                 /* unknown */
     {
       Run = False;
     }
@@ -3030,7 +5092,7 @@ _Bool Cmd_AddText(Token_Type *TokenList)
    *  check parser results
    */
 
-  if ((Run == False) || (Get > 0) || (TextToken == NULL))
+  if ((Run == False) || (Get > 0) || (NameToken == NULL))
   {
     Run = False;
     LogCfgError();
@@ -3043,13 +5105,8 @@ _Bool Cmd_AddText(Token_Type *TokenList)
 
   if (Run)
   {
-    if (Env->List)             /* if filelist is opened */
-    {
-      /* add text to filelist */
-      snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1, "%s\n",
-        TextToken->String);
-      if (fputs(TempBuffer, Env->List) >= 0) Flag = True;
-    }
+    /* add name to global exclude list */
+    Flag = AddExcludeElement(NameToken->String);
   }
 
   return Flag;
@@ -3058,24 +5115,33 @@ _Bool Cmd_AddText(Token_Type *TokenList)
 
 
 /*
- *  open filelist
- *  Syntax: FileList <filepath>
+ *  open logfile
+ *  Syntax: LogFile <filepath> [Flush <seconds>]
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Cmd_FileList(Token_Type *TokenList)
+_Bool Cmd_LogFile(Token_Type *TokenList)
 {
   _Bool             Flag = False;            /* return value */
   _Bool             Run = True;              /* control flag */
   unsigned short    Get = 0;                 /* mode control */
   Token_Type        *FilepathToken = NULL;
+  long              Seconds = LOG_FLUSH;     /* flush interval */
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
 
+  /* command line takes precedence */
+  /* also prevent any additional logfile command */
+  if (Env->LogFilepath)
+  {
+    Log(L_WARN, "Logfile already set!");
+    return Flag;
+  }
+
 
   /*
    *  parse tokens
@@ -3088,10 +5154,19 @@ _Bool Cmd_FileList(Token_Type *TokenList)
       FilepathToken = TokenList;
       Get = 0;                       /* reset */      
     }
-    else if (strcasecmp(TokenList->String, "FileList") == 0)   /* filepath */
+    else if (Get == 2)             /* get value: seconds */
+    {
+      Seconds = Str2Long(TokenList->String);
+      Get = 0;                       /* reset */
+    }
+    else if (strcasecmp(TokenList->String, "LogFile") == 0)   /* filepath */
     {
       Get = 1;
     }
+    else if (strcasecmp(TokenList->String, "Flush") == 0)     /* seconds */
+    {
+      Get = 2;
+    }
     else                                               /* unknown */
     {
       Run = False;
@@ -3105,22 +5180,13 @@ _Bool Cmd_FileList(Token_Type *TokenList)
    *  check parser results
    */
 
-  if ((Run == False) || (Get > 0) || (FilepathToken == NULL))
+  if ((Run == False) || (Get > 0) || (FilepathToken == NULL) ||
+      (Seconds < 0) || (Seconds > MAX_LOG_FLUSH))
   {
     Run = False;
     LogCfgError();
   }
 
-  if (Run)
-  {
-    if (Env->Fields_filelist == NULL)
-    {
-      Run = False;
-      Log(L_WARN, "No format for filelist specified!");
-      LogCfgError();
-    }
-  }
-
 
   /*
    *  process
@@ -3128,17 +5194,10 @@ _Bool Cmd_FileList(Token_Type *TokenList)
 
   if (Run)
   {
-    /* first close old filelist */
-    if (Env->List) CloseFilelist();
-
-    Env->ListFilepath = FilepathToken->String;   /* move string */
+    Env->LogFilepath = FilepathToken->String;    /* move string */
     FilepathToken->String = NULL;
-
-    /* reset statistics */
-    Env->Files = 0;
-    Env->Bytes = 0;
-
-    Flag = OpenFilelist();
+    Env->LogFlush = Seconds;
+    Flag = OpenLogfile();                        /* open file */
   }
 
   return Flag;
@@ -3147,25 +5206,32 @@ _Bool Cmd_FileList(Token_Type *TokenList)
 
 
 /*
- *  reset stuff
- *  Syntax: Reset [InfoMode] [Excludes] 
+ *  set download counter store
+ *  - has to precede the fileareas
+ *  Syntax: Counters <filepath>
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Cmd_Reset(Token_Type *TokenList)
+_Bool Cmd_Counters(Token_Type *TokenList)
 {
-  _Bool                  Flag = False;       /* return value */
-  _Bool                  Run = True;         /* control flag */
-  unsigned short         Keyword = 0;        /* keyword ID */
-  static char            *Keywords[4] =
-    {"Reset", "InfoMode", "Excludes", NULL};
+  _Bool             Flag = False;            /* return value */
+  _Bool             Run = True;              /* control flag */
+  unsigned short    Get = 0;                 /* mode control */
+  Token_Type        *FilepathToken = NULL;
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
 
+  /* prevent any additional counters command */
+  if (Env->CounterPath)
+  {
+    Log(L_WARN, "Counters already set!");
+    return Flag;
+  }
+
 
   /*
    *  parse tokens
@@ -3173,32 +5239,18 @@ _Bool Cmd_Reset(Token_Type *TokenList)
 
   while (Run && TokenList && TokenList->String)
   {
-    Keyword = GetKeyword(Keywords, TokenList->String);
-
-    switch (Keyword)           /* keywords without data */
+    if (Get == 1)                  /* get value: filepath */
     {
-      case 0:       /* unknown keyword */
-        Run = False;
-        LogBadKeyword(TokenList->String);
-        break;
-
-      case 1:       /* command itself */
-        /* just skip */
-        break;
-
-      case 2:       /* InfoMode */
-        Env->InfoMode = INFO_NONE;      /* set switches to default */
-        /* unset bits for local switches set by InfoMode */
-        Env->CfgSwitches &= ~(SW_SI_UNITS | SW_IEC_UNITS | SW_ANY_CASE);
-        break;
-
-      case 3:       /* Excludes */
-        if (Env->ExcludeList)           /* clear file excludes */
-        {
-          FreeExcludeList(Env->ExcludeList);
-          Env->ExcludeList = NULL;
-        }
-        break;
+      FilepathToken = TokenList;
+      Get = 0;                       /* reset */
+    }
+    else if (strcasecmp(TokenList->String, "Counters") == 0)  /* filepath */
+    {
+      Get = 1;
+    }
+    else                                               /* unknown */
+    {
+      Run = False;
     }
 
     TokenList = TokenList->Next;     /* goto to next token */
@@ -3209,13 +5261,25 @@ _Bool Cmd_Reset(Token_Type *TokenList)
    *  check parser results
    */
 
-  if (Run == False)
+  if ((Run == False) || (Get > 0) || (FilepathToken == NULL))
   {
+    Run = False;
     LogCfgError();
   }
-  else
+
+
+  /*
+   *  process
+   */
+
+  if (Run)
   {
-    Flag = True;       /* signal success */
+    Env->CounterPath = FilepathToken->String;    /* move string */
+    FilepathToken->String = NULL;
+
+    /* missing store: no downloads counted yet */
+    Env->CounterStore = OpenCounterStore(Env->CounterPath, False);
+    Flag = True;
   }
 
   return Flag;
@@ -3224,29 +5288,32 @@ _Bool Cmd_Reset(Token_Type *TokenList)
 
 
 /*
- *  file info mode
- *  Syntax: InfoMode [dir.bbs] [files.bbs] [Update] [Strict] |Skips]
- *                   [Relax] [SI-Units] [IEC-Units] |AnyCase]
+ *  set path of render cache
+ *  - has to precede the fileareas
+ *  Syntax: CachePath <path>
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Cmd_InfoMode(Token_Type *TokenList)
+_Bool Cmd_CachePath(Token_Type *TokenList)
 {
-  _Bool                  Flag = False;       /* return value */
-  _Bool                  Run = True;         /* control flag */
-  unsigned short         Keyword = 0;        /* keyword ID */
-  unsigned short         Mode = INFO_NONE;
-  unsigned short         Switches = SW_NONE;
-  static char            *Keywords[11] =
-    {"InfoMode", "dir.bbs", "files.bbs", "Update", "Strict",
-     "Skips", "Relax", "SI-Units", "IEC-Units", "AnyCase", NULL};
+  _Bool             Flag = False;            /* return value */
+  _Bool             Run = True;              /* control flag */
+  unsigned short    Get = 0;                 /* mode control */
+  Token_Type        *PathToken = NULL;
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
 
+  /* prevent any additional cache path command */
+  if (Env->CachePath)
+  {
+    Log(L_WARN, "CachePath already set!");
+    return Flag;
+  }
+
 
   /*
    *  parse tokens
@@ -3254,59 +5321,18 @@ _Bool Cmd_InfoMode(Token_Type *TokenList)
 
   while (Run && TokenList && TokenList->String)
   {
-    Keyword = GetKeyword(Keywords, TokenList->String);
-
-    switch (Keyword)      /* keywords without data */
+    if (Get == 1)                  /* get value: path */
     {
-      case 0:       /* unknown keyword */
-        Run = False;
-        LogBadKeyword(TokenList->String);
-        break;
-
-      case 1:       /* command itself */
-        /* just skip */
-        break;
-
-      case 2:       /* dir.bbs */
-        Mode |= INFO_DIR_BBS;
-        break;
-
-      case 3:       /* files.bbs */
-        Mode |= INFO_FILES_BBS;
-        if (Env->Fields_files_bbs == NULL)
-        {
-          Log(L_WARN, "Format of files.bbs not defined!");
-          Run = False;
-        }
-        break;
-
-      case 4:       /* update */
-        Mode |= INFO_UPDATE;
-        break;
-
-      case 5:       /* strict */
-        Mode |= INFO_STRICT;
-        break;
-
-      case 6:       /* skips */
-        Mode |= INFO_SKIPS;
-        break;
-
-      case 7:       /* relax */
-        Mode |= INFO_RELAX;
-        break;
-
-      case 8:       /* SI units */
-        Switches |= SW_SI_UNITS;
-        break;
-
-      case 9:       /* IEC units for output */
-        Switches |= SW_IEC_UNITS;
-        break;
-
-      case 10:      /* any case */
-        Switches |= SW_ANY_CASE;
-        break;
+      PathToken = TokenList;
+      Get = 0;                       /* reset */
+    }
+    else if (strcasecmp(TokenList->String, "CachePath") == 0)  /* path */
+    {
+      Get = 1;
+    }
+    else                                               /* unknown */
+    {
+      Run = False;
     }
 
     TokenList = TokenList->Next;     /* goto to next token */
@@ -3317,16 +5343,21 @@ _Bool Cmd_InfoMode(Token_Type *TokenList)
    *  check parser results
    */
 
-  if (Run == False)           /* error */
+  if ((Run == False) || (Get > 0) || (PathToken == NULL))
   {
+    Run = False;
     LogCfgError();
   }
-  else                        /* success */
+
+
+  /*
+   *  process
+   */
+
+  if (Run)
   {
-    Env->InfoMode = Mode;               /* set new infomode */
-    /* unset bits for local switches set by InfoMode */
-    Env->CfgSwitches &= ~(SW_SI_UNITS | SW_IEC_UNITS | SW_ANY_CASE);
-    Env->CfgSwitches |= Switches;       /* update switches */
+    Env->CachePath = PathToken->String;          /* move string */
+    PathToken->String = NULL;
     Flag = True;
   }
 
@@ -3336,20 +5367,20 @@ _Bool Cmd_InfoMode(Token_Type *TokenList)
 
 
 /*
- *  exclude specific filename
- *  Syntax: Exclude <name or pattern>
+ *  set number of area workers
+ *  Syntax: Workers <number>
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Cmd_Exclude(Token_Type *TokenList)
+_Bool Cmd_Workers(Token_Type *TokenList)
 {
-  _Bool             Flag = False;       /* return value */
-  _Bool             Run = True;         /* control flag */
-  unsigned short    Get = 0;            /* mode control */
-  Token_Type        *NameToken = NULL;
+  _Bool             Flag = False;            /* return value */
+  _Bool             Run = True;              /* control flag */
+  unsigned short    Get = 0;                 /* mode control */
+  long              Number = -1;             /* number of workers */
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
@@ -3361,17 +5392,16 @@ _Bool Cmd_Exclude(Token_Type *TokenList)
 
   while (Run && TokenList && TokenList->String)
   {
-    if (Get == 1)                  /* get value: name */
+    if (Get == 1)                  /* get value: number */
     {
-      NameToken = TokenList;
-
-      Get = 0;                       /* reset */      
+      Number = Str2Long(TokenList->String);
+      Get = 0;                       /* reset */
     }
-    else if (strcasecmp(TokenList->String, "Exclude") == 0)   /* name */
+    else if (strcasecmp(TokenList->String, "Workers") == 0)   /* number */
     {
       Get = 1;
     }
-    else                                                 /* unknown */
+    else                                               /* unknown */
     {
       Run = False;
     }
@@ -3384,7 +5414,8 @@ _Bool Cmd_Exclude(Token_Type *TokenList)
    *  check parser results
    */
 
-  if ((Run == False) || (Get > 0) || (NameToken == NULL))
+  if ((Run == False) || (Get > 0) ||
+      (Number < 0) || (Number > MAX_AREA_WORKERS))
   {
     Run = False;
     LogCfgError();
@@ -3397,8 +5428,8 @@ _Bool Cmd_Exclude(Token_Type *TokenList)
 
   if (Run)
   {
-    /* add name to global exclude list */
-    Flag = AddExcludeElement(NameToken->String);
+    Env->Workers = Number;
+    Flag = True;
   }
 
   return Flag;
@@ -3407,32 +5438,28 @@ _Bool Cmd_Exclude(Token_Type *TokenList)
 
 
 /*
- *  open logfile
- *  Syntax: LogFile <filepath>
+ *  build file index from following fileareas (combined mode)
+ *  - index is written by next Index command or at the end
+ *  Syntax: Index <filepath> [PathAliases] [BinarySearch] [AnyCase]
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Cmd_LogFile(Token_Type *TokenList)
+_Bool Cmd_Index(Token_Type *TokenList)
 {
   _Bool             Flag = False;            /* return value */
   _Bool             Run = True;              /* control flag */
-  unsigned short    Get = 0;                 /* mode control */
+  unsigned short    Keyword = 0;             /* keyword ID */
+  unsigned short    Switches = SW_NONE;
   Token_Type        *FilepathToken = NULL;
+  static char       *Keywords[5] =
+    {"Index", "PathAliases", "BinarySearch", "AnyCase", NULL};
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
 
-  /* command line takes precedence */
-  /* also prevent any additional logfile command */
-  if (Env->LogFilepath)
-  {
-    Log(L_WARN, "Logfile already set!");
-    return Flag;
-  }
-
 
   /*
    *  parse tokens
@@ -3440,18 +5467,37 @@ _Bool Cmd_LogFile(Token_Type *TokenList)
 
   while (Run && TokenList && TokenList->String)
   {
-    if (Get == 1)                  /* get value: filepath */
+    if (Keyword == 1)         /* get value: filepath */
     {
       FilepathToken = TokenList;
-      Get = 0;                       /* reset */      
-    }
-    else if (strcasecmp(TokenList->String, "LogFile") == 0)   /* filepath */
-    {
-      Get = 1;
+      Keyword = 0;            /* reset */
     }
-    else                                               /* unknown */
+    else                      /* get keyword */
     {
-      Run = False;
+      Keyword = GetKeyword(Keywords, TokenList->String);
+
+      switch (Keyword)        /* keywords without data */
+      {
+        case 0:               /* unknown keyword */
+          Run = False;
+          LogBadKeyword(TokenList->String);
+          break;
+
+        case 2:               /* path aliases */
+          Switches |= SW_PATH_ALIASES;
+          Keyword = 0;        /* reset keyword */
+          break;
+
+        case 3:               /* binary search */
+          Switches |= SW_BINARY_SEARCH;
+          Keyword = 0;        /* reset keyword */
+          break;
+
+        case 4:               /* case-insensitive search */
+          Switches |= SW_ANY_CASE;
+          Keyword = 0;        /* reset keyword */
+          break;
+      }
     }
 
     TokenList = TokenList->Next;     /* goto to next token */
@@ -3462,7 +5508,7 @@ _Bool Cmd_LogFile(Token_Type *TokenList)
    *  check parser results
    */
 
-  if ((Run == False) || (Get > 0) || (FilepathToken == NULL))
+  if ((Run == False) || (Keyword > 0) || (FilepathToken == NULL))
   {
     Run = False;
     LogCfgError();
@@ -3475,9 +5521,24 @@ _Bool Cmd_LogFile(Token_Type *TokenList)
 
   if (Run)
   {
-    Env->LogFilepath = FilepathToken->String;    /* move string */
+    /* write areas of workers (index is built serially) */
+    Run = DrainWorkers(0);
+
+    /* first write old index */
+    if (Env->IndexFilepath)
+    {
+      if (!CloseIndex()) Run = False;
+    }
+  }
+
+  if (Run)
+  {
+    Env->IndexFilepath = FilepathToken->String;   /* move string */
     FilepathToken->String = NULL;
-    Flag = OpenLogfile();                        /* open file */
+    Env->IndexSwitches = Switches;
+    Env->IndexFiles = 0;
+
+    Flag = True;
   }
 
   return Flag;
@@ -3502,9 +5563,10 @@ _Bool ParseConfig(Token_Type *TokenList)
 {
   _Bool                  Flag = False;        /* return value */
   unsigned short         Keyword = 0;        /* keyword ID */
-  static char            *Keywords[11] =
+  static char            *Keywords[15] =
     {"FileArea", "SharedFileArea", "AddText", "Exclude", "Include",
-     "InfoMode", "Reset", "Define", "LogFile", "FileList", NULL};
+     "InfoMode", "Reset", "Define", "LogFile", "FileList", "Counters",
+     "Workers", "CachePath", "Index", NULL};
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
@@ -3560,6 +5622,22 @@ _Bool ParseConfig(Token_Type *TokenList)
       case 10:      /* filelist */
         Flag = Cmd_FileList(TokenList);
         break;
+
+      case 11:      /* download counters */
+        Flag = Cmd_Counters(TokenList);
+        break;
+
+      case 12:      /* area workers */
+        Flag = Cmd_Workers(TokenList);
+        break;
+
+      case 13:      /* render cache */
+        Flag = Cmd_CachePath(TokenList);
+        break;
+
+      case 14:      /* file index */
+        Flag = Cmd_Index(TokenList);
+        break;
     }
   }
 
@@ -3856,6 +5934,7 @@ _Bool InitStuff(void)
 _Bool GetAllocations(void)
 {
   _Bool                 Flag = FALSE;
+  unsigned short        n;              /* counter */
 
   /* buffers */
   LogBuffer = (char *) malloc(DEFAULT_BUFFER_SIZE);
@@ -3887,6 +5966,7 @@ _Bool GetAllocations(void)
 
     /* environment: file streams */
     Env->Log = NULL;
+    Env->LogFlush = LOG_FLUSH;
     Env->List = NULL;
 
     /* environment: program control */
@@ -3899,14 +5979,51 @@ _Bool GetAllocations(void)
     Env->CfgSwitches = SW_NONE;
 
     /* environment: file index */
+    Env->IndexSwitches = SW_NONE;
+    Env->IndexFiles = 0;
+    Env->IndexFilepath = NULL;
+    Env->IndexPW = NULL;
+    Env->IndexAutoMagic = False;
+    Env->DataList = NULL;
+    Env->LastData = NULL;
+    Env->LookupList = NULL;
+    Env->LastLookup = NULL;
+    Env->AliasList = NULL;
+    Env->LastAlias = NULL;
     Env->ExcludeList = NULL;
     Env->LastExclude = NULL;
 
+    /* environment: download counters */
+    Env->CounterPath = NULL;
+    Env->CounterStore = NULL;
+
     /* environment: filelist */
     Env->ListFilepath = NULL;
     Env->InfoMode = INFO_NONE;
     Env->InfoList = NULL;
     Env->LastInfo = NULL;
+    Env->InfoHash.Buckets = NULL;
+    Env->InfoHash.Size = 0;
+    Env->InfoHash.Count = 0;
+    Env->InfoHash.AnyCase = False;
+    Env->Arena = NULL;
+    Env->Checks_files_bbs = 0;
+    Env->Writes_files_bbs = 0;
+    for (n = 0; n < SINKS; n++)
+    {
+      Env->SinkFilepath[n] = NULL;
+      Env->Sink[n] = NULL;
+    }
+    Env->Sinks = 0;
+    Env->SinkAreas = 0;
+    Env->NewFilesTime = 0;
+    Env->NewFiles = 0;
+    Env->CachePath = NULL;
+    Env->Workers = 0;
+    Env->ActiveWorkers = 0;
+    Env->WorkerFailed = False;
+    Env->WorkerList = NULL;
+    Env->LastWorker = NULL;
     Env->Fields_filelist = NULL;
     Env->Fields_files_bbs = NULL;
   }
@@ -3922,6 +6039,8 @@ _Bool GetAllocations(void)
 
 void FreeAllocations()
 {
+  unsigned short        n;              /* counter */
+
   /*  structures */
   if (Env)
   {
@@ -3930,10 +6049,23 @@ void FreeAllocations()
     if (Env->LogFilepath) free(Env->LogFilepath);
     if (Env->CWD) free(Env->CWD);
     if (Env->ListFilepath) free(Env->ListFilepath);
+    if (Env->CachePath) free(Env->CachePath);
+    if (Env->CounterPath) free(Env->CounterPath);
+    if (Env->CounterStore) CloseCounterStore(Env->CounterStore);
+    if (Env->IndexFilepath) free(Env->IndexFilepath);
+    for (n = 0; n < SINKS; n++)
+    {
+      if (Env->SinkFilepath[n]) free(Env->SinkFilepath[n]);
+    }
 
     /* linked lists */
     if (Env->ExcludeList) FreeExcludeList(Env->ExcludeList);
+    if (Env->DataList) FreeDataList(Env->DataList);
+    if (Env->LookupList) FreeLookupList(Env->LookupList);
+    if (Env->AliasList) FreeAliasList(Env->AliasList);
     if (Env->InfoList) FreeInfoList(Env->InfoList);
+    FreeInfoHash();
+    FreeArena();
     if (Env->Fields_filelist) FreeFieldList(Env->Fields_filelist);
     if (Env->Fields_files_bbs) FreeFieldList(Env->Fields_files_bbs);
 
@@ -4031,7 +6163,15 @@ int main(int argc, char *argv[])
 
   if (Env)
   {
-    if (Env->List) CloseFilelist();
+    if (Env->List)
+    {
+      if (!CloseFilelist()) Flag = False;
+    }
+
+    if (Env->IndexFilepath)
+    {
+      if (!CloseIndex()) Flag = False;
+    }
 
     if (Env->Run)             /* log "done" */
     {
@@ -4041,6 +6181,7 @@ int main(int argc, char *argv[])
 
     if (Env->Log)             /* close logfile */
     {
+      FlushLog();                  /* write buffered lines */
       UnlockFile(Env->Log);
       fclose(Env->Log);
       Env->Log = NULL;
@@ -37,6 +37,18 @@
 #include <sys/stat.h>
 #include <errno.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+/* resident server */
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <signal.h>
+
+/* threads */
+#include <pthread.h>
 
 
 /*
@@ -56,6 +68,13 @@
   #define TMP_PATH       DEFAULT_TMP_PATH
 #endif
 
+/* batch processing of matched files */
+#define BATCH_SIZE       64         /* max. number of matches per batch */
+#define MAX_STAT_THREADS 16         /* max. number of threads for file details */
+
+/* parallel search */
+#define MAX_CANDIDATES   256        /* max. matches per request and thread */
+
 
 /*
  *  local variables
@@ -63,11 +82,93 @@
 
 /* buffers */
 char                *InBuffer2 = NULL;       /* for file reading */
-char                *AliasBuffer = NULL;     /* for aliases */
 
 /* counters */
 int                 BadPWs = 0;              /* number of bad passwords */
 
+/* batch processing of matched files */
+Pending_Type        *Batch = NULL;           /* matches (array) */
+unsigned int        BatchFiles = 0;          /* number of matches in batch */
+unsigned int        BatchChecks = 0;         /* matches requiring file details */
+unsigned int        BatchPWs = 0;            /* matches with bad password */
+unsigned int        StatNext = 0;            /* next match for stat threads */
+pthread_mutex_t     StatLock = PTHREAD_MUTEX_INITIALIZER;
+
+/* result cache */
+ScanResult_Type     *Recording = NULL;       /* matches to be cached */
+Response_Type       *RecordMark = NULL;      /* last response before search */
+
+/* resident server */
+volatile sig_atomic_t    ServerRun = 1;      /* server loop control */
+
+/* timing */
+Timing_Type         Timing;                  /* timing of current session */
+
+
+
+/* ************************************************************************
+ *   timing
+ * ************************************************************************ */
+
+
+/*
+ *  start timer for a phase
+ */
+
+void StartTimer(struct timespec *Start)
+{
+  clock_gettime(CLOCK_MONOTONIC, Start);
+}
+
+
+
+/*
+ *  stop timer and add elapsed time to phase
+ *
+ *  returns:
+ *  - elapsed time in microseconds
+ */
+
+long long StopTimer(unsigned short Phase, struct timespec *Start)
+{
+  long long              Time;               /* return value */
+  struct timespec        End;
+
+  clock_gettime(CLOCK_MONOTONIC, &End);
+
+  Time = (long long)(End.tv_sec - Start->tv_sec) * 1000000;
+  Time += (End.tv_nsec - Start->tv_nsec) / 1000;
+
+  if (Phase < TIME_PHASES) Timing.Time[Phase] += Time;
+
+  return Time;
+}
+
+
+
+/*
+ *  log timing and counters of session in a single line
+ *  - times in microseconds
+ */
+
+void LogTiming()
+{
+  long long              Total = 0;          /* total time */
+  unsigned int           n;                  /* counter */
+
+  for (n = 0; n < TIME_PHASES; n++) Total += Timing.Time[n];
+
+  Log(L_INFO, "Timing: config=%lld srif=%lld limits=%lld request=%lld "
+    "index=%lld presearch=%lld scan=%lld stat=%lld mail=%lld "
+    "response=%lld total=%lld records=%lu patterns=%lu stats=%lu",
+    Timing.Time[TIME_CONFIG], Timing.Time[TIME_SRIF],
+    Timing.Time[TIME_LIMITS], Timing.Time[TIME_REQUEST],
+    Timing.Time[TIME_INDEX], Timing.Time[TIME_PRESEARCH],
+    Timing.Time[TIME_SCAN], Timing.Time[TIME_STAT],
+    Timing.Time[TIME_MAIL], Timing.Time[TIME_RESPONSE], Total,
+    Timing.Records, Timing.Patterns, Timing.Stats);
+}
+
 
 
 /* ************************************************************************
@@ -143,40 +244,138 @@ off_t GetFileSize(char *Filepath)
 
 
 /*
- *  get path alias from index alias file
- *
- *  Warning: uses global buffer InBuffer2 to return result
+ *  load index alias file
+ *  - reads complete file with a single read
+ *  - terminates paths with 0 instead of LF, so the offsets used by the
+ *    data file point directly to the paths
  *
  *  returns:
- *  -  pointer to string on success
- *  -  NULL on error
+ *  - 1 on success (Paths is NULL for an empty file)
+ *  - 0 on error
  */
 
-char *GetAlias(FILE *AliasFile, off_t Offset)
+_Bool LoadAliasPaths(char *Filepath, char **Paths, off_t *Size)
 {
-  char              *Path = NULL;       /* return value */
-  size_t            Length;
+  _Bool                  Flag = False;        /* return value */
+  int                    File;                /* file descriptor */
+  struct stat            FileData;
+  char                   *Data;               /* file content */
+  off_t                  n;                   /* counter */
 
   /* sanity check */
-  if ((AliasFile == NULL) || (Offset < 0)) return Path;
+  if ((Filepath == NULL) || (Paths == NULL) || (Size == NULL)) return Flag;
 
-  /* move to offset position */
-  fseeko(AliasFile, Offset, SEEK_SET);
+  *Paths = NULL;
+  *Size = 0;
 
-  /* read path from current line */
-  if (fgets(InBuffer2, DEFAULT_BUFFER_SIZE, AliasFile) != NULL)
+  File = open(Filepath, O_RDONLY);
+  if (File >= 0)
   {
-    Length = strlen(InBuffer2);
-
-    /* sanity check for linesize */
-    if ((Length > 0) && (Length < DEFAULT_BUFFER_SIZE - 1))
+    if (fstat(File, &FileData) == 0)
     {
-      /* remove LF at end of line */
-      if (InBuffer2[Length - 1] == 10) InBuffer2[Length - 1] = 0;
+      if (FileData.st_size == 0)        /* no aliases */
+      {
+        Flag = True;
+      }
+      else if ((Data = malloc(FileData.st_size + 1)) == NULL)
+      {
+        Log(L_ERR, "Couldn't allocate memory!");
+      }
+      else if (read(File, Data, FileData.st_size) == FileData.st_size)
+      {
+        Data[FileData.st_size] = 0;     /* terminate last path */
 
-      /* if it's not an empty */
-      if (InBuffer2[0] != 0) Path = InBuffer2;
+        for (n = 0; n < FileData.st_size; n++)
+        {
+          if (Data[n] == 10) Data[n] = 0;     /* LF -> end of path */
+        }
+
+        *Paths = Data;
+        *Size = FileData.st_size;
+        Flag = True;
+      }
+      else                              /* read error */
+      {
+        free(Data);
+      }
     }
+
+    close(File);
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  create alias table for searching a file index
+ *  - FreePaths: table takes over paths
+ *
+ *  returns:
+ *  - pointer to table on success
+ *  - NULL on error
+ */
+
+AliasTable_Type *OpenAliasTable(char *Paths, off_t Size, _Bool FreePaths)
+{
+  AliasTable_Type        *Table = NULL;       /* return value */
+
+  Table = malloc(sizeof(AliasTable_Type));
+  if (Table)
+  {
+    Table->Paths = Paths;
+    Table->Size = Size;
+    Table->FreePaths = FreePaths;
+    Table->LastOffset = -1;        /* nothing cached yet */
+    Table->LastLength = 0;
+  }
+  else
+  {
+    Log(L_ERR, "Couldn't allocate memory!");
+  }
+
+  return Table;
+}
+
+
+
+/*
+ *  free alias table
+ */
+
+void CloseAliasTable(AliasTable_Type *Table)
+{
+  /* sanity check */
+  if (Table == NULL) return;
+
+  if (Table->FreePaths && Table->Paths) free(Table->Paths);
+  free(Table);
+}
+
+
+
+/*
+ *  get path alias from alias table
+ *
+ *  returns:
+ *  -  pointer to string on success
+ *  -  NULL on error
+ */
+
+char *GetAlias(AliasTable_Type *Table, off_t Offset)
+{
+  char              *Path = NULL;       /* return value */
+
+  /* sanity check */
+  if ((Table == NULL) || (Offset < 0)) return Path;
+
+  /* offset has to point to the start of a path */
+  if ((Offset < Table->Size) &&
+      ((Offset == 0) || (Table->Paths[Offset - 1] == 0)) &&
+      (Table->Paths[Offset] != 0))
+  {
+    Path = &Table->Paths[Offset];
   }
 
   if (Path == NULL)
@@ -189,23 +388,26 @@ char *GetAlias(FILE *AliasFile, off_t Offset)
 
 /*
  *  process path alias (at strings beginning) 
+ *  - keeps the path of the last alias in the table's buffer, so
+ *    consecutive matches in the same directory only append the filename
  *
- *  Warning: uses global buffer AliasBuffer to return result
+ *  Warning: returns pointer to table's buffer (valid until next call)
  *
  *  returns:
  *  -  pointer to string on success
  *  -  NULL on error
  */
 
-char *ProcessAlias(FILE *AliasFile, char *String)
+char *ProcessAlias(AliasTable_Type *Table, char *String)
 {
   char              *Buffer = NULL;          /* return value */
   char              *Alias, *Remainder;
   char              *Help, *Path;
   off_t             Offset;
+  size_t            Length;
 
   /* sanity check */
-  if ((AliasFile == NULL) || (String == NULL)) return Buffer;
+  if ((Table == NULL) || (String == NULL)) return Buffer;
 
   if (String[0] == '%')       /* alias starts with % */
   {
@@ -225,15 +427,34 @@ char *ProcessAlias(FILE *AliasFile, char *String)
       Offset = Str2Long(Alias);    /* convert */
       if (Offset >= 0)             /* valid values */
       {
-        /* get alias from alias file */
-        Path = GetAlias(AliasFile, Offset);
+        /* get alias from table and cache it */
+        if (Offset != Table->LastOffset)
+        {
+          Path = GetAlias(Table, Offset);
+
+          if (Path)
+          {
+            Length = strlen(Path);
+
+            if (Length < DEFAULT_BUFFER_SIZE)
+            {
+              memcpy(Table->Buffer, Path, Length);
+              Table->LastOffset = Offset;
+              Table->LastLength = Length;
+            }
+          }
+        }
 
         /* replace alias */
-        if (Path)
+        if (Offset == Table->LastOffset)
         {
-          snprintf(AliasBuffer, DEFAULT_BUFFER_SIZE - 1,
-            "%s%s", Path, Remainder);
-          Buffer = AliasBuffer;
+          Length = strlen(Remainder);
+
+          if (Table->LastLength + Length < DEFAULT_BUFFER_SIZE)
+          {
+            memcpy(&Table->Buffer[Table->LastLength], Remainder, Length + 1);
+            Buffer = Table->Buffer;
+          }
         }
       }
 
@@ -458,34 +679,24 @@ _Bool ReadIndexLookup(char *Filepath)
 
 
 /*
- *  return lookup element for a specific character
+ *  return lookup table entry for a specific character
  *
  *  returns:
  *  - pointer on success
- *  - NULL on error
+ *  - NULL on error or if there's no entry
  */
 
-IndexLookup_Type *GetLookupElement(IndexLookup_Type *List, char Char)
+LookupEntry_Type *GetLookupEntry(LookupEntry_Type *Table, char Char)
 {
-  IndexLookup_Type       *Element = NULL;    /* return value */
+  LookupEntry_Type       *Entry = NULL;      /* return value */
 
   /* sanity check */
-  if ((List == NULL) || (Char == 0)) return Element;
+  if ((Table == NULL) || (Char == 0)) return Entry;
 
-  while (List)                        /* follow linked list */
-  {
-    if (List->Letter == Char)           /* got a match */
-    {
-      Element = List;                     /* save pointer */
-      List = NULL;                        /* end loop */
-    }
-    else                                /* no match */
-    {
-      List = List->Next;                  /* go to next element */
-    }
-  }
+  Entry = &Table[(unsigned char)Char];    /* direct access */
+  if (Entry->Offset < 0) Entry = NULL;    /* no filenames for char */
 
-  return Element;
+  return Entry;
 }
 
 
@@ -498,25 +709,13 @@ IndexLookup_Type *GetLookupElement(IndexLookup_Type *List, char Char)
  *  - -1 on error
  */
 
-long GetLetterOffset(IndexLookup_Type *List, char Char)
+long GetLetterOffset(LookupEntry_Type *Table, char Char)
 {
   long              Offset = -1;        /* return value */
+  LookupEntry_Type  *Entry;             /* lookup table entry */
 
-  /* sanity check */
-  if ((List == NULL) || (Char == 0)) return Offset;
-
-  while (List)                        /* follow linked list */
-  {
-    if (List->Letter == Char)           /* got a match */
-    {
-      Offset = List->Offset;              /* save value */
-      List = NULL;                        /* end loop */
-    }
-    else                                /* no match */
-    {
-      List = List->Next;                  /* go to next element */
-    }
-  }
+  Entry = GetLookupEntry(Table, Char);
+  if (Entry) Offset = Entry->Offset;
 
   return Offset;
 }
@@ -524,173 +723,247 @@ long GetLetterOffset(IndexLookup_Type *List, char Char)
 
 
 /* ************************************************************************
- *   request processing
+ *   resident file index
  * ************************************************************************ */
 
 
 /*
- *  log file request in more detail
+ *  map file into memory (read-only)
+ *
+ *  returns:
+ *  - pointer to mapped file on success
+ *  - NULL on error or for an empty file
  */
 
-void LogRequest()
+char *MapFile(char *Filepath, off_t *Size)
 {
-  Request_Type           *Request;      /* file(s) requested */
-  Response_Type          *Response;     /* file found */
-  char                   *Help;         /* temporary string */
+  char                   *Data = NULL;        /* return value */
+  int                    File;                /* file descriptor */
+  struct stat            FileData;
 
-  Request = Env->RequestList;           /* first request */
+  /* sanity check */
+  if ((Filepath == NULL) || (Size == NULL)) return Data;
 
-  while (Request)                       /* follow requests */
+  *Size = 0;
+
+  File = open(Filepath, O_RDONLY);
+  if (File >= 0)
   {
-    /* requested filename pattern */
-    if (Request->PW)                    /* with password */
+    if ((fstat(File, &FileData) == 0) && (FileData.st_size > 0))
     {
-      Log(L_INFO, "FReq: %s !%s", Request->Name, Request->PW);
-    }
-    else                                /* without password */
-    {
-      Log(L_INFO, "FReq: %s", Request->Name);
+      Data = mmap(NULL, FileData.st_size, PROT_READ, MAP_SHARED, File, 0);
+
+      if (Data == MAP_FAILED)      /* error */
+      {
+        Data = NULL;
+      }
+      else                         /* success */
+      {
+        *Size = FileData.st_size;
+      }
     }
 
+    close(File);              /* mapping stays valid */
+  }
 
-    Response = Request->Files;          /* first file */
+  return Data;
+}
 
-    while (Response)                    /* follow files */
-    {
-      Help = GetFilename(Response->Filepath);   /* get pointer to filename */
-      if (Help == NULL)                         /* error */
-      {
-        Help = Response->Filepath;              /* use filepath instead */
-      }
 
-      if (Help)       /* sanity check */
-      {
-        /* file is ok */
-        if (Response->Status & RESP_OK)
-        {
-          if (Bytes2String(Response->Size, TempBuffer, DEFAULT_BUFFER_SIZE - 1))
-            Log(L_INFO, "- %s (%s)", Help, TempBuffer);
-        }
 
-        /* password error */
-        else if (Response->Status & RESP_PWERROR)
-        {
-          Log(L_INFO, "- PW Error (%s)", Help);
-        }
+/*
+ *  load lookup table of file index
+ *  - maps lookup table file
+ *  - falls back to the lookup file for indexes without lookup table
+ *
+ *  returns:
+ *  - pointer to table on success
+ *    (Size: size of mapped table, 0 for allocated table)
+ *  - NULL on error
+ */
 
-        /* file offline */
-        else if (Response->Status & RESP_OFFLINE)
-        {
-          Log(L_INFO, "- Offline (%s)", Help);
-        }
+LookupEntry_Type *LoadLookupTable(char *Filepath, off_t *Size)
+{
+  LookupEntry_Type       *Table = NULL;       /* return value */
+  char                   *Data;               /* mapped file */
 
-        /* file dupe */
-        else if (Response->Status & RESP_DUPE)
-        {
-          Log(L_INFO, "- Dupe (%s)", Help);
-        }
-      }
+  /* sanity check */
+  if ((Filepath == NULL) || (Size == NULL)) return Table;
 
-      Response = Response->Next;        /* next file */
-    }
+  /* map lookup table file */
+  snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+    "%s."SUFFIX_TABLE, Filepath);
+  Data = MapFile(TempBuffer, Size);
 
-    /* no files found */
-    if (Request->Status & FREQ_NO_FILE)
+  if (Data)
+  {
+    if (*Size == sizeof(LookupEntry_Type) * LOOKUP_ENTRIES)
     {
-      Log(L_INFO, "- nothing found", Help);
+      Table = (LookupEntry_Type *)Data;
+    }
+    else                           /* wrong size */
+    {
+      munmap(Data, *Size);
+      Log(L_WARN, "Invalid index lookup table file (%s)!", TempBuffer);
     }
+  }
 
-    /* ignored */
-    else if (Request->Status == FREQ_NONE)
+  /* read lookup file */
+  if (Table == NULL)
+  {
+    *Size = 0;
+
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+      "%s."SUFFIX_LOOKUP, Filepath);
+
+    if (ReadIndexLookup(TempBuffer))
     {
-      Log(L_INFO, "- ignored", Help);
+      Table = malloc(sizeof(LookupEntry_Type) * LOOKUP_ENTRIES);
+      if (Table) BuildLookupTable(Env->LookupList, Table);
+      else Log(L_ERR, "Couldn't allocate memory!");
     }
 
-    Request = Request->Next;            /* next request */
+    FreeLookupList(Env->LookupList);
+    Env->LookupList = NULL;
+    Env->LastLookup = NULL;
   }
+
+  return Table;
 }
 
 
 
 /*
- *  write textmail
+ *  free lookup table of file index
+ */
+
+void FreeLookupTable(LookupEntry_Type *Table, off_t Size)
+{
+  /* sanity check */
+  if (Table == NULL) return;
+
+  if (Size > 0) munmap(Table, Size);     /* mapped */
+  else free(Table);                      /* allocated */
+}
+
+
+
+/*
+ *  free resident file index
+ */
+
+void FreeIndexMap(IndexMap_Type *Map)
+{
+  /* sanity check */
+  if (Map == NULL) return;
+
+  if (Map->Data) munmap(Map->Data, Map->DataSize);
+  if (Map->Alias) free(Map->Alias);
+  if (Map->Offset) munmap(Map->Offset, Map->OffsetSize);
+  if (Map->Bloom) munmap(Map->Bloom, Map->BloomSize);
+  FreeLookupTable(Map->Lookup, Map->LookupSize);
+
+  free(Map);
+}
+
+
+
+/*
+ *  load file index into memory
+ *  - maps data, offset and bloom filter files
+ *  - loads alias file and lookup table
  *
  *  returns:
- *  - 1 on success (if any match is found)
- *  - 0 on error
+ *  - pointer to resident index on success
+ *  - NULL on error
  */
 
-_Bool TextMail()
+IndexMap_Type *LoadIndexMap(char *Filepath)
 {
-  _Bool             Flag = False;       /* return value */
-  FILE              *File = NULL;
-  unsigned short    n = 0;
-  unsigned int      Value;
+  IndexMap_Type          *Map = NULL;         /* return value */
+  _Bool                  Run = False;         /* control flag */
 
-  /* create filepath for text file */
-  if (Env->TextFilepath == NULL)
+  /* sanity check */
+  if (Filepath == NULL) return Map;
+
+  Map = calloc(1, sizeof(IndexMap_Type));
+  if (Map == NULL)
   {
-    Value = (unsigned int)Env->UnixTime;
+    Log(L_ERR, "Couldn't allocate memory!");
+    return Map;
+  }
 
-    while (n < 10)          /* try up to 10 times */
-    {
-      /* use unix time plus offset */
-      snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
-        "%s/resp%04x.txt", Env->MailPath, Value & 0xFFFF);
+  /* map data file */
+  snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+    "%s."SUFFIX_DATA, Filepath);
+  Map->Data = MapFile(TempBuffer, &Map->DataSize);
 
-      /* check if file exits */
-      /* lstat() might be better solution */
-      File = fopen(TempBuffer, "r");       /* read mode */
-      if (File)               /* file exists **/
-      {
-        fclose(File);           /* close */
-        Value++;
-        n++;                    /* another loop run */
-      }
-      else                    /* file not available */
-      {
-        Env->TextFilepath = CopyString(TempBuffer);    /* use this filepath */
-        n = 10;                 /* end loop */
-      }
-    }
+  /* load alias file */
+  snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+    "%s."SUFFIX_ALIAS, Filepath);
+  LoadAliasPaths(TempBuffer, &Map->Alias, &Map->AliasSize);
 
-    if (Env->TextFilepath == NULL)
-    {
-      Log(L_WARN, "Couldn't create usable textmail filepath!");
-      return Flag;
-    }
-  }
+  /* map offset file (BinarySearch) */
+  snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+    "%s."SUFFIX_OFFSET, Filepath);
+  Map->Offset = MapFile(TempBuffer, &Map->OffsetSize);
 
-  /* write feedback */
-  File = fopen(Env->TextFilepath, "w");       /* truncate & write mode  */
-  if (File)
+  /* map bloom filter file (optional) */
+  snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+    "%s."SUFFIX_BLOOM, Filepath);
+  Map->Bloom = MapFile(TempBuffer, &Map->BloomSize);
+
+  /* empty alias and offset files are fine */
+  if (Map->Data)
   {
-    Flag = WriteMailContent(File);         /* write response mail */
-    fclose(File);                          /* close file */
+    /* load lookup table */
+    Map->Lookup = LoadLookupTable(Filepath, &Map->LookupSize);
+    if (Map->Lookup) Run = True;
   }
-  else
+
+  if (!Run)                   /* error */
   {
-    Log(L_WARN, "Couldn't open textmail (%s)!", Env->TextFilepath);
+    FreeIndexMap(Map);
+    Map = NULL;
   }
 
-  /* clean up */
-  if (!Flag)        /* on error */
-  {
-    /* try to remove broken netmail */
-    if (File)
-    {
-      unlink(Env->TextFilepath);
-    }
+  return Map;
+}
 
-    /* reset filepath to prevent sending of broken file */
-    if (Env->TextFilepath)
+
+
+/*
+ *  check if file index has been changed
+ *  - compares inode and mtime of data file with the generation loaded
+ *    (mfreq-index publishes the data file last)
+ *  - generation is updated by caller after loading the index
+ *
+ *  requires:
+ *  - file index
+ *  - pointer to file status of data file
+ *
+ *  returns:
+ *  - 1 if changed
+ *  - 0 if not changed or not available
+ */
+
+_Bool IndexChanged(Index_Type *Index, struct stat *FileData)
+{
+  _Bool                  Flag = False;        /* return value */
+
+  /* sanity checks */
+  if ((Index == NULL) || (FileData == NULL)) return Flag;
+
+  snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+    "%s."SUFFIX_DATA, Index->Filepath);
+
+  if (stat(TempBuffer, FileData) == 0)
+  {
+    if ((FileData->st_ino != Index->Inode) ||
+        (FileData->st_mtime != Index->MTime))
     {
-      free(Env->TextFilepath);
-      Env->TextFilepath = NULL;
+      Flag = True;
     }
-
-    /* log problem */
-    Log(L_WARN, "Couldn't create textmail!");
   }
 
   return Flag;
@@ -699,618 +972,330 @@ _Bool TextMail()
 
 
 /*
- *  write response (list of files to be send)
+ *  load file index and update generation
+ *  - generation is only updated on success, so a failed generation is
+ *    retried at the next check
+ *  - failure is logged once per generation
  *
  *  returns:
- *  - 1 on success (if any match is found)
- *  - 0 on error
+ *  - pointer to resident index on success
+ *  - NULL on error
  */
 
-_Bool WriteResponse()
+IndexMap_Type *LoadIndexGeneration(Index_Type *Index, struct stat *FileData)
 {
-  _Bool                  Flag = False;      /* return value */
-  _Bool                  Run = True;        /* control flag */
-  FILE                   *File;             /* file stream */
-  Request_Type           *Request;          /* requests */
-  Response_Type          *Response;         /* files found */
-
-  /*
-   *  file list syntax: <flag><filepath>
-   *  flag:
-   *  =  erase file if sent successfully
-   *  +  do not erase the file after sent
-   *  -  erase the file in any case after session
-   */
+  IndexMap_Type          *Map;                /* return value */
 
-  /* sanity check */
-  if (Env->ResponseFilepath == NULL) return Flag;
+  Map = LoadIndexMap(Index->Filepath);
 
-  /* open file */
-  File = fopen(Env->ResponseFilepath, "w");           /*  truncate & write mode  */
-  if (File)           /* file opened */
+  if (Map)                    /* success */
   {
-    Request = Env->RequestList;            /* start of list */
+    Index->Inode = FileData->st_ino;
+    Index->MTime = FileData->st_mtime;
+    Index->FailInode = 0;
+    Index->FailMTime = 0;
+  }
+  else if ((FileData->st_ino != Index->FailInode) ||
+           (FileData->st_mtime != Index->FailMTime))
+  {
+    Log(L_WARN, "Couldn't load index (%s)!", Index->Filepath);
+    Index->FailInode = FileData->st_ino;
+    Index->FailMTime = FileData->st_mtime;
+  }
 
-    while (Run && Request)                 /* follow linked list */
-    {
-      Response = Request->Files;             /* start of list */
+  return Map;
+}
 
-      while (Run && Response)                /* follow linked list */
-      {
-        /* list valid files only */
-        if (Response->Filepath && (Response->Status & RESP_OK))
-        {
-          /* write filepath to response file */
 
-          snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
-            "+%s\n", Response->Filepath);
 
-          if (fputs(OutBuffer, File) < 0)    /* write error */
-          {
-            Run = False;
-            Log(L_WARN, "Write error for response file (%s)!", Env->ResponseFilepath);
-          }
-        }
+/*
+ *  load all file indexes into memory
+ *  - indexes which aren't available are processed the standard way
+ */
 
-        Response = Response->Next;      /* next element */
-      }
+void LoadIndexes()
+{
+  Index_Type             *Index;              /* file index */
+  _Bool                  Run;                 /* control flag */
+  struct stat            FileData;
 
-      Request = Request->Next;        /* next element */
-    }
+  Index = Env->IndexList;
 
-    /* add netmail packet */
-    if (Run && Env->MailFilepath)
+  while (Index)               /* follow list */
+  {
+    Run = True;
+
+    /* check if filesystem is mounted (IfMounted) */
+    if (Index->MountingPoint)
     {
-      snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
-        "=%s\n", Env->MailFilepath);
-      if (fputs(OutBuffer, File) < 0)    /* write error */
-      {
-        Run = False;
-        Log(L_WARN, "Write error for response file (%s)!", Env->ResponseFilepath);
-      }
+      Run = IsMountingPoint(Index->MountingPoint);
     }
 
-    /* add text feedback */
-    if (Run && Env->TextFilepath)
+    if (Run && (Index->Map == NULL))
     {
-      snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
-        "=%s\n", Env->TextFilepath);
-      if (fputs(OutBuffer, File) < 0)    /* write error */
-      {
-        Run = False;
-        Log(L_WARN, "Write error for response file (%s)!", Env->ResponseFilepath);
-      }
+      if (IndexChanged(Index, &FileData))
+        Index->Map = LoadIndexGeneration(Index, &FileData);
+      else
+        Log(L_WARN, "Couldn't load index (%s)!", Index->Filepath);
+
+      if (Index->Map)
+        Log(L_INFO, "Loaded index (%s)", Index->Filepath);
     }
 
-    fclose(File);             /* close file */ 
-    if (Run) Flag = True;     /* signal success */
-  }
-  else                /* file error */
-  {
-    Log(L_WARN, "Couldn't open response file (%s)!", Env->ResponseFilepath);
+    Index = Index->Next;      /* next element */
   }
-
-  /* log problem */
-  if (!Flag) Log(L_WARN, "Couldn't create response file!");
-
-  return Flag;
 }
 
 
 
 /*
- *  look for best AKA pair to use (for netmail etc.)
+ *  reload changed file indexes
+ *  - the new index is loaded first and then swapped with the old one
+ *  - running child processes keep their copy of the old mapping,
+ *    which is released by the kernel when the last one has finished
+ *  - if loading fails the old index stays active and the new one
+ *    is tried again at the next check
  *
  *  returns:
- *  - 1 on success (if any match is found)
- *  - 0 on error
+ *  - 1 if any index was reloaded
+ *  - 0 if not
  */
 
-_Bool ActivateAKAs()
+_Bool ReloadIndexes(unsigned int Children)
 {
-  _Bool                  Flag = False;     /* return value */
-  _Bool                  Run = True;       /* control flag */
-  AKA_Type               *Remote, *Local;
+  Index_Type             *Index;              /* file index */
+  IndexMap_Type          *Map;                /* new resident index */
+  _Bool                  Run;                 /* control flag */
+  _Bool                  Flag = False;        /* return value */
+  long                   Time;                /* time in ms */
+  struct timespec        Start, End;
+  struct stat            FileData;
 
-  if (Env->CalledAKA)     /* if called a specific AKA we'll use that one */
+  Index = Env->IndexList;
+
+  while (Index)               /* follow list */
   {
-    Env->ActiveLocalAKA = Env->CalledAKA;
+    Run = True;
 
-    /* and try to find a match for the requester */
-    Remote = Env->ReqAKA; 
-    while (Remote)                    /* follow list */
+    /* check if filesystem is mounted (IfMounted) */
+    if (Index->MountingPoint)
     {
-      if (MatchAKAs(Env->ActiveLocalAKA, Remote))
-      {
-        Env->ActiveRemoteAKA = Remote;
-        Remote = NULL;                      /* end loop */
-      }
-      else
-      {
-        Remote = Remote->Next;              /* next one */
-      } 
+      Run = IsMountingPoint(Index->MountingPoint);
     }
 
-    /* if no match found use the first remote AKA */
-    if (Env->ActiveRemoteAKA == NULL)
-    {
-      Env->ActiveRemoteAKA = Env->ReqAKA;
-    }
-  }
-  else                    /* otherwise find a match */
-  {
-    Local = Env->AKA;
-    while (Run && Local)           /* follow list */
+    if (Run && IndexChanged(Index, &FileData))
     {
-      Remote = Env->ReqAKA;
-      while (Run && Remote)          /* follow list */
+      clock_gettime(CLOCK_MONOTONIC, &Start);
+      Map = LoadIndexGeneration(Index, &FileData);
+      clock_gettime(CLOCK_MONOTONIC, &End);
+
+      if (Map)                /* success */
       {
-        if (MatchAKAs(Local, Remote))
-        {
-          Env->ActiveLocalAKA = Local;
-          Env->ActiveRemoteAKA = Remote;
-          Run = False;                   /* end loops */
-        }
+        /* swap indexes */
+        FreeIndexMap(Index->Map);
+        Index->Map = Map;
+        Flag = True;
 
-        Remote = Remote->Next;         /* next one */
+        Time = (End.tv_sec - Start.tv_sec) * 1000;
+        Time += (End.tv_nsec - Start.tv_nsec) / 1000000;
+        Log(L_INFO, "Reloaded index (%s) in %ld ms, %u requests in flight",
+          Index->Filepath, Time, Children);
       }
-
-      Local = Local->Next;           /* next one */
     }
 
-    /* if no match found use the first AKAs */
-    if (Run)
-    {
-      Env->ActiveLocalAKA = Env->AKA;
-      Env->ActiveRemoteAKA = Env->ReqAKA;
-    }
+    Index = Index->Next;      /* next element */
   }
 
-  /* check if we got the job done */
-  if (Env->ActiveLocalAKA && Env->ActiveRemoteAKA) Flag = True;
-
   return Flag;
 }
 
 
 
 /*
- *  search request limit rules for specific address
- *  and activate that rule
- *
- *  returns:
- *  - 1 on success (if any match is found)
- *  - 0 on error
+ *  free all resident file indexes
  */
 
-_Bool ActivateLimits()
+void UnloadIndexes()
 {
-  _Bool                  Flag = False;     /* return value */
-  AKA_Type               *AKA;
-  Limit_Type             *Limit;
+  Index_Type             *Index;              /* file index */
 
-  /* take first match */
-
-  AKA = Env->ReqAKA;
+  Index = Env->IndexList;
 
-  while((Flag == False) && AKA)    /* follow AKA list */
+  while (Index)               /* follow list */
   {
-    Limit = Env->LimitList;
-
-    while (Limit)                    /* follow limit list */
+    if (Index->Map)
     {
-      if (MatchPattern(AKA->Address, Limit->Address))  /* match */
-      {
-        Flag = True;                    /* signal match */
-
-        /* check also flags */
-        if (Limit->Flags & REQ_LISTED)    /* node has to be listed */
-        {
-          if (!(Env->ReqFlags & REQ_LISTED)) Flag = False;
-        }
-
-        if (Flag)                  /* if still ok */
-        {
-          Env->ActiveLimit = Limit;        /* active this one */
-          Limit = NULL;                    /* end loop */
-        }
-      }
-      else                             /* no match */
-      {
-        Limit = Limit->Next;             /* next element */
-      }
+      FreeIndexMap(Index->Map);
+      Index->Map = NULL;
     }
 
-    AKA = AKA->Next;                 /* next element */
+    Index = Index->Next;      /* next element */
   }
+}
 
-  /* log limits */
-  if (Env->ActiveLimit)
-  {
-    if (Bytes2String(Env->ActiveLimit->Bytes, TempBuffer, DEFAULT_BUFFER_SIZE))
-      Log(L_INFO, "Limits used: %ld files / %s / %d BadPWs / %d Freqs",
-          Env->ActiveLimit->Files, TempBuffer, Env->ActiveLimit->BadPWs,
-          Env->ActiveLimit->Freqs);
-  }
 
-  return Flag;
-}
 
+/* ************************************************************************
+ *   batch processing of matched files
+ * ************************************************************************ */
 
 
 /*
- *  search for matches in index data file
- *  - linear search algorithm
- *  - starts at pre-set offset position
- *
- *  requires:
- *  - Pos: position of first wildcard (-1: no wildcards)
- *
- *  returns:
- *  - 1 on success (if any or no matches are found)
- *  - 0 on error
+ *  thread for getting file details of matches in batch
+ *  - picks next match requiring file details until batch is done
+ *  - must not call any function using global buffers or logging
  */
 
-_Bool SearchIndex(FILE *DataFile, FILE *AliasFile, Request_Type *Request, int Pos)
+void *StatWorker(void *Arg)
 {
-  _Bool                  Flag = True;         /* return value */
   _Bool                  Run = True;          /* loop control */
-  _Bool                  Match = False;       /* match flag */
-  size_t                 Length;              /* string length */
-  char                   *Requested;          /* requested file pattern */
-  char                   *Help;               /* temporary string */
-  char                   *Name, *Filepath, *Password;
-  int                    Check;               /* test value */
-  Response_Type          *Response;           /* response element */
-  
-  /* sanity checks */
-  if ((DataFile == NULL) ||
-      (AliasFile == NULL) ||
-      (Request == NULL))
-    return False;
+  Pending_Type           *Pending;            /* match */
 
-  Requested = Request->SearchName;
-  if (Requested == NULL) return False;
-
-  while (Run)                 /* processing loop */
+  while (Run)
   {
-    /* reset variables */
-    Name = NULL;
-    Filepath = NULL;
-    Password = NULL;
-    Match = False;
-
+    Pending = NULL;
 
-    /*
-     *  read line-wise
-     */
+    /* get next match requiring file details */
+    pthread_mutex_lock(&StatLock);
+    while ((Pending == NULL) && (StatNext < BatchFiles))
+    {
+      if (Batch[StatNext].Check == CHECK_NONE) Pending = &Batch[StatNext];
+      StatNext++;
+    }
+    pthread_mutex_unlock(&StatLock);
 
-    if (fgets(InBuffer, DEFAULT_BUFFER_SIZE, DataFile) != NULL)
+    if (Pending)              /* got match */
+    {
+      Pending->Size = GetFileSize(Pending->Response->Filepath);
+    }
+    else                      /* batch done */
     {
-      Length = strlen(InBuffer);
+      Run = False;            /* end loop */
+    }
+  }
 
-      if (Length == 0)                  /* sanity check */
-      {
-        Run = False;                         /* end loop */
-        Flag = False;
-      }
-      else if (Length == (DEFAULT_BUFFER_SIZE - 1))         /* maximum size reached */
-      {
-        /* now check if line matches buffer size exacly or exceeds it */
-        /* exact matches should have a LF as last character in front of the trailing 0 */
-        if (InBuffer[Length - 1] != 10)             /* pre-last char is not LF */
-        {
-          Run = False;                         /* end loop */
-          Flag = False;
-          Log(L_WARN, "Input overflow for request file!");
-        }
-      }
+  return NULL;
+}
 
-      if (Run)       /* if still in business */
-      {
-        /* remove LF at end of line */
-        if (InBuffer[Length - 1] == 10)
-        {
-          InBuffer[Length - 1] = 0;
-          Length--;
-        }
 
-        /* if it's not empty */
-        if (InBuffer[0] != 0)
-        {
-          /*
-           *  parse line
-           *  format: <name><sep><filepath>[<sep><password>]
-           *  sep: ascii 31 (unit separator, octal 037)
-           */
 
-          Help = InBuffer;
-          Name = InBuffer;          /* start of string */
+/*
+ *  get file details for all matches in batch
+ *  - uses a small pool of threads if enabled by cfg
+ *  - falls back to the current thread alone
+ */
 
-          /* get name */
-          while ((Help[0] != 0) && (Help[0] != 31)) Help++;
-          if (Help[0] == 31)
-          {
-            Help[0] = 0;            /* create substring */
-            Help++;
-            Filepath = Help;        /* start of string */
+void GetBatchDetails()
+{
+  pthread_t         Threads[MAX_STAT_THREADS];    /* thread IDs */
+  unsigned int      Number;                  /* number of threads */
+  unsigned int      n = 0;                   /* counter */
+  struct timespec   Start;                   /* timer */
 
-            /* get filepath */
-            while ((Help[0] != 0) && (Help[0] != 31)) Help++;
-            if (Help[0] == 31)      /* PW follows */
-            {
-              Help[0] = 0;            /* create substring */
-              Help++;
-              Password = Help;        /* start of string */
-            }
-          }
-          else                        /* syntax error */
-          {
-            Name = NULL;
-          }
-        }
-      }
-    } 
-    else                     /* EOF or error */
-    {
-      Run = False;        /* end loop */
-    }
+  StartTimer(&Start);
+  Timing.Stats += BatchChecks;
 
+  /* number of threads: don't exceed number of files */
+  Number = Env->StatThreads;
+  if (Number > BatchChecks) Number = BatchChecks;
 
-    /*
-     *  compare
-     */
+  StatNext = 0;               /* start with first match */
 
-    if (Run && Name && Filepath)
+  /* start additional threads (current one is first thread) */
+  while (n + 1 < Number)
+  {
+    if (pthread_create(&Threads[n], NULL, StatWorker, NULL) == 0)
     {
-      /* select best search algorithm based on wildcard position */
-
-      /*
-       *  filename pattern without any wildcard:
-       *  - simple string compare
-       *  - stop when index data > request
-       */
-
-      if (Pos == -1)               /* no wildcard at all */
-      {
-        Check = strcmp(Name, Requested);
-        if (Check == 0)            /* match */
-        {
-          Match = True;            /* add file */
-        }
-        else if (Check > 0)        /* index data > request */
-        {
-          Run = False;             /* end loop */
-        }
-      }
-
-      /*
-       *  filename pattern starting with some char(s) and a wildcard:
-       *  - simple string compare for first part of request
-       *  - on match perform pattern matching for remaining part
-       *  - stop when index data > first part of request 
-       */
-      
-      else if (Pos > 0)            /* wildcard follows */
-      {
-        Check = strncmp(Name, Requested, Pos);
-        if (Check == 0)               /* first part matches */
-        {
-          /* perform pattern matching */
-          if (MatchPattern(Name, Requested))      /* match */
-          {
-            Match = True;             /* add file */
-          }
-        }
-        else if (Check > 0)           /* index data > request */
-        {
-          Run = False;                /* end loop */
-        }
-      }
+      n++;                         /* next thread */
+    }
+    else                           /* error */
+    {
+      Number = 0;                  /* end loop */
+    }
+  }
 
-      /*
-       *  filename pattern starts with a wildcard:
-       *  - perform pattern matching
-       *  - stop when we reach EOF (done by master loop anyway)
-       */
+  StatWorker(NULL);           /* process batch */
 
-      else if (Pos == 0)           /* first char is a wildcard */
-      {
-        if (MatchPattern(Name, Requested))   /* match */
-        {
-          Match = True;            /* add file */
-        }
-      }
-    }
+  /* wait for additional threads */
+  while (n > 0)
+  {
+    n--;
+    pthread_join(Threads[n], NULL);
+  }
 
+  StopTimer(TIME_STAT, &Start);
+}
 
-    /*
-     *  prepare processing of matching file
-     *  - filepath
-     *  - response element
-     */
 
-    if (Match)           /* got match */
-    {
-      /*
-       *  <filepath>: <path>/[<filename>]
-       *              %<alias offset>%/[filename]
-       *  - %<alias offset>% for automatic path aliasing
-       *  - <filename> can be omitted if same as <name>
-       */
 
-      /* automatic filepath */
-      Length = strlen(Filepath);
-      if (Filepath[Length - 1] == '/')       /* filename is missing */
-      {
-        /* add filename to path */
-        snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1,
-          "%s%s", Filepath, Name);
-        Filepath = TempBuffer2;
-      }
+/*
+ *  add match to request and to batch
+ *  - performs all checks which don't depend on file details
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
 
-      /* check for path alias */
-      if (Filepath[0] == '%')      /* alias starts with % */
-      {
-        /* process alias and use result on success */
-        Help = ProcessAlias(AliasFile, Filepath);
-        if (Help) Filepath = Help;
-      }
+_Bool QueueMatch(Request_Type *Request, char *Filepath, char *Password)
+{
+  _Bool                  Flag = False;        /* return value */
+  Response_Type          *Response;           /* response element */
+  Pending_Type           *Pending;            /* match */
 
-      /* create response element and add it to the request */
-      Response = CreateResponseElement(Filepath);
-      if (Response)                /* got element */
-      {
-        if (Request->LastFile) Request->LastFile->Next = Response;
-        else Request->Files = Response;
-        Request->LastFile = Response;
-      }
-      else                         /* error */
-      {
-        Match = False;             /* skip file */
-      }
-    }
+  /* sanity checks */
+  if ((Request == NULL) || (Filepath == NULL)) return Flag;
+  if (BatchFiles >= BATCH_SIZE) return Flag;
 
+  /* create response element and add it to the request */
+  Response = CreateResponseElement(Filepath);
+  if (Response)                /* got element */
+  {
+    if (Request->LastFile) Request->LastFile->Next = Response;
+    else Request->Files = Response;
+    Request->LastFile = Response;
+
+    Pending = &Batch[BatchFiles];
+    BatchFiles++;
+    Pending->Response = Response;
+    Pending->Check = CHECK_NONE;
+    Pending->Size = -1;
+    Flag = True;
 
     /*
      *  check for any duplicate in current request
      *  - caused by AnyCase search
-     *  - mark file if it's a duplicate
      */
 
-    if (Match)           /* proceed with match */
+    if (DuplicateResponse(Request, Response))   /* is duplicate */
     {
-      if (DuplicateResponse(Request, Response))   /* is duplicate */
-      {
-        Response->Status |= RESP_INTDUPE;    /* set flag */
-        Match = False;                       /* skip file */
-      }
+      Pending->Check = CHECK_INTDUPE;
     }
 
-
     /*
      *  check password (if required)
-     *  - mark file in case of a bad PW
-     *  - check limit for bad PWs
      */
 
-    if (Match && Password)
+    else if (Password &&
+             ((Request->PW == NULL) || (strcmp(Request->PW, Password) != 0)))
     {
-      /* check if the request password matches the index one */
-      if ((Request->PW == NULL) || (strcmp(Request->PW, Password) != 0))
-      {
-        Response->Status |= RESP_PWERROR;    /* set flag */
-        Match = False;                       /* skip file */
-
-        /* log PW error if not done later on */
-        if (!(Env->CfgSwitches & SW_LOG_REQUEST))
-        {
-          Help = GetFilename(Response->Filepath);
-          if (Help == NULL) Help = Response->Filepath;
-
-          if (Request->PW)
-            Log(L_INFO, "PW error: %s (req: %s !%s)", Help, Request->Name, Request->PW);
-          else
-            Log(L_INFO, "PW error: %s (req: %s)", Help, Request->Name);
-        }
-
-        /* manage limit */
-        BadPWs++;                       /* another bad PW */
-
-        if (Env->ActiveLimit)           /* sanity check */
-        {
-          /* check if limit for bad PWs is exceeded */
-          if ((Env->ActiveLimit->BadPWs >= 0) &&
-              (BadPWs > Env->ActiveLimit->BadPWs))
-          {
-            /* update global frequest status: PW limit exceeded */
-            Env->FreqStatus |= FREQ_PWLIMIT | FREQ_LIMIT;
-
-            Run = False;                     /* end loop */
-          }
-        }
-      }
+      Pending->Check = CHECK_PWERROR;
+      BatchPWs++;
     }
 
-
     /*
      *  check for any duplicate in all requests
      *  - to prevent sending the same file twice
-     *  - mark file if it's a duplicate
-     */
-
-    if (Match)
-    {
-      if (AnyDuplicateResponse(Response))    /* is duplicate */
-      {
-        Request->Status = FREQ_FOUND_FILE;   /* got a file */
-        Response->Status |= RESP_DUPE;       /* file is a dupe */
-        Match = False;                       /* skip file */
-      }
-    }
-
-
-    /*
-     *  check file and request limits
      */
 
-    if (Match)                /* passed pre-processing */
+    else if (AnyDuplicateResponse(Response))    /* is duplicate */
     {
-      Response->Size = GetFileSize(Response->Filepath);   /* get file size */
-
-      if (Response->Size > -1)          /* got file size */
-      {
-        Env->Bytes += Response->Size;   /* add to global counter */
-        Env->Files++;                   /* increase global counter */
- 
-        if (Env->ActiveLimit)      /* sanity check */
-        {
-          /* check if file number limit is exceeded */
-          if ((Env->ActiveLimit->Files >= 0) &&
-              (Env->Files > Env->ActiveLimit->Files))
-          {
-            /* update global frequest status; file limit exceeded */
-            Env->FreqStatus |= FREQ_FILELIMIT | FREQ_LIMIT;
-
-            Match = False;                   /* skip file */
-            Run = False;                     /* end loop */
-          }
-
-          /* check if byte limit is exceeded */
-          if ((Env->ActiveLimit->Bytes >= 0) &&
-              (Env->Bytes > Env->ActiveLimit->Bytes))
-          {
-            /* update global frequest status: byte limit exceeded */
-            Env->FreqStatus |= FREQ_BYTELIMIT | FREQ_LIMIT;
-
-            Match = False;                   /* skip file */
-            Run = False;                     /* end loop */
-          }
-
-          if (!Run)           /* some limit exceeded */
-          {
-            /* correct global counters */
-            Env->Bytes -= Response->Size;
-            Env->Files--;
-          }
-        }
-      }
-      else                                 /* error */
-      {
-        Request->Status = FREQ_FOUND_FILE;   /* got a file */
-        Response->Status |= RESP_OFFLINE;    /* currently not available */
-      }
+      Pending->Check = CHECK_DUPE;
     }
 
-
-    if (Match)                /* passed all checks */
+    else                                        /* file details required */
     {
-      if (Response->Status == RESP_NONE)     /* not set yet */
-      {
-        Response->Status |= RESP_OK;         /* ok to send */
-      }
-
-      Request->Status = FREQ_FOUND_FILE;     /* found a file */
+      BatchChecks++;
     }
   }
 
@@ -1320,390 +1305,422 @@ _Bool SearchIndex(FILE *DataFile, FILE *AliasFile, Request_Type *Request, int Po
 
 
 /*
- *  pre-search start position in index data file
- *  - binary search algorithm
- *  - sets the file offset for the real search
- *  - doesn't support case-insensitive search
- *
- *  requires:
- *  - Request: requested file/pattern
- *  - Pos: position of first wildcard (-1: no wildcards)
- *  - Letter: first char
+ *  add match from result cache to request and to batch
+ *  - file size is known already
  *
  *  returns:
- *  - offset on success
- *  - -2 if no match is found
- *  - -1 on error
- *
+ *  - 1 on success
+ *  - 0 on error
  */
 
-off_t BinaryPreSearch(FILE *DataFile, FILE *OffsetFile, char *Request, int Pos, char Letter)
+_Bool QueueCachedMatch(Request_Type *Request, char *Filepath, char *Password,
+  off_t Size)
 {
-  off_t             Offset = -1;             /* return value */
-  _Bool             Run = False;             /* control flag */
-  IndexLookup_Type  *LookupElement;          /* lookup element */
-  unsigned int      Start;                   /* lower filenumber */
-  unsigned int      Stop;                    /* upper filenumber */
-  unsigned int      Middle;                  /* middle filenumber */
-  unsigned int      Files;                   /* number of files */
-  unsigned int      Length;                  /* string length */
-  int               Check;
-  off_t             TempOffset;              /* file offset */
-  char              *HelpStr;
-
-  /* sanity checks */
-  if ((DataFile == NULL) ||
-      (OffsetFile == NULL) ||
-      (Request == NULL) ||
-      (Pos == 0))
-    return Offset;
-
-
-  /*
-   *  get data for first char from lookup list
-   *  - lower and upper filenumbers limit the search range
-   */
+  _Bool                  Flag = False;        /* return value */
+  Pending_Type           *Pending;            /* match */
 
-  LookupElement = GetLookupElement(Env->LookupList, Letter);
+  Flag = QueueMatch(Request, Filepath, Password);
 
-  if (LookupElement)               /* found char */
+  if (Flag)
   {
-    Start = LookupElement->Start;
-    Stop = LookupElement->Stop;
+    Pending = &Batch[BatchFiles - 1];
 
-    if (Stop >= Start)             /* sanity check */
+    if (Pending->Check == CHECK_NONE)    /* passed pre-checks */
     {
-      Run = True;                  /* ok to proceed */
+      Pending->Check = CHECK_CACHED;     /* no file details required */
+      Pending->Size = Size;
+      BatchChecks--;
     }
   }
 
- /* todo:
-    if lookup list isn't available we could fall back to the complete fileindex
-    by getting the size of the offset file:
-    fileno & fstat
-    Start = 1 
-    Stop = filesize/sizeof(off_t)
- */
-
-
-  /*
-   *  search loop
-   */
-
-  while (Run)
-  {
-    Middle = (Stop + Start) / 2;      /* determine middle */
-
-    /*
-     *  get offset for middle filename from offset file
-     */
+  return Flag;
+}
 
-    Run = False;                      /* reset flag */
-    TempOffset = sizeof(off_t) * (Middle - 1);     /* calculate offset */ 
 
-    /* set file position */      
-    if (fseeko(OffsetFile, TempOffset, SEEK_SET) == 0)
-    {
-      /* read offset stored */
-      if (fread(&TempOffset, sizeof(off_t), 1, OffsetFile) == 1)
-      {
-        Run = True;         /* ok to proceed */
-      }
-    }
 
+/*
+ *  check if batch should be processed
+ *  - batch is full
+ *  - enough matches to exceed the file or bad PW limit
+ *
+ *  returns:
+ *  - 1 if batch should be processed
+ *  - 0 if there is room for more matches
+ */
 
-    /*
-     *  get middle filename from data file
-     */
+_Bool BatchFull()
+{
+  _Bool                  Flag = False;        /* return value */
 
-    if (Run)
+  if (BatchFiles >= BATCH_SIZE)             /* batch is full */
+  {
+    Flag = True;
+  }
+  else if (Env->ActiveLimit)                /* sanity check */
+  {
+    /* matches might exceed file limit */
+    if ((Env->ActiveLimit->Files >= 0) &&
+        (Env->Files + BatchChecks > Env->ActiveLimit->Files))
     {
-      Run = False;                      /* reset flag */
-
-      /* set file position */      
-      if (fseeko(DataFile, TempOffset, SEEK_SET) == 0)
-      {        
-        /* read line */
-        if (fgets(InBuffer, DEFAULT_BUFFER_SIZE, DataFile) != NULL)
-        {
-          Length = strlen(InBuffer);
-
-          if ((Length > 0) && (InBuffer[0] != 10))     /* not empty */
-          {
-            /* get filename */
-            HelpStr = InBuffer;
-            while ((HelpStr[0] != 0) && (HelpStr[0] != 31)) HelpStr++;
-
-            if (HelpStr[0] == 31)     /* got field separator */
-            {
-              HelpStr[0] = 0;         /* create sub string */
-              Run = True;             /* ok to proceed */
-            }
-          }
-        }
-      }
+      Flag = True;
     }
 
-
-    /*
-     *  compare & search logic
-     */
-
-    if (Run)
+    /* matches might exceed bad PW limit */
+    if ((Env->ActiveLimit->BadPWs >= 0) &&
+        (BadPWs + BatchPWs > Env->ActiveLimit->BadPWs))
     {
-      Files = Stop - Start + 1;         /* number of files in span */
-
-      /* compare strings */
-      if (Pos > 0)                 /* up to position of wildcard */
-      {
-        Check = strncmp(InBuffer, Request, Pos);
-      }
-      else                         /* complete strings */
-      {
-        Check = strcmp(InBuffer, Request);
-      }
-
-      if (Check < 0)          /* filename < request */
-      {
-        Start = Middle;            /* proceed with upper half */
-        if (Start < Stop) Start++; /* don't re-check middle */
-      }
-      else if (Check > 0)     /* filename > request */
-      {
-        Stop = Middle;             /* proceed with lower half */
-        if (Stop > Start) Stop--;  /* don't re-check middle */
-      }
-      else                    /* filename = request */
-      {
-        Run = False;               /* end loop */
-        Offset = TempOffset;       /* signal success */
-      }
-
-      /* just one file left */
-      if (Files == 1)         /* break condition */
-      {
-        Run = False;                    /* end loop anyway */
-      }
+      Flag = True;
     }
   }
 
-  return Offset;
+  return Flag;
 }
 
 
 
 /*
- *  process file request
+ *  process batch of matched files
+ *  - gets file details for all matches at once
+ *  - marks files and manages limits in request order
+ *  - drops any matches beyond an exceeded limit
  *
  *  returns:
- *  - 1 on success
- *  - 0 on error
+ *  - 1 if we may proceed with searching
+ *  - 0 if any limit is exceeded
  */
 
-_Bool ProcessRequest()
+_Bool ProcessBatch(Request_Type *Request)
 {
-  _Bool             Flag = True;             /* return value */
-  _Bool             Run;                     /* loop control */
-  _Bool             Result;                  /* result flag */
-  _Bool             Limit = False;           /* limits exceeded */
-  _Bool             BinSearch = False;       /* binary search */
-  Index_Type        *Index;                  /* file index list */
-  Request_Type      *Request;                /* file request list */
-  FILE              *DataFile;               /* index data file */
-  FILE              *AliasFile;              /* index alias file */
-  FILE              *OffsetFile;             /* index offset file */
-  char              *Help;                   /* support pointer */
-  int               Pos;                     /* position of first wildcard */
-                                             /* -1: no wildcard at all */
-  off_t             Offset;                  /* file offset */
-  char              Letter;                  /* first char */
-
-  /* update flags based on configuration */
-  if (Env->CfgSwitches & SW_BINARY_SEARCH) BinSearch = True;
+  _Bool                  Run = True;          /* return value / loop control */
+  _Bool                  Match;               /* match flag */
+  Pending_Type           *Pending = NULL;     /* match */
+  Response_Type          *Response;           /* response element */
+  unsigned int           n = 0;               /* counter */
+  char                   *Help;               /* temporary string */
 
+  /* sanity check */
+  if (Request == NULL) return False;
 
-  /*
-   *  process all file indexes
-   */
+  /* get file details */
+  if (BatchChecks > 0) GetBatchDetails();
 
-  Index = Env->IndexList;
-  if (Index == NULL)
+  while (Run && (n < BatchFiles))
   {
-    Log(L_WARN, "No fileindex specified!");
-    Flag = False;                            /* signal error */
-  }
+    Pending = &Batch[n];
+    Response = Pending->Response;
+    Match = False;
 
+    switch (Pending->Check)
+    {
+      case CHECK_INTDUPE:     /* internal dupe */
+        Response->Status |= RESP_INTDUPE;    /* set flag */
+        break;
 
-  while (Index)               /* follow index list */
-  {
-    /* reset variables to defaults */
-    Run = True;
-    DataFile = NULL;
-    AliasFile = NULL;
-    OffsetFile = NULL;
 
+      /*
+       *  mark file in case of a bad PW
+       *  - check limit for bad PWs
+       */
 
-    /*
-     *  check index options 
-     */
+      case CHECK_PWERROR:     /* bad PW */
+        Response->Status |= RESP_PWERROR;    /* set flag */
 
-    if (Index->MountingPoint)      /* IfMounted option enabled */
-    {
-      /* check if filesystem is mounted */
-      Run = IsMountingPoint(Index->MountingPoint);
-      if (!Run)
-      {
-        Log(L_WARN, "Skipped index (%s): fs not mounted", Index->Filepath);
-      }
-    }
+        /* log PW error if not done later on */
+        if (!(Env->CfgSwitches & SW_LOG_REQUEST))
+        {
+          Help = GetFilename(Response->Filepath);
+          if (Help == NULL) Help = Response->Filepath;
 
+          if (Request->PW)
+            Log(L_INFO, "PW error: %s (req: %s !%s)", Help, Request->Name, Request->PW);
+          else
+            Log(L_INFO, "PW error: %s (req: %s)", Help, Request->Name);
+        }
 
-    /*
-     *  open index files
-     */
+        /* manage limit */
+        BadPWs++;                       /* another bad PW */
 
-    if (Run)
-    {
-      Run = False;            /* reset flag */
+        if (Env->ActiveLimit)           /* sanity check */
+        {
+          /* check if limit for bad PWs is exceeded */
+          if ((Env->ActiveLimit->BadPWs >= 0) &&
+              (BadPWs > Env->ActiveLimit->BadPWs))
+          {
+            /* update global frequest status: PW limit exceeded */
+            Env->FreqStatus |= FREQ_PWLIMIT | FREQ_LIMIT;
 
-      /* open data file */
-      snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
-        "%s."SUFFIX_DATA, Index->Filepath);
-      DataFile = fopen(TempBuffer, "r");          /* read mode */
+            Run = False;                     /* end loop */
+          }
+        }
+        break;
 
-      /* open alias file */
-      snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
-        "%s."SUFFIX_ALIAS, Index->Filepath);
-      AliasFile = fopen(TempBuffer, "r");         /* read mode */
+      case CHECK_DUPE:        /* dupe */
+        Request->Status = FREQ_FOUND_FILE;   /* got a file */
+        Response->Status |= RESP_DUPE;       /* file is a dupe */
+        break;
 
-      /* open offset file (BinarySearch) */
-      snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
-        "%s."SUFFIX_OFFSET, Index->Filepath);
-      OffsetFile = fopen(TempBuffer, "r");        /* read mode */
 
-      /* check if we got all files */
-      if (DataFile)
-      {
-        if (AliasFile)
+      /*
+       *  check file and request limits
+       */
+
+      case CHECK_CACHED:      /* passed pre-processing (cached) */
+      case CHECK_NONE:        /* passed pre-processing */
+        Response->Size = Pending->Size;      /* file size */
+        Match = True;
+
+        if (Response->Size > -1)          /* got file size */
         {
-          if (OffsetFile)
-          {
-            /* read lookup file */
-            snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
-              "%s."SUFFIX_LOOKUP, Index->Filepath);
-            Run = ReadIndexLookup(TempBuffer);
-          }
-          else
+          Env->Bytes += Response->Size;   /* add to global counter */
+          Env->Files++;                   /* increase global counter */
+
+          if (Env->ActiveLimit)      /* sanity check */
           {
-            Log(L_WARN, "Couldn't open index offset file (%s)!", Index->Filepath);
+            /* check if file number limit is exceeded */
+            if ((Env->ActiveLimit->Files >= 0) &&
+                (Env->Files > Env->ActiveLimit->Files))
+            {
+              /* update global frequest status; file limit exceeded */
+              Env->FreqStatus |= FREQ_FILELIMIT | FREQ_LIMIT;
+
+              Match = False;                   /* skip file */
+              Run = False;                     /* end loop */
+            }
+
+            /* check if byte limit is exceeded */
+            if ((Env->ActiveLimit->Bytes >= 0) &&
+                (Env->Bytes > Env->ActiveLimit->Bytes))
+            {
+              /* update global frequest status: byte limit exceeded */
+              Env->FreqStatus |= FREQ_BYTELIMIT | FREQ_LIMIT;
+
+              Match = False;                   /* skip file */
+              Run = False;                     /* end loop */
+            }
+
+            if (!Run)           /* some limit exceeded */
+            {
+              /* correct global counters */
+              Env->Bytes -= Response->Size;
+              Env->Files--;
+            }
           }
         }
-        else
+        else                                 /* error */
         {
-          Log(L_WARN, "Couldn't open index alias file (%s)!", Index->Filepath);
+          Request->Status = FREQ_FOUND_FILE;   /* got a file */
+          Response->Status |= RESP_OFFLINE;    /* currently not available */
         }
-      }
-      else
+        break;
+    }
+
+    if (Match)                /* passed all checks */
+    {
+      if (Response->Status == RESP_NONE)     /* not set yet */
       {
-        Log(L_WARN, "Couldn't open index data file (%s)!", Index->Filepath);
+        Response->Status |= RESP_OK;         /* ok to send */
       }
 
-      if (!Run) Flag = False;                /* signal error */
+      Request->Status = FREQ_FOUND_FILE;     /* found a file */
     }
 
+    n++;                      /* next match */
+  }
 
-    /*
-     *  process each filerequest in the current file index
-     */
 
-    Request = Env->RequestList;       /* start of list */
-    while (Run && Request)            /* follow request list */
+  /*
+   *  drop matches beyond an exceeded limit
+   *  - the search would have stopped at that file
+   */
+
+  if ((n < BatchFiles) && Pending)
+  {
+    Response = Pending->Response;
+    FreeResponseList(Response->Next);
+    Response->Next = NULL;
+    Request->LastFile = Response;
+  }
+
+  /* reset batch */
+  BatchFiles = 0;
+  BatchChecks = 0;
+  BatchPWs = 0;
+
+  return Run;
+}
+
+
+
+/* ************************************************************************
+ *   request processing
+ * ************************************************************************ */
+
+
+/*
+ *  log file request in more detail
+ */
+
+void LogRequest()
+{
+  Request_Type           *Request;      /* file(s) requested */
+  Response_Type          *Response;     /* file found */
+  char                   *Help;         /* temporary string */
+
+  Request = Env->RequestList;           /* first request */
+
+  while (Request)                       /* follow requests */
+  {
+    /* requested filename pattern and search plan */
+    if (Request->PW)                    /* with password */
     {
-      /* init request status */
-      if (Request->Status == FREQ_NONE)     /* no status yet */
-      { 
-        Request->Status = FREQ_NO_FILE;     /* "no file" by default */
-      }
+      Log(L_INFO, "FReq: %s !%s (plan: %s)", Request->Name, Request->PW,
+        GetPlanName(Request->Plan));
+    }
+    else                                /* without password */
+    {
+      Log(L_INFO, "FReq: %s (plan: %s)", Request->Name,
+        GetPlanName(Request->Plan));
+    }
 
-      if (Request->SearchName)              /* sanity check */
+
+    Response = Request->Files;          /* first file */
+
+    while (Response)                    /* follow files */
+    {
+      Help = GetFilename(Response->Filepath);   /* get pointer to filename */
+      if (Help == NULL)                         /* error */
       {
-        /* check if we got any wildcards */
-        Help = Request->SearchName;
-        Pos = 0;
-        Offset = -1;
+        Help = Response->Filepath;              /* use filepath instead */
+      }
 
-        /* find first wildcard */
-        while ((Help[0] != 0) && (Help[0] != '*') && (Help[0] != '?'))
+      if (Help)       /* sanity check */
+      {
+        /* file is ok */
+        if (Response->Status & RESP_OK)
         {
-          Help++;                /* next char */
-          Pos++;
+          if (Bytes2String(Response->Size, TempBuffer, DEFAULT_BUFFER_SIZE - 1))
+            Log(L_INFO, "- %s (%s)", Help, TempBuffer);
         }
 
-        if (Help[0] == 0) Pos = -1;   /* reset position if end of line is reached */
-                                      /* e.g. no wildcard at all */
-
-        /* set position of data file to speed up search */
-        if (Pos == 0)              /* first char of request is a wildcard */
+        /* password error */
+        else if (Response->Status & RESP_PWERROR)
         {
-          Offset = 0;
+          Log(L_INFO, "- PW Error (%s)", Help);
         }
-        else                       /* first char of request is no wildcard */
-        {
-          Letter = Request->SearchName[0];
-
-          if (BinSearch)                /* binary pre-search */
-          {
-            Offset = BinaryPreSearch(DataFile, OffsetFile, Request->SearchName, Pos, Letter);
-          }
 
-          if (Offset == -1)        /* no or failed binary pre-search */
-          {
-            /* get offset from lookup list for first char */
-            Offset = GetLetterOffset(Env->LookupList, Letter);
-          }
+        /* file offline */
+        else if (Response->Status & RESP_OFFLINE)
+        {
+          Log(L_INFO, "- Offline (%s)", Help);
         }
 
-        /* search index data file */
-        if (Offset >= 0)           /* valid offset */
+        /* file dupe */
+        else if (Response->Status & RESP_DUPE)
         {
-          /* set start position */
-          if (fseeko(DataFile, Offset, SEEK_SET) == 0) 
-          {
-            Result = SearchIndex(DataFile, AliasFile, Request, Pos);
-            if (!Result) Flag = False;            /* signal error */
-          }
+          Log(L_INFO, "- Dupe (%s)", Help);
         }
       }
 
-      /* any limits exceeded */
-      if (Env->FreqStatus & FREQ_LIMIT)
+      Response = Response->Next;        /* next file */
+    }
+
+    /* no files found */
+    if (Request->Status & FREQ_NO_FILE)
+    {
+      Log(L_INFO, "- nothing found", Help);
+    }
+
+    /* ignored */
+    else if (Request->Status == FREQ_NONE)
+    {
+      Log(L_INFO, "- ignored", Help);
+    }
+
+    Request = Request->Next;            /* next request */
+  }
+}
+
+
+
+/*
+ *  write textmail
+ *
+ *  returns:
+ *  - 1 on success (if any match is found)
+ *  - 0 on error
+ */
+
+_Bool TextMail()
+{
+  _Bool             Flag = False;       /* return value */
+  FILE              *File = NULL;
+  unsigned short    n = 0;
+  unsigned int      Value;
+
+  /* create filepath for text file */
+  if (Env->TextFilepath == NULL)
+  {
+    Value = (unsigned int)Env->UnixTime;
+
+    while (n < 10)          /* try up to 10 times */
+    {
+      /* use unix time plus offset */
+      snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+        "%s/resp%04x.txt", Env->MailPath, Value & 0xFFFF);
+
+      /* check if file exits */
+      /* lstat() might be better solution */
+      File = fopen(TempBuffer, "r");       /* read mode */
+      if (File)               /* file exists **/
       {
-        Limit = True;              /* set flag */
-        Run = False;               /* end loop (requests) */
+        fclose(File);           /* close */
+        Value++;
+        n++;                    /* another loop run */
+      }
+      else                    /* file not available */
+      {
+        Env->TextFilepath = CopyString(TempBuffer);    /* use this filepath */
+        n = 10;                 /* end loop */
       }
-
-      Request = Request->Next;        /* next element */
     }
 
-    /* clean up */
-    if (OffsetFile) fclose(OffsetFile);  /* close offset file */
-    if (AliasFile) fclose(AliasFile);    /* close alias file */
-    if (DataFile) fclose(DataFile);      /* close data file */
-    if (Env->LookupList)                 /* free lookup list */
+    if (Env->TextFilepath == NULL)
     {
-      FreeLookupList(Env->LookupList);
-      Env->LookupList = NULL;
-      Env->LastLookup = NULL;
+      Log(L_WARN, "Couldn't create usable textmail filepath!");
+      return Flag;
     }
+  }
 
-    if (Limit)                /* any limits exceeded */
+  /* write feedback */
+  File = fopen(Env->TextFilepath, "w");       /* truncate & write mode  */
+  if (File)
+  {
+    Flag = WriteMailContent(File);         /* write response mail */
+    fclose(File);                          /* close file */
+  }
+  else
+  {
+    Log(L_WARN, "Couldn't open textmail (%s)!", Env->TextFilepath);
+  }
+
+  /* clean up */
+  if (!Flag)        /* on error */
+  {
+    /* try to remove broken netmail */
+    if (File)
     {
-      Index = NULL;           /* end loop (indexes) */
+      unlink(Env->TextFilepath);
     }
-    else                      /* keep going */
+
+    /* reset filepath to prevent sending of broken file */
+    if (Env->TextFilepath)
     {
-      Index = Index->Next;    /* next element */
+      free(Env->TextFilepath);
+      Env->TextFilepath = NULL;
     }
+
+    /* log problem */
+    Log(L_WARN, "Couldn't create textmail!");
   }
 
   return Flag;
@@ -1712,407 +1729,3774 @@ _Bool ProcessRequest()
 
 
 /*
- *  read request file (loosely based on FTS-0006)
- *
- *  format: <name/pattern> [!<password>]
+ *  write response (list of files to be send)
  *
  *  returns:
- *  - 1 on success
+ *  - 1 on success (if any match is found)
  *  - 0 on error
  */
 
-_Bool ReadRequest()
+_Bool WriteResponse()
 {
-  _Bool                  Flag = False;        /* return value */
-  _Bool                  Run = True;          /* loop control */
-  FILE                   *File;               /* filestream */
-  int                    Freqs = 0;           /* number of frequests */
-  size_t                 Length;              /* string length */
-  Token_Type             *TokenList = NULL;   /* token list */
-  char                   *Password = NULL;    /* password */
+  _Bool                  Flag = False;      /* return value */
+  _Bool                  Run = True;        /* control flag */
+  FILE                   *File;             /* file stream */
+  Request_Type           *Request;          /* requests */
+  Response_Type          *Response;         /* files found */
 
-  File = fopen(Env->RequestFilepath, "r");         /* read mode */
-  if (File)
+  /*
+   *  file list syntax: <flag><filepath>
+   *  flag:
+   *  =  erase file if sent successfully
+   *  +  do not erase the file after sent
+   *  -  erase the file in any case after session
+   */
+
+  /* sanity check */
+  if (Env->ResponseFilepath == NULL) return Flag;
+
+  /* open file */
+  File = fopen(Env->ResponseFilepath, "w");           /*  truncate & write mode  */
+  if (File)           /* file opened */
   {
-    Flag = True;          /* signal success */
+    Request = Env->RequestList;            /* start of list */
 
-    while (Run)
+    while (Run && Request)                 /* follow linked list */
     {
-      /* read line-wise */
-      if (fgets(InBuffer, DEFAULT_BUFFER_SIZE, File) != NULL)
-      {
-        Length = strlen(InBuffer);
+      Response = Request->Files;             /* start of list */
 
-        if (Length == 0)                  /* sanity check */
-        {
-          Run = False;                         /* end loop */
-        }
-        else if (Length == (DEFAULT_BUFFER_SIZE - 1))         /* maximum size reached */
+      while (Run && Response)                /* follow linked list */
+      {
+        /* list valid files only */
+        if (Response->Filepath && (Response->Status & RESP_OK))
         {
-          /* now check if line matches buffer size exacly or exceeds it */
-          /* exact matches should have a LF as last character in front of the trailing 0 */
-          if (InBuffer[Length - 1] != 10)             /* pre-last char is not LF */
+          /* write filepath to response file */
+
+          snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
+            "+%s\n", Response->Filepath);
+
+          if (fputs(OutBuffer, File) < 0)    /* write error */
           {
-            Run = False;                         /* end loop */
-            Log(L_WARN, "Input overflow for request file!");
+            Run = False;
+            Log(L_WARN, "Write error for response file (%s)!", Env->ResponseFilepath);
           }
         }
 
-        if (Run)       /* if still in business */
-        {
-          /* remove LF at end of line */
-          if (InBuffer[Length - 1] == 10)
-          {
-            InBuffer[Length - 1] = 0;
-            Length--;
-          }
+        Response = Response->Next;      /* next element */
+      }
 
-          /* remove CR at end of line */
-          if (InBuffer[Length - 1] == 13)
+      Request = Request->Next;        /* next element */
+    }
+
+    /* add netmail packet */
+    if (Run && Env->MailFilepath)
+    {
+      snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
+        "=%s\n", Env->MailFilepath);
+      if (fputs(OutBuffer, File) < 0)    /* write error */
+      {
+        Run = False;
+        Log(L_WARN, "Write error for response file (%s)!", Env->ResponseFilepath);
+      }
+    }
+
+    /* add text feedback */
+    if (Run && Env->TextFilepath)
+    {
+      snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
+        "=%s\n", Env->TextFilepath);
+      if (fputs(OutBuffer, File) < 0)    /* write error */
+      {
+        Run = False;
+        Log(L_WARN, "Write error for response file (%s)!", Env->ResponseFilepath);
+      }
+    }
+
+    fclose(File);             /* close file */ 
+    if (Run) Flag = True;     /* signal success */
+  }
+  else                /* file error */
+  {
+    Log(L_WARN, "Couldn't open response file (%s)!", Env->ResponseFilepath);
+  }
+
+  /* log problem */
+  if (!Flag) Log(L_WARN, "Couldn't create response file!");
+
+  return Flag;
+}
+
+
+
+/*
+ *  add entry and string to journal record
+ *
+ *  returns:
+ *  - pointer to end of entry
+ */
+
+char *AddJournalEntry(char *Buffer, int64_t Size, uint32_t Count,
+  uint16_t Status, char *String)
+{
+  JournalEntry_Type      Entry;             /* entry */
+
+  Entry.Size = Size;
+  Entry.Count = Count;
+  Entry.Status = Status;
+  Entry.Length = strlen(String) + 1;
+
+  memcpy(Buffer, &Entry, sizeof(JournalEntry_Type));
+  Buffer += sizeof(JournalEntry_Type);
+  memcpy(Buffer, String, Entry.Length);
+  Buffer += Entry.Length;
+
+  return Buffer;
+}
+
+
+
+/*
+ *  append record of session to request journal
+ *  - single write in append mode, so concurrent sessions don't need
+ *    any locking
+ *  - strings are limited to 64k each (uint16_t)
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool WriteJournal()
+{
+  _Bool                  Flag = False;      /* return value */
+  Request_Type           *Request;          /* requests */
+  Response_Type          *Response;         /* files found */
+  JournalHeader_Type     Header;            /* record header */
+  char                   *Record;           /* record */
+  char                   *Help;             /* support pointer */
+  char                   *AKA = "";         /* requester AKA */
+  char                   *Name;             /* filename */
+  size_t                 Size;              /* size of record */
+  uint32_t               Count;             /* number of responses */
+  unsigned int           n;                 /* counter */
+  int                    FD;                /* file descriptor */
+
+  /* sanity check */
+  if (Env->JournalPath == NULL) return Flag;
+
+  if (Env->ActiveRemoteAKA && Env->ActiveRemoteAKA->Address)
+    AKA = Env->ActiveRemoteAKA->Address;
+
+
+  /*
+   *  build header and get size of record
+   */
+
+  memset(&Header, 0, sizeof(JournalHeader_Type));
+  Header.Magic = JOURNAL_MAGIC;
+  Header.Version = JOURNAL_VERSION;
+  Header.Time = Env->UnixTime;
+  Header.Bytes = Env->Bytes;
+  Header.Files = Env->Files;
+  Header.Status = Env->FreqStatus;
+  Header.AKALength = strlen(AKA) + 1;
+
+  for (n = 0; n < TIME_PHASES; n++)
+  {
+    if (Timing.Time[n] > UINT32_MAX) Header.Phases[n] = UINT32_MAX;
+    else Header.Phases[n] = Timing.Time[n];
+  }
+
+  Size = sizeof(JournalHeader_Type) + Header.AKALength;
+
+  Request = Env->RequestList;
+  while (Request)
+  {
+    Header.Requests++;
+    Size += sizeof(JournalEntry_Type) + strlen(Request->Name) + 1;
+
+    Response = Request->Files;
+    while (Response)
+    {
+      Name = GetFilename(Response->Filepath);
+      if (Name == NULL) Name = Response->Filepath;
+      Size += sizeof(JournalEntry_Type) + strlen(Name) + 1;
+      Response = Response->Next;
+    }
+
+    Request = Request->Next;
+  }
+
+  if (Size > MAX_JOURNAL_SIZE)
+  {
+    Log(L_WARN, "Record too large for journal (%s)!", Env->JournalPath);
+    return Flag;
+  }
+
+  Header.Size = Size;
+
+
+  /*
+   *  build record
+   */
+
+  Record = malloc(Size);
+  if (Record == NULL)
+  {
+    Log(L_ERR, "Couldn't allocate memory!");
+    return Flag;
+  }
+
+  Help = Record;
+  memcpy(Help, &Header, sizeof(JournalHeader_Type));
+  Help += sizeof(JournalHeader_Type);
+  memcpy(Help, AKA, Header.AKALength);
+  Help += Header.AKALength;
+
+  Request = Env->RequestList;
+  while (Request)
+  {
+    /* count responses */
+    Count = 0;
+    Response = Request->Files;
+    while (Response)
+    {
+      Count++;
+      Response = Response->Next;
+    }
+
+    Help = AddJournalEntry(Help, 0, Count, Request->Status, Request->Name);
+
+    Response = Request->Files;
+    while (Response)
+    {
+      Name = GetFilename(Response->Filepath);
+      if (Name == NULL) Name = Response->Filepath;
+      Help = AddJournalEntry(Help, Response->Size, 0, Response->Status, Name);
+      Response = Response->Next;
+    }
+
+    Request = Request->Next;
+  }
+
+
+  /*
+   *  append record
+   */
+
+  FD = open(Env->JournalPath, O_WRONLY | O_APPEND | O_CREAT, 0644);
+  if (FD >= 0)
+  {
+    if (write(FD, Record, Size) == (ssize_t)Size) Flag = True;
+    close(FD);
+  }
+
+  if (!Flag) Log(L_WARN, "Couldn't write journal (%s)!", Env->JournalPath);
+
+  free(Record);
+
+  return Flag;
+}
+
+
+
+/*
+ *  update download counters for files sent
+ *  - opens counter store on first call (kept for batch mode)
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool UpdateCounters()
+{
+  _Bool                  Flag = True;       /* return value */
+  Request_Type           *Request;          /* requests */
+  Response_Type          *Response;         /* files found */
+
+  /* sanity check */
+  if (Env->CounterPath == NULL) return False;
+
+  if (Env->CounterStore == NULL)
+  {
+    Env->CounterStore = OpenCounterStore(Env->CounterPath, True);
+    if (Env->CounterStore == NULL) return False;
+  }
+
+  Request = Env->RequestList;
+  while (Request)
+  {
+    Response = Request->Files;
+    while (Response)
+    {
+      if (Response->Filepath && (Response->Status & RESP_OK))
+      {
+        Flag &= AddCounter(Env->CounterStore, Response->Filepath, 1);
+      }
+
+      Response = Response->Next;
+    }
+
+    Request = Request->Next;
+  }
+
+  if (!Flag)
+    Log(L_WARN, "Counter store full, downloads not counted (%s)!",
+      Env->CounterPath);
+
+  return Flag;
+}
+
+
+
+/*
+ *  look for best AKA pair to use (for netmail etc.)
+ *
+ *  returns:
+ *  - 1 on success (if any match is found)
+ *  - 0 on error
+ */
+
+_Bool ActivateAKAs()
+{
+  _Bool                  Flag = False;     /* return value */
+  _Bool                  Run = True;       /* control flag */
+  AKA_Type               *Remote, *Local;
+
+  if (Env->CalledAKA)     /* if called a specific AKA we'll use that one */
+  {
+    Env->ActiveLocalAKA = Env->CalledAKA;
+
+    /* and try to find a match for the requester */
+    Remote = Env->ReqAKA; 
+    while (Remote)                    /* follow list */
+    {
+      if (MatchAKAs(Env->ActiveLocalAKA, Remote))
+      {
+        Env->ActiveRemoteAKA = Remote;
+        Remote = NULL;                      /* end loop */
+      }
+      else
+      {
+        Remote = Remote->Next;              /* next one */
+      } 
+    }
+
+    /* if no match found use the first remote AKA */
+    if (Env->ActiveRemoteAKA == NULL)
+    {
+      Env->ActiveRemoteAKA = Env->ReqAKA;
+    }
+  }
+  else                    /* otherwise find a match */
+  {
+    Local = Env->AKA;
+    while (Run && Local)           /* follow list */
+    {
+      Remote = Env->ReqAKA;
+      while (Run && Remote)          /* follow list */
+      {
+        if (MatchAKAs(Local, Remote))
+        {
+          Env->ActiveLocalAKA = Local;
+          Env->ActiveRemoteAKA = Remote;
+          Run = False;                   /* end loops */
+        }
+
+        Remote = Remote->Next;         /* next one */
+      }
+
+      Local = Local->Next;           /* next one */
+    }
+
+    /* if no match found use the first AKAs */
+    if (Run)
+    {
+      Env->ActiveLocalAKA = Env->AKA;
+      Env->ActiveRemoteAKA = Env->ReqAKA;
+    }
+  }
+
+  /* check if we got the job done */
+  if (Env->ActiveLocalAKA && Env->ActiveRemoteAKA) Flag = True;
+
+  return Flag;
+}
+
+
+
+/*
+ *  search request limit rules for specific address
+ *  and activate that rule
+ *
+ *  returns:
+ *  - 1 on success (if any match is found)
+ *  - 0 on error
+ */
+
+_Bool ActivateLimits()
+{
+  _Bool                  Flag = False;     /* return value */
+  AKA_Type               *AKA;
+  Limit_Type             *Limit;
+
+  /* take first match (compiled limits) */
+
+  AKA = Env->ReqAKA;
+
+  while((Flag == False) && AKA)    /* follow AKA list */
+  {
+    Limit = MatchLimit(AKA, Env->ReqFlags);
+
+    if (Limit)                       /* match */
+    {
+      Env->ActiveLimit = Limit;        /* active this one */
+      Flag = True;                     /* signal match */
+    }
+
+    AKA = AKA->Next;                 /* next element */
+  }
+
+  /* log limits */
+  if (Env->ActiveLimit)
+  {
+    if (Bytes2String(Env->ActiveLimit->Bytes, TempBuffer, DEFAULT_BUFFER_SIZE))
+      Log(L_INFO, "Limits used: %ld files / %s / %d BadPWs / %d Freqs",
+          Env->ActiveLimit->Files, TempBuffer, Env->ActiveLimit->BadPWs,
+          Env->ActiveLimit->Freqs);
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  find next match in index data file
+ *  - linear search algorithm
+ *  - starts at current position
+ *  - uses given buffers only (safe for parallel search)
+ *
+ *  requires:
+ *  - Request: requested file/pattern and search plan
+ *  - Buffer: line buffer
+ *  - Buffer2: buffer for automatic filepath
+ *  - Counters: counters for records and pattern matching
+ *
+ *  returns:
+ *  - 1 on match (sets Filepath and Password)
+ *  - 0 if there are no more matches
+ *  - -1 on error
+ *  - -2 on input overflow
+ */
+
+int NextMatch(FILE *DataFile, Request_Type *Request,
+  char *Buffer, char *Buffer2, char **Filepath, char **Password,
+  Timing_Type *Counters)
+{
+  int                    Result = 0;          /* return value */
+  _Bool                  Run = True;          /* loop control */
+  size_t                 Length;              /* string length */
+  char                   *Help;               /* temporary string */
+  char                   *Name, *Path, *PW;
+  char                   *Requested;          /* requested file/pattern */
+  int                    Pos;                 /* position of first wildcard */
+  int                    Check;               /* test value */
+
+  /* sanity checks */
+  if ((DataFile == NULL) || (Request == NULL) ||
+      (Request->SearchName == NULL) ||
+      (Buffer == NULL) || (Buffer2 == NULL) ||
+      (Filepath == NULL) || (Password == NULL) ||
+      (Counters == NULL))
+    return -1;
+
+  Requested = Request->SearchName;
+  Pos = Request->Pos;
+
+  while (Run)                 /* processing loop */
+  {
+    /* reset variables */
+    Name = NULL;
+    Path = NULL;
+    PW = NULL;
+
+
+    /*
+     *  read line-wise
+     */
+
+    if (fgets(Buffer, DEFAULT_BUFFER_SIZE, DataFile) != NULL)
+    {
+      Counters->Records++;
+      Length = strlen(Buffer);
+
+      if (Length == 0)                  /* sanity check */
+      {
+        Run = False;                         /* end loop */
+        Result = -1;
+      }
+      else if (Length == (DEFAULT_BUFFER_SIZE - 1))         /* maximum size reached */
+      {
+        /* now check if line matches buffer size exacly or exceeds it */
+        /* exact matches should have a LF as last character in front of the trailing 0 */
+        if (Buffer[Length - 1] != 10)              /* pre-last char is not LF */
+        {
+          Run = False;                         /* end loop */
+          Result = -2;
+        }
+      }
+
+      if (Run)       /* if still in business */
+      {
+        /* remove LF at end of line */
+        if (Buffer[Length - 1] == 10)
+        {
+          Buffer[Length - 1] = 0;
+          Length--;
+        }
+
+        /* if it's not empty */
+        if (Buffer[0] != 0)
+        {
+          /*
+           *  parse line
+           *  format: <name><sep><filepath>[<sep><password>]
+           *  sep: ascii 31 (unit separator, octal 037)
+           */
+
+          Help = Buffer;
+          Name = Buffer;            /* start of string */
+
+          /* get name */
+          while ((Help[0] != 0) && (Help[0] != 31)) Help++;
+          if (Help[0] == 31)
+          {
+            Help[0] = 0;            /* create substring */
+            Help++;
+            Path = Help;            /* start of string */
+
+            /* get filepath */
+            while ((Help[0] != 0) && (Help[0] != 31)) Help++;
+            if (Help[0] == 31)      /* PW follows */
+            {
+              Help[0] = 0;            /* create substring */
+              Help++;
+              PW = Help;              /* start of string */
+            }
+          }
+          else                        /* syntax error */
+          {
+            Name = NULL;
+          }
+        }
+      }
+    }
+    else                     /* EOF or error */
+    {
+      Run = False;        /* end loop */
+    }
+
+
+    /*
+     *  compare
+     */
+
+    if (Run && Name && Path)
+    {
+      /* select best search algorithm based on wildcard position */
+
+      /*
+       *  filename pattern without any wildcard:
+       *  - simple string compare
+       *  - stop when index data > request
+       */
+
+      if (Pos == -1)               /* no wildcard at all */
+      {
+        Check = strcmp(Name, Requested);
+        if (Check == 0)            /* match */
+        {
+          Result = 1;              /* add file */
+        }
+        else if (Check > 0)        /* index data > request */
+        {
+          Run = False;             /* end loop */
+        }
+      }
+
+      /*
+       *  filename pattern starting with some char(s) and a wildcard:
+       *  - simple string compare for first part of request
+       *  - on match perform pattern matching for remaining part
+       *  - stop when index data > first part of request
+       */
+
+      else if (Pos > 0)            /* wildcard follows */
+      {
+        Check = strncmp(Name, Requested, Pos);
+        if (Check == 0)               /* first part matches */
+        {
+          /* perform pattern matching */
+          Counters->Patterns++;
+          if (MatchPattern(Name, Requested))      /* match */
+          {
+            Result = 1;               /* add file */
+          }
+        }
+        else if (Check > 0)           /* index data > request */
+        {
+          Run = False;                /* end loop */
+        }
+      }
+
+      /*
+       *  filename pattern matching anything:
+       *  - no compare at all
+       *  - caller stops when any limit is exceeded
+       */
+
+      else if (Request->Plan == PLAN_ALL)
+      {
+        Result = 1;                /* add file */
+      }
+
+      /*
+       *  filename pattern with fixed suffix:
+       *  - simple string compare for end of name
+       */
+
+      else if (Request->Plan == PLAN_SUFFIX)
+      {
+        Length = strlen(Name);
+        if ((Length >= Request->LiteralLength) &&
+            (strcmp(Name + Length - Request->LiteralLength,
+                    Request->Literal) == 0))
+        {
+          Result = 1;              /* add file */
+        }
+      }
+
+      /*
+       *  filename pattern with fixed substring:
+       *  - simple substring search
+       */
+
+      else if (Request->Plan == PLAN_CONTAINS)
+      {
+        if (strstr(Name, Request->Literal))    /* match */
+        {
+          Result = 1;              /* add file */
+        }
+      }
+
+      /*
+       *  filename pattern starts with a wildcard:
+       *  - perform pattern matching
+       *  - stop when we reach EOF (done by master loop anyway)
+       */
+
+      else if (Pos == 0)           /* first char is a wildcard */
+      {
+        Counters->Patterns++;
+        if (MatchPattern(Name, Requested))   /* match */
+        {
+          Result = 1;              /* add file */
+        }
+      }
+
+      if (Result == 1) Run = False;          /* end loop */
+    }
+  }
+
+
+  /*
+   *  prepare filepath of matching file
+   *
+   *  <filepath>: <path>/[<filename>]
+   *              %<alias offset>%/[filename]
+   *  - %<alias offset>% for automatic path aliasing
+   *  - <filename> can be omitted if same as <name>
+   */
+
+  if (Result == 1)            /* got match */
+  {
+    /* automatic filepath */
+    Length = strlen(Path);
+    if (Path[Length - 1] == '/')           /* filename is missing */
+    {
+      /* add filename to path */
+      snprintf(Buffer2, DEFAULT_BUFFER_SIZE - 1,
+        "%s%s", Path, Name);
+      Path = Buffer2;
+    }
+
+    *Filepath = Path;
+    *Password = PW;
+  }
+
+  return Result;
+}
+
+
+
+/*
+ *  add match to search result
+ *  - single allocation for element and strings
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool AddCandidate(ScanResult_Type *Result, char *Filepath, char *Password)
+{
+  _Bool             Flag = False;            /* return value */
+  Candidate_Type    *Candidate;              /* new element */
+  size_t            Size;                    /* size of element */
+  char              *Help;                   /* support pointer */
+
+  /* sanity checks */
+  if ((Result == NULL) || (Filepath == NULL)) return Flag;
+
+  Size = sizeof(Candidate_Type) + strlen(Filepath) + 1;
+  if (Password) Size += strlen(Password) + 1;
+
+  /* no logging here (thread) */
+  Candidate = malloc(Size);
+  if (Candidate)
+  {
+    Help = (char *)(Candidate + 1);     /* strings follow element */
+    strcpy(Help, Filepath);
+    Candidate->Filepath = Help;
+    Candidate->Password = NULL;
+    Candidate->Size = -1;
+    Candidate->Next = NULL;
+
+    if (Password)
+    {
+      Help += strlen(Filepath) + 1;
+      strcpy(Help, Password);
+      Candidate->Password = Help;
+    }
+
+    if (Result->Last) Result->Last->Next = Candidate;
+    else Result->First = Candidate;
+    Result->Last = Candidate;
+
+    Flag = True;
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  free matches of search result
+ */
+
+void FreeCandidates(ScanResult_Type *Result)
+{
+  Candidate_Type    *Candidate;              /* match */
+
+  /* sanity check */
+  if (Result == NULL) return;
+
+  while (Result->First)
+  {
+    Candidate = Result->First;
+    Result->First = Candidate->Next;
+    free(Candidate);
+  }
+
+  Result->Last = NULL;
+  Result->Result = SCAN_NONE;
+}
+
+
+
+/*
+ *  add matching file to request
+ *  - processes path alias
+ *  - records match for result cache
+ *  - processes batch of matches when it's full
+ *    or when we might exceed some limit
+ *
+ *  returns:
+ *  - 1 if we may proceed with searching
+ *  - 0 if any limit is exceeded
+ */
+
+_Bool AddMatch(AliasTable_Type *Alias, Request_Type *Request,
+  char *Filepath, char *Password)
+{
+  _Bool                  Run = True;          /* return value */
+  char                   *Help;               /* temporary string */
+
+  /* sanity checks */
+  if ((Request == NULL) || (Filepath == NULL)) return Run;
+
+  /* check for path alias */
+  if (Filepath[0] == '%')      /* alias starts with % */
+  {
+    /* process alias and use result on success */
+    Help = ProcessAlias(Alias, Filepath);
+    if (Help) Filepath = Help;
+  }
+
+  /* add match to request and batch */
+  if (QueueMatch(Request, Filepath, Password))
+  {
+    /* record match for result cache */
+    if (Recording && !AddCandidate(Recording, Filepath, Password))
+      Recording->Result = SCAN_ERROR;
+
+    if (BatchFull()) Run = ProcessBatch(Request);
+  }
+
+  return Run;
+}
+
+
+
+/*
+ *  search for matches in index data file
+ *  - linear search algorithm
+ *  - starts at pre-set offset position
+ *  - matches are checked in batches
+ *  - stops when any limit is exceeded
+ *
+ *  returns:
+ *  - 1 on success (if any or no matches are found)
+ *  - 0 on error
+ */
+
+_Bool SearchIndex(FILE *DataFile, AliasTable_Type *Alias, Request_Type *Request)
+{
+  _Bool                  Flag = True;         /* return value */
+  _Bool                  Run = True;          /* loop control */
+  int                    Result;              /* search result */
+  char                   *Filepath, *Password;
+
+  /* sanity checks */
+  if ((DataFile == NULL) ||
+      (Alias == NULL) ||
+      (Request == NULL))
+    return False;
+
+  if (Request->SearchName == NULL) return False;
+
+  while (Run)                 /* processing loop */
+  {
+    Result = NextMatch(DataFile, Request, InBuffer, TempBuffer2,
+      &Filepath, &Password, &Timing);
+
+    if (Result == 1)          /* got match */
+    {
+      Run = AddMatch(Alias, Request, Filepath, Password);
+    }
+    else                      /* done or error */
+    {
+      Run = False;            /* end loop */
+
+      if (Result < 0) Flag = False;
+      if (Result == -2) Log(L_WARN, "Input overflow for request file!");
+    }
+  }
+
+  /* process remaining matches */
+  if (BatchFiles > 0) ProcessBatch(Request);
+
+  return Flag;
+}
+
+
+
+/*
+ *  pre-search start position in index data file
+ *  - binary search algorithm
+ *  - sets the file offset for the real search
+ *  - doesn't support case-insensitive search
+ *
+ *  requires:
+ *  - Lookup: lookup table of index
+ *  - Request: requested file/pattern
+ *  - Pos: position of first wildcard (-1: no wildcards)
+ *  - Letter: first char
+ *  - Buffer: line buffer
+ *
+ *  returns:
+ *  - offset on success
+ *  - -2 if no match is found
+ *  - -1 on error
+ *
+ */
+
+off_t BinaryPreSearch(FILE *DataFile, FILE *OffsetFile,
+  LookupEntry_Type *Lookup, char *Request, int Pos, char Letter,
+  char *Buffer)
+{
+  off_t             Offset = -1;             /* return value */
+  _Bool             Run = False;             /* control flag */
+  LookupEntry_Type  *LookupEntry;            /* lookup table entry */
+  unsigned int      Start;                   /* lower filenumber */
+  unsigned int      Stop;                    /* upper filenumber */
+  unsigned int      Middle;                  /* middle filenumber */
+  unsigned int      Files;                   /* number of files */
+  unsigned int      Length;                  /* string length */
+  int               Check;
+  off_t             TempOffset;              /* file offset */
+  char              *HelpStr;
+
+  /* sanity checks */
+  if ((DataFile == NULL) ||
+      (OffsetFile == NULL) ||
+      (Request == NULL) ||
+      (Buffer == NULL) ||
+      (Pos == 0))
+    return Offset;
+
+
+  /*
+   *  get data for first char from lookup table
+   *  - lower and upper filenumbers limit the search range
+   */
+
+  LookupEntry = GetLookupEntry(Lookup, Letter);
+
+  if (LookupEntry)                 /* found char */
+  {
+    Start = LookupEntry->Start;
+    Stop = LookupEntry->Stop;
+
+    if (Stop >= Start)             /* sanity check */
+    {
+      Run = True;                  /* ok to proceed */
+    }
+  }
+
+ /* todo:
+    if lookup list isn't available we could fall back to the complete fileindex
+    by getting the size of the offset file:
+    fileno & fstat
+    Start = 1
+    Stop = filesize/sizeof(off_t)
+ */
+
+
+  /*
+   *  search loop
+   */
+
+  while (Run)
+  {
+    Middle = (Stop + Start) / 2;      /* determine middle */
+
+    /*
+     *  get offset for middle filename from offset file
+     */
+
+    Run = False;                      /* reset flag */
+    TempOffset = sizeof(off_t) * (Middle - 1);     /* calculate offset */
+
+    /* set file position */
+    if (fseeko(OffsetFile, TempOffset, SEEK_SET) == 0)
+    {
+      /* read offset stored */
+      if (fread(&TempOffset, sizeof(off_t), 1, OffsetFile) == 1)
+      {
+        Run = True;         /* ok to proceed */
+      }
+    }
+
+
+    /*
+     *  get middle filename from data file
+     */
+
+    if (Run)
+    {
+      Run = False;                      /* reset flag */
+
+      /* set file position */
+      if (fseeko(DataFile, TempOffset, SEEK_SET) == 0)
+      {
+        /* read line */
+        if (fgets(Buffer, DEFAULT_BUFFER_SIZE, DataFile) != NULL)
+        {
+          Length = strlen(Buffer);
+
+          if ((Length > 0) && (Buffer[0] != 10))       /* not empty */
+          {
+            /* get filename */
+            HelpStr = Buffer;
+            while ((HelpStr[0] != 0) && (HelpStr[0] != 31)) HelpStr++;
+
+            if (HelpStr[0] == 31)     /* got field separator */
+            {
+              HelpStr[0] = 0;         /* create sub string */
+              Run = True;             /* ok to proceed */
+            }
+          }
+        }
+      }
+    }
+
+
+    /*
+     *  compare & search logic
+     */
+
+    if (Run)
+    {
+      Files = Stop - Start + 1;         /* number of files in span */
+
+      /* compare strings */
+      if (Pos > 0)                 /* up to position of wildcard */
+      {
+        Check = strncmp(Buffer, Request, Pos);
+      }
+      else                         /* complete strings */
+      {
+        Check = strcmp(Buffer, Request);
+      }
+
+      if (Check < 0)          /* filename < request */
+      {
+        Start = Middle;            /* proceed with upper half */
+        if (Start < Stop) Start++; /* don't re-check middle */
+      }
+      else if (Check > 0)     /* filename > request */
+      {
+        Stop = Middle;             /* proceed with lower half */
+        if (Stop > Start) Stop--;  /* don't re-check middle */
+      }
+      else                    /* filename = request */
+      {
+        Run = False;               /* end loop */
+        Offset = TempOffset;       /* signal success */
+      }
+
+      /* just one file left */
+      if (Files == 1)         /* break condition */
+      {
+        Run = False;                    /* end loop anyway */
+      }
+    }
+  }
+
+  return Offset;
+}
+
+
+
+/*
+ *  get start position in index data file for request
+ *  - skips names not in index based on bloom filter
+ *  - uses binary pre-search if enabled
+ *  - falls back to lookup table
+ *
+ *  requires:
+ *  - Request: requested file/pattern and search plan
+ *  - Buffer: line buffer
+ *
+ *  returns:
+ *  - offset on success
+ *  - negative value if there's nothing to search
+ */
+
+off_t GetSearchOffset(IndexSearch_Type *Search, Request_Type *Request,
+  _Bool BinSearch, char *Buffer)
+{
+  off_t             Offset = -1;             /* return value */
+  char              *Requested;              /* requested file/pattern */
+  char              Letter;                  /* first char */
+
+  /* sanity checks */
+  if ((Search == NULL) || (Request == NULL) ||
+      (Request->SearchName == NULL))
+    return Offset;
+
+  Requested = Request->SearchName;
+
+  /* set position of data file to speed up search */
+  if (Request->Pos == 0)     /* first char of request is a wildcard */
+  {
+    Offset = 0;
+  }
+  else if ((Request->Pos == -1) &&   /* name isn't in index (bloom filter) */
+           (! CheckBloomName(Search->Bloom, Search->BloomSize, Requested)))
+  {
+    Offset = -2;
+  }
+  else                       /* first char of request is no wildcard */
+  {
+    Letter = Requested[0];
+
+    if (BinSearch)                /* binary pre-search */
+    {
+      Offset = BinaryPreSearch(Search->DataFile, Search->OffsetFile,
+        Search->Lookup, Requested, Request->Pos, Letter, Buffer);
+    }
+
+    if (Offset == -1)        /* no or failed binary pre-search */
+    {
+      /* get offset from lookup table for first char */
+      Offset = GetLetterOffset(Search->Lookup, Letter);
+    }
+  }
+
+  return Offset;
+}
+
+
+
+/*
+ *  check if any request might match in file index
+ *  - requests with wildcards always might match
+ *  - names are checked with the bloom filter
+ *
+ *  returns:
+ *  - 1 if any request might match
+ *  - 0 if no request can match
+ */
+
+_Bool RequestsMayMatch(IndexSearch_Type *Search)
+{
+  _Bool             Flag = False;            /* return value */
+  Request_Type      *Request;                /* file request list */
+
+  /* sanity check */
+  if (Search == NULL) return True;
+
+  Request = Env->RequestList;       /* start of list */
+  while (!Flag && Request)          /* follow request list */
+  {
+    if (Request->SearchName)              /* sanity check */
+    {
+      if (Request->Pos != -1)                       /* wildcards */
+      {
+        Flag = True;
+      }
+      else if (CheckBloomName(Search->Bloom, Search->BloomSize,
+                 Request->SearchName))              /* name */
+      {
+        Flag = True;
+      }
+    }
+
+    Request = Request->Next;        /* next element */
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  open file index for searching
+ *  - checks index options
+ *  - doesn't open index files if no request can match (bloom filter)
+ *  - uses resident index if available
+ *  - doesn't log skipped indexes (caller's job)
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error or if index is skipped
+ */
+
+_Bool OpenIndexSearch(Index_Type *Index, IndexSearch_Type *Search)
+{
+  _Bool             Run = True;              /* return value */
+  IndexMap_Type     *Map;                    /* resident index */
+  char              *AliasPaths;             /* loaded alias file */
+  off_t             AliasSize;               /* size of alias file */
+  struct stat       FileData;
+
+  /* sanity checks */
+  if ((Index == NULL) || (Search == NULL)) return False;
+
+  /* reset variables to defaults */
+  memset(Search, 0, sizeof(IndexSearch_Type));
+  Search->Index = Index;
+  Search->State = INDEX_ERROR;
+
+
+  /*
+   *  check index options
+   */
+
+  if (Index->MountingPoint)      /* IfMounted option enabled */
+  {
+    /* check if filesystem is mounted */
+    Run = IsMountingPoint(Index->MountingPoint);
+    if (!Run)
+    {
+      Search->State = INDEX_SKIPPED;
+    }
+  }
+
+
+  /*
+   *  check bloom filter
+   *  - skip index files if no request can match
+   */
+
+  if (Run)
+  {
+    if (Index->Map)           /* resident index */
+    {
+      Search->Bloom = Index->Map->Bloom;
+      Search->BloomSize = Index->Map->BloomSize;
+    }
+    else                      /* map bloom filter file (optional) */
+    {
+      snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+        "%s."SUFFIX_BLOOM, Index->Filepath);
+      Search->Bloom = MapFile(TempBuffer, &Search->BloomSize);
+      if (Search->Bloom) Search->UnmapBloom = True;
+    }
+
+    if (Search->Bloom && !RequestsMayMatch(Search))
+    {
+      Search->State = INDEX_NOMATCH;
+      return Run;             /* no need to open index files */
+    }
+  }
+
+
+  /*
+   *  get generation of index (result cache)
+   *  - before opening the data file, so the generation is never newer
+   *    than the data
+   */
+
+  if (Run && Env->CachePath)
+  {
+    if (Index->Map)           /* resident index */
+    {
+      Search->Inode = Index->Inode;
+      Search->MTime = Index->MTime;
+    }
+    else                      /* data file */
+    {
+      snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+        "%s."SUFFIX_DATA, Index->Filepath);
+
+      if (stat(TempBuffer, &FileData) == 0)
+      {
+        Search->Inode = FileData.st_ino;
+        Search->MTime = FileData.st_mtime;
+      }
+    }
+  }
+
+
+  /*
+   *  open resident index
+   *  - use streams for mapped files
+   */
+
+  if (Run && Index->Map)
+  {
+    Map = Index->Map;
+
+    /* empty alias and offset files aren't loaded */
+    Search->DataFile = fmemopen(Map->Data, Map->DataSize, "r");
+    Search->Alias = OpenAliasTable(Map->Alias, Map->AliasSize, False);
+    if (Map->Offset)
+      Search->OffsetFile = fmemopen(Map->Offset, Map->OffsetSize, "r");
+    else
+      Search->OffsetFile = fopen("/dev/null", "r");
+
+    if (Search->DataFile && Search->Alias && Search->OffsetFile)
+    {
+      Search->Lookup = Map->Lookup;
+    }
+    else
+    {
+      Log(L_WARN, "Couldn't open resident index (%s)!", Index->Filepath);
+      Run = False;
+    }
+  }
+
+
+  /*
+   *  open index files
+   */
+
+  else if (Run)
+  {
+    Run = False;            /* reset flag */
+
+    /* open data file */
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+      "%s."SUFFIX_DATA, Index->Filepath);
+    Search->DataFile = fopen(TempBuffer, "r");          /* read mode */
+
+    /* load alias file */
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+      "%s."SUFFIX_ALIAS, Index->Filepath);
+    if (LoadAliasPaths(TempBuffer, &AliasPaths, &AliasSize))
+    {
+      Search->Alias = OpenAliasTable(AliasPaths, AliasSize, True);
+      if (Search->Alias == NULL) free(AliasPaths);
+    }
+
+    /* open offset file (BinarySearch) */
+    snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+      "%s."SUFFIX_OFFSET, Index->Filepath);
+    Search->OffsetFile = fopen(TempBuffer, "r");        /* read mode */
+
+    /* check if we got all files */
+    if (Search->DataFile)
+    {
+      if (Search->Alias)
+      {
+        if (Search->OffsetFile)
+        {
+          /* load lookup table */
+          Search->ReadLookup = LoadLookupTable(Index->Filepath,
+            &Search->ReadLookupSize);
+          Search->Lookup = Search->ReadLookup;
+          if (Search->Lookup) Run = True;
+        }
+        else
+        {
+          Log(L_WARN, "Couldn't open index offset file (%s)!", Index->Filepath);
+        }
+      }
+      else
+      {
+        Log(L_WARN, "Couldn't open index alias file (%s)!", Index->Filepath);
+      }
+    }
+    else
+    {
+      Log(L_WARN, "Couldn't open index data file (%s)!", Index->Filepath);
+    }
+  }
+
+  if (Run) Search->State = INDEX_OK;
+
+  return Run;
+}
+
+
+
+/*
+ *  close file index opened for searching
+ *  - also frees results of parallel search
+ */
+
+void CloseIndexSearch(IndexSearch_Type *Search, unsigned int Requests)
+{
+  unsigned int      n;                       /* counter */
+
+  /* sanity check */
+  if (Search == NULL) return;
+
+  if (Search->OffsetFile) fclose(Search->OffsetFile);  /* close offset file */
+  CloseAliasTable(Search->Alias);                      /* free alias table */
+  if (Search->DataFile) fclose(Search->DataFile);      /* close data file */
+  FreeLookupTable(Search->ReadLookup, Search->ReadLookupSize);
+  if (Search->UnmapBloom) munmap(Search->Bloom, Search->BloomSize);
+
+  /* parallel search */
+  if (Search->Buffer) free(Search->Buffer);
+  if (Search->Buffer2) free(Search->Buffer2);
+  if (Search->Results)
+  {
+    for (n = 0; n < Requests; n++)
+    {
+      FreeCandidates(&Search->Results[n]);
+    }
+
+    free(Search->Results);
+  }
+
+  memset(Search, 0, sizeof(IndexSearch_Type));
+}
+
+
+
+/*
+ *  get filepath of result cache for request
+ *  - filename is a hash of index, search pattern and AnyCase switch
+ *  - also builds header line for checking the cache (OutBuffer)
+ *
+ *  Warning: uses global buffer TempBuffer2 to return result
+ *
+ *  header format: <inode> <mtime> <AnyCase> <index>0x1F<search pattern>LF
+ */
+
+char *GetCacheFilepath(IndexSearch_Type *Search, char *SearchName)
+{
+  uint32_t          Hash1, Hash2;            /* hash values */
+  unsigned int      AnyCase = 0;             /* AnyCase switch */
+
+  if (Env->CfgSwitches & SW_ANY_CASE) AnyCase = 1;
+
+  Hash1 = BloomHash(SearchName, BloomHash(Search->Index->Filepath, 0));
+  Hash2 = BloomHash(SearchName, BloomHash(Search->Index->Filepath, BLOOM_SEED));
+  Hash2 ^= AnyCase;
+
+  snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1,
+    "%s/%08x%08x."SUFFIX_CACHE, Env->CachePath,
+    (unsigned int)Hash1, (unsigned int)Hash2);
+
+  snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
+    "%lu %ld %u %s\037%s\n", (unsigned long)Search->Inode,
+    (long)Search->MTime, AnyCase, Search->Index->Filepath, SearchName);
+
+  return TempBuffer2;
+}
+
+
+
+/*
+ *  load result cache for request
+ *  - cache has to match the generation of the index
+ *  - removes outdated or broken cache files
+ *
+ *  format: <header>LF (see GetCacheFilepath())
+ *          <filesize>0x1F<filepath>[0x1F<password>]LF
+ *
+ *  returns:
+ *  - 1 on cache hit (matches in Result)
+ *  - 0 on cache miss
+ */
+
+_Bool LoadResultCache(IndexSearch_Type *Search, Request_Type *Request,
+  ScanResult_Type *Result)
+{
+  _Bool             Flag = False;            /* return value */
+  _Bool             Run = False;             /* loop control */
+  FILE              *File;                   /* filestream */
+  char              *Filepath;               /* cache file */
+  char              *Help, *Password;
+  size_t            Length;
+  long              Size;                    /* filesize */
+
+  /* sanity checks */
+  if ((Env->CachePath == NULL) || (Search == NULL) ||
+      (Request == NULL) || (Result == NULL))
+    return Flag;
+  if ((Search->State != INDEX_OK) || (Request->SearchName == NULL))
+    return Flag;
+
+  Filepath = GetCacheFilepath(Search, Request->SearchName);
+
+  File = fopen(Filepath, "r");
+  if (File == NULL) return Flag;       /* not cached */
+
+  /* check header */
+  if (fgets(InBuffer, DEFAULT_BUFFER_SIZE, File) != NULL)
+  {
+    if (strcmp(InBuffer, OutBuffer) == 0) Run = True;
+  }
+
+  /* read matches */
+  while (Run && (fgets(InBuffer, DEFAULT_BUFFER_SIZE, File) != NULL))
+  {
+    Run = False;
+    Length = strlen(InBuffer);
+
+    if ((Length > 0) && (InBuffer[Length - 1] == 10))    /* complete line */
+    {
+      InBuffer[Length - 1] = 0;            /* remove LF */
+
+      Help = strchr(InBuffer, 31);         /* filepath */
+      if (Help)
+      {
+        Help[0] = 0;
+        Help++;
+        Size = Str2Long(InBuffer);
+
+        Password = strchr(Help, 31);       /* password (optional) */
+        if (Password)
+        {
+          Password[0] = 0;
+          Password++;
+        }
+
+        if ((Size >= 0) && (Help[0] != 0) &&
+            AddCandidate(Result, Help, Password))
+        {
+          Result->Last->Size = Size;
+          Run = True;
+        }
+      }
+    }
+  }
+
+  if (Run && (ferror(File) == 0) && Result->First)
+  {
+    Result->Result = SCAN_CACHED;
+    Flag = True;
+  }
+  else                        /* outdated or broken */
+  {
+    FreeCandidates(Result);
+  }
+
+  fclose(File);
+
+  if (!Flag) unlink(Filepath);
+
+  return Flag;
+}
+
+
+
+/*
+ *  save matches of request to result cache
+ *  - files have to be available (file size)
+ *  - skipped for incomplete results (any error or limit)
+ *  - Mark: last response before search
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error or if skipped
+ */
+
+_Bool SaveResultCache(IndexSearch_Type *Search, Request_Type *Request,
+  ScanResult_Type *Record, Response_Type *Mark)
+{
+  _Bool             Flag = False;            /* return value */
+  _Bool             Run = True;              /* loop control */
+  FILE              *File;                   /* filestream */
+  char              *Filepath;               /* cache file */
+  Candidate_Type    *Candidate;              /* match */
+  Response_Type     *Response;               /* response element */
+  off_t             Size;                    /* filesize */
+
+  /* sanity checks */
+  if ((Env->CachePath == NULL) || (Search == NULL) ||
+      (Request == NULL) || (Record == NULL))
+    return Flag;
+  if ((Search->State != INDEX_OK) || (Request->SearchName == NULL) ||
+      (Record->Result != SCAN_OK) || (Record->First == NULL) ||
+      (Env->FreqStatus & FREQ_LIMIT))
+    return Flag;
+
+  Filepath = GetCacheFilepath(Search, Request->SearchName);
+
+  /* write temporary file */
+  snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+    "%s.%d."SUFFIX_TEMP, Filepath, (int)getpid());
+
+  File = fopen(TempBuffer, "w");
+  if (File == NULL) return Flag;
+
+  if (fputs(OutBuffer, File) < 0) Run = False;
+
+  /* matches are in the same order as the responses */
+  if (Mark) Response = Mark->Next;
+  else Response = Request->Files;
+  Candidate = Record->First;
+
+  while (Run && Candidate)
+  {
+    Run = False;
+
+    if (Response && (strcmp(Response->Filepath, Candidate->Filepath) == 0))
+    {
+      /* file size is known for files to be sent */
+      if (Response->Status & RESP_OK) Size = Response->Size;
+      else Size = GetFileSize(Candidate->Filepath);
+
+      if (Size >= 0)          /* file available */
+      {
+        if (Candidate->Password)
+        {
+          snprintf(InBuffer, DEFAULT_BUFFER_SIZE - 1, "%ld\037%s\037%s\n",
+            (long)Size, Candidate->Filepath, Candidate->Password);
+        }
+        else
+        {
+          snprintf(InBuffer, DEFAULT_BUFFER_SIZE - 1, "%ld\037%s\n",
+            (long)Size, Candidate->Filepath);
+        }
+
+        if (fputs(InBuffer, File) >= 0) Run = True;
+      }
+
+      Response = Response->Next;      /* next element */
+    }
+
+    Candidate = Candidate->Next;      /* next element */
+  }
+
+  if (fclose(File) != 0) Run = False;
+
+  /* replace cache file atomically */
+  if (Run && (rename(TempBuffer, Filepath) == 0))
+  {
+    Flag = True;
+  }
+  else
+  {
+    unlink(TempBuffer);
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  compare cache files by modification time (qsort)
+ *  - ascending order, i.e. oldest first
+ */
+
+int CompareCacheFile(const void *File1, const void *File2)
+{
+  CacheFile_Type    *A, *B;
+
+  A = (CacheFile_Type *)File1;
+  B = (CacheFile_Type *)File2;
+
+  if (A->MTime != B->MTime) return (A->MTime < B->MTime) ? -1 : 1;
+  return strcmp(A->Name, B->Name);
+}
+
+
+
+/*
+ *  check if filename is a cache file or a temporary cache file
+ *  - cache file: <16 hex digits>.cache
+ *  - temporary file: <cache file>.<pid>.tmp
+ *
+ *  returns:
+ *  - 1 for cache file
+ *  - 2 for temporary file
+ *  - 0 for any other file
+ */
+
+int CacheFileType(char *Name)
+{
+  int               Type = 0;                /* return value */
+  size_t            Length;
+
+  /* sanity check */
+  if (Name == NULL) return Type;
+
+  Length = strlen(Name);
+
+  if ((Length >= 22) && (strspn(Name, "0123456789abcdef") == 16) &&
+      (strncmp(&Name[16], "."SUFFIX_CACHE, 6) == 0))
+  {
+    if (Length == 22) Type = 1;
+    else if ((Length > 27) && (Name[22] == '.') &&
+             (strcmp(&Name[Length - 4], "."SUFFIX_TEMP) == 0))
+      Type = 2;
+  }
+
+  return Type;
+}
+
+
+
+/*
+ *  check if cache file matches the current generation of its file index
+ *
+ *  Warning: uses global buffers InBuffer and TempBuffer
+ *
+ *  returns:
+ *  - 1 if cache file is current or the index isn't available
+ *  - 0 if outdated, broken or the index isn't configured anymore
+ */
+
+_Bool CacheFileCurrent(char *Filepath)
+{
+  _Bool             Flag = False;            /* return value */
+  FILE              *File;                   /* filestream */
+  Index_Type        *Index;                  /* file index */
+  char              *Help;
+  unsigned long     Inode;                   /* generation: inode */
+  long              MTime;                   /* generation: mtime */
+  unsigned int      AnyCase;
+  int               Offset = 0;              /* start of index filepath */
+  struct stat       FileData;
+
+  /* sanity check */
+  if (Filepath == NULL) return Flag;
+
+  File = fopen(Filepath, "r");
+  if (File == NULL) return Flag;
+
+  /* header: <inode> <mtime> <AnyCase> <index>0x1F<search pattern>LF */
+  if ((fgets(InBuffer, DEFAULT_BUFFER_SIZE, File) != NULL) &&
+      (sscanf(InBuffer, "%lu %ld %u %n", &Inode, &MTime, &AnyCase,
+        &Offset) == 3) &&
+      (Offset > 0) && (Help = strchr(&InBuffer[Offset], 31)))
+  {
+    Help[0] = 0;              /* end of index filepath */
+
+    /* find index */
+    Index = Env->IndexList;
+    while (Index && (strcmp(Index->Filepath, &InBuffer[Offset]) != 0))
+      Index = Index->Next;
+
+    if (Index && Index->Map)       /* resident index */
+    {
+      if ((Inode == (unsigned long)Index->Inode) &&
+          (MTime == (long)Index->MTime))
+        Flag = True;
+    }
+    else if (Index)                /* data file */
+    {
+      snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+        "%s."SUFFIX_DATA, Index->Filepath);
+
+      if (stat(TempBuffer, &FileData) == 0)
+      {
+        if ((Inode == (unsigned long)FileData.st_ino) &&
+            (MTime == (long)FileData.st_mtime))
+          Flag = True;
+      }
+      else                         /* not available (e.g. not mounted) */
+      {
+        Flag = True;
+      }
+    }
+  }
+
+  fclose(File);
+
+  return Flag;
+}
+
+
+
+/*
+ *  prune result cache
+ *  - removes cache files of outdated index generations or of indexes
+ *    which aren't configured anymore
+ *  - removes left-over temporary files
+ *  - removes the oldest cache files exceeding the limit (MaxFiles)
+ *  - runs once per CACHE_PRUNE_TIME based on a stamp file, unless forced
+ *
+ *  Warning: uses global buffers InBuffer, TempBuffer and TempBuffer2
+ */
+
+void PruneResultCache(_Bool Force)
+{
+  _Bool             Run = True;              /* loop control */
+  DIR               *Directory;              /* directory stream */
+  struct dirent     *File;                   /* directory entry */
+  CacheFile_Type    *Files = NULL;           /* cache files (array) */
+  CacheFile_Type    *Help;
+  size_t            Size = 0;                /* size of array */
+  size_t            Count = 0;               /* number of cache files */
+  size_t            n;                       /* counter */
+  long              Removed = 0;             /* removed files */
+  int               Type;                    /* type of file */
+  int               Handle;                  /* file handle */
+  time_t            Now;
+  struct stat       FileData;
+
+  /* sanity check */
+  if (Env->CachePath == NULL) return;
+
+
+  /*
+   *  check and update stamp file
+   */
+
+  time(&Now);
+
+  snprintf(TempBuffer, DEFAULT_BUFFER_SIZE - 1,
+    "%s/"CACHE_STAMP, Env->CachePath);
+
+  if (!Force && (stat(TempBuffer, &FileData) == 0) &&
+      (FileData.st_mtime <= Now) &&
+      (Now - FileData.st_mtime < CACHE_PRUNE_TIME))
+    return;                   /* pruned recently */
+
+  Handle = open(TempBuffer, O_WRONLY | O_CREAT, 0644);
+  if (Handle < 0) return;     /* cache not writable */
+  futimens(Handle, NULL);     /* set to current time */
+  close(Handle);
+
+
+  /*
+   *  check cache files
+   */
+
+  Directory = opendir(Env->CachePath);
+  if (Directory == NULL) return;
+
+  while (Run)
+  {
+    File = readdir(Directory);     /* get next file */
+
+    if (File)                      /* got it */
+    {
+      Type = CacheFileType(File->d_name);
+      if (Type == 0) continue;       /* skip other files */
+
+      snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1,
+        "%s/%s", Env->CachePath, File->d_name);
+
+      if ((lstat(TempBuffer2, &FileData) != 0) ||
+          !S_ISREG(FileData.st_mode))
+        continue;                    /* skip */
+
+      if (Type == 2)                 /* temporary file */
+      {
+        /* left over by an aborted process */
+        if ((Now - FileData.st_mtime) > CACHE_PRUNE_TIME)
+        {
+          if (unlink(TempBuffer2) == 0) Removed++;
+        }
+      }
+      else if (!CacheFileCurrent(TempBuffer2))     /* outdated */
+      {
+        if (unlink(TempBuffer2) == 0) Removed++;
+      }
+      else if (Env->CacheMaxFiles > 0)             /* keep for limit */
+      {
+        if (Count == Size)           /* increase array */
+        {
+          if (Size == 0) Size = 256;
+          else Size *= 2;
+
+          Help = realloc(Files, Size * sizeof(CacheFile_Type));
+          if (Help == NULL)
+          {
+            Log(L_WARN, "Couldn't allocate memory!");
+            Run = False;
+            continue;
+          }
+          Files = Help;
+        }
+
+        Files[Count].MTime = FileData.st_mtime;
+        /* name of cache file has a fixed length (22 chars) */
+        memcpy(Files[Count].Name, File->d_name, 23);
+        Count++;
+      }
+    }
+    else                           /* error or no more entries */
+    {
+      Run = False;
+    }
+  }
+
+  closedir(Directory);
+
+
+  /*
+   *  apply limit: remove oldest files
+   */
+
+  if (Files && (Count > (size_t)Env->CacheMaxFiles))
+  {
+    qsort(Files, Count, sizeof(CacheFile_Type), CompareCacheFile);
+
+    for (n = 0; n < Count - (size_t)Env->CacheMaxFiles; n++)
+    {
+      snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1,
+        "%s/%s", Env->CachePath, Files[n].Name);
+      if (unlink(TempBuffer2) == 0) Removed++;
+    }
+  }
+
+  if (Files) free(Files);
+
+  if (Removed > 0)
+    Log(L_INFO, "Pruned result cache: %ld files removed", Removed);
+}
+
+
+
+/*
+ *  start recording matches for result cache
+ */
+
+void StartRecording(Request_Type *Request, ScanResult_Type *Record)
+{
+  /* sanity checks */
+  if ((Env->CachePath == NULL) || (Request == NULL) || (Record == NULL))
+    return;
+
+  Record->Result = SCAN_OK;
+  RecordMark = Request->LastFile;
+  Recording = Record;
+}
+
+
+
+/*
+ *  stop recording matches and save them to result cache
+ *  - Flag: search result
+ */
+
+void StopRecording(IndexSearch_Type *Search, Request_Type *Request,
+  _Bool Flag)
+{
+  /* sanity check */
+  if (Recording == NULL) return;
+
+  if (!Flag) Recording->Result = SCAN_ERROR;
+  SaveResultCache(Search, Request, Recording, RecordMark);
+  FreeCandidates(Recording);
+
+  Recording = NULL;
+  RecordMark = NULL;
+}
+
+
+
+/*
+ *  thread for searching all requests in a single file index
+ *  - collects matches, checks are done later on when merging
+ *  - collects no more matches per request than the file limit allows
+ *    (MAX_CANDIDATES at most), the merge continues the search if needed
+ *  - must not call any function using global buffers or logging
+ */
+
+void *ScanWorker(void *Arg)
+{
+  IndexSearch_Type       *Search;             /* opened index */
+  Request_Type           *Request;            /* file request list */
+  ScanResult_Type        *Result;             /* search result */
+  _Bool                  BinSearch = False;   /* binary search */
+  _Bool                  Run;                 /* loop control */
+  int                    Check;               /* search result */
+  off_t                  Offset;              /* file offset */
+  long                   Max;                 /* max. matches per request */
+  long                   Matches;             /* matches of request */
+  char                   *Filepath, *Password;
+
+  Search = (IndexSearch_Type *)Arg;
+  if (Search == NULL) return NULL;
+
+  /* update flags based on configuration */
+  if (Env->CfgSwitches & SW_BINARY_SEARCH) BinSearch = True;
+
+  /* a merge can't use more matches than the file limit allows */
+  Max = MAX_CANDIDATES;
+  if (Env->ActiveLimit && (Env->ActiveLimit->Files >= 0) &&
+      (Env->ActiveLimit->Files - Env->Files + 1 < Max))
+    Max = Env->ActiveLimit->Files - Env->Files + 1;
+  if (Max < 1) Max = 1;
+
+  Request = Env->RequestList;       /* start of list */
+  Result = Search->Results;
+
+  while (Request)                   /* follow request list */
+  {
+    /* sanity check, skip cached result */
+    if (Request->SearchName && (Result->Result != SCAN_CACHED))
+    {
+      Offset = GetSearchOffset(Search, Request, BinSearch, Search->Buffer);
+
+      /* search index data file */
+      if ((Offset >= 0) &&          /* valid offset */
+          (fseeko(Search->DataFile, Offset, SEEK_SET) == 0))
+      {
+        Result->Result = SCAN_OK;
+        Run = True;
+        Matches = 0;
+
+        while (Run)
+        {
+          Check = NextMatch(Search->DataFile, Request,
+            Search->Buffer, Search->Buffer2, &Filepath, &Password,
+            &Search->Timing);
+
+          if (Check == 1)           /* got match */
+          {
+            if (!AddCandidate(Result, Filepath, Password))
+            {
+              Result->Result = SCAN_ERROR;
+              Run = False;
+            }
+            else if (++Matches >= Max)     /* enough for merge */
+            {
+              Result->Offset = ftello(Search->DataFile);
+              Result->Result = SCAN_TRUNCATED;
+              Run = False;
+            }
+          }
+          else                      /* done or error */
+          {
+            if (Check == -1) Result->Result = SCAN_ERROR;
+            else if (Check == -2) Result->Result = SCAN_OVERFLOW;
+            Run = False;
+          }
+        }
+      }
+    }
+
+    Request = Request->Next;        /* next element */
+    Result++;                       /* next result */
+  }
+
+  return NULL;
+}
+
+
+
+/*
+ *  merge results of parallel search or result cache for a request
+ *  - adds matches to request like the serial search
+ *  - continues a truncated search if no limit is reached yet
+ *  - records matches of a search for result cache
+ *
+ *  returns:
+ *  - 1 on success (if any or no matches are found)
+ *  - 0 on error
+ */
+
+_Bool MergeResults(IndexSearch_Type *Search, Request_Type *Request,
+  ScanResult_Type *Result)
+{
+  _Bool                  Flag = True;         /* return value */
+  _Bool                  Run = True;          /* loop control */
+  _Bool                  Scan;                /* loop control */
+  int                    Check;               /* search result */
+  char                   *Filepath, *Password;
+  Candidate_Type         *Candidate;          /* match */
+  ScanResult_Type        Record = {SCAN_NONE, NULL, NULL, 0};   /* recorded */
+
+  /* sanity checks */
+  if ((Search == NULL) || (Request == NULL) || (Result == NULL))
+    return False;
+
+  if (Result->Result == SCAN_NONE) return Flag;   /* not searched */
+
+  if (Result->Result != SCAN_CACHED) StartRecording(Request, &Record);
+
+  Candidate = Result->First;
+  while (Run && Candidate)
+  {
+    if (Result->Result == SCAN_CACHED)    /* file size known */
+    {
+      if (QueueCachedMatch(Request, Candidate->Filepath,
+          Candidate->Password, Candidate->Size))
+      {
+        if (BatchFull()) Run = ProcessBatch(Request);
+      }
+    }
+    else                                  /* search result */
+    {
+      Run = AddMatch(Search->Alias, Request,
+        Candidate->Filepath, Candidate->Password);
+    }
+
+    Candidate = Candidate->Next;     /* next element */
+  }
+
+  /* continue truncated search (threads are done) */
+  if (Run && (Result->Result == SCAN_TRUNCATED))
+  {
+    Result->Result = SCAN_OK;
+    Scan = True;
+
+    if (fseeko(Search->DataFile, Result->Offset, SEEK_SET) != 0)
+    {
+      Result->Result = SCAN_ERROR;
+      Scan = False;
+    }
+
+    while (Run && Scan)
+    {
+      Check = NextMatch(Search->DataFile, Request, InBuffer, TempBuffer2,
+        &Filepath, &Password, &Timing);
+
+      if (Check == 1)         /* got match */
+      {
+        Run = AddMatch(Search->Alias, Request, Filepath, Password);
+      }
+      else                    /* done or error */
+      {
+        if (Check == -1) Result->Result = SCAN_ERROR;
+        else if (Check == -2) Result->Result = SCAN_OVERFLOW;
+        Scan = False;
+      }
+    }
+  }
+
+  /* scan was ended by an error (but not by a limit) */
+  if (Run && (Result->Result != SCAN_OK) && (Result->Result != SCAN_CACHED))
+  {
+    Flag = False;
+    if (Result->Result == SCAN_OVERFLOW)
+      Log(L_WARN, "Input overflow for request file!");
+  }
+
+  /* process remaining matches */
+  if (BatchFiles > 0) ProcessBatch(Request);
+
+  StopRecording(Search, Request, Flag);
+
+  return Flag;
+}
+
+
+
+/*
+ *  process file request with parallel search of all file indexes
+ *  - searches each index in its own thread
+ *  - merges results in index order and applies limits afterwards
+ *    (same results as serial search)
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool ParallelSearch()
+{
+  _Bool             Flag = True;             /* return value */
+  _Bool             Run = True;              /* loop control */
+  Index_Type        *Index;                  /* file index list */
+  Request_Type      *Request;                /* file request list */
+  IndexSearch_Type  *Searches;               /* opened indexes (array) */
+  IndexSearch_Type  *Search;                 /* opened index */
+  pthread_t         *Threads;                /* thread IDs (array) */
+  _Bool             *Started;                /* thread started (array) */
+  _Bool             Opened;                  /* index opened */
+  unsigned int      Indexes = 0;             /* number of indexes */
+  unsigned int      Requests = 0;            /* number of requests */
+  unsigned int      n, m;                    /* counters */
+  struct timespec   Start, IndexStart;       /* timers */
+  long long         IndexTime = 0;           /* time for opening indexes */
+
+  /* count indexes and requests */
+  Index = Env->IndexList;
+  while (Index)
+  {
+    Indexes++;
+    Index = Index->Next;
+  }
+
+  Request = Env->RequestList;
+  while (Request)
+  {
+    Requests++;
+    Request = Request->Next;
+  }
+
+  if (Indexes == 0) return Flag;
+
+  Searches = calloc(Indexes, sizeof(IndexSearch_Type));
+  Threads = calloc(Indexes, sizeof(pthread_t));
+  Started = calloc(Indexes, sizeof(_Bool));
+  if ((Searches == NULL) || (Threads == NULL) || (Started == NULL))
+  {
+    if (Searches) free(Searches);
+    if (Threads) free(Threads);
+    if (Started) free(Started);
+    Log(L_ERR, "Couldn't allocate memory!");
+    return False;
+  }
+
+
+  /*
+   *  open all indexes and start search threads
+   *  - scan time is the time until all threads are done,
+   *    minus the time for opening indexes
+   */
+
+  StartTimer(&Start);
+  Index = Env->IndexList;
+  n = 0;
+  while (Index)
+  {
+    Search = &Searches[n];
+
+    StartTimer(&IndexStart);
+    Opened = OpenIndexSearch(Index, Search);
+    IndexTime += StopTimer(TIME_INDEX, &IndexStart);
+
+    if (Opened)
+    {
+      Search->Buffer = malloc(DEFAULT_BUFFER_SIZE);
+      Search->Buffer2 = malloc(DEFAULT_BUFFER_SIZE);
+      Search->Results = calloc(Requests + 1, sizeof(ScanResult_Type));
+
+      if ((Search->Buffer == NULL) || (Search->Buffer2 == NULL) ||
+          (Search->Results == NULL))
+      {
+        /* skip index (merge signals error) */
+        Log(L_WARN, "Couldn't allocate memory!");
+        CloseIndexSearch(Search, Requests);
+        Search->Index = Index;
+        Search->State = INDEX_ERROR;
+        Opened = False;
+      }
+    }
+
+    if (Opened)
+    {
+      /* use result cache (skipped by thread) */
+      Request = Env->RequestList;
+      m = 0;
+      while (Env->CachePath && Request)
+      {
+        LoadResultCache(Search, Request, &Search->Results[m]);
+        Request = Request->Next;
+        m++;
+      }
+
+      if (pthread_create(&Threads[n], NULL, ScanWorker, Search) == 0)
+      {
+        Started[n] = True;
+      }
+      else                     /* no thread, search right now */
+      {
+        ScanWorker(Search);
+      }
+    }
+
+    Index = Index->Next;
+    n++;
+  }
+
+  /* wait for threads */
+  for (n = 0; n < Indexes; n++)
+  {
+    if (Started[n]) pthread_join(Threads[n], NULL);
+
+    /* add counters of thread */
+    Timing.Records += Searches[n].Timing.Records;
+    Timing.Patterns += Searches[n].Timing.Patterns;
+  }
+
+  Timing.Time[TIME_SCAN] += StopTimer(TIME_PHASES, &Start) - IndexTime;
+
+
+  /*
+   *  merge results in index order
+   */
+
+  n = 0;
+  while (Run && (n < Indexes))
+  {
+    Search = &Searches[n];
+
+    if (Search->State == INDEX_SKIPPED)
+    {
+      Log(L_WARN, "Skipped index (%s): fs not mounted", Search->Index->Filepath);
+    }
+    else if (Search->State == INDEX_ERROR)
+    {
+      Flag = False;                          /* signal error */
+    }
+    else                                     /* INDEX_OK or INDEX_NOMATCH */
+    {
+      Request = Env->RequestList;
+      m = 0;
+
+      while (Run && Request)        /* follow request list */
+      {
+        /* init request status */
+        if (Request->Status == FREQ_NONE)     /* no status yet */
+        {
+          Request->Status = FREQ_NO_FILE;     /* "no file" by default */
+        }
+
+        if (Request->SearchName)              /* sanity check */
+        {
+          if (!MergeResults(Search, Request, &Search->Results[m]))
+            Flag = False;                     /* signal error */
+        }
+
+        /* any limits exceeded */
+        if (Env->FreqStatus & FREQ_LIMIT)
+        {
+          Run = False;               /* end loops */
+        }
+
+        Request = Request->Next;     /* next element */
+        m++;
+      }
+    }
+
+    n++;                      /* next index */
+  }
+
+
+  /*
+   *  clean up
+   */
+
+  for (n = 0; n < Indexes; n++)
+  {
+    CloseIndexSearch(&Searches[n], Requests);
+  }
+
+  free(Started);
+  free(Threads);
+  free(Searches);
+
+  return Flag;
+}
+
+
+
+/*
+ *  process file request
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool ProcessRequest()
+{
+  _Bool             Flag = True;             /* return value */
+  _Bool             Run;                     /* loop control */
+  _Bool             Result;                  /* result flag */
+  _Bool             Limit = False;           /* limits exceeded */
+  _Bool             BinSearch = False;       /* binary search */
+  Index_Type        *Index;                  /* file index list */
+  Request_Type      *Request;                /* file request list */
+  IndexSearch_Type  Search;                  /* opened index */
+  ScanResult_Type   Cached = {SCAN_NONE, NULL, NULL, 0};   /* result cache */
+  off_t             Offset;                  /* file offset */
+  struct timespec   Start;                   /* timer */
+  long long         StatTime;                /* time for file details */
+
+  /* update flags based on configuration */
+  if (Env->CfgSwitches & SW_BINARY_SEARCH) BinSearch = True;
+
+
+  /*
+   *  process all file indexes
+   */
+
+  Index = Env->IndexList;
+  if (Index == NULL)
+  {
+    Log(L_WARN, "No fileindex specified!");
+    Flag = False;                            /* signal error */
+  }
+
+  /* search all indexes in parallel if requested */
+  if (Index && (Env->CfgSwitches & SW_PARALLEL_SEARCH))
+  {
+    Flag = ParallelSearch();
+    Index = NULL;                            /* skip serial search */
+  }
+
+
+  while (Index)               /* follow index list */
+  {
+    /* open index */
+    StartTimer(&Start);
+    Run = OpenIndexSearch(Index, &Search);
+    StopTimer(TIME_INDEX, &Start);
+
+    if (Search.State == INDEX_SKIPPED)
+    {
+      Log(L_WARN, "Skipped index (%s): fs not mounted", Index->Filepath);
+    }
+    else if (!Run)
+    {
+      Flag = False;                          /* signal error */
+    }
+
+
+    /*
+     *  process each filerequest in the current file index
+     */
+
+    Request = Env->RequestList;       /* start of list */
+    while (Run && Request)            /* follow request list */
+    {
+      /* init request status */
+      if (Request->Status == FREQ_NONE)     /* no status yet */
+      {
+        Request->Status = FREQ_NO_FILE;     /* "no file" by default */
+      }
+
+      if (Request->SearchName)              /* sanity check */
+      {
+        if (LoadResultCache(&Search, Request, &Cached))   /* cache hit */
+        {
+          if (!MergeResults(&Search, Request, &Cached)) Flag = False;
+          FreeCandidates(&Cached);
+        }
+        else                                   /* search index */
+        {
+          StartRecording(Request, &Cached);
+          Result = True;
+
+          /* get start position */
+          StartTimer(&Start);
+          Offset = GetSearchOffset(&Search, Request, BinSearch, InBuffer);
+          StopTimer(TIME_PRESEARCH, &Start);
+
+          /* search index data file */
+          if (Offset >= 0)           /* valid offset */
+          {
+            /* set start position */
+            if (fseeko(Search.DataFile, Offset, SEEK_SET) == 0)
+            {
+              /* scan time without file details of matches */
+              StatTime = Timing.Time[TIME_STAT];
+              StartTimer(&Start);
+              Result = SearchIndex(Search.DataFile, Search.Alias, Request);
+              StopTimer(TIME_SCAN, &Start);
+              Timing.Time[TIME_SCAN] -= Timing.Time[TIME_STAT] - StatTime;
+
+              if (!Result) Flag = False;          /* signal error */
+            }
+          }
+
+          StopRecording(&Search, Request, Result);
+        }
+      }
+
+      /* any limits exceeded */
+      if (Env->FreqStatus & FREQ_LIMIT)
+      {
+        Limit = True;              /* set flag */
+        Run = False;               /* end loop (requests) */
+      }
+
+      Request = Request->Next;        /* next element */
+    }
+
+    /* clean up */
+    CloseIndexSearch(&Search, 0);
+
+    if (Limit)                /* any limits exceeded */
+    {
+      Index = NULL;           /* end loop (indexes) */
+    }
+    else                      /* keep going */
+    {
+      Index = Index->Next;    /* next element */
+    }
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  read request file (loosely based on FTS-0006)
+ *
+ *  format: <name/pattern> [!<password>]
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool ReadRequest()
+{
+  _Bool                  Flag = False;        /* return value */
+  _Bool                  Run = True;          /* loop control */
+  FILE                   *File;               /* filestream */
+  int                    Freqs = 0;           /* number of frequests */
+  size_t                 Length;              /* string length */
+  Token_Type             *TokenList = NULL;   /* token list */
+  char                   *Password = NULL;    /* password */
+
+  File = fopen(Env->RequestFilepath, "r");         /* read mode */
+  if (File)
+  {
+    Flag = True;          /* signal success */
+
+    while (Run)
+    {
+      /* read line-wise */
+      if (fgets(InBuffer, DEFAULT_BUFFER_SIZE, File) != NULL)
+      {
+        Length = strlen(InBuffer);
+
+        if (Length == 0)                  /* sanity check */
+        {
+          Run = False;                         /* end loop */
+        }
+        else if (Length == (DEFAULT_BUFFER_SIZE - 1))         /* maximum size reached */
+        {
+          /* now check if line matches buffer size exacly or exceeds it */
+          /* exact matches should have a LF as last character in front of the trailing 0 */
+          if (InBuffer[Length - 1] != 10)             /* pre-last char is not LF */
+          {
+            Run = False;                         /* end loop */
+            Log(L_WARN, "Input overflow for request file!");
+          }
+        }
+
+        if (Run)       /* if still in business */
+        {
+          /* remove LF at end of line */
+          if (InBuffer[Length - 1] == 10)
+          {
+            InBuffer[Length - 1] = 0;
+            Length--;
+          }
+
+          /* remove CR at end of line */
+          if (InBuffer[Length - 1] == 13)
+          {
+            InBuffer[Length - 1] = 0;
+            Length--;
+          }
+
+          /* if it's not an empty */
+          if (InBuffer[0] != 0)
+          {
+            /* we expect: <name> [!<password>] */
+
+            TokenList = Tokenize(InBuffer);          /* tokenize line */
+            if (TokenList && TokenList->String)      /* sanity check */
+            {
+              Freqs++;                  /* another frequest */
+
+              /* check if limit for frequests is exceeded */
+              if (Env->ActiveLimit)           /* sanity check */
+              {
+                if ((Env->ActiveLimit->Freqs >= 0) &&
+                    (Freqs > Env->ActiveLimit->Freqs))
+                {
+                  /* update global frequest status: frequest limit exceeded */
+                  Env->FreqStatus |= FREQ_FREQLIMIT;
+
+                  Run = False;            /* end loop */
+                }
+              }
+
+              /* check for optional PW */
+              if (TokenList->Next)                   /* got second token */
+              {
+                Password = TokenList->Next->String;
+
+                if (Password && (Password[0] == '!'))
+                {
+                  Password++;      /* skip "!" */
+                }
+                else
+                {
+                  Password = NULL;
+                  /* or should we allow passwords without "!" ? */ 
+                }
+              }
+
+              /* we ignore any stuff following the password */
+
+              if (Run)
+              {
+                /* add request to global list */
+                AddRequestElement(TokenList->String, Password);
+                Password = NULL;                     /* reset string */
+              }
+
+              FreeTokenlist(TokenList);              /* free list */
+              TokenList = NULL;
+            }
+          }
+        }
+      }
+      else                     /* EOF or error */
+      {
+        Run = False;               /* end loop */
+
+        /* check for error */
+        if (ferror(File) != 0)
+        {
+          Log(L_WARN, "Read error for request file!");
+        }
+      }
+    }
+
+    fclose(File);           /* close file */
+
+    /* log problem */
+    if (!Flag) Log(L_WARN, "Couldn't read request file!");
+  }
+  else
+  {
+    Log(L_WARN, "Couldn't open request file (%s)!", Env->RequestFilepath);
+  }
+
+  return Flag;
+}
+
+
+
+/* ************************************************************************
+ *   SRIF
+ * ************************************************************************ */
+
+
+/*
+ *  get filepath from SRIF
+ *  - takes over string
+ *  - resident server: relative filepath is based on the client's
+ *    working directory (not the server's)
+ *
+ *  returns:
+ *  - pointer to filepath
+ */
+
+char *ClientFilepath(char *Filepath)
+{
+  char              *Help;              /* absolute filepath */
+
+  /* sanity checks */
+  if ((Filepath == NULL) || (Filepath[0] == '/') || (Env->CWD == NULL))
+    return Filepath;
+  if (Env->RunMode != MODE_SERVER) return Filepath;
+
+  Help = malloc(strlen(Env->CWD) + strlen(Filepath) + 2);
+  if (Help)
+  {
+    sprintf(Help, "%s/%s", Env->CWD, Filepath);
+    free(Filepath);
+    Filepath = Help;
+  }
+  else
+  {
+    Log(L_ERR, "Couldn't allocate memory!");
+  }
+
+  return Filepath;
+}
+
+
+
+/*
+ *  parse SRIF
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool ParseSRIF(Token_Type *TokenList)
+{
+  _Bool                  Flag = False;       /* return value */
+  _Bool                  Run = True;         /* control flag */
+  unsigned short         Keyword = 0;        /* keyword ID */
+  static char            *Keywords[12] =
+    {"Sysop", "AKA", "Baud", "Time", "RequestList",
+     "ResponseList", "RemoteStatus", "SystemStatus", "OurAKA", "CallerID",
+     "SessionType", NULL};
+  AKA_Type               *AKA;
+
+  /* sanity checks */
+  if (TokenList == NULL) return Flag;
+
+
+  /*
+   *  parse tokens
+   */
+
+  while (Run && TokenList && TokenList->String)
+  {
+    if (Keyword > 0)        /* get value */
+    {
+      switch (Keyword)
+      {
+        case 1:     /* sysop */
+          if (Env->Sysop)                    /* free old one */
+          {
+            free(Env->Sysop);
+            Env->Sysop = NULL;
+          }
+          /* sysops name may have several parts (tokens) */
+          Env->Sysop = UnTokenize(TokenList);
+          break;
+      
+        case 2:     /* AKA */
+          if ((AKA = NewAKA(TokenList->String)))  /* create AKA */
+          {
+            /* add to global list */
+            if (Env->ReqLastAKA) Env->ReqLastAKA->Next = AKA;
+            else Env->ReqAKA = AKA;
+            Env->ReqLastAKA = AKA; 
+          }
+          break;
+
+        case 3:     /* baud */
+          Env->BPS = Str2Long(TokenList->String);
+          break;
+
+        case 4:     /* time */
+          Env->ReqTime = Str2Long(TokenList->String);
+          break;
+
+        case 5:     /* request file */
+          if (Env->RequestFilepath)          /* free old one */
+          {
+            free(Env->RequestFilepath);
+            Env->RequestFilepath = NULL;
+          }
+          Env->RequestFilepath = ClientFilepath(TokenList->String);
+          TokenList->String = NULL;
+          break;
+
+        case 6:     /* response file */
+          if (Env->ResponseFilepath)         /* free old one */
+          {
+            free(Env->ResponseFilepath);
+            Env->ResponseFilepath = NULL;
+          }
+          Env->ResponseFilepath = ClientFilepath(TokenList->String);
+          TokenList->String = NULL;
+          break;
+
+        case 7:     /* remote status */
+          /* check for keyword */
+          if (strcasecmp(TokenList->String, "UNPROTECTED") == 0)
+          {
+            Env->ReqFlags |= REQ_UNPROTECTED;
+          }
+          else if (strcasecmp(TokenList->String, "PROTECTED") == 0)
+          {
+            Env->ReqFlags |= REQ_PROTECTED;
+          }
+          break;
+
+        case 8:     /* system status */
+          /* check for keyword */
+          if (strcasecmp(TokenList->String, "UNLISTED") == 0)
+          {
+            Env->ReqFlags |= REQ_UNLISTED;
+          }
+          else if (strcasecmp(TokenList->String, "LISTED") == 0)
+          {
+            Env->ReqFlags |= REQ_LISTED;
+          }
+          break;
+
+        case 9:     /* our AKA (optional) */
+          if (Env->CalledAKA)                     /* free old AKA */
+          {
+            FreeAKAlist(Env->CalledAKA);
+            Env->CalledAKA = NULL;
+          }
+          if ((AKA = NewAKA(TokenList->String)))  /* create AKA */
+          {
+            Env->CalledAKA = AKA;
+          }
+          break;
+
+        case 10:    /* Caller ID (optional) */
+          if (Env->CallerID)            /* free old one */
+          {
+            free(Env->CallerID);
+            Env->CallerID = NULL;
+          }
+          /* in case the caller ID has several parts (tokens) */
+          Env->CallerID = UnTokenize(TokenList);
+          break;
+
+        case 11:    /* session type (optional) */
+          if (Env->SessionType)         /* free old one */
+          {
+            free(Env->SessionType);
+            Env->SessionType = NULL;
+          }
+          /* copy session type */
+          Env->SessionType = CopyString(TokenList->String);
+          break;
+      }
+
+      Keyword = 0;             /* reset */
+    }
+    else                   /* get keyword */
+    {
+      Keyword = GetKeyword(Keywords, TokenList->String);
+
+      if (Keyword == 0)       /* unknown keyword */
+      {
+        Run = False;               /* end loop */
+        Log(L_WARN, "Unknown keyword in SRIF (%s)!", TokenList->String);
+      }
+    }
+
+    TokenList = TokenList->Next;     /* goto to next token */
+  }
+
+
+  /*
+   *  Since some statements are optional and even might lack data
+   *  we assume everything's fine :)
+   */
+
+  Flag = True;
+
+  return Flag;
+}
+
+
+
+/*
+ *  read SRIF
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool ReadSRIF()
+{
+  _Bool                  Flag = False;        /* return value */
+  _Bool                  Run = True;          /* loop control */
+  FILE                   *File;               /* filestream */
+  size_t                 Length;
+  Token_Type             *TokenList;
+
+  File = fopen(Env->SRIF_Filepath, "r");         /* read mode */
+
+  if (File)
+  {
+    while (Run)
+    {
+      /* read line-wise */
+      if (fgets(InBuffer, DEFAULT_BUFFER_SIZE, File) != NULL)
+      {
+        Length = strlen(InBuffer);
+
+        if (Length == 0)                  /* sanity check */
+        {
+          Run = False;                         /* end loop */
+        }
+        else if (Length == (DEFAULT_BUFFER_SIZE - 1))         /* maximum size reached */
+        {
+          /* now check if line matches buffer size exacly or exceeds it */
+          /* exact matches should have a LF as last character in front of the trailing 0 */
+          if (InBuffer[Length - 1] != 10)             /* pre-last char is not LF */
+          {
+            Run = False;                         /* end loop */
+            Log(L_WARN, "Input overflow for SRIF file!");
+          }
+        }
+
+        if (Run)       /* if still in business */
+        {
+          /* remove LF at end of line */
+          if (InBuffer[Length - 1] == 10)
           {
             InBuffer[Length - 1] = 0;
             Length--;
           }
 
-          /* if it's not an empty */
-          if (InBuffer[0] != 0)
-          {
-            /* we expect: <name> [!<password>] */
+          /* if it's not an empty line */
+          if (InBuffer[0] != 0)
+          {
+            TokenList = Tokenize(InBuffer);          /* tokenize line */
+
+            if (TokenList)
+            {
+              Flag = ParseSRIF(TokenList);           /* parse line */
+              if (Flag == False) Run = False;        /* end loop on error */
+              FreeTokenlist(TokenList);              /* free linked list */
+            }
+          }
+        }
+      }
+      else                     /* EOF or error */
+      {
+        Run = False;               /* end loop */
+
+        /* check for error */
+        if (ferror(File) != 0)
+        {
+          Flag = False;            /* signal problem */
+          Log(L_WARN, "Read error for SRIF!");
+        }
+      }
+    }
+
+    fclose(File);           /* close file */
+
+    /* log problem */
+    if (!Flag) Log(L_WARN, "Couldn't read SRIF!");
+  }
+  else
+  {
+    Log(L_WARN, "Couldn't open SRIF file (%s)!", Env->SRIF_Filepath);
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  check SRIF data for required stuff
+ *
+ *  returns:
+ *  - 1 on success (if any match is found)
+ *  - 0 on error
+ */
+
+_Bool CheckSRIF()
+{
+  _Bool                  Flag = False;     /* return value */
+
+  /* we don't care obout Baud, Time, RemoteStatus and SystemStatus */
+
+  /*
+   *  we require request file, response file and one AKA
+   */
+
+  if (Env->RequestFilepath && Env->ResponseFilepath && Env->ReqAKA)
+  {
+    Flag = True;
+  }
+  else
+  {
+    Log(L_WARN, "Required settings are missing in SRIF!");
+  }
+
+
+  /*
+   *  missing sysop
+   */
+
+  if (Env->Sysop == NULL)
+  {
+    /* in case we should send a netmail */
+    if (Env->CfgSwitches & SW_SEND_NETMAIL)
+    {
+      /* change that into a textmail */
+      Env->CfgSwitches |= SW_SEND_TEXT;           /* enable textmail */
+      Env->CfgSwitches &= ~SW_SEND_NETMAIL;       /* disable netmail */
+    }
+
+    /* set pseudo name for logging */
+    Env->Sysop = CopyString("Sysop");
+  }
+
+  return Flag;
+}
+
+
+
+/* ************************************************************************
+ *   frequest session
+ * ************************************************************************ */
+
+
+/*
+ *  process frequest for SRIF file
+ *  - read and check SRIF
+ *  - search requested files
+ *  - write response and netmail/textmail
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool ProcessSRIF()
+{
+  _Bool                  Flag = False;        /* return value */
+  struct timespec        Start;               /* timer */
+
+  /*
+   *  read SRIF and init stuff
+   */
+
+  StartTimer(&Start);
+
+  if (ReadSRIF())                 /* read SRIF */
+  {
+    if (CheckSRIF())              /* check SRIF for required stuff */
+    {
+      if (ActivateAKAs())         /* find best AKA pair */
+      {
+        Flag = True;              /* ok to proceed */
+      }
+    }
+  }
+
+  StopTimer(TIME_SRIF, &Start);
+
+
+  /*
+   *  process request
+   */
+
+  if (Flag)
+  {
+    Flag = False;                       /* reset flag */
+
+    /* log request */
+    Log(L_INFO, "Request from %s %s",
+      Env->Sysop, Env->ActiveRemoteAKA->Address);
+    if (Env->CallerID)                  /* caller ID available */
+    {
+      Log(L_INFO, "Caller ID: %s", Env->CallerID);
+    }
+    if (Env->SessionType)               /* session type available */
+    {
+      Log(L_INFO, "Session Type: %s", Env->SessionType);
+    }
+
+    StartTimer(&Start);
+    ActivateLimits();         /* apply rule for frequest limits */
+    StopTimer(TIME_LIMITS, &Start);
+
+    StartTimer(&Start);
+    Flag = ReadRequest();     /* read request */
+    StopTimer(TIME_REQUEST, &Start);
+
+    if (Flag)
+    {
+
+      /* delete request file if requested */
+      if (Env->CfgSwitches & SW_DELETE_REQUEST)
+        unlink(Env->RequestFilepath);
+
+      Flag &= ProcessRequest();    /* search for requested files */
+
+      StartTimer(&Start);
+
+      /* create netmail if requested */
+      if (Env->CfgSwitches & SW_SEND_NETMAIL)
+        Flag &= NetMail();
+
+      /* create textmail if requested */
+      if (Env->CfgSwitches & SW_SEND_TEXT)
+        Flag &= TextMail();
+
+      StopTimer(TIME_MAIL, &Start);
+
+      /* log request detailed if requested */ 
+      if (Env->CfgSwitches & SW_LOG_REQUEST) LogRequest();
+
+      StartTimer(&Start);
+      Flag &= WriteResponse();     /* write file list */
+      StopTimer(TIME_RESPONSE, &Start);
+
+      /* log results */
+      if (Env->FreqStatus & FREQ_FREQLIMIT)
+        Log(L_INFO, "frequest limit exceeded");
+      if (Env->FreqStatus & FREQ_FILELIMIT)
+        Log(L_INFO, "file limit exceeded");
+      if (Env->FreqStatus & FREQ_BYTELIMIT)
+        Log(L_INFO, "byte limit exceeded");
+      if (Env->FreqStatus & FREQ_PWLIMIT)
+        Log(L_INFO, "bad PW limit exceeded");
+
+      if (Bytes2String(Env->Bytes, TempBuffer, DEFAULT_BUFFER_SIZE))
+        Log(L_INFO, "Totals: %ld files / %s", Env->Files, TempBuffer);
+
+      /* add session to journal if requested */
+      if (Env->JournalPath) WriteJournal();
+
+      /* count files sent if requested */
+      if (Env->CounterPath) UpdateCounters();
+    }
+  }
+
+  /* prune result cache once in a while (server: main loop) */
+  if (Env->CachePath && (Env->RunMode != MODE_SERVER))
+    PruneResultCache(False);
+
+  /* log timing if requested */
+  if (Env->CfgSwitches & SW_TIMING) LogTiming();
 
-            TokenList = Tokenize(InBuffer);          /* tokenize line */
-            if (TokenList && TokenList->String)      /* sanity check */
-            {
-              Freqs++;                  /* another frequest */
+  return Flag;
+}
 
-              /* check if limit for frequests is exceeded */
-              if (Env->ActiveLimit)           /* sanity check */
-              {
-                if ((Env->ActiveLimit->Freqs >= 0) &&
-                    (Freqs > Env->ActiveLimit->Freqs))
-                {
-                  /* update global frequest status: frequest limit exceeded */
-                  Env->FreqStatus |= FREQ_FREQLIMIT;
 
-                  Run = False;            /* end loop */
-                }
-              }
 
-              /* check for optional PW */
-              if (TokenList->Next)                   /* got second token */
-              {
-                Password = TokenList->Next->String;
+/*
+ *  reset frequest details for next session (batch mode)
+ *  - frees SRIF details and request list
+ *  - resets counters and restores cfg switches
+ */
 
-                if (Password && (Password[0] == '!'))
-                {
-                  Password++;      /* skip "!" */
-                }
-                else
-                {
-                  Password = NULL;
-                  /* or should we allow passwords without "!" ? */ 
-                }
-              }
+void ResetSession(unsigned short CfgSwitches)
+{
+  /* free strings */
+  if (Env->SRIF_Filepath)
+  {
+    free(Env->SRIF_Filepath);
+    Env->SRIF_Filepath = NULL;
+  }
+  if (Env->RequestFilepath)
+  {
+    free(Env->RequestFilepath);
+    Env->RequestFilepath = NULL;
+  }
+  if (Env->ResponseFilepath)
+  {
+    free(Env->ResponseFilepath);
+    Env->ResponseFilepath = NULL;
+  }
+  if (Env->MailFilepath)
+  {
+    free(Env->MailFilepath);
+    Env->MailFilepath = NULL;
+  }
+  if (Env->TextFilepath)
+  {
+    free(Env->TextFilepath);
+    Env->TextFilepath = NULL;
+  }
+  if (Env->Sysop)
+  {
+    free(Env->Sysop);
+    Env->Sysop = NULL;
+  }
+  if (Env->CallerID)
+  {
+    free(Env->CallerID);
+    Env->CallerID = NULL;
+  }
+  if (Env->SessionType)
+  {
+    free(Env->SessionType);
+    Env->SessionType = NULL;
+  }
 
-              /* we ignore any stuff following the password */
+  /* free lists */
+  if (Env->ReqAKA) FreeAKAlist(Env->ReqAKA);
+  Env->ReqAKA = NULL;
+  Env->ReqLastAKA = NULL;
+  if (Env->CalledAKA) FreeAKAlist(Env->CalledAKA);
+  Env->CalledAKA = NULL;
+  if (Env->RequestList) FreeRequestList(Env->RequestList);
+  Env->RequestList = NULL;
+  Env->LastRequest = NULL;
+
+  /* reset requester details */
+  Env->BPS = 0;
+  Env->ReqTime = 0;
+  Env->ReqFlags = REQ_NONE;
+
+  /* reset runtime stuff */
+  Env->ActiveLimit = NULL;
+  Env->Files = 0;
+  Env->Bytes = 0;
+  Env->FreqStatus = FREQ_NONE;
+  Env->ActiveLocalAKA = NULL;
+  Env->ActiveRemoteAKA = NULL;
+  BadPWs = 0;
+  memset(&Timing, 0, sizeof(Timing_Type));
+
+  /* SRIF may change switches */
+  Env->CfgSwitches = CfgSwitches;
+
+  /* update time for this session */
+  time(&(Env->UnixTime));
+  localtime_r(&(Env->UnixTime), &(Env->DateTime));
+}
 
-              if (Run)
-              {
-                /* add request to global list */
-                AddRequestElement(TokenList->String, Password);
-                Password = NULL;                     /* reset string */
-              }
 
-              FreeTokenlist(TokenList);              /* free list */
-              TokenList = NULL;
-            }
-          }
-        }
+
+/* ************************************************************************
+ *   batch mode
+ * ************************************************************************ */
+
+
+/*
+ *  process all SRIF files in spool directory
+ *  - SRIF files are processed in alphabetical order
+ *  - only files matching the name pattern are processed
+ *  - hidden files and failed SRIF files (*.bad) are skipped
+ *  - files modified within the last SPOOL_MIN_AGE seconds are skipped,
+ *    since the mailer might still be writing them
+ *  - a processed SRIF file is deleted, a failed one renamed to *.bad
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool RunBatch()
+{
+  _Bool                  Flag = False;        /* return value */
+  _Bool                  Run;                 /* control flag */
+  struct dirent          **List = NULL;       /* directory entries */
+  char                   *Name;               /* filename */
+  size_t                 Length;              /* string length */
+  int                    Number;              /* number of entries */
+  int                    n;                   /* counter */
+  unsigned long          Requests = 0;        /* number of requests */
+  unsigned long          Errors = 0;          /* number of failed requests */
+  unsigned short         CfgSwitches;         /* switches of config */
+  char                   *Pattern;            /* name pattern */
+  time_t                 Now;                 /* current time */
+  struct stat            FileData;
+
+  /* sanity check */
+  if (Env->SpoolPath == NULL) return Flag;
+
+  CfgSwitches = Env->CfgSwitches;      /* keep switches of config */
+  Pattern = Env->SpoolPattern;
+  if (Pattern == NULL) Pattern = SPOOL_PATTERN;
+  Now = time(NULL);
+
+  Number = scandir(Env->SpoolPath, &List, NULL, alphasort);
+  if (Number < 0)
+  {
+    Log(L_WARN, "Couldn't open spool directory (%s)!", Env->SpoolPath);
+    return Flag;
+  }
+
+  Flag = True;
+
+  for (n = 0; n < Number; n++)
+  {
+    Run = True;
+    Name = List[n]->d_name;
+    Length = strlen(Name);
+
+    /* skip hidden, failed and non-SRIF files */
+    if (Name[0] == '.') Run = False;
+    else if ((Length > 4) &&
+             (strcmp(&Name[Length - 4], "."SUFFIX_BAD) == 0)) Run = False;
+    else if (! MatchPattern(Name, Pattern)) Run = False;
+
+    /* regular files only */
+    if (Run)
+    {
+      snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1,
+        "%s/%s", Env->SpoolPath, Name);
+
+      if ((stat(TempBuffer2, &FileData) != 0) ||
+          (! S_ISREG(FileData.st_mode))) Run = False;
+    }
+
+    /* skip files the mailer might still be writing (next run) */
+    if (Run && (FileData.st_mtime > Now - SPOOL_MIN_AGE)) Run = False;
+
+    if (Run)                  /* process SRIF */
+    {
+      ResetSession(CfgSwitches);
+      Env->SRIF_Filepath = CopyString(TempBuffer2);
+      Requests++;
+
+      if (ProcessSRIF())      /* success */
+      {
+        unlink(Env->SRIF_Filepath);
       }
-      else                     /* EOF or error */
+      else                    /* error */
       {
-        Run = False;               /* end loop */
+        Errors++;
+        Log(L_WARN, "Couldn't process SRIF (%s)!", Env->SRIF_Filepath);
 
-        /* check for error */
-        if (ferror(File) != 0)
-        {
-          Log(L_WARN, "Read error for request file!");
-        }
+        snprintf(TempBuffer2, DEFAULT_BUFFER_SIZE - 1,
+          "%s."SUFFIX_BAD, Env->SRIF_Filepath);
+        if (rename(Env->SRIF_Filepath, TempBuffer2) != 0)
+          Log(L_WARN, "Couldn't rename SRIF (%s)!", Env->SRIF_Filepath);
       }
     }
 
-    fclose(File);           /* close file */
+    free(List[n]);
+  }
 
-    /* log problem */
-    if (!Flag) Log(L_WARN, "Couldn't read request file!");
+  free(List);
+
+  Log(L_INFO, "Batch done: %lu requests, %lu errors", Requests, Errors);
+  if (Errors > 0) Flag = False;
+
+  return Flag;
+}
+
+
+
+/* ************************************************************************
+ *   resident server
+ * ************************************************************************ */
+
+
+/*
+ *  signal handler for resident server
+ *  - SIGTERM and SIGINT end the server loop
+ */
+
+void ServerSignal(int Signal)
+{
+  ServerRun = 0;              /* end server loop */
+}
+
+
+
+/*
+ *  serve a single client (child process)
+ *  - request:  SRIF <filepath>0x1F<working directory>LF
+ *  - response: OK LF, ERROR LF (request failed)
+ *              or BAD LF (request not processed)
+ *  - relative paths in the SRIF are based on the client's working directory
+ *    (see ParseSRIF())
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool ServeClient(int Client)
+{
+  _Bool                  Flag = False;        /* return value */
+  _Bool                  Bad = True;          /* request not processed */
+  size_t                 Length = 0;          /* string length */
+  ssize_t                Bytes;               /* bytes read */
+  char                   *Help;
+  char                   *Dir;                /* working directory */
+  struct timeval         Timeout;
+
+  /* update process details and time for this session */
+  Env->PID = getpid();
+  time(&(Env->UnixTime));
+  localtime_r(&(Env->UnixTime), &(Env->DateTime));
+  memset(&Timing, 0, sizeof(Timing_Type));
+
+  /* don't wait forever for a broken client */
+  Timeout.tv_sec = 10;
+  Timeout.tv_usec = 0;
+  setsockopt(Client, SOL_SOCKET, SO_RCVTIMEO, &Timeout, sizeof(Timeout));
+
+  /* read request line */
+  Help = NULL;
+  while (Help == NULL)
+  {
+    Bytes = read(Client, InBuffer2 + Length, DEFAULT_BUFFER_SIZE - 1 - Length);
+
+    if (Bytes > 0)            /* got data */
+    {
+      Length += Bytes;
+      InBuffer2[Length] = 0;
+      Help = strchr(InBuffer2, '\n');
+
+      if ((Help == NULL) && (Length >= DEFAULT_BUFFER_SIZE - 1))
+      {
+        Log(L_WARN, "Input overflow for client request!");
+        Help = InBuffer2;     /* end loop */
+        Length = 0;
+      }
+    }
+    else                      /* EOF or error */
+    {
+      Help = InBuffer2;       /* end loop */
+      Length = 0;
+    }
   }
-  else
+
+  /* parse request */
+  if (Length > 0)
   {
-    Log(L_WARN, "Couldn't open request file (%s)!", Env->RequestFilepath);
+    Help[0] = 0;              /* remove LF */
+
+    Dir = strchr(InBuffer2, 31);
+    if (Dir)                  /* working directory of client */
+    {
+      Dir[0] = 0;
+      Dir++;
+    }
+
+    if ((strncmp(InBuffer2, "SRIF ", 5) != 0) ||
+        (Dir == NULL) || (Dir[0] != '/'))
+    {
+      Log(L_WARN, "Bad client request!");
+    }
+    else
+    {
+      if (Env->CWD) free(Env->CWD);
+      Env->CWD = CopyString(Dir);
+      Env->SRIF_Filepath = CopyString(InBuffer2 + 5);
+      Bad = False;
+      Flag = ProcessSRIF();
+    }
   }
 
+  /* send result */
+  if (Flag) Help = "OK\n";
+  else if (Bad) Help = "BAD\n";
+  else Help = "ERROR\n";
+  if (write(Client, Help, strlen(Help)) < 0) Flag = False;
+
+  close(Client);
+
   return Flag;
 }
 
 
 
-/* ************************************************************************
- *   SRIF
- * ************************************************************************ */
+/*
+ *  run resident server
+ *  - config and indexes are loaded only once
+ *  - updated indexes are reloaded on the fly
+ *  - each request is processed by a child process
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool RunServer()
+{
+  _Bool                  Flag = False;        /* return value */
+  _Bool                  Reloaded;            /* index reloaded */
+  int                    Socket;              /* server socket */
+  int                    Client;              /* client connection */
+  pid_t                  PID;                 /* process ID */
+  unsigned long          Requests = 0;        /* number of requests */
+  unsigned int           Children = 0;        /* number of child processes */
+  time_t                 Now, LastCheck = 0;  /* time */
+  struct sockaddr_un     Address;             /* socket address */
+  struct pollfd          Poll;
+  struct sigaction       Action;
+  mode_t                 Mask;                /* file mode mask */
+
+  /* sanity check */
+  if (Env->SocketFilepath == NULL) return Flag;
+  if (strlen(Env->SocketFilepath) >= sizeof(Address.sun_path))
+  {
+    Log(L_WARN, "Socket filepath too long (%s)!", Env->SocketFilepath);
+    return Flag;
+  }
+
+  /* signal handling */
+  memset(&Action, 0, sizeof(Action));
+  Action.sa_handler = ServerSignal;
+  sigaction(SIGTERM, &Action, NULL);
+  sigaction(SIGINT, &Action, NULL);
+  signal(SIGPIPE, SIG_IGN);
+
+  /* create socket */
+  memset(&Address, 0, sizeof(Address));
+  Address.sun_family = AF_UNIX;
+  strcpy(Address.sun_path, Env->SocketFilepath);
+
+  /* check for running server and remove stale socket */
+  Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (Socket >= 0)
+  {
+    if (connect(Socket, (struct sockaddr *)&Address, sizeof(Address)) == 0)
+    {
+      close(Socket);
+      Log(L_WARN, "Server already running on %s!", Env->SocketFilepath);
+      return Flag;
+    }
+    else if (errno == ECONNREFUSED)    /* nobody listening */
+    {
+      unlink(Env->SocketFilepath);
+    }
+
+    close(Socket);
+  }
+
+  Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (Socket >= 0)
+  {
+    /* no access for others, even for a moment */
+    Mask = umask(~SOCKET_MODE & 0777);
+    if (bind(Socket, (struct sockaddr *)&Address, sizeof(Address)) == 0)
+    {
+      Flag = True;
+    }
+    umask(Mask);
+
+    /* set permissions explicitly */
+    if (Flag && ((chmod(Env->SocketFilepath, SOCKET_MODE) != 0) ||
+        (listen(Socket, 16) != 0)))
+    {
+      unlink(Env->SocketFilepath);
+      Flag = False;
+    }
+
+    if (Flag) Log(L_INFO, "Server listening on %s", Env->SocketFilepath);
+    else close(Socket);
+  }
+
+  if (!Flag) Log(L_WARN, "Couldn't create socket (%s)!", Env->SocketFilepath);
+
+
+  /*
+   *  server loop
+   */
+
+  Poll.fd = Socket;
+  Poll.events = POLLIN;
+
+  while (Flag && ServerRun)
+  {
+    /* reap child processes */
+    while ((Children > 0) && (waitpid(-1, NULL, WNOHANG) > 0)) Children--;
+
+    /* check for updated file indexes once per second */
+    time(&Now);
+    if (Now != LastCheck)
+    {
+      Reloaded = ReloadIndexes(Children);
+
+      /* prune result cache once in a while or for new index generation */
+      if (Env->CachePath) PruneResultCache(Reloaded);
+      FlushLog();             /* don't keep log lines while idle */
+      LastCheck = Now;
+    }
+
+    /* wait for connection */
+    if (poll(&Poll, 1, 1000) > 0)
+    {
+      Client = accept(Socket, NULL, NULL);
+
+      if (Client >= 0)
+      {
+        FlushLog();           /* don't duplicate buffered data */
+
+        PID = fork();
+
+        if (PID == 0)         /* child */
+        {
+          close(Socket);
+          Flag = ServeClient(Client);
+          FlushLog();         /* write buffered lines */
+          if (Flag) exit(EXIT_SUCCESS);
+          else exit(EXIT_FAILURE);
+        }
+        else if (PID > 0)     /* parent */
+        {
+          Children++;
+          Requests++;
+        }
+        else                  /* error */
+        {
+          Log(L_WARN, "Couldn't fork process!");
+        }
+
+        close(Client);
+      }
+    }
+  }
+
+
+  /*
+   *  clean up
+   */
+
+  if (Flag)
+  {
+    close(Socket);
+    unlink(Env->SocketFilepath);
+
+    /* wait for remaining child processes */
+    while (Children > 0)
+    {
+      if (waitpid(-1, NULL, 0) > 0) Children--;
+      else Children = 0;
+    }
+
+    Log(L_INFO, "Server stopped after %lu requests", Requests);
+  }
+
+  return Flag;
+}
+
 
 
 /*
- *  parse SRIF
+ *  pass frequest to resident server
+ *  - sends working directory for relative paths in SRIF
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
+ *  - -1 if server isn't available or didn't process request
  */
 
-_Bool ParseSRIF(Token_Type *TokenList)
+int PassToServer()
 {
-  _Bool                  Flag = False;       /* return value */
-  _Bool                  Run = True;         /* control flag */
-  unsigned short         Keyword = 0;        /* keyword ID */
-  static char            *Keywords[12] =
-    {"Sysop", "AKA", "Baud", "Time", "RequestList",
-     "ResponseList", "RemoteStatus", "SystemStatus", "OurAKA", "CallerID",
-     "SessionType", NULL};
-  AKA_Type               *AKA;
+  int                    Flag = -1;           /* return value */
+  int                    Socket;              /* server socket */
+  size_t                 Length = 0;          /* string length */
+  ssize_t                Bytes;               /* bytes read */
+  struct sockaddr_un     Address;             /* socket address */
 
   /* sanity checks */
-  if (TokenList == NULL) return Flag;
+  if ((Env->SocketFilepath == NULL) || (Env->SRIF_Filepath == NULL))
+    return Flag;
+  if (strlen(Env->SocketFilepath) >= sizeof(Address.sun_path))
+    return Flag;
 
+  memset(&Address, 0, sizeof(Address));
+  Address.sun_family = AF_UNIX;
+  strcpy(Address.sun_path, Env->SocketFilepath);
 
-  /*
-   *  parse tokens
-   */
+  Socket = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (Socket < 0) return Flag;
 
-  while (Run && TokenList && TokenList->String)
+  if (connect(Socket, (struct sockaddr *)&Address, sizeof(Address)) == 0)
   {
-    if (Keyword > 0)        /* get value */
-    {
-      switch (Keyword)
-      {
-        case 1:     /* sysop */
-          if (Env->Sysop)                    /* free old one */
-          {
-            free(Env->Sysop);
-            Env->Sysop = NULL;
-          }
-          /* sysops name may have several parts (tokens) */
-          Env->Sysop = UnTokenize(TokenList);
-          break;
-      
-        case 2:     /* AKA */
-          if ((AKA = NewAKA(TokenList->String)))  /* create AKA */
-          {
-            /* add to global list */
-            if (Env->ReqLastAKA) Env->ReqLastAKA->Next = AKA;
-            else Env->ReqAKA = AKA;
-            Env->ReqLastAKA = AKA; 
-          }
-          break;
+    Flag = 0;                 /* server available */
 
-        case 3:     /* baud */
-          Env->BPS = Str2Long(TokenList->String);
-          break;
+    /* server needs an absolute filepath and our working directory */
+    if (Env->SRIF_Filepath[0] == '/')
+      snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
+        "SRIF %s\037%s\n", Env->SRIF_Filepath, Env->CWD);
+    else
+      snprintf(OutBuffer, DEFAULT_BUFFER_SIZE - 1,
+        "SRIF %s/%s\037%s\n", Env->CWD, Env->SRIF_Filepath, Env->CWD);
 
-        case 4:     /* time */
-          Env->ReqTime = Str2Long(TokenList->String);
-          break;
+    if (write(Socket, OutBuffer, strlen(OutBuffer)) == strlen(OutBuffer))
+    {
+      /* wait for result */
+      Bytes = 1;
+      while ((Bytes > 0) && (Length < 10))
+      {
+        Bytes = read(Socket, InBuffer + Length, 10 - Length);
+        if (Bytes > 0) Length += Bytes;
+        InBuffer[Length] = 0;
+        if (strchr(InBuffer, '\n')) Bytes = 0;      /* end loop */
+      }
 
-        case 5:     /* request file */
-          if (Env->RequestFilepath)          /* free old one */
-          {
-            free(Env->RequestFilepath);
-            Env->RequestFilepath = NULL;
-          }
-          Env->RequestFilepath = TokenList->String;     /* move string */
-          TokenList->String = NULL;
-          break;
+      if (strncmp(InBuffer, "OK\n", 3) == 0) Flag = 1;
+      else if (strncmp(InBuffer, "BAD\n", 4) == 0)
+      {
+        Log(L_WARN, "Server rejected request!");
+        Flag = -1;
+      }
+    }
 
-        case 6:     /* response file */
-          if (Env->ResponseFilepath)         /* free old one */
-          {
-            free(Env->ResponseFilepath);
-            Env->ResponseFilepath = NULL;
-          }
-          Env->ResponseFilepath = TokenList->String;    /* move string */
-          TokenList->String = NULL;
-          break;
+    if (Flag == 0) Log(L_WARN, "Server couldn't process request!");
+  }
 
-        case 7:     /* remote status */
-          /* check for keyword */
-          if (strcasecmp(TokenList->String, "UNPROTECTED") == 0)
-          {
-            Env->ReqFlags |= REQ_UNPROTECTED;
-          }
-          else if (strcasecmp(TokenList->String, "PROTECTED") == 0)
-          {
-            Env->ReqFlags |= REQ_PROTECTED;
-          }
-          break;
+  close(Socket);
 
-        case 8:     /* system status */
-          /* check for keyword */
-          if (strcasecmp(TokenList->String, "UNLISTED") == 0)
-          {
-            Env->ReqFlags |= REQ_UNLISTED;
-          }
-          else if (strcasecmp(TokenList->String, "LISTED") == 0)
-          {
-            Env->ReqFlags |= REQ_LISTED;
-          }
-          break;
+  return Flag;
+}
 
-        case 9:     /* our AKA (optional) */
-          if (Env->CalledAKA)                     /* free old AKA */
-          {
-            FreeAKAlist(Env->CalledAKA);
-            Env->CalledAKA = NULL;
-          }
-          if ((AKA = NewAKA(TokenList->String)))  /* create AKA */
-          {
-            Env->CalledAKA = AKA;
-          }
-          break;
 
-        case 10:    /* Caller ID (optional) */
-          if (Env->CallerID)            /* free old one */
-          {
-            free(Env->CallerID);
-            Env->CallerID = NULL;
-          }
-          /* in case the caller ID has several parts (tokens) */
-          Env->CallerID = UnTokenize(TokenList);
-          break;
 
-        case 11:    /* session type (optional) */
-          if (Env->SessionType)         /* free old one */
-          {
-            free(Env->SessionType);
-            Env->SessionType = NULL;
-          }
-          /* copy session type */
-          Env->SessionType = CopyString(TokenList->String);
-          break;
-      }
+/* ************************************************************************
+ *   configuration parser support
+ * ************************************************************************ */
 
-      Keyword = 0;             /* reset */
-    }
-    else                   /* get keyword */
-    {
-      Keyword = GetKeyword(Keywords, TokenList->String);
 
-      if (Keyword == 0)       /* unknown keyword */
-      {
-        Run = False;               /* end loop */
-        Log(L_WARN, "Unknown keyword in SRIF (%s)!", TokenList->String);
-      }
-    }
+/*
+ *  log warning for bad or unknown keyword
+ */
 
-    TokenList = TokenList->Next;     /* goto to next token */
+void LogBadKeyword(char *KeyWord)
+{
+  if (KeyWord)      /* sanity check */
+  {
+    Log(L_WARN, "Bad or unknown Keyword: %s!", KeyWord);
   }
+}
 
 
-  /*
-   *  Since some statements are optional and even might lack data
-   *  we assume everything's fine :)
-   */
-
-  Flag = True;
-
-  return Flag;
-}
 
+/* ************************************************************************
+ *   configuration settings
+ * ************************************************************************ */
 
 
 /*
- *  read SRIF
+ *  add request limits
+ *  Syntax: Limit <FTS address pattern> [Files <number of>] [Bytes <number of>]
+ *                [IfListed]
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool ReadSRIF()
+_Bool Add_Limit(Token_Type *TokenList)
 {
-  _Bool                  Flag = False;        /* return value */
-  _Bool                  Run = True;          /* loop control */
-  FILE                   *File;               /* filestream */
-  size_t                 Length;
-  Token_Type             *TokenList;
+  _Bool             Flag = False;            /* return value */
+  _Bool             Run = True;              /* control flag */
+  unsigned short    Keyword = 0;             /* keyword ID */
+  char              *Address = NULL;         /* FTS address patern */
+  long              Files = 20;              /* number of files */
+  long long         Bytes = 2000000;         /* number of bytes */
+  int               BadPWs = 2;              /* number of bad passwords */
+  int               Freqs = 10;              /* number of frequests (*/
+  unsigned short    ReqFlags = REQ_NONE;     /* conditions */
+  static char       *Keywords[7] =
+    {"Limit", "Files", "Bytes", "BadPWs", "Freqs", "IfListed", NULL};
 
-  File = fopen(Env->SRIF_Filepath, "r");         /* read mode */
+  /* sanity check */
+  if (TokenList == NULL) return Flag;
 
-  if (File)
+
+  /*
+   *  parse tokens
+   */
+
+  while (Run && TokenList && TokenList->String)
   {
-    while (Run)
+    if (Keyword > 0)          /* get value */
     {
-      /* read line-wise */
-      if (fgets(InBuffer, DEFAULT_BUFFER_SIZE, File) != NULL)
+      switch (Keyword)
       {
-        Length = strlen(InBuffer);
+        case 1:     /* FTS address pattern */
+          Address = TokenList->String;
+          break;
 
-        if (Length == 0)                  /* sanity check */
-        {
-          Run = False;                         /* end loop */
-        }
-        else if (Length == (DEFAULT_BUFFER_SIZE - 1))         /* maximum size reached */
-        {
-          /* now check if line matches buffer size exacly or exceeds it */
-          /* exact matches should have a LF as last character in front of the trailing 0 */
-          if (InBuffer[Length - 1] != 10)             /* pre-last char is not LF */
-          {
-            Run = False;                         /* end loop */
-            Log(L_WARN, "Input overflow for SRIF file!");
-          }
-        }
+        case 2:     /* files */
+          Files = Str2Long(TokenList->String);
+          if (Files < -1) Run = False;
+          break;
 
-        if (Run)       /* if still in business */
-        {
-          /* remove LF at end of line */
-          if (InBuffer[Length - 1] == 10)
-          {
-            InBuffer[Length - 1] = 0;
-            Length--;
-          }
+        case 3:     /* bytes */
+          Bytes = String2Bytes(TokenList->String);
+          if (Bytes < -1) Run = False;
+          break;
 
-          /* if it's not an empty line */
-          if (InBuffer[0] != 0)
-          {
-            TokenList = Tokenize(InBuffer);          /* tokenize line */
+        case 4:     /* bad PWs */
+          BadPWs = Str2Long(TokenList->String);
+          if (BadPWs < -1) Run = False;
+          break;
 
-            if (TokenList)
-            {
-              Flag = ParseSRIF(TokenList);           /* parse line */
-              if (Flag == False) Run = False;        /* end loop on error */
-              FreeTokenlist(TokenList);              /* free linked list */
-            }
-          }
-        }
+        case 5:     /* frequests (filename pattern) */
+          Freqs = Str2Long(TokenList->String);
+          if (Freqs < -1) Run = False;
       }
-      else                     /* EOF or error */
+
+      Keyword = 0;            /* reset */
+    }
+    else                      /* get keyword */
+    {
+      Keyword = GetKeyword(Keywords, TokenList->String);
+
+      switch (Keyword)        /* keywords without data */
       {
-        Run = False;               /* end loop */
+        case 0:               /* unknown keyword */
+          Run = False;
+          LogBadKeyword(TokenList->String);
+          break;
 
-        /* check for error */
-        if (ferror(File) != 0)
-        {
-          Flag = False;            /* signal problem */
-          Log(L_WARN, "Read error for SRIF!");
-        }
+        case 6:               /* if listed */
+          ReqFlags |= REQ_LISTED;
+          Keyword = 0;        /* reset keyword */
       }
     }
 
-    fclose(File);           /* close file */
+    TokenList = TokenList->Next;     /* goto to next token */
+  }
 
-    /* log problem */
-    if (!Flag) Log(L_WARN, "Couldn't read SRIF!");
+
+  /*
+   *  check parser results
+   */
+
+  if ((Run == False) || (Keyword > 0) || (Address == NULL))
+  {
+    Run = False;
+    LogCfgError();
   }
-  else
+
+
+  /*
+   *  add to global list
+   */
+
+  if (Run)
   {
-    Log(L_WARN, "Couldn't open SRIF file (%s)!", Env->SRIF_Filepath);
+    Flag = AddLimitElement(Address, Files, Bytes, BadPWs, Freqs, ReqFlags);
   }
 
   return Flag;
@@ -2121,49 +5505,102 @@ _Bool ReadSRIF()
 
 
 /*
- *  check SRIF data for required stuff
+ *  add mail footer/header text
+ *  Syntax: MailHeader <text>
+ *          MailFooter <text>
  *
  *  returns:
- *  - 1 on success (if any match is found)
+ *  - 1 on success
  *  - 0 on error
  */
 
-_Bool CheckSRIF()
+_Bool Add_MailText(Token_Type *TokenList)
 {
-  _Bool                  Flag = False;     /* return value */
+  _Bool             Flag = False;       /* return value */
+  _Bool             Run = True;         /* control flag */
+  unsigned short    Type = 0;           /* text type */ 
+  unsigned short    Get = 0;            /* mode control */
+  Token_Type        *TextToken = NULL;  /* token with mail text */
+  Token_Type        *HelpToken = NULL;  /* token before TextToken */
+
+  #define FOOTER   1
+  #define HEADER   2
+
+  /* sanity check */
+  if (TokenList == NULL) return Flag;
 
-  /* we don't care obout Baud, Time, RemoteStatus and SystemStatus */
 
   /*
-   *  we require request file, response file and one AKA
+   *  parse tokens
    */
 
-  if (Env->RequestFilepath && Env->ResponseFilepath && Env->ReqAKA)
+  while (Run && TokenList && TokenList->String)
   {
-    Flag = True;
+    if (Get == 1)                  /* get value: text */
+    {
+      TextToken = TokenList;
+
+      Get = 0;                       /* reset */      
+    }
+    else if (strcasecmp(TokenList->String, "MailHeader") == 0)   /* header */
+    {
+      HelpToken = TokenList;           /* save token */
+      Type = HEADER;
+      Get = 1;
+    }
+    else if (strcasecmp(TokenList->String, "MailFooter") == 0)   /* footer */
+    {
+      HelpToken = TokenList;           /* save token */
+      Type = FOOTER;
+      Get = 1;
+    }
+    else                                               /* unknown */
+    {
+      Run = False;
+    }
+
+    TokenList = TokenList->Next;     /* goto to next token */
   }
-  else
+
+
+  /*
+   *  check parser results
+   */
+
+  if ((Run == False) || (Get > 0) || (TextToken == NULL))
   {
-    Log(L_WARN, "Required settings are missing in SRIF!");
+    Run = False;
+    LogCfgError();
   }
 
 
   /*
-   *  missing sysop
+   *  add to global list
    */
 
-  if (Env->Sysop == NULL)
+  if (Run)
   {
-    /* in case we should send a netmail */
-    if (Env->CfgSwitches & SW_SEND_NETMAIL)
+    /* move token from token list to mailheader/footer list */
+
+    HelpToken->Next = TextToken->Next;         /* unlink token */
+    TextToken->Next = NULL;                    /* single token */
+
+    if (Type == FOOTER)                 /* footer */
     {
-      /* change that into a textmail */
-      Env->CfgSwitches |= SW_SEND_TEXT;           /* enable textmail */
-      Env->CfgSwitches &= ~SW_SEND_NETMAIL;       /* disable netmail */
+      /* add token to end of list */
+      if (Env->LastFooter) Env->LastFooter->Next = TextToken;
+      else Env->MailFooter = TextToken;
+      Env->LastFooter = TextToken;
+    }
+    else if (Type == HEADER)            /* header */
+    {
+      /* add token to end of list */
+      if (Env->LastHeader) Env->LastHeader->Next = TextToken;
+      else Env->MailHeader = TextToken;
+      Env->LastHeader = TextToken;
     }
 
-    /* set pseudo name for logging */
-    Env->Sysop = CopyString("Sysop");
+    Flag = True;       /* signal success */
   }
 
   return Flag;
@@ -2171,53 +5608,102 @@ _Bool CheckSRIF()
 
 
 
-/* ************************************************************************
- *   configuration parser support
- * ************************************************************************ */
-
-
 /*
- *  log warning for bad or unknown keyword
+ *  set path for netmail
+ *  Syntax: NetMailDir <path>
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
  */
 
-void LogBadKeyword(char *KeyWord)
+_Bool Set_MailPath(Token_Type *TokenList)
 {
-  if (KeyWord)      /* sanity check */
+  _Bool             Flag = False;       /* return value */
+  _Bool             Run = True;         /* control flag */
+  unsigned short    Get = 0;            /* mode control */
+  Token_Type        *PathToken = NULL;
+
+  /* sanity check */
+  if (TokenList == NULL) return Flag;
+
+  /* prevent any additional calls of this command */
+  if (Env->MailPath)
   {
-    Log(L_WARN, "Bad or unknown Keyword: %s!", KeyWord);
+    Log(L_WARN, "MailPath already set!");
+    return Flag;
   }
-}
 
 
+  /*
+   *  parse tokens
+   */
+
+  while (Run && TokenList && TokenList->String)
+  {
+    if (Get == 1)                  /* get value: path */
+    {
+      PathToken = TokenList;
+      Get = 0;                       /* reset */      
+    }
+    else if (strcasecmp(TokenList->String, "MailDir") == 0)   /* path */
+    {
+      Get = 1;
+    }
+    else                                               /* unknown */
+    {
+      Run = False;
+    }
+
+    TokenList = TokenList->Next;     /* goto to next token */
+  }
+
+  /*
+   *  check parser results
+   */
+
+  if ((Run == False) || (Get > 0) || (PathToken == NULL))
+  {
+    Run = False;
+    LogCfgError();
+  }
+
+
+  /*
+   *  process
+   */
+
+  if (Run)
+  {
+    Env->MailPath = PathToken->String;        /* move string */
+    PathToken->String = NULL;
+    Flag = True;
+  }
+
+  return Flag;
+}
 
-/* ************************************************************************
- *   configuration settings
- * ************************************************************************ */
 
 
 /*
- *  add request limits
- *  Syntax: Limit <FTS address pattern> [Files <number of>] [Bytes <number of>]
- *                [IfListed]
+ *  add file index
+ *  Syntax: Index <filepath> [IfMounted <mounting point>]
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Add_Limit(Token_Type *TokenList)
+_Bool Add_Index(Token_Type *TokenList)
 {
-  _Bool             Flag = False;            /* return value */
-  _Bool             Run = True;              /* control flag */
-  unsigned short    Keyword = 0;             /* keyword ID */
-  char              *Address = NULL;         /* FTS address patern */
-  long              Files = 20;              /* number of files */
-  long long         Bytes = 2000000;         /* number of bytes */
-  int               BadPWs = 2;              /* number of bad passwords */
-  int               Freqs = 10;              /* number of frequests (*/
-  unsigned short    ReqFlags = REQ_NONE;     /* conditions */
-  static char       *Keywords[7] =
-    {"Limit", "Files", "Bytes", "BadPWs", "Freqs", "IfListed", NULL};
+  _Bool             Flag = False;       /* return value */
+  _Bool             Run = True;         /* control flag */
+  unsigned short    Keyword = 0;        /* keyword ID */
+  char              *IndexFilepath = NULL;
+  char              *MountingPoint = NULL;
+  static char       *Keywords[3] =
+    {"Index", "IfMounted", NULL};
+
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
@@ -2229,50 +5715,29 @@ _Bool Add_Limit(Token_Type *TokenList)
 
   while (Run && TokenList && TokenList->String)
   {
-    if (Keyword > 0)          /* get value */
-    {
-      switch (Keyword)
-      {
-        case 1:     /* FTS address pattern */
-          Address = TokenList->String;
-          break;
-
-        case 2:     /* files */
-          Files = Str2Long(TokenList->String);
-          if (Files < -1) Run = False;
-          break;
-
-        case 3:     /* bytes */
-          Bytes = String2Bytes(TokenList->String);
-          if (Bytes < -1) Run = False;
+    if (Keyword > 0)        /* get value */
+    {
+      switch (Keyword)
+      {
+        case 1:     /* filepath of file index */
+          IndexFilepath = TokenList->String;
           break;
-
-        case 4:     /* bad PWs */
-          BadPWs = Str2Long(TokenList->String);
-          if (BadPWs < -1) Run = False;
+      
+        case 2:     /* path of mounting point */
+          MountingPoint = TokenList->String;
           break;
-
-        case 5:     /* frequests (filename pattern) */
-          Freqs = Str2Long(TokenList->String);
-          if (Freqs < -1) Run = False;
       }
 
-      Keyword = 0;            /* reset */
+      Keyword = 0;             /* reset */
     }
-    else                      /* get keyword */
+    else                   /* get keyword */
     {
       Keyword = GetKeyword(Keywords, TokenList->String);
 
-      switch (Keyword)        /* keywords without data */
+      if (Keyword == 0)       /* unknown keyword */
       {
-        case 0:               /* unknown keyword */
-          Run = False;
-          LogBadKeyword(TokenList->String);
-          break;
-
-        case 6:               /* if listed */
-          ReqFlags |= REQ_LISTED;
-          Keyword = 0;        /* reset keyword */
+        Run = False;
+        LogBadKeyword(TokenList->String);
       }
     }
 
@@ -2284,7 +5749,7 @@ _Bool Add_Limit(Token_Type *TokenList)
    *  check parser results
    */
 
-  if ((Run == False) || (Keyword > 0) || (Address == NULL))
+  if ((Run == False) || (Keyword > 0) || (IndexFilepath == NULL))
   {
     Run = False;
     LogCfgError();
@@ -2297,7 +5762,7 @@ _Bool Add_Limit(Token_Type *TokenList)
 
   if (Run)
   {
-    Flag = AddLimitElement(Address, Files, Bytes, BadPWs, Freqs, ReqFlags);
+    Flag = AddIndexElement(IndexFilepath, MountingPoint);
   }
 
   return Flag;
@@ -2306,26 +5771,21 @@ _Bool Add_Limit(Token_Type *TokenList)
 
 
 /*
- *  add mail footer/header text
- *  Syntax: MailHeader <text>
- *          MailFooter <text>
+ *  add FTS address / AKA
+ *  Syntax: <zone>:<net>/<node>[.<point>][@<domain>]
+ *          
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
-
-_Bool Add_MailText(Token_Type *TokenList)
+_Bool Add_AKA(Token_Type *TokenList)
 {
   _Bool             Flag = False;       /* return value */
   _Bool             Run = True;         /* control flag */
-  unsigned short    Type = 0;           /* text type */ 
   unsigned short    Get = 0;            /* mode control */
-  Token_Type        *TextToken = NULL;  /* token with mail text */
-  Token_Type        *HelpToken = NULL;  /* token before TextToken */
-
-  #define FOOTER   1
-  #define HEADER   2
+  Token_Type        *AddressToken = NULL;
+  AKA_Type          *AKA;
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
@@ -2337,22 +5797,13 @@ _Bool Add_MailText(Token_Type *TokenList)
 
   while (Run && TokenList && TokenList->String)
   {
-    if (Get == 1)                  /* get value: text */
+    if (Get == 1)                  /* get value: address */
     {
-      TextToken = TokenList;
-
+      AddressToken = TokenList;
       Get = 0;                       /* reset */      
     }
-    else if (strcasecmp(TokenList->String, "MailHeader") == 0)   /* header */
-    {
-      HelpToken = TokenList;           /* save token */
-      Type = HEADER;
-      Get = 1;
-    }
-    else if (strcasecmp(TokenList->String, "MailFooter") == 0)   /* footer */
+    else if (strcasecmp(TokenList->String, "Address") == 0)   /* address */
     {
-      HelpToken = TokenList;           /* save token */
-      Type = FOOTER;
       Get = 1;
     }
     else                                               /* unknown */
@@ -2368,7 +5819,7 @@ _Bool Add_MailText(Token_Type *TokenList)
    *  check parser results
    */
 
-  if ((Run == False) || (Get > 0) || (TextToken == NULL))
+  if ((Run == False) || (Get > 0) || (AddressToken == NULL))
   {
     Run = False;
     LogCfgError();
@@ -2381,26 +5832,125 @@ _Bool Add_MailText(Token_Type *TokenList)
 
   if (Run)
   {
-    /* move token from token list to mailheader/footer list */
-
-    HelpToken->Next = TextToken->Next;         /* unlink token */
-    TextToken->Next = NULL;                    /* single token */
-
-    if (Type == FOOTER)                 /* footer */
+    if ((AKA = NewAKA(AddressToken->String)))    /* create AKA */
     {
-      /* add token to end of list */
-      if (Env->LastFooter) Env->LastFooter->Next = TextToken;
-      else Env->MailFooter = TextToken;
-      Env->LastFooter = TextToken;
+      /* add to global list */
+      if (Env->LastAKA) Env->LastAKA->Next = AKA;
+      else Env->AKA = AKA;
+      Env->LastAKA = AKA;
+
+      Flag = True;     /* signal success */
     }
-    else if (Type == HEADER)            /* header */
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  set mode
+ *  Syntax: SetMode [NetMail] [TextMail] [RemoveReq] [AnyCase]
+ *                  [BinarySearch] [LogRequest] [SI-Units]
+ *                  [ParallelSearch]
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool Set_Mode(Token_Type *TokenList)
+{
+  _Bool                  Flag = False;       /* return value */
+  _Bool                  Run = True;         /* control flag */
+  unsigned short         Keyword = 0;        /* keyword ID */
+  static char            *Keywords[13] =
+    {"SetMode", "NetMail", "NetMail+", "TextMail", "RemoveReq",
+     "AnyCase", "BinarySearch", "LogRequest", "SI-Units", "IEC-Units",
+     "ParallelSearch", "Timing", NULL};
+
+  /* sanity check */
+  if (TokenList == NULL) return Flag;
+
+
+  /*
+   *  parse tokens
+   */
+
+  while (Run && TokenList && TokenList->String)
+  {
+    Keyword = GetKeyword(Keywords, TokenList->String);
+
+    switch (Keyword)           /* keywords without data */
     {
-      /* add token to end of list */
-      if (Env->LastHeader) Env->LastHeader->Next = TextToken;
-      else Env->MailHeader = TextToken;
-      Env->LastHeader = TextToken;
+      case 0:       /* unknown keyword */
+        Run = False;
+        LogBadKeyword(TokenList->String);
+        break;
+
+      case 1:       /* command itself */
+        /* just skip */
+        break;
+
+      case 2:       /* netmail type-2 */
+        Env->CfgSwitches |= SW_SEND_NETMAIL | SW_TYPE_2;
+        break;
+
+      case 3:       /* netmail type-2+ */
+        Env->CfgSwitches |= SW_SEND_NETMAIL | SW_TYPE_2PLUS;
+        break;
+
+      case 4:       /* textmail */
+        Env->CfgSwitches |= SW_SEND_TEXT;
+        break;
+
+      case 5:       /* remove .req */
+        Env->CfgSwitches |= SW_DELETE_REQUEST;
+        break;
+
+      case 6:       /* any case */
+        Env->CfgSwitches |= SW_ANY_CASE;
+        break;
+
+      case 7:       /* binary search */
+        Env->CfgSwitches |= SW_BINARY_SEARCH;
+        break;
+
+      case 8:       /* log request */
+        Env->CfgSwitches |= SW_LOG_REQUEST;
+        break;
+
+      case 9:       /* SI units */
+        Env->CfgSwitches |= SW_SI_UNITS;
+        break;
+
+      case 10:      /* IEC units for output */
+        Env->CfgSwitches |= SW_IEC_UNITS;
+        break;
+
+      case 11:      /* parallel search */
+        Env->CfgSwitches |= SW_PARALLEL_SEARCH;
+        break;
+
+      case 12:      /* timing */
+        Env->CfgSwitches |= SW_TIMING;
+        break;
     }
 
+    TokenList = TokenList->Next;     /* goto to next token */
+  }
+
+
+  /*
+   *  check parser results
+   */
+
+  if (Run == False)
+  {
+    LogCfgError();
+  }
+  else
+  {
     Flag = True;       /* signal success */
   }
 
@@ -2410,28 +5960,30 @@ _Bool Add_MailText(Token_Type *TokenList)
 
 
 /*
- *  set path for netmail
- *  Syntax: NetMailDir <path>
+ *  open logfile
+ *  Syntax: LogFile <filepath> [Flush <seconds>]
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Set_MailPath(Token_Type *TokenList)
+_Bool Set_LogFile(Token_Type *TokenList)
 {
   _Bool             Flag = False;       /* return value */
   _Bool             Run = True;         /* control flag */
   unsigned short    Get = 0;            /* mode control */
-  Token_Type        *PathToken = NULL;
+  Token_Type        *FilepathToken = NULL;
+  long              Seconds = LOG_FLUSH;/* flush interval */
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
 
-  /* prevent any additional calls of this command */
-  if (Env->MailPath)
+  /* command line takes precedence */
+  /* also prevent any additional logfile command */
+  if (Env->LogFilepath)
   {
-    Log(L_WARN, "MailPath already set!");
+    Log(L_WARN, "Logfile already set!");
     return Flag;
   }
 
@@ -2442,15 +5994,24 @@ _Bool Set_MailPath(Token_Type *TokenList)
 
   while (Run && TokenList && TokenList->String)
   {
-    if (Get == 1)                  /* get value: path */
+    if (Get == 1)                  /* get value: filepath */
     {
-      PathToken = TokenList;
+      FilepathToken = TokenList;
       Get = 0;                       /* reset */      
     }
-    else if (strcasecmp(TokenList->String, "MailDir") == 0)   /* path */
+    else if (Get == 2)             /* get value: seconds */
+    {
+      Seconds = Str2Long(TokenList->String);
+      Get = 0;                       /* reset */
+    }
+    else if (strcasecmp(TokenList->String, "LogFile") == 0)   /* filepath */
     {
       Get = 1;
     }
+    else if (strcasecmp(TokenList->String, "Flush") == 0)     /* seconds */
+    {
+      Get = 2;
+    }
     else                                               /* unknown */
     {
       Run = False;
@@ -2459,11 +6020,13 @@ _Bool Set_MailPath(Token_Type *TokenList)
     TokenList = TokenList->Next;     /* goto to next token */
   }
 
+
   /*
    *  check parser results
    */
 
-  if ((Run == False) || (Get > 0) || (PathToken == NULL))
+  if ((Run == False) || (Get > 0) || (FilepathToken == NULL) ||
+      (Seconds < 0) || (Seconds > MAX_LOG_FLUSH))
   {
     Run = False;
     LogCfgError();
@@ -2476,9 +6039,10 @@ _Bool Set_MailPath(Token_Type *TokenList)
 
   if (Run)
   {
-    Env->MailPath = PathToken->String;        /* move string */
-    PathToken->String = NULL;
-    Flag = True;
+    Env->LogFilepath = FilepathToken->String;    /* move string */
+    FilepathToken->String = NULL;
+    Env->LogFlush = Seconds;
+    Flag = OpenLogfile();                        /* open file */
   }
 
   return Flag;
@@ -2487,59 +6051,43 @@ _Bool Set_MailPath(Token_Type *TokenList)
 
 
 /*
- *  add file index
- *  Syntax: Index <filepath> [IfMounted <mounting point>]
+ *  set number of threads for getting file details
+ *  Syntax: StatThreads <number>
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Add_Index(Token_Type *TokenList)
+_Bool Set_StatThreads(Token_Type *TokenList)
 {
   _Bool             Flag = False;       /* return value */
   _Bool             Run = True;         /* control flag */
-  unsigned short    Keyword = 0;        /* keyword ID */
-  char              *IndexFilepath = NULL;
-  char              *MountingPoint = NULL;
-  static char       *Keywords[3] =
-    {"Index", "IfMounted", NULL};
-
-
-  /* sanity check */
-  if (TokenList == NULL) return Flag;
-
-
-  /*
-   *  parse tokens
-   */
+  unsigned short    Get = 0;            /* mode control */
+  long              Number = -1;        /* number of threads */
 
-  while (Run && TokenList && TokenList->String)
-  {
-    if (Keyword > 0)        /* get value */
-    {
-      switch (Keyword)
-      {
-        case 1:     /* filepath of file index */
-          IndexFilepath = TokenList->String;
-          break;
-      
-        case 2:     /* path of mounting point */
-          MountingPoint = TokenList->String;
-          break;
-      }
+  /* sanity check */
+  if (TokenList == NULL) return Flag;
 
-      Keyword = 0;             /* reset */
+
+  /*
+   *  parse tokens
+   */
+
+  while (Run && TokenList && TokenList->String)
+  {
+    if (Get == 1)                  /* get value: number */
+    {
+      Number = Str2Long(TokenList->String);
+      Get = 0;                       /* reset */
     }
-    else                   /* get keyword */
+    else if (strcasecmp(TokenList->String, "StatThreads") == 0)   /* number */
     {
-      Keyword = GetKeyword(Keywords, TokenList->String);
-
-      if (Keyword == 0)       /* unknown keyword */
-      {
-        Run = False;
-        LogBadKeyword(TokenList->String);
-      }
+      Get = 1;
+    }
+    else                                               /* unknown */
+    {
+      Run = False;
     }
 
     TokenList = TokenList->Next;     /* goto to next token */
@@ -2550,7 +6098,8 @@ _Bool Add_Index(Token_Type *TokenList)
    *  check parser results
    */
 
-  if ((Run == False) || (Keyword > 0) || (IndexFilepath == NULL))
+  if ((Run == False) || (Get > 0) ||
+      (Number < 0) || (Number > MAX_STAT_THREADS))
   {
     Run = False;
     LogCfgError();
@@ -2558,12 +6107,13 @@ _Bool Add_Index(Token_Type *TokenList)
 
 
   /*
-   *  add to global list
+   *  process
    */
 
   if (Run)
   {
-    Flag = AddIndexElement(IndexFilepath, MountingPoint);
+    Env->StatThreads = Number;
+    Flag = True;
   }
 
   return Flag;
@@ -2572,25 +6122,32 @@ _Bool Add_Index(Token_Type *TokenList)
 
 
 /*
- *  add FTS address / AKA
- *  Syntax: <zone>:<net>/<node>[.<point>][@<domain>]
- *          
+ *  set path for result cache
+ *  Syntax: CachePath <path> [MaxFiles <number>]
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
-_Bool Add_AKA(Token_Type *TokenList)
+
+_Bool Set_CachePath(Token_Type *TokenList)
 {
   _Bool             Flag = False;       /* return value */
   _Bool             Run = True;         /* control flag */
   unsigned short    Get = 0;            /* mode control */
-  Token_Type        *AddressToken = NULL;
-  AKA_Type          *AKA;
+  Token_Type        *PathToken = NULL;
+  long              Number = CACHE_MAX_FILES;   /* max. cache files */
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
 
+  /* prevent any additional calls of this command */
+  if (Env->CachePath)
+  {
+    Log(L_WARN, "CachePath already set!");
+    return Flag;
+  }
+
 
   /*
    *  parse tokens
@@ -2598,15 +6155,24 @@ _Bool Add_AKA(Token_Type *TokenList)
 
   while (Run && TokenList && TokenList->String)
   {
-    if (Get == 1)                  /* get value: address */
+    if (Get == 1)                  /* get value: path */
     {
-      AddressToken = TokenList;
-      Get = 0;                       /* reset */      
+      PathToken = TokenList;
+      Get = 0;                       /* reset */
     }
-    else if (strcasecmp(TokenList->String, "Address") == 0)   /* address */
+    else if (Get == 2)             /* get value: number */
+    {
+      Number = Str2Long(TokenList->String);
+      Get = 0;                       /* reset */
+    }
+    else if (strcasecmp(TokenList->String, "CachePath") == 0)   /* path */
     {
       Get = 1;
     }
+    else if (strcasecmp(TokenList->String, "MaxFiles") == 0)    /* number */
+    {
+      Get = 2;
+    }
     else                                               /* unknown */
     {
       Run = False;
@@ -2620,7 +6186,7 @@ _Bool Add_AKA(Token_Type *TokenList)
    *  check parser results
    */
 
-  if ((Run == False) || (Get > 0) || (AddressToken == NULL))
+  if ((Run == False) || (Get > 0) || (PathToken == NULL) || (Number < 0))
   {
     Run = False;
     LogCfgError();
@@ -2628,20 +6194,15 @@ _Bool Add_AKA(Token_Type *TokenList)
 
 
   /*
-   *  add to global list
+   *  process
    */
 
   if (Run)
   {
-    if ((AKA = NewAKA(AddressToken->String)))    /* create AKA */
-    {
-      /* add to global list */
-      if (Env->LastAKA) Env->LastAKA->Next = AKA;
-      else Env->AKA = AKA;
-      Env->LastAKA = AKA;
-
-      Flag = True;     /* signal success */
-    }
+    Env->CachePath = PathToken->String;       /* move string */
+    PathToken->String = NULL;
+    Env->CacheMaxFiles = Number;
+    Flag = True;
   }
 
   return Flag;
@@ -2650,27 +6211,31 @@ _Bool Add_AKA(Token_Type *TokenList)
 
 
 /*
- *  set mode
- *  Syntax: SetMode [NetMail] [TextMail] [RemoveReq] [AnyCase]
- *                  [BinarySearch] [LogRequest] [SI-Units]
+ *  set filepath of request journal
+ *  Syntax: Journal <filepath>
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Set_Mode(Token_Type *TokenList)
+_Bool Set_Journal(Token_Type *TokenList)
 {
-  _Bool                  Flag = False;       /* return value */
-  _Bool                  Run = True;         /* control flag */
-  unsigned short         Keyword = 0;        /* keyword ID */
-  static char            *Keywords[11] =
-    {"SetMode", "NetMail", "NetMail+", "TextMail", "RemoveReq",
-     "AnyCase", "BinarySearch", "LogRequest", "SI-Units", "IEC-Units", NULL};
+  _Bool             Flag = False;       /* return value */
+  _Bool             Run = True;         /* control flag */
+  unsigned short    Get = 0;            /* mode control */
+  Token_Type        *FilepathToken = NULL;
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
 
+  /* prevent any additional calls of this command */
+  if (Env->JournalPath)
+  {
+    Log(L_WARN, "Journal already set!");
+    return Flag;
+  }
+
 
   /*
    *  parse tokens
@@ -2678,54 +6243,18 @@ _Bool Set_Mode(Token_Type *TokenList)
 
   while (Run && TokenList && TokenList->String)
   {
-    Keyword = GetKeyword(Keywords, TokenList->String);
-
-    switch (Keyword)           /* keywords without data */
+    if (Get == 1)                  /* get value: filepath */
     {
-      case 0:       /* unknown keyword */
-        Run = False;
-        LogBadKeyword(TokenList->String);
-        break;
-
-      case 1:       /* command itself */
-        /* just skip */
-        break;
-
-      case 2:       /* netmail type-2 */
-        Env->CfgSwitches |= SW_SEND_NETMAIL | SW_TYPE_2;
-        break;
-
-      case 3:       /* netmail type-2+ */
-        Env->CfgSwitches |= SW_SEND_NETMAIL | SW_TYPE_2PLUS;
-        break;
-
-      case 4:       /* textmail */
-        Env->CfgSwitches |= SW_SEND_TEXT;
-        break;
-
-      case 5:       /* remove .req */
-        Env->CfgSwitches |= SW_DELETE_REQUEST;
-        break;
-
-      case 6:       /* any case */
-        Env->CfgSwitches |= SW_ANY_CASE;
-        break;
-
-      case 7:       /* binary search */
-        Env->CfgSwitches |= SW_BINARY_SEARCH;
-        break;
-
-      case 8:       /* log request */
-        Env->CfgSwitches |= SW_LOG_REQUEST;
-        break;
-
-      case 9:       /* SI units */
-        Env->CfgSwitches |= SW_SI_UNITS;
-        break;
-
-      case 10:      /* IEC units for output */
-        Env->CfgSwitches |= SW_IEC_UNITS;
-        break;
+      FilepathToken = TokenList;
+      Get = 0;                       /* reset */
+    }
+    else if (strcasecmp(TokenList->String, "Journal") == 0)     /* filepath */
+    {
+      Get = 1;
+    }
+    else                                               /* unknown */
+    {
+      Run = False;
     }
 
     TokenList = TokenList->Next;     /* goto to next token */
@@ -2736,13 +6265,22 @@ _Bool Set_Mode(Token_Type *TokenList)
    *  check parser results
    */
 
-  if (Run == False)
+  if ((Run == False) || (Get > 0) || (FilepathToken == NULL))
   {
+    Run = False;
     LogCfgError();
   }
-  else
+
+
+  /*
+   *  process
+   */
+
+  if (Run)
   {
-    Flag = True;       /* signal success */
+    Env->JournalPath = FilepathToken->String;       /* move string */
+    FilepathToken->String = NULL;
+    Flag = True;
   }
 
   return Flag;
@@ -2751,15 +6289,15 @@ _Bool Set_Mode(Token_Type *TokenList)
 
 
 /*
- *  open logfile
- *  Syntax: LogFile <filepath>
+ *  set download counter store
+ *  Syntax: Counters <filepath>
  *
  *  returns:
  *  - 1 on success
  *  - 0 on error
  */
 
-_Bool Set_LogFile(Token_Type *TokenList)
+_Bool Set_Counters(Token_Type *TokenList)
 {
   _Bool             Flag = False;       /* return value */
   _Bool             Run = True;         /* control flag */
@@ -2769,11 +6307,10 @@ _Bool Set_LogFile(Token_Type *TokenList)
   /* sanity check */
   if (TokenList == NULL) return Flag;
 
-  /* command line takes precedence */
-  /* also prevent any additional logfile command */
-  if (Env->LogFilepath)
+  /* prevent any additional calls of this command */
+  if (Env->CounterPath)
   {
-    Log(L_WARN, "Logfile already set!");
+    Log(L_WARN, "Counters already set!");
     return Flag;
   }
 
@@ -2787,9 +6324,9 @@ _Bool Set_LogFile(Token_Type *TokenList)
     if (Get == 1)                  /* get value: filepath */
     {
       FilepathToken = TokenList;
-      Get = 0;                       /* reset */      
+      Get = 0;                       /* reset */
     }
-    else if (strcasecmp(TokenList->String, "LogFile") == 0)   /* filepath */
+    else if (strcasecmp(TokenList->String, "Counters") == 0)    /* filepath */
     {
       Get = 1;
     }
@@ -2819,9 +6356,9 @@ _Bool Set_LogFile(Token_Type *TokenList)
 
   if (Run)
   {
-    Env->LogFilepath = FilepathToken->String;    /* move string */
+    Env->CounterPath = FilepathToken->String;       /* move string */
     FilepathToken->String = NULL;
-    Flag = OpenLogfile();                        /* open file */
+    Flag = True;
   }
 
   return Flag;
@@ -2846,9 +6383,10 @@ _Bool ParseConfig(Token_Type *TokenList)
 {
   _Bool                  Flag = False;       /* return value */
   unsigned short         Keyword = 0;        /* keyword ID */
-  static char            *Keywords[9] =
+  static char            *Keywords[13] =
     {"MailHeader", "MailFooter", "Limit", "Address", "Index",
-     "LogFile", "MailDir", "SetMode", NULL};
+     "LogFile", "MailDir", "SetMode", "StatThreads", "CachePath",
+     "Journal", "Counters", NULL};
 
   /* sanity check */
   if (TokenList == NULL) return Flag;
@@ -2896,6 +6434,22 @@ _Bool ParseConfig(Token_Type *TokenList)
       case 8:       /* set mode */
         Flag = Set_Mode(TokenList);
         break;
+
+      case 9:       /* stat threads */
+        Flag = Set_StatThreads(TokenList);
+        break;
+
+      case 10:      /* cache path */
+        Flag = Set_CachePath(TokenList);
+        break;
+
+      case 11:      /* journal */
+        Flag = Set_Journal(TokenList);
+        break;
+
+      case 12:      /* download counters */
+        Flag = Set_Counters(TokenList);
+        break;
     }
   }
 
@@ -3050,6 +6604,9 @@ _Bool CheckConfig()
       /* 20 files, 2000000 Bytes, 2 bad PWs, 10 Freqs */
       AddLimitElement("*", 20, 2000000, 2, 10, REQ_NONE);
     }
+
+    /* compile limits for fast matching */
+    Flag = CompileLimits();
   }
 
   return Flag;
@@ -3070,10 +6627,16 @@ void PrintUsage()
 {
   printf(NAME" "VERSION" "COPYRIGHT"\n");
   printf("Usage: "NAME" [options] -s <SRIF file>\n");
+  printf("       "NAME" [options] -d <socket>\n");
+  printf("       "NAME" [options] -b <spool path>\n");
   printf("Options:\n");
   printf("  -h, -?                 Print this brief help.\n");
   printf("  -c <config file>       Use specified configuration file.\n");
   printf("  -l <log file>          Use specified log file.\n");
+  printf("  -d <socket>            Run as resident server.\n");
+  printf("  -u <socket>            Pass request to resident server.\n");
+  printf("  -b <spool path>        Process all SRIF files in spool directory.\n");
+  printf("  -p <pattern>           Name pattern of SRIF files (default: "SPOOL_PATTERN").\n");
 }
 
 
@@ -3091,8 +6654,8 @@ _Bool ParseCommandLine(int argc, char *argv[])
   _Bool              Flag = TRUE;        /* return value */
   unsigned int       n = 1;              /* loop counter */
   unsigned short     Keyword = 0;        /* keyword ID */
-  static char        *Keywords[6] =
-    {"-h", "-?", "-c", "-l", "-s", NULL};
+  static char        *Keywords[10] =
+    {"-h", "-?", "-c", "-l", "-s", "-d", "-u", "-b", "-p", NULL};
 
   /* sanity checks */
   if ((argc == 0) || (argv == NULL)) return False;
@@ -3133,6 +6696,37 @@ _Bool ParseCommandLine(int argc, char *argv[])
             Env->SRIF_Filepath = NULL;
           }  
           Env->SRIF_Filepath = CopyString(argv[n]);
+          break;
+
+        case 6:     /* resident server */
+        case 7:     /* pass request to resident server */
+          if (Env->SocketFilepath)   /* free old value if already set */
+          {
+            free(Env->SocketFilepath);
+            Env->SocketFilepath = NULL;
+          }
+          Env->SocketFilepath = CopyString(argv[n]);
+          if (Keyword == 6) Env->RunMode = MODE_SERVER;
+          else Env->RunMode = MODE_CLIENT;
+          break;
+
+        case 8:     /* spool path */
+          if (Env->SpoolPath)        /* free old value if already set */
+          {
+            free(Env->SpoolPath);
+            Env->SpoolPath = NULL;
+          }
+          Env->SpoolPath = CopyString(argv[n]);
+          Env->RunMode = MODE_BATCH;
+          break;
+
+        case 9:     /* name pattern of spooled SRIF files */
+          if (Env->SpoolPattern)     /* free old value if already set */
+          {
+            free(Env->SpoolPattern);
+            Env->SpoolPattern = NULL;
+          }
+          Env->SpoolPattern = CopyString(argv[n]);
       }
 
       Keyword = 0;            /* reset */
@@ -3173,8 +6767,9 @@ _Bool ParseCommandLine(int argc, char *argv[])
   /* check if we got all required options */
   if (Flag && Env->Run)       /* if everything's fine so far */
   {
-    /* we must have the SRIF filepath */
-    if (Env->SRIF_Filepath == NULL)
+    /* we must have the SRIF filepath (except for server and batch mode) */
+    if ((Env->SRIF_Filepath == NULL) && (Env->RunMode != MODE_SERVER) &&
+        (Env->RunMode != MODE_BATCH))
     {
       Log(L_WARN, "Missing SRIF filepath!");
       Flag = False;
@@ -3268,14 +6863,16 @@ _Bool GetAllocations(void)
   OutBuffer = (char *) malloc(DEFAULT_BUFFER_SIZE);
   TempBuffer = (char *) malloc(DEFAULT_BUFFER_SIZE);
   TempBuffer2 = (char *) malloc(DEFAULT_BUFFER_SIZE);
-  AliasBuffer = (char *) malloc(DEFAULT_BUFFER_SIZE);
+
+  /* batch processing */
+  Batch = (Pending_Type *) malloc(sizeof(Pending_Type) * BATCH_SIZE);
 
   /* environment / configuration */
   Env = calloc(1, sizeof(Env_Type));
 
   /* check pointeris */
   if (LogBuffer && InBuffer && InBuffer2 && OutBuffer &&
-      TempBuffer && TempBuffer2 && AliasBuffer && Env)
+      TempBuffer && TempBuffer2 && Batch && Env)
   {
     Flag = True;        /* ok to proceed */
   }
@@ -3293,9 +6890,11 @@ _Bool GetAllocations(void)
 
     /* environment: file streams */
     Env->Log = NULL;
+    Env->LogFlush = LOG_FLUSH;
 
     /* environment: program control */
     Env->Run = True;          /* run by default */
+    Env->RunMode = MODE_NONE;
     Env->CfgInUse = NULL;
     Env->CfgLinenumber = 0;
 
@@ -3318,6 +6917,14 @@ _Bool GetAllocations(void)
     Env->LastIndex = NULL;
     Env->LimitList = NULL;
     Env->LastLimit = NULL;
+    Env->LimitTrie = NULL;
+    Env->LimitRules = NULL;
+    Env->StatThreads = 0;
+    Env->CachePath = NULL;
+    Env->CacheMaxFiles = CACHE_MAX_FILES;
+    Env->JournalPath = NULL;
+    Env->CounterPath = NULL;
+    Env->CounterStore = NULL;
 
     /* environment: frequest filepaths */
     Env->SRIF_Filepath = NULL;
@@ -3325,6 +6932,9 @@ _Bool GetAllocations(void)
     Env->ResponseFilepath = NULL;
     Env->MailFilepath = NULL;
     Env->TextFilepath = NULL;
+    Env->SocketFilepath = NULL;
+    Env->SpoolPath = NULL;
+    Env->SpoolPattern = NULL;
 
     /* request(er) details */
     Env->Sysop = NULL;
@@ -3367,11 +6977,18 @@ void FreeAllocations()
     if (Env->LogFilepath) free(Env->LogFilepath);
     if (Env->CWD) free(Env->CWD);
     if (Env->MailPath) free(Env->MailPath);
+    if (Env->CachePath) free(Env->CachePath);
+    if (Env->JournalPath) free(Env->JournalPath);
+    if (Env->CounterPath) free(Env->CounterPath);
+    if (Env->CounterStore) CloseCounterStore(Env->CounterStore);
     if (Env->SRIF_Filepath) free(Env->SRIF_Filepath);
     if (Env->RequestFilepath) free(Env->RequestFilepath);
     if (Env->ResponseFilepath) free(Env->ResponseFilepath);
     if (Env->MailFilepath) free(Env->MailFilepath);
     if (Env->TextFilepath) free(Env->TextFilepath);
+    if (Env->SocketFilepath) free(Env->SocketFilepath);
+    if (Env->SpoolPath) free(Env->SpoolPath);
+    if (Env->SpoolPattern) free(Env->SpoolPattern);
     if (Env->Sysop) free(Env->Sysop);
     if (Env->CallerID) free(Env->CallerID);
     if (Env->SessionType) free(Env->SessionType);
@@ -3380,8 +6997,14 @@ void FreeAllocations()
     if (Env->MailHeader) FreeTokenlist(Env->MailHeader);
     if (Env->MailFooter) FreeTokenlist(Env->MailFooter);
     if (Env->AKA) FreeAKAlist(Env->AKA);
-    if (Env->IndexList) FreeIndexList(Env->IndexList);
+    if (Env->IndexList)
+    {
+      UnloadIndexes();                /* free resident indexes */
+      FreeIndexList(Env->IndexList);
+    }
     if (Env->LimitList) FreeLimitList(Env->LimitList);
+    FreeLimitTrie(Env->LimitTrie);
+    FreeLimitRules(Env->LimitRules);
     if (Env->ReqAKA) FreeAKAlist(Env->ReqAKA);
     if (Env->CalledAKA) FreeAKAlist(Env->CalledAKA);
     if (Env->RequestList) FreeRequestList(Env->RequestList);
@@ -3422,10 +7045,12 @@ void FreeAllocations()
     free(TempBuffer2);
     TempBuffer = NULL;
   }
-  if (AliasBuffer)
+
+  /* batch processing */
+  if (Batch)
   {
-    free(AliasBuffer);
-    AliasBuffer = NULL;
+    free(Batch);
+    Batch = NULL;
   }
 }
 
@@ -3444,6 +7069,8 @@ int main(int argc, char *argv[])
 {
   int                RetVal = EXIT_FAILURE;   /* return value */
   _Bool              Flag = False;            /* control flag */
+  int                Result;                  /* result of server request */
+  struct timespec    Start;                   /* timer */
 
   /* sanity checks */
   if ((argc == 0) || (argv == NULL)) return RetVal;
@@ -3475,89 +7102,68 @@ int main(int argc, char *argv[])
 
 
   /*
-   *  read cfg, read SRIF and init stuff
+   *  pass request to resident server
    */
 
-  if (Flag && Env->Run)
+  if (Flag && Env->Run && (Env->RunMode == MODE_CLIENT))
+  {
+    Result = PassToServer();
+
+    if (Result == -1)              /* server not available */
+    {
+      Log(L_WARN, "Server not available (%s), processing request locally",
+        Env->SocketFilepath);
+      Env->RunMode = MODE_NONE;    /* fall back to standalone mode */
+    }
+    else                           /* server processed request */
+    {
+      Flag = Result;
+    }
+  }
+
+
+  /*
+   *  read cfg
+   */
+
+  if (Flag && Env->Run && (Env->RunMode != MODE_CLIENT))
   {
     Flag = False;                       /* reset flag */
+    StartTimer(&Start);
 
     if (ReadConfig(Env->CfgFilepath))   /* read config */
     {
       if (CheckConfig())                /* check cfg for required stuff */
       {
-        if (ReadSRIF())                 /* read SRIF */
-        {
-          if (CheckSRIF())              /* check SRIF for required stuff */
-          {
-            if (ActivateAKAs())         /* find best AKA pair */
-            {
-              Flag = True;              /* ok to proceed */
-            }
-          }
-        }
+        Flag = True;                    /* ok to proceed */
       }
     } 
+
+    StopTimer(TIME_CONFIG, &Start);
   }
 
 
   /*
-   *  process request
+   *  process request(s)
    */
 
   if (Flag && Env->Run)
   {
-    Flag = False;                       /* reset flag */
-
-    /* log request */
-    Log(L_INFO, "Request from %s %s",
-      Env->Sysop, Env->ActiveRemoteAKA->Address);
-    if (Env->CallerID)                  /* caller ID available */
+    if (Env->RunMode == MODE_SERVER)         /* resident server */
     {
-      Log(L_INFO, "Caller ID: %s", Env->CallerID);
+      LoadIndexes();                    /* load indexes once */
+      Flag = RunServer();               /* serve requests */
+      UnloadIndexes();                  /* free indexes */
     }
-    if (Env->SessionType)               /* session type available */
+    else if (Env->RunMode == MODE_BATCH)     /* spool directory */
     {
-      Log(L_INFO, "Session Type: %s", Env->SessionType);
+      LoadIndexes();                    /* load indexes once */
+      Flag = RunBatch();                /* process SRIF files */
+      UnloadIndexes();                  /* free indexes */
     }
-
-    ActivateLimits();         /* apply rule for frequest limits */
-
-    if (ReadRequest())        /* read request */
+    else if (Env->RunMode == MODE_NONE)      /* standalone */
     {
-      Flag = True;
-
-      /* delete request file if requested */
-      if (Env->CfgSwitches & SW_DELETE_REQUEST)
-        unlink(Env->RequestFilepath);
-
-      Flag &= ProcessRequest();    /* search for requested files */
-
-      /* create netmail if requested */
-      if (Env->CfgSwitches & SW_SEND_NETMAIL)
-        Flag &= NetMail();
-
-      /* create textmail if requested */
-      if (Env->CfgSwitches & SW_SEND_TEXT)
-        Flag &= TextMail();
-
-      /* log request detailed if requested */ 
-      if (Env->CfgSwitches & SW_LOG_REQUEST) LogRequest();
-
-      Flag &= WriteResponse();     /* write file list */
-
-      /* log results */
-      if (Env->FreqStatus & FREQ_FREQLIMIT)
-        Log(L_INFO, "frequest limit exceeded");
-      if (Env->FreqStatus & FREQ_FILELIMIT)
-        Log(L_INFO, "file limit exceeded");
-      if (Env->FreqStatus & FREQ_BYTELIMIT)
-        Log(L_INFO, "byte limit exceeded");
-      if (Env->FreqStatus & FREQ_PWLIMIT)
-        Log(L_INFO, "bad PW limit exceeded");
-
-      if (Bytes2String(Env->Bytes, TempBuffer, DEFAULT_BUFFER_SIZE))
-        Log(L_INFO, "Totals: %ld files / %s", Env->Files, TempBuffer);
+      Flag = ProcessSRIF();             /* process SRIF */
     }
   }
 
@@ -3576,6 +7182,7 @@ int main(int argc, char *argv[])
 
     if (Env->Log)             /* close logfile */
     {
+      FlushLog();             /* write buffered lines */
       fclose(Env->Log);
       Env->Log = NULL;
     }
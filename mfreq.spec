@@ -36,6 +36,7 @@ cp -a sample-cfg "%{buildroot}%{_docdir}/%{name}-%{version}/"
 %{_bindir}/mfreq-index
 %{_bindir}/mfreq-list
 %{_bindir}/mfreq-srif
+%{_bindir}/mfreq-journal
 %dir %{_docdir}/%{name}-%{version}
 %doc %{_docdir}/%{name}-%{version}/README
 %doc %{_docdir}/%{name}-%{version}/CHANGES
@@ -670,6 +670,29 @@ char *GetFilename(char *Filepath)
 
 
 
+/*
+ *  check for temporary file of mfreq-list
+ *  - ".<name>.tmp.<pid>" left behind by an aborted rewrite
+ *
+ *  returns:
+ *  - 1 if temporary file
+ *  - 0 if not
+ */
+
+_Bool IsTempFile(char *Name)
+{
+  _Bool             Flag = False;       /* return value */
+
+  /* sanity check */
+  if (Name == NULL) return Flag;
+
+  if ((Name[0] == '.') && strstr(Name, "."SUFFIX_TEMP".")) Flag = True;
+
+  return Flag;
+}
+
+
+
 /* ************************************************************************
  *   parser support functions
  * ************************************************************************ */
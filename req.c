@@ -82,6 +82,11 @@ _Bool AddIndexElement(char *Filepath, char *MountingPoint)
   if (Element)          /* success */
   {
     /* set defaults */
+    Element->Map = NULL;
+    Element->Inode = 0;
+    Element->MTime = 0;
+    Element->FailInode = 0;
+    Element->FailMTime = 0;
     Element->Next = NULL;
 
     /* copy data */
@@ -189,6 +194,463 @@ _Bool AddLimitElement(char *Address, long Files, long long Bytes, int BadPWs,
 
 
 
+/* ************************************************************************
+ *   frequest limits (trie)
+ * ************************************************************************ */
+
+
+/*
+ *  free list of compiled limit rules
+ *  - limits themselves are part of the limit list
+ */
+
+void FreeLimitRules(LimitRule_Type *List)
+{
+  LimitRule_Type      *Next;
+
+  while (List)
+  {
+    Next = List->Next;           /* save pointer to next element */
+    free(List);                  /* free structure */
+    List = Next;                 /* move to next element */
+  }
+}
+
+
+
+/*
+ *  free limit trie
+ */
+
+void FreeLimitTrie(LimitNode_Type *Node)
+{
+  unsigned int        n;                   /* counter */
+
+  /* sanity check */
+  if (Node == NULL) return;
+
+  for (n = 0; n < Node->Count; n++)        /* free next level */
+  {
+    FreeLimitTrie(Node->Children[n]);
+  }
+
+  if (Node->Children) free(Node->Children);
+  if (Node->Domain) free(Node->Domain);
+  FreeLimitRules(Node->Rest);
+  FreeLimitRules(Node->End);
+  free(Node);
+}
+
+
+
+/*
+ *  add compiled limit rule to end of list
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool AddLimitRule(LimitRule_Type **List, Limit_Type *Limit,
+  unsigned int Number)
+{
+  _Bool               Flag = False;        /* return value */
+  LimitRule_Type      *Element;            /* new element */
+
+  /* sanity checks */
+  if ((List == NULL) || (Limit == NULL)) return Flag;
+
+  Element = malloc(sizeof(LimitRule_Type));
+  if (Element)
+  {
+    Element->Limit = Limit;
+    Element->Number = Number;
+    Element->Next = NULL;
+
+    while (*List) List = &(*List)->Next;   /* find end of list */
+    *List = Element;                       /* and link */
+
+    Flag = True;
+  }
+  else
+  {
+    Log(L_ERR, "Couldn't allocate memory!");
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  get child node of limit trie
+ *  - children are sorted by value and domain (wildcard first)
+ *  - binary search
+ *  - Create: add missing node
+ *
+ *  returns:
+ *  - pointer to node on success
+ *  - NULL if not found or on error
+ */
+
+LimitNode_Type *GetLimitNode(LimitNode_Type *Parent, long Value, char *Domain,
+  _Bool Create)
+{
+  LimitNode_Type      *Node = NULL;        /* return value */
+  LimitNode_Type      **Children;          /* new array */
+  unsigned int        Start = 0;           /* lower index */
+  unsigned int        Stop;                /* upper index + 1 */
+  unsigned int        Middle;              /* middle index */
+  int                 Check;               /* result of comparison */
+
+  /* sanity check */
+  if (Parent == NULL) return Node;
+
+  Stop = Parent->Count;
+
+  while (Start < Stop)            /* binary search */
+  {
+    Middle = (Start + Stop) / 2;
+    Node = Parent->Children[Middle];
+
+    /* compare value, then domain */
+    if (Node->Value < Value) Check = -1;
+    else if (Node->Value > Value) Check = 1;
+    else if (Node->Domain == Domain) Check = 0;     /* both NULL */
+    else if (Node->Domain == NULL) Check = -1;
+    else if (Domain == NULL) Check = 1;
+    else Check = strcmp(Node->Domain, Domain);
+
+    if (Check == 0) Start = Stop = Middle + 1;  /* found, end loop */
+    else
+    {
+      if (Check < 0) Start = Middle + 1;
+      else Stop = Middle;
+      Node = NULL;
+    }
+  }
+
+  /* insert new node at position */
+  if ((Node == NULL) && Create)
+  {
+    Node = calloc(1, sizeof(LimitNode_Type));
+    Children = realloc(Parent->Children,
+      sizeof(LimitNode_Type *) * (Parent->Count + 1));
+
+    if (Node && Children)
+    {
+      Node->Value = Value;
+      if (Domain) Node->Domain = CopyString(Domain);
+
+      memmove(&Children[Start + 1], &Children[Start],
+        sizeof(LimitNode_Type *) * (Parent->Count - Start));
+      Children[Start] = Node;
+      Parent->Children = Children;
+      Parent->Count++;
+    }
+    else
+    {
+      if (Children) Parent->Children = Children;
+      if (Node) free(Node);
+      Node = NULL;
+      Log(L_ERR, "Couldn't allocate memory!");
+    }
+  }
+
+  return Node;
+}
+
+
+
+/*
+ *  add limit to trie
+ *  - supports address patterns with a number or "*" for each field,
+ *    a domain or "*" for the domain, and a final "*" for any remainder
+ *    (e.g. "2:240/5.*", "1:2/3.4@fidonet" or "*")
+ *  - other patterns have to be matched the old way
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 if pattern doesn't fit the trie or on error
+ */
+
+_Bool AddLimitPattern(Limit_Type *Limit, unsigned int Number)
+{
+  _Bool               Flag = True;         /* return value */
+  _Bool               Rest = False;        /* final "*" */
+  static char         Separators[4] = {':', '/', '.', '@'};
+  long                Values[4];           /* zone, net, node, point */
+  unsigned short      Fields = 0;          /* number of fields */
+  char                *Domain = NULL;      /* domain */
+  char                *Help;
+  size_t              Length;
+  LimitNode_Type      *Node;               /* trie node */
+  LimitRule_Type      **List = NULL;       /* rule list */
+  unsigned short      n;                   /* counter */
+
+  /* sanity check */
+  if ((Limit == NULL) || (Limit->Address == NULL)) return False;
+
+  /*
+   *  split pattern into fields
+   */
+
+  Help = Limit->Address;
+
+  while (Flag && !Rest && (Domain == NULL) && (Fields < 4))
+  {
+    Length = strcspn(Help, ":/.@");        /* length of field */
+
+    if ((Length == 1) && (Help[0] == '*'))      /* wildcard */
+    {
+      Values[Fields] = -1;
+      if (Help[1] == 0) Rest = True;       /* final "*" */
+    }
+    else if ((Length > 0) && (Length <= 5) &&
+             (strspn(Help, "0123456789") == Length) &&
+             ((Help[0] != '0') || (Length == 1)))   /* plain number */
+    {
+      Values[Fields] = atol(Help);
+      if (Values[Fields] > 65535) Flag = False;
+    }
+    else                                   /* anything else */
+    {
+      Flag = False;
+    }
+
+    Help += Length;
+
+    if (Flag && !Rest)
+    {
+      /* check separator */
+      if (Help[0] == Separators[Fields])
+      {
+        Help++;
+        if (Fields == 3) Domain = Help;    /* point is followed by domain */
+      }
+      else if ((Help[0] != 0) || (Fields < 3))
+      {
+        Flag = False;                      /* unexpected end or separator */
+      }
+    }
+
+    Fields++;
+  }
+
+  /* check domain: "*" or plain string */
+  if (Flag && Domain)
+  {
+    if ((Domain[0] == 0) ||
+        ((strpbrk(Domain, "*?") != NULL) && (strcmp(Domain, "*") != 0)))
+      Flag = False;
+  }
+
+
+  /*
+   *  add nodes and rule
+   */
+
+  if (Flag)
+  {
+    Node = Env->LimitTrie;
+
+    if (Rest)                      /* final "*" is no node */
+    {
+      Fields--;
+    }
+
+    for (n = 0; Node && (n < Fields); n++)
+    {
+      Node = GetLimitNode(Node, Values[n], NULL, True);
+    }
+
+    if (Domain && Node)            /* domain node */
+    {
+      if (strcmp(Domain, "*") == 0) Node = GetLimitNode(Node, -1, NULL, True);
+      else Node = GetLimitNode(Node, 0, Domain, True);
+    }
+
+    if (Node)
+    {
+      if (Rest) List = &Node->Rest;
+      else List = &Node->End;
+
+      Flag = AddLimitRule(List, Limit, Number);
+    }
+    else
+    {
+      Flag = False;
+    }
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  compile limit list
+ *  - builds trie of zone/net/node/point/domain
+ *  - keeps limits not fitting the trie in a separate list
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool CompileLimits()
+{
+  _Bool               Flag = True;         /* return value */
+  Limit_Type          *Limit;              /* limit list */
+  unsigned int        Number = 0;          /* position in list */
+
+  /* reset */
+  FreeLimitTrie(Env->LimitTrie);
+  FreeLimitRules(Env->LimitRules);
+  Env->LimitRules = NULL;
+
+  Env->LimitTrie = calloc(1, sizeof(LimitNode_Type));
+  if (Env->LimitTrie == NULL)
+  {
+    Log(L_ERR, "Couldn't allocate memory!");
+    return False;
+  }
+
+  Limit = Env->LimitList;
+  while (Flag && Limit)
+  {
+    Number++;
+
+    if (!AddLimitPattern(Limit, Number))        /* doesn't fit trie */
+    {
+      Flag = AddLimitRule(&Env->LimitRules, Limit, Number);
+    }
+
+    Limit = Limit->Next;           /* next element */
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  update best rule with first usable rule of list
+ *  - rules requiring a listed node are skipped for unlisted ones
+ */
+
+void UpdateBestLimit(LimitRule_Type **Best, LimitRule_Type *List,
+  unsigned short ReqFlags)
+{
+  while (List)
+  {
+    if (!(List->Limit->Flags & REQ_LISTED) || (ReqFlags & REQ_LISTED))
+    {
+      if ((*Best == NULL) || (List->Number < (*Best)->Number)) *Best = List;
+      List = NULL;                 /* end loop */
+    }
+    else
+    {
+      List = List->Next;           /* next element */
+    }
+  }
+}
+
+
+
+/*
+ *  search limit trie for best rule
+ *  - follows exact and wildcard nodes
+ *  - Level: 0 (root) to 5 (domain)
+ */
+
+void SearchLimitTrie(LimitNode_Type *Node, unsigned short Level,
+  AKA_Type *AKA, unsigned short ReqFlags, LimitRule_Type **Best)
+{
+  long                Value = 0;           /* field value */
+
+  /* sanity check */
+  if (Node == NULL) return;
+
+  if (Level < 4)                   /* zone, net, node or point follows */
+  {
+    UpdateBestLimit(Best, Node->Rest, ReqFlags);
+
+    if (Level == 0) Value = AKA->Zone;
+    else if (Level == 1) Value = AKA->Net;
+    else if (Level == 2) Value = AKA->Node;
+    else Value = AKA->Point;
+
+    SearchLimitTrie(GetLimitNode(Node, Value, NULL, False), Level + 1,
+      AKA, ReqFlags, Best);
+    SearchLimitTrie(GetLimitNode(Node, -1, NULL, False), Level + 1,
+      AKA, ReqFlags, Best);
+  }
+  else if (Level == 4)             /* domain follows */
+  {
+    if (AKA->Domain == NULL)       /* no domain */
+    {
+      UpdateBestLimit(Best, Node->End, ReqFlags);
+    }
+    else
+    {
+      SearchLimitTrie(GetLimitNode(Node, 0, AKA->Domain, False), Level + 1,
+        AKA, ReqFlags, Best);
+      SearchLimitTrie(GetLimitNode(Node, -1, NULL, False), Level + 1,
+        AKA, ReqFlags, Best);
+    }
+  }
+  else                             /* domain */
+  {
+    UpdateBestLimit(Best, Node->End, ReqFlags);
+  }
+}
+
+
+
+/*
+ *  find first matching limit for AKA
+ *  - same result as checking the limit list in order
+ *
+ *  returns:
+ *  - pointer to limit on success
+ *  - NULL if no limit matches
+ */
+
+Limit_Type *MatchLimit(AKA_Type *AKA, unsigned short ReqFlags)
+{
+  Limit_Type          *Limit = NULL;       /* return value */
+  LimitRule_Type      *Best = NULL;        /* best rule */
+  LimitRule_Type      *Rule;               /* rule list */
+
+  /* sanity check */
+  if ((AKA == NULL) || (AKA->Address == NULL)) return Limit;
+
+  SearchLimitTrie(Env->LimitTrie, 0, AKA, ReqFlags, &Best);
+
+  /* check other limits, but only those before the best rule */
+  Rule = Env->LimitRules;
+  while (Rule && ((Best == NULL) || (Rule->Number < Best->Number)))
+  {
+    if ((!(Rule->Limit->Flags & REQ_LISTED) || (ReqFlags & REQ_LISTED)) &&
+        MatchPattern(AKA->Address, Rule->Limit->Address))
+    {
+      Best = Rule;
+      Rule = NULL;                 /* end loop */
+    }
+    else
+    {
+      Rule = Rule->Next;           /* next element */
+    }
+  }
+
+  if (Best) Limit = Best->Limit;
+
+  return Limit;
+}
+
+
+
 /* ************************************************************************
  *   files to send (linked list)
  * ************************************************************************ */
@@ -371,6 +833,7 @@ void FreeRequestList(Request_Type *List)
     if (List->Name) free(List->Name);
     if ((List->SearchName) && (List->SearchName != List->Name)) free(List->SearchName);
     if (List->PW) free(List->PW);
+    if (List->Literal) free(List->Literal);
     if (List->Files) FreeResponseList(List->Files);
 
     /* free structure */
@@ -382,6 +845,139 @@ void FreeRequestList(Request_Type *List)
 
 
 
+/*
+ *  select search plan for request
+ *  - based on shape of filename pattern
+ *  - "*" and "**" match anything
+ *  - "*<chars>" matches names ending with <chars>
+ *  - "*<chars>*" matches names containing <chars> (e.g. "*.*")
+ *  - <chars> must not include any wildcard
+ *
+ *  returns:
+ *  - 1 on success
+ *  - 0 on error
+ */
+
+_Bool PlanRequest(Request_Type *Request)
+{
+  _Bool             Flag = True;        /* return value */
+  char              *Help;              /* support pointer */
+  char              *Start;             /* start of fixed part */
+  size_t            Length = 0;         /* length of fixed part */
+
+  /* sanity check */
+  if ((Request == NULL) || (Request->SearchName == NULL)) return False;
+
+  Request->Plan = PLAN_PATTERN;
+  Request->Literal = NULL;
+  Request->LiteralLength = 0;
+
+  /* find first wildcard */
+  Help = strpbrk(Request->SearchName, "*?");
+
+  if (Help == NULL)                     /* no wildcard at all */
+  {
+    Request->Pos = -1;
+    Request->Plan = PLAN_NAME;
+  }
+  else if (Help != Request->SearchName) /* fixed prefix */
+  {
+    Request->Pos = Help - Request->SearchName;
+    Request->Plan = PLAN_PREFIX;
+  }
+  else                                  /* starts with wildcard */
+  {
+    Request->Pos = 0;
+
+    /* skip leading "*" */
+    while (Help[0] == '*') Help++;
+
+    /* get fixed part */
+    Start = Help;
+    while ((Help[0] != 0) && (Help[0] != '*') && (Help[0] != '?'))
+    {
+      Length++;
+      Help++;
+    }
+
+    /* skip trailing "*" */
+    if (Length > 0)
+    {
+      while (Help[0] == '*') Help++;
+    }
+
+    if (Start == Request->SearchName)   /* leading "?" */
+    {
+      /* keep pattern matching */
+    }
+    else if (Length == 0)               /* just "*" */
+    {
+      if (Help[0] == 0) Request->Plan = PLAN_ALL;
+    }
+    else if (Help[0] == 0)              /* end of pattern */
+    {
+      Request->Literal = malloc(Length + 1);
+      if (Request->Literal)
+      {
+        strncpy(Request->Literal, Start, Length);
+        Request->Literal[Length] = 0;
+        Request->LiteralLength = Length;
+
+        if (Start[Length] == 0) Request->Plan = PLAN_SUFFIX;
+        else Request->Plan = PLAN_CONTAINS;
+      }
+      else
+      {
+        Flag = False;
+      }
+    }
+  }
+
+  return Flag;
+}
+
+
+
+/*
+ *  get name of search plan (for logging)
+ */
+
+char *GetPlanName(unsigned short Plan)
+{
+  char                   *Name;         /* return value */
+
+  switch (Plan)
+  {
+    case PLAN_NAME:
+      Name = "name";
+      break;
+
+    case PLAN_PREFIX:
+      Name = "prefix";
+      break;
+
+    case PLAN_ALL:
+      Name = "all";
+      break;
+
+    case PLAN_SUFFIX:
+      Name = "suffix";
+      break;
+
+    case PLAN_CONTAINS:
+      Name = "substring";
+      break;
+
+    default:
+      Name = "pattern";
+      break;
+  }
+
+  return Name;
+}
+
+
+
 /*
  *  create and add new request element to global list
  *
@@ -405,6 +1001,10 @@ _Bool AddRequestElement(char *Name, char *Password)
   {
     /* set defaults */
     Element->PW = NULL;
+    Element->Plan = PLAN_PATTERN;
+    Element->Pos = 0;
+    Element->Literal = NULL;
+    Element->LiteralLength = 0;
     Element->Files = NULL;
     Element->Status = FREQ_NONE;
     Element->LastFile = NULL;
@@ -434,6 +1034,12 @@ _Bool AddRequestElement(char *Name, char *Password)
       Element->SearchName = Element->Name;        /* same filename pattern */
     }
 
+    /* select search plan */
+    if (Element->SearchName && !PlanRequest(Element))
+    {
+      Log(L_ERR, "Couldn't allocate memory!");
+    }
+
     /* add new element to list */
     if (Env->LastRequest) Env->LastRequest->Next = Element;    /* just link */
     else Env->RequestList = Element;                           /* start list */
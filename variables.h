@@ -16,9 +16,11 @@
  *  - mfreq-index.c
  *  - mfreq-list.c 
  *  - mfreq-srif.c
+ *  - mfreq-journal.c
  */
 
-#if defined ( MFREQ_INDEX_C ) || defined ( MFREQ_LIST_C ) || defined( MFREQ_SRIF_C )
+#if defined ( MFREQ_INDEX_C ) || defined ( MFREQ_LIST_C ) || \
+    defined( MFREQ_SRIF_C ) || defined ( MFREQ_JOURNAL_C )
 
   /* environment */
   Env_Type                *Env = NULL;